@@ -28,6 +28,8 @@
 #include <opendavinci/GeneratedHeaders_OpenDaVINCI.h>
 #include <opendavinci/odcore/wrapper/SharedMemory.h>
 
+#include "SharedImageRing.h"
+
 namespace opendlv {
 namespace core {
 namespace system {
@@ -72,9 +74,22 @@ class Camera {
     virtual ~Camera();
 
     /**
-     * @return Meta information about the image.
+     * This method captures a frame into the shared memory.
+     *
+     * @param sharedImage Meta information about the image; only set if a frame was published.
+     * @return true if a new frame was written into the shared memory.
+     */
+    bool capture(odcore::data::image::SharedImage &sharedImage);
+
+    /**
+     * This method lets the images be written in turn into the slots
+     * "<name>.<k>" of a SharedImageRing instead of the single segment
+     * "<name>"; the SharedImage names the slot of each image.
+     *
+     * @param numberOfSlots Number of slots; 1 keeps the single segment.
+     * @return true if the slots are used.
      */
-    odcore::data::image::SharedImage capture();
+    bool setSlots(const uint32_t &numberOfSlots);
 
    protected:
     /**
@@ -99,6 +114,7 @@ class Camera {
    private:
     odcore::data::image::SharedImage m_sharedImage;
     std::shared_ptr< odcore::wrapper::SharedMemory > m_sharedMemory;
+    std::shared_ptr< SharedImageRing > m_ring; //slots the images are written into; empty to use m_sharedMemory
 
    protected:
     string m_name;
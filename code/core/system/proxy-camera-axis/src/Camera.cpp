@@ -20,6 +20,7 @@
 #include <iostream>
 
 #include <opendavinci/odcore/base/Lock.h>
+#include <opendavinci/odcore/data/TimeStamp.h>
 #include <opendavinci/odcore/wrapper/SharedMemoryFactory.h>
 
 #include "Camera.h"
@@ -34,6 +35,7 @@ using namespace odcore::base;
 Camera::Camera(const string &name, const uint32_t &width, const uint32_t &height)
     : m_sharedImage()
     , m_sharedMemory()
+    , m_ring()
     , m_name(name)
     , m_width(width)
     , m_height(height)
@@ -68,17 +70,41 @@ uint32_t Camera::getSize() const {
     return m_size;
 }
 
-odcore::data::image::SharedImage Camera::capture() {
+bool Camera::capture(odcore::data::image::SharedImage &sharedImage) {
+    bool retVal = false;
     if (isValid()) {
         if (captureFrame()) {
-            if (m_sharedMemory.get() && m_sharedMemory->isValid()) {
+            if (m_ring.get() != NULL) {
+                //A slot that could not be written stays marked as being written and is reused for the next image
+                if (copyImageTo(m_ring->beginFrame(), m_size)) {
+                    m_sharedImage.setName(m_ring->publishFrame(odcore::data::TimeStamp().toMicroseconds()));
+                    retVal = true;
+                }
+            } else if (m_sharedMemory.get() && m_sharedMemory->isValid()) {
                 Lock l(m_sharedMemory);
-                copyImageTo(static_cast<char*>(m_sharedMemory->getSharedMemory()), m_size);
+                retVal = copyImageTo(static_cast<char*>(m_sharedMemory->getSharedMemory()), m_size);
+            }
+            if (retVal) {
+                sharedImage = m_sharedImage;
             }
         }
     }
 
-    return m_sharedImage;
+    return retVal;
+}
+
+bool Camera::setSlots(const uint32_t &numberOfSlots) {
+    if (numberOfSlots < 2) {
+        m_ring.reset();
+        m_sharedImage.setName(m_name);
+        return false;
+    }
+    std::shared_ptr< SharedImageRing > ring(new SharedImageRing(m_name, numberOfSlots, m_size));
+    if (!ring->isValid()) {
+        return false;
+    }
+    m_ring = ring;
+    return true;
 }
 }
 }
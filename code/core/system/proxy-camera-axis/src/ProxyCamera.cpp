@@ -66,6 +66,20 @@ void ProxyCamera::setUp() {
     m_camera = unique_ptr< Camera >(new AxisCamera(NAME, ADDRESS, USERNAME, PASSWORD, WIDTH, HEIGHT, CALIBRATION_FILE, DEBUG));
     if (m_camera.get() == NULL) {
         cerr << "[" << getName() << "] No valid camera type defined." << endl;
+        return;
+    }
+
+    //Optional: number of shared memory slots "<name>.<k>" the images are written into in turn (1, default: overwrite "<name>" under its lock)
+    uint32_t slots = 1;
+    try {
+        slots = getKeyValueConfiguration().getValue< uint32_t >("proxy-camera-axis.slots");
+    }
+    catch(...) {
+        slots = 1;
+    }
+    cout << "[" << getName() << "] Shared memory slots (1: single segment; >1: ring of slots):" << slots << endl;
+    if (slots > 1 && !m_camera->setSlots(slots)) {
+        cerr << "[" << getName() << "] Shared memory slots could not be created; using the single segment instead." << endl;
     }
 }
 
@@ -76,17 +90,19 @@ odcore::data::dmcp::ModuleExitCodeMessage::ModuleExitCode ProxyCamera::body() {
     while (getModuleStateAndWaitForRemainingTimeInTimeslice() == odcore::data::dmcp::ModuleStateMessage::RUNNING) {
         if (m_camera.get() != NULL) {
             // Capture frame.
-            odcore::data::image::SharedImage si = m_camera->capture();
-            TimeStamp now;
+            odcore::data::image::SharedImage si;
+            if (m_camera->capture(si)) {
+                TimeStamp now;
 
-            // Create container with meta-information about captured frame.
-            Container c(si);
-            c.setSampleTimeStamp(now);
+                // Create container with meta-information about captured frame.
+                Container c(si);
+                c.setSampleTimeStamp(now);
 
-            // Share container for recording.
-            getConference().send(c);
+                // Share container for recording.
+                getConference().send(c);
 
-            captureCounter++;
+                captureCounter++;
+            }
         }
     }
     cout << "[" << getName() << "] Captured " << captureCounter << " frames." << endl;
@@ -0,0 +1,151 @@
+/**
+ * CameraPipelineBenchmark - Publish jitter and frame age of the camera capture paths
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opendavinci/odcore/data/TimeStamp.h>
+
+#include "Camera.h"
+#include "CameraCaptureThread.h"
+#include "SyntheticCamera.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+namespace {
+
+// The test pattern at the frame rate of the camera; every slowEvery-th frame takes slowTime longer to copy.
+class PacedCamera : public SyntheticCamera {
+   public:
+    PacedCamera(const string &name, const uint32_t &width, const uint32_t &height, const float &fps, const uint32_t &slowEvery, const chrono::microseconds &slowTime)
+        : SyntheticCamera(name, 0, width, height, 3, fps)
+        , m_slowEvery(slowEvery)
+        , m_slowTime(slowTime) {}
+
+   protected:
+    virtual bool copyImageTo(char *dest, const uint32_t &size) {
+        const bool retVal = SyntheticCamera::copyImageTo(dest, size);
+        if (m_slowEvery > 0 && getFrame() % m_slowEvery == 0) {
+            this_thread::sleep_for(m_slowTime);
+        }
+        return retVal;
+    }
+
+   private:
+    uint32_t m_slowEvery;
+    chrono::microseconds m_slowTime;
+};
+
+double percentile(vector< int64_t > values, const double &fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    sort(values.begin(), values.end());
+    const size_t index = min(values.size() - 1, static_cast< size_t >(fraction * static_cast< double >(values.size())));
+    return static_cast< double >(values[index]) / 1000.0;
+}
+
+void report(const string &name, const vector< int64_t > &intervals, const vector< int64_t > &ages, const int64_t &period) {
+    vector< int64_t > jitter;
+    for (auto interval : intervals) {
+        jitter.push_back(abs(interval - period));
+    }
+    cout << name << ": " << ages.size() << " frames published" << endl;
+    cout << "  publish jitter (ms)  p50 " << percentile(jitter, 0.5) << ", p90 " << percentile(jitter, 0.9) << ", p99 " << percentile(jitter, 0.99) << ", max " << percentile(jitter, 1.0) << endl;
+    cout << "  frame age (ms)       p50 " << percentile(ages, 0.5) << ", p90 " << percentile(ages, 0.9) << ", p99 " << percentile(ages, 0.99) << ", max " << percentile(ages, 1.0) << endl;
+}
+
+// Runs the publish loop at the given period like a time-triggered module: waits for the rest of the timeslice unless it is overrun.
+template < typename Publish >
+void run(const string &name, const chrono::microseconds &period, const chrono::seconds &duration, Publish publish) {
+    vector< int64_t > intervals;
+    vector< int64_t > ages;
+    const chrono::steady_clock::time_point end = chrono::steady_clock::now() + duration;
+    chrono::steady_clock::time_point slice = chrono::steady_clock::now();
+    odcore::data::TimeStamp last;
+    bool first = true;
+    while (slice < end) {
+        odcore::data::TimeStamp captured;
+        if (publish(captured)) {
+            const odcore::data::TimeStamp now;
+            if (!first) {
+                intervals.push_back(now.toMicroseconds() - last.toMicroseconds());
+            }
+            ages.push_back(now.toMicroseconds() - captured.toMicroseconds());
+            last = now;
+            first = false;
+        }
+        slice += period;
+        if (slice > chrono::steady_clock::now()) {
+            this_thread::sleep_until(slice);
+        } else {
+            slice = chrono::steady_clock::now();
+        }
+    }
+    report(name, intervals, ages, period.count());
+}
+}
+
+int32_t main(int32_t argc, char **argv) {
+    // Arguments: seconds per run, publish frequency in Hz, camera frame rate, width, height.
+    const int64_t seconds = (argc > 1) ? atoi(argv[1]) : 10;
+    const int64_t frequency = (argc > 2) ? atoi(argv[2]) : 20;
+    const int64_t fps = (argc > 3) ? atoi(argv[3]) : 30;
+    const uint32_t width = (argc > 4) ? static_cast< uint32_t >(atoi(argv[4])) : 1280;
+    const uint32_t height = (argc > 5) ? static_cast< uint32_t >(atoi(argv[5])) : 720;
+    const chrono::microseconds period(1000000 / frequency);
+    cout << "Publishing at " << frequency << " Hz from a " << width << "x" << height << " camera at " << fps << " fps; every 10th frame takes 25 ms longer" << endl;
+
+    {
+        PacedCamera camera("CameraPipelineBenchmarkSync", width, height, static_cast< float >(fps), 10, chrono::milliseconds(25));
+        run("capture in the timeslice", period, chrono::seconds(seconds), [&camera](odcore::data::TimeStamp &captured) {
+            odcore::data::image::SharedImage si;
+            if (!camera.capture(si)) {
+                return false;
+            }
+            captured = camera.getCaptureTimeStamp();
+            return true;
+        });
+    }
+
+    {
+        PacedCamera camera("CameraPipelineBenchmarkThread", width, height, static_cast< float >(fps), 10, chrono::milliseconds(25));
+        CameraCaptureThread capture(camera);
+        capture.start();
+        run("capture thread", period, chrono::seconds(seconds), [&capture](odcore::data::TimeStamp &captured) {
+            if (!capture.nextFrame()) {
+                return false;
+            }
+            captured = capture.getFrame().m_captured;
+            return true;
+        });
+        capture.stop();
+        const CameraCaptureStatistics statistics = capture.getStatistics();
+        cout << "  captured " << statistics.captured << ", replaced before publishing " << statistics.overwritten << endl;
+    }
+    return 0;
+}
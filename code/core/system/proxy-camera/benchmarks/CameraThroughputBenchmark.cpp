@@ -0,0 +1,229 @@
+/**
+ * CameraThroughputBenchmark - Latency and frame rate from the camera to concurrent consumers
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opendavinci/odcore/base/Lock.h>
+#include <opendavinci/odcore/data/Container.h>
+#include <opendavinci/odcore/data/TimeStamp.h>
+#include <opendavinci/odcore/wrapper/SharedMemory.h>
+#include <opendavinci/odcore/wrapper/SharedMemoryFactory.h>
+
+#include "SharedImageRing.h"
+#include "SyntheticCamera.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+namespace {
+
+double percentile(vector< int64_t > values, const double &fraction) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    sort(values.begin(), values.end());
+    const size_t index = min(values.size() - 1, static_cast< size_t >(fraction * static_cast< double >(values.size())));
+    return static_cast< double >(values[index]) / 1000.0;
+}
+
+// Delivers the containers to one consumer as the conference would.
+class ContainerQueue {
+   private:
+    ContainerQueue(const ContainerQueue &);
+    ContainerQueue &operator=(const ContainerQueue &);
+
+   public:
+    ContainerQueue()
+        : m_mutex()
+        , m_condition()
+        , m_containers()
+        , m_closed(false) {}
+
+    void push(const odcore::data::Container &c) {
+        {
+            lock_guard< mutex > l(m_mutex);
+            m_containers.push_back(c);
+        }
+        m_condition.notify_one();
+    }
+
+    void close() {
+        {
+            lock_guard< mutex > l(m_mutex);
+            m_closed = true;
+        }
+        m_condition.notify_one();
+    }
+
+    // Takes the newest container; skipped counts the older ones dropped.
+    bool pop(odcore::data::Container &c, uint64_t &skipped) {
+        unique_lock< mutex > l(m_mutex);
+        m_condition.wait(l, [this]() { return m_closed || !m_containers.empty(); });
+        if (m_containers.empty()) {
+            return false;
+        }
+        skipped += m_containers.size() - 1;
+        c = m_containers.back();
+        m_containers.clear();
+        return true;
+    }
+
+   private:
+    mutex m_mutex;
+    condition_variable m_condition;
+    deque< odcore::data::Container > m_containers;
+    bool m_closed;
+};
+
+struct ConsumerResult {
+    ConsumerResult()
+        : received(0)
+        , skipped(0)
+        , torn(0)
+        , latencies() {}
+
+    uint64_t received; //complete images read
+    uint64_t skipped; //containers replaced by a newer one before they were taken
+    uint64_t torn; //images overwritten while reading
+    vector< int64_t > latencies; //capture until the image was read, microseconds
+};
+
+// Reads the announced image like CameraProjection and checks that its first and last bytes belong to the same frame.
+void consume(ContainerQueue &queue, const uint32_t &work, ConsumerResult &result) {
+    map< string, shared_ptr< odcore::wrapper::SharedMemory > > segments;
+    vector< char > image;
+    odcore::data::Container c;
+    while (queue.pop(c, result.skipped)) {
+        const odcore::data::image::SharedImage si = c.getData< odcore::data::image::SharedImage >();
+        shared_ptr< odcore::wrapper::SharedMemory > &segment = segments[si.getName()];
+        if (segment.get() == NULL) {
+            segment = odcore::wrapper::SharedMemoryFactory::attachToSharedMemory(si.getName());
+        }
+        if (segment.get() == NULL || !segment->isValid()) {
+            continue;
+        }
+        image.resize(si.getSize());
+        bool complete = true;
+        if (si.getName().find('.') != string::npos) {
+            uint32_t frame = 0;
+            complete = SharedImageRing::read(segment->getSharedMemory(), segment->getSize(), &image[0], si.getSize(), frame);
+        } else {
+            odcore::base::Lock l(segment);
+            ::memcpy(&image[0], segment->getSharedMemory(), si.getSize());
+        }
+        const odcore::data::TimeStamp now;
+        const uint32_t last = si.getSize() - 1;
+        const uint8_t expected = static_cast< uint8_t >(static_cast< uint8_t >(image[0]) + SyntheticCamera::getPixel(0, si.getWidth() - 1, si.getHeight() - 1, si.getBytesPerPixel() - 1));
+        if (!complete || static_cast< uint8_t >(image[last]) != expected) {
+            result.torn++;
+            continue;
+        }
+        result.received++;
+        result.latencies.push_back(now.toMicroseconds() - c.getSampleTimeStamp().toMicroseconds());
+        if (work > 0) {
+            this_thread::sleep_for(chrono::milliseconds(work));
+        }
+    }
+}
+
+void run(const uint32_t &seconds, const uint32_t &width, const uint32_t &height, const uint32_t &bpp, const float &fps, const uint32_t &consumers, const uint32_t &slots, const uint32_t &work) {
+    SyntheticCamera camera("CameraThroughputBenchmark", 0, width, height, bpp, fps);
+    if (slots > 1 && !camera.setSlots(slots)) {
+        cerr << "Shared memory slots could not be created." << endl;
+        return;
+    }
+
+    vector< unique_ptr< ContainerQueue > > queues;
+    vector< ConsumerResult > results(consumers);
+    vector< thread > threads;
+    for (uint32_t i = 0; i < consumers; i++) {
+        queues.push_back(unique_ptr< ContainerQueue >(new ContainerQueue()));
+    }
+    for (uint32_t i = 0; i < consumers; i++) {
+        // The last consumer is the slow one.
+        threads.push_back(thread(consume, ref(*queues[i]), (i + 1 == consumers) ? work : 0, ref(results[i])));
+    }
+
+    // The body of ProxyCamera: capture into the shared memory and announce the image.
+    vector< int64_t > writes;
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    const chrono::steady_clock::time_point end = start + chrono::seconds(seconds);
+    uint64_t published = 0;
+    while (chrono::steady_clock::now() < end) {
+        odcore::data::image::SharedImage si;
+        if (!camera.capture(si)) {
+            continue;
+        }
+        const odcore::data::TimeStamp now;
+        odcore::data::Container c(si);
+        c.setSampleTimeStamp(camera.getCaptureTimeStamp());
+        for (auto &queue : queues) {
+            queue->push(c);
+        }
+        writes.push_back(now.toMicroseconds() - camera.getCaptureTimeStamp().toMicroseconds());
+        published++;
+    }
+    const double elapsed = chrono::duration< double >(chrono::steady_clock::now() - start).count();
+    for (auto &queue : queues) {
+        queue->close();
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+
+    cout << width << "x" << height << "x" << bpp << ", " << ((slots > 1) ? to_string(slots) + " slots" : string("single segment")) << ", " << consumers << " consumers"
+         << ((work > 0) ? ", the last one busy for " + to_string(work) + " ms per image" : string("")) << ":" << endl;
+    cout << "  published " << (static_cast< double >(published) / elapsed) << " frames/s, written into the shared memory in (ms) p50 " << percentile(writes, 0.5) << ", p99 " << percentile(writes, 0.99) << endl;
+    for (uint32_t i = 0; i < consumers; i++) {
+        const ConsumerResult &r = results[i];
+        cout << "  consumer " << i << ": " << (static_cast< double >(r.received) / elapsed) << " frames/s, skipped " << r.skipped << ", torn " << r.torn
+             << ", latency (ms) p50 " << percentile(r.latencies, 0.5) << ", p99 " << percentile(r.latencies, 0.99) << ", max " << percentile(r.latencies, 1.0) << endl;
+    }
+}
+}
+
+int32_t main(int32_t argc, char **argv) {
+    // Arguments: seconds per run, width, height, bytes per pixel, camera frame rate (0: as fast as possible), consumers, ms the last consumer works per image.
+    const uint32_t seconds = (argc > 1) ? static_cast< uint32_t >(atoi(argv[1])) : 5;
+    const uint32_t width = (argc > 2) ? static_cast< uint32_t >(atoi(argv[2])) : 1280;
+    const uint32_t height = (argc > 3) ? static_cast< uint32_t >(atoi(argv[3])) : 720;
+    const uint32_t bpp = (argc > 4) ? static_cast< uint32_t >(atoi(argv[4])) : 3;
+    const float fps = (argc > 5) ? static_cast< float >(atof(argv[5])) : 0.0f;
+    const uint32_t consumers = (argc > 6) ? static_cast< uint32_t >(atoi(argv[6])) : 3;
+    const uint32_t work = (argc > 7) ? static_cast< uint32_t >(atoi(argv[7])) : 20;
+
+    run(seconds, width, height, bpp, fps, consumers, 1, work);
+    run(seconds, width, height, bpp, fps, consumers, 3, work);
+    return 0;
+}
@@ -0,0 +1,103 @@
+/**
+ * ImageConversionBenchmark - Throughput of the camera image conversions
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <stdint.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ImageConversion.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+namespace {
+
+typedef void (*Conversion)(const ImageConversion::Kernel &, const uint8_t *, const uint32_t &, const uint32_t &, const uint32_t &, uint8_t *, const bool &);
+
+// Runs the conversion repeatedly and prints ms per frame and megapixels per second.
+template < typename Convert >
+void run(const string &name, const uint32_t &width, const uint32_t &height, const uint32_t &repetitions, Convert convert) {
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (uint32_t r = 0; r < repetitions; r++) {
+        convert();
+    }
+    const double seconds = chrono::duration< double >(chrono::steady_clock::now() - start).count();
+    cout << "  " << name << ": " << (seconds * 1000.0 / repetitions) << " ms per frame, "
+         << (static_cast< double >(width) * height * repetitions / seconds / 1e6) << " MPixel/s" << endl;
+}
+
+void run(const string &name, const Conversion &conversion, const uint32_t &inputBytes, const uint32_t &outputBytes, const uint32_t &width, const uint32_t &height, const uint32_t &repetitions) {
+    // NV12 has the chroma plane after the luma; the other formats just leave it unused.
+    vector< uint8_t > src(inputBytes * width * height * 2);
+    for (uint32_t i = 0; i < src.size(); i++) {
+        src[i] = static_cast< uint8_t >(i * 2654435761u >> 24);
+    }
+    vector< uint8_t > dest(outputBytes * width * height);
+    for (uint32_t k = ImageConversion::SCALAR; k <= ImageConversion::AVX2; k++) {
+        const ImageConversion::Kernel kernel = static_cast< ImageConversion::Kernel >(k);
+        if (!ImageConversion::isSupported(kernel)) {
+            continue;
+        }
+        for (uint32_t f = 0; f < 2; f++) {
+            const bool flipped = (f == 1);
+            run(name + " " + ImageConversion::getName(kernel) + (flipped ? ", flipped" : ""), width, height, repetitions, [&]() {
+                conversion(kernel, &src[0], inputBytes * width, width, height, &dest[0], flipped);
+            });
+        }
+    }
+}
+}
+
+int32_t main(int32_t argc, char **argv) {
+    // Usage: ImageConversionBenchmark [repetitions]
+    const uint32_t repetitions = (argc > 1) ? static_cast< uint32_t >(atoi(argv[1])) : 200;
+    const uint32_t resolutions[][2] = {{640, 480}, {1280, 720}, {1920, 1080}};
+    for (auto &resolution : resolutions) {
+        const uint32_t width = resolution[0];
+        const uint32_t height = resolution[1];
+        cout << width << "x" << height << ":" << endl;
+
+        // The previous OpenCVCamera path: grey into a separate image, turned in place, copied into the shared memory.
+        vector< uint8_t > bgr(width * height * 3, 128);
+        vector< uint8_t > grey(width * height);
+        vector< uint8_t > shared(width * height);
+        run("BGR to grey in three passes (scalar, flipped)", width, height, repetitions, [&]() {
+            ImageConversion::bgrToGrey(ImageConversion::SCALAR, &bgr[0], width * 3, width, height, &grey[0], false);
+            for (uint32_t i = 0, j = width * height - 1; i < j; i++, j--) {
+                const uint8_t tmp = grey[i];
+                grey[i] = grey[j];
+                grey[j] = tmp;
+            }
+            ::memcpy(&shared[0], &grey[0], shared.size());
+        });
+
+        run("BGR to grey", &ImageConversion::bgrToGrey, 3, 1, width, height, repetitions);
+        run("BGR to BGR", &ImageConversion::bgrToBGR, 3, 3, width, height, repetitions);
+        run("YUYV to BGR", &ImageConversion::yuyvToBGR, 2, 3, width, height, repetitions);
+        run("YUYV to grey", &ImageConversion::yuyvToGrey, 2, 1, width, height, repetitions);
+        run("NV12 to BGR", &ImageConversion::nv12ToBGR, 1, 3, width, height, repetitions);
+        run("NV12 to grey", &ImageConversion::nv12ToGrey, 1, 1, width, height, repetitions);
+    }
+    return 0;
+}
@@ -26,8 +26,11 @@
 #include <string>
 
 #include <opendavinci/GeneratedHeaders_OpenDaVINCI.h>
+#include <opendavinci/odcore/data/TimeStamp.h>
 #include <opendavinci/odcore/wrapper/SharedMemory.h>
 
+#include "SharedImageRing.h"
+
 namespace opendlv {
 namespace core {
 namespace system {
@@ -74,9 +77,35 @@ class Camera {
     virtual ~Camera();
 
     /**
-     * @return Meta information about the image.
+     * This method captures a frame into the shared memory.
+     *
+     * @param sharedImage Meta information about the image; only set if a frame was published.
+     * @return true if a new frame was written into the shared memory.
+     */
+    bool capture(odcore::data::image::SharedImage &sharedImage);
+
+    /**
+     * @return Time the last captured image was taken.
+     */
+    odcore::data::TimeStamp getCaptureTimeStamp() const;
+
+    /**
+     * This method lets the images be written in turn into the slots
+     * "<name>.<k>" of a SharedImageRing instead of the single segment
+     * "<name>"; the SharedImage names the slot of each image. Readers
+     * need not lock the slots and the camera never waits for them.
+     *
+     * @param numberOfSlots Number of slots; 1 keeps the single segment.
+     * @return true if the slots are used.
+     */
+    bool setSlots(const uint32_t &numberOfSlots);
+
+    /**
+     * @return Number of slots the images are written into; 1 for the single segment.
      */
-    odcore::data::image::SharedImage capture();
+    uint32_t getNumberOfSlots() const;
+
+    uint32_t getSize() const;
 
    protected:
     /**
@@ -93,16 +122,23 @@ class Camera {
 
     virtual bool isValid() const = 0;
 
+    /**
+     * @return Time the frame of the last successful captureFrame() was
+     *         taken; the default is the time captureFrame() returned.
+     */
+    virtual odcore::data::TimeStamp getFrameTimeStamp() const;
+
     const string getName() const;
     uint32_t getID() const;
     uint32_t getWidth() const;
     uint32_t getHeight() const;
     uint32_t getBPP() const;
-    uint32_t getSize() const;
 
    private:
     odcore::data::image::SharedImage m_sharedImage;
     std::shared_ptr< odcore::wrapper::SharedMemory > m_sharedMemory;
+    std::shared_ptr< SharedImageRing > m_ring; //slots the images are written into; empty to use m_sharedMemory
+    odcore::data::TimeStamp m_captureTimeStamp;
 
    protected:
     string m_name;
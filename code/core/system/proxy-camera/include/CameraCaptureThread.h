@@ -0,0 +1,150 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef CAMERACAPTURETHREAD_H_
+#define CAMERACAPTURETHREAD_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <thread>
+
+#include <opendavinci/GeneratedHeaders_OpenDaVINCI.h>
+#include <opendavinci/odcore/data/TimeStamp.h>
+
+#include "Camera.h"
+#include "TripleBuffer.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * Image captured by the capture thread; the image itself stays in the
+ * slot of the camera's SharedImageRing named by the SharedImage.
+ */
+struct CameraFrame {
+    CameraFrame()
+        : m_sharedImage()
+        , m_captured()
+        , m_sequence(0) {}
+
+    odcore::data::image::SharedImage m_sharedImage;
+    odcore::data::TimeStamp m_captured;
+    uint64_t m_sequence; //1 for the first captured frame
+};
+
+/**
+ * Counters of the capture thread.
+ */
+struct CameraCaptureStatistics {
+    uint64_t captured; //frames captured
+    uint64_t taken; //frames taken by the publishing side
+    uint64_t overwritten; //frames replaced by a newer one before they were taken
+    uint64_t failed; //captures that returned no image
+};
+
+/**
+ * CameraCaptureThread captures the images of a camera in a dedicated
+ * thread so that a slow publish step neither delays the next grab nor
+ * lets frames queue up in the driver. The images are converted straight
+ * into the slots of the camera's SharedImageRing, which serve as the
+ * buffers between the threads: the publishing side (e.g. the
+ * time-triggered body of the proxy) picks up only the name of the newest
+ * slot and its capture time through a lock-free triple buffer, and
+ * readers detect slots overwritten meanwhile by their sequence.
+ */
+class CameraCaptureThread {
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     *
+     * @param obj Reference to an object of this class.
+     */
+    CameraCaptureThread(const CameraCaptureThread & /*obj*/);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     *
+     * @param obj Reference to an object of this class.
+     * @return Reference to this instance.
+     */
+    CameraCaptureThread &operator=(const CameraCaptureThread & /*obj*/);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param camera Camera to capture from; only the capture thread uses it while running.
+     */
+    explicit CameraCaptureThread(Camera &camera);
+
+    virtual ~CameraCaptureThread();
+
+    /**
+     * This method starts the capture thread. A camera writing into its
+     * single segment is given three slots first.
+     *
+     * @return true if the thread was started.
+     */
+    bool start();
+
+    /**
+     * This method stops the capture thread after the current capture.
+     */
+    void stop();
+
+    /**
+     * This method takes the newest frame captured since the last call.
+     *
+     * @return true if there is a new frame in getFrame().
+     */
+    bool nextFrame();
+
+    /**
+     * @return Frame taken by the last successful nextFrame(); valid until the next call.
+     */
+    const CameraFrame &getFrame();
+
+    CameraCaptureStatistics getStatistics() const;
+
+   private:
+    void capture();
+
+   private:
+    Camera &m_camera;
+    TripleBuffer< CameraFrame > m_frames;
+    std::atomic< bool > m_running;
+    std::thread m_thread;
+    std::atomic< uint64_t > m_captured;
+    std::atomic< uint64_t > m_taken;
+    std::atomic< uint64_t > m_overwritten;
+    std::atomic< uint64_t > m_failed;
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*CAMERACAPTURETHREAD_H_*/
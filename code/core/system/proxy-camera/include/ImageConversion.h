@@ -0,0 +1,157 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef IMAGECONVERSION_H_
+#define IMAGECONVERSION_H_
+
+#include <stdint.h>
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * This class converts camera images from the pixel formats delivered by
+ * the drivers into the layout of the shared image (8 bit grey or BGR,
+ * rows without padding) in one pass, optionally turned by 180 degrees for
+ * cameras mounted upside down. YUV is converted with the BT.601 limited
+ * range coefficients (as OpenCV's COLOR_YUV2BGR_*); grey is the luma.
+ * BGR is converted into grey with the fixed point coefficients of
+ * OpenCV's CV_BGR2GRAY.
+ *
+ * Every conversion has a scalar reference and vectorized kernels that
+ * produce the same bytes; the methods without a kernel argument use the
+ * widest kernel supported by the CPU.
+ */
+class ImageConversion {
+   private:
+    ImageConversion() = delete;
+
+   public:
+    enum Kernel {
+        SCALAR = 0,
+        SSSE3 = 1,
+        AVX2 = 2, //the grey outputs are 32 pixels wide; the BGR outputs use the SSSE3 kernels
+    };
+
+    /**
+     * @return The widest kernel supported by the CPU at runtime.
+     */
+    static Kernel best();
+
+    static bool isSupported(const Kernel &kernel);
+
+    static const char *getName(const Kernel &kernel);
+
+    /**
+     * @param src BGR image.
+     * @param srcStride bytes per row of src.
+     * @param width image width.
+     * @param height image height.
+     * @param dest width * height bytes.
+     * @param flipped true to turn the image by 180 degrees.
+     */
+    static void bgrToGrey(const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped);
+
+    /**
+     * @param src BGR image.
+     * @param srcStride bytes per row of src.
+     * @param width image width.
+     * @param height image height.
+     * @param dest width * height * 3 bytes.
+     * @param flipped true to turn the image by 180 degrees.
+     */
+    static void bgrToBGR(const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped);
+
+    /**
+     * @param src YUYV (Y0 U Y1 V) image; width must be even.
+     * @param srcStride bytes per row of src.
+     * @param width image width.
+     * @param height image height.
+     * @param dest width * height * 3 bytes.
+     * @param flipped true to turn the image by 180 degrees.
+     */
+    static void yuyvToBGR(const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped);
+
+    /**
+     * @param src YUYV (Y0 U Y1 V) image; width must be even.
+     * @param srcStride bytes per row of src.
+     * @param width image width.
+     * @param height image height.
+     * @param dest width * height bytes.
+     * @param flipped true to turn the image by 180 degrees.
+     */
+    static void yuyvToGrey(const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped);
+
+    /**
+     * @param src NV12 image: the Y plane followed by the interleaved U V plane at half resolution; width and height must be even.
+     * @param srcStride bytes per row of both planes.
+     * @param width image width.
+     * @param height image height.
+     * @param dest width * height * 3 bytes.
+     * @param flipped true to turn the image by 180 degrees.
+     */
+    static void nv12ToBGR(const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped);
+
+    /**
+     * @param src NV12 image; only the Y plane is read.
+     * @param srcStride bytes per row of the Y plane.
+     * @param width image width.
+     * @param height image height.
+     * @param dest width * height bytes.
+     * @param flipped true to turn the image by 180 degrees.
+     */
+    static void nv12ToGrey(const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped);
+
+    /**
+     * The methods below convert with the given kernel, which must be
+     * supported by the CPU; see above for the arguments.
+     */
+    static void bgrToGrey(const Kernel &kernel, const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped);
+    static void bgrToBGR(const Kernel &kernel, const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped);
+    static void yuyvToBGR(const Kernel &kernel, const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped);
+    static void yuyvToGrey(const Kernel &kernel, const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped);
+    static void nv12ToBGR(const Kernel &kernel, const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped);
+    static void nv12ToGrey(const Kernel &kernel, const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped);
+
+    /**
+     * This method converts one BGR pixel into grey.
+     *
+     * @param bgr three bytes.
+     * @return Luma.
+     */
+    static uint8_t bgrToGrey(const uint8_t *bgr);
+
+    /**
+     * This method converts one YUV sample into BGR.
+     *
+     * @param y luma.
+     * @param u blue difference.
+     * @param v red difference.
+     * @param bgr three bytes.
+     */
+    static void yuvToBGR(const uint8_t &y, const uint8_t &u, const uint8_t &v, uint8_t *bgr);
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*IMAGECONVERSION_H_*/
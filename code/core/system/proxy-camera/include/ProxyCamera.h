@@ -27,6 +27,7 @@
 #include <opendavinci/odcore/base/module/TimeTriggeredConferenceClientModule.h>
 
 #include "Camera.h"
+#include "CameraCaptureThread.h"
 
 namespace opendlv {
 namespace core {
@@ -61,6 +62,7 @@ class ProxyCamera : public odcore::base::module::TimeTriggeredConferenceClientMo
 
    private:
     unique_ptr< Camera > m_camera;
+    unique_ptr< CameraCaptureThread > m_captureThread; //captures in its own thread; body() publishes the newest frame
 };
 }
 }
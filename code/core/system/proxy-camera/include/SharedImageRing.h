@@ -0,0 +1,141 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SHAREDIMAGERING_H_
+#define SHAREDIMAGERING_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "SharedMemorySlotRing.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * Description of an image stored in the trailer of its slot.
+ */
+struct SharedImageInfo {
+    uint32_t size; //bytes of the image
+    int64_t captured; //capture time in microseconds since the epoch
+};
+
+typedef SharedMemorySlotTrailer< SharedImageInfo > SharedImageSlotTrailer;
+
+/**
+ * SharedImageRing is the SharedMemorySlotRing a camera writes its images
+ * into in turn. An image is published by announcing its slot in a
+ * SharedImage. Readers locate the trailer from the size of the image as
+ * announced in the SharedImage, so a segment attached with a larger size
+ * is read correctly.
+ */
+class SharedImageRing : public SharedMemorySlotRing< SharedImageInfo > {
+   private:
+    typedef SharedMemorySlotRing< SharedImageInfo > Ring;
+
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    SharedImageRing(const SharedImageRing &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    SharedImageRing &operator=(const SharedImageRing &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param name base name of the shared memory segments.
+     * @param numberOfSlots number of slots (at least 2 to never overwrite the latest image).
+     * @param size size in bytes of an image.
+     */
+    SharedImageRing(const std::string &name, const uint32_t &numberOfSlots, const uint32_t &size)
+        : Ring(name, numberOfSlots, size) {}
+
+    virtual ~SharedImageRing() {}
+
+    /**
+     * This method publishes the current image and advances to the next slot.
+     *
+     * @param captured capture time in microseconds since the epoch.
+     * @return Name of the shared memory segment holding the published image.
+     */
+    std::string publishFrame(const int64_t &captured) {
+        const SharedImageInfo info = {getSize(), captured};
+        return Ring::publishFrame(info);
+    }
+
+    /**
+     * This method starts reading a published image in place.
+     *
+     * @param slot memory of the slot as attached by the reader.
+     * @param slotSize size in bytes of the attached shared memory segment.
+     * @param size size in bytes of the image as announced in the SharedImage.
+     * @param frame number of the image in the slot; a gap to the previous one means missed images.
+     * @param captured if not NULL, capture time in microseconds since the epoch.
+     * @return Sequence to pass to endRead(); 0 if the slot holds no complete image.
+     */
+    static uint32_t beginRead(const void *slot, const uint32_t &slotSize, const uint32_t &size, uint32_t &frame, int64_t *captured = NULL) {
+        SharedImageInfo info;
+        const uint32_t sequence = Ring::beginRead(slot, slotSize, size, frame, &info);
+        if ((sequence != 0) && (captured != NULL)) {
+            *captured = info.captured;
+        }
+        return sequence;
+    }
+
+    /**
+     * This method copies a published image out of a slot without blocking
+     * the camera.
+     *
+     * @param slot memory of the slot as attached by the reader.
+     * @param slotSize size in bytes of the attached shared memory segment.
+     * @param destination memory for size bytes.
+     * @param size size in bytes of the image as announced in the SharedImage.
+     * @param frame number of the copied image; a gap to the previous one means missed images.
+     * @param captured if not NULL, capture time in microseconds since the epoch.
+     * @return true if a complete image was copied; false if the slot was written meanwhile.
+     */
+    static bool read(const void *slot, const uint32_t &slotSize, void *destination, const uint32_t &size, uint32_t &frame, int64_t *captured = NULL) {
+        SharedImageInfo info;
+        if (!Ring::read(slot, slotSize, size, destination, size, frame, &info)) {
+            return false;
+        }
+        if (captured != NULL) {
+            *captured = info.captured;
+        }
+        return true;
+    }
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*SHAREDIMAGERING_H_*/
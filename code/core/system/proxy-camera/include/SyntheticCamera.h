@@ -0,0 +1,114 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SYNTHETICCAMERA_H_
+#define SYNTHETICCAMERA_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "Camera.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+using namespace std;
+
+/**
+ * This class generates a deterministic test pattern instead of capturing
+ * from a device so that the capture path (shared memory, containers,
+ * capture thread) can be exercised and measured on any machine. Byte c
+ * of pixel (x, y) in frame n is getPixel(n, x, y, c): diagonal gradients
+ * that move by three per frame and differ per channel, so that consumers
+ * can check which frame they got and whether it is complete.
+ *
+ * Frames are delivered at the given rate like a free-running camera; a
+ * rate of 0 delivers them as fast as they are taken.
+ */
+class SyntheticCamera : public Camera {
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     *
+     * @param obj Reference to an object of this class.
+     */
+    SyntheticCamera(const SyntheticCamera & /*obj*/);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     *
+     * @param obj Reference to an object of this class.
+     * @return Reference to this instance.
+     */
+    SyntheticCamera &operator=(const SyntheticCamera & /*obj*/);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param name Name of the shared memory segment.
+     * @param id SyntheticCamera identifier.
+     * @param width Image width.
+     * @param height Image height.
+     * @param bpp Bytes per pixel.
+     * @param fps Frames per second; 0 for as fast as possible.
+     */
+    SyntheticCamera(const string &name, const uint32_t &id, const uint32_t &width, const uint32_t &height, const uint32_t &bpp, const float &fps);
+    virtual ~SyntheticCamera();
+
+    /**
+     * @param frame Frame number.
+     * @param x Column.
+     * @param y Row.
+     * @param channel Byte of the pixel.
+     * @return Value of the byte in the test pattern.
+     */
+    static uint8_t getPixel(const uint64_t &frame, const uint32_t &x, const uint32_t &y, const uint32_t &channel);
+
+    /**
+     * @return Number of the last captured frame; the first one is 1.
+     */
+    uint64_t getFrame() const;
+
+   protected:
+    virtual bool copyImageTo(char *dest, const uint32_t &size);
+    virtual bool isValid() const;
+    virtual bool captureFrame();
+
+   private:
+    chrono::steady_clock::time_point m_start;
+    chrono::steady_clock::duration m_period; //zero for as fast as possible
+    uint64_t m_frame;
+    vector< uint8_t > m_line; //one row of the pattern, 256 pixels longer to start it at any offset
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*SYNTHETICCAMERA_H_*/
@@ -0,0 +1,128 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRIPLEBUFFER_H_
+#define TRIPLEBUFFER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * TripleBuffer hands the latest of a stream of values from exactly one
+ * producer to exactly one consumer without locks and without either side
+ * waiting: the producer writes into its back slot and publishes it, the
+ * consumer swaps the newest published slot into its front slot. Values
+ * the consumer did not pick up in time are overwritten.
+ */
+template < typename T >
+class TripleBuffer {
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    TripleBuffer(const TripleBuffer &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    TripleBuffer &operator=(const TripleBuffer &);
+
+    static const uint8_t INDEX = 0x3;
+    static const uint8_t FRESH = 0x4; //the middle slot was published and not yet taken
+
+   public:
+    TripleBuffer()
+        : m_slots()
+        , m_back(0)
+        , m_middle(1)
+        , m_front(2) {}
+
+    virtual ~TripleBuffer() {}
+
+    // Producer side.
+
+    /**
+     * @return Slot the producer writes the next value into.
+     */
+    T &getBack() {
+        return m_slots[m_back];
+    }
+
+    /**
+     * This method publishes the back slot; the producer continues with another slot.
+     *
+     * @return true if the previously published value was not taken and is overwritten.
+     */
+    bool publish() {
+        const uint8_t previous = m_middle.exchange(static_cast< uint8_t >(m_back | FRESH), std::memory_order_acq_rel);
+        m_back = static_cast< uint8_t >(previous & INDEX);
+        return (previous & FRESH) != 0;
+    }
+
+    // Consumer side.
+
+    /**
+     * This method takes the newest published value into the front slot.
+     *
+     * @return true if a value was published since the last update.
+     */
+    bool update() {
+        if ((m_middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        m_front = static_cast< uint8_t >(m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX);
+        return true;
+    }
+
+    /**
+     * @return Slot with the value taken by the last successful update().
+     */
+    T &getFront() {
+        return m_slots[m_front];
+    }
+
+    /**
+     * @return All three slots, e.g. to preallocate them before the producer starts.
+     */
+    T *getSlots() {
+        return m_slots;
+    }
+
+   private:
+    T m_slots[3];
+    uint8_t m_back; //producer only
+    std::atomic< uint8_t > m_middle;
+    uint8_t m_front; //consumer only
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*TRIPLEBUFFER_H_*/
@@ -0,0 +1,137 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef V4L2CAMERA_H_
+#define V4L2CAMERA_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "Camera.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+using namespace std;
+
+/**
+ * This class captures from a Video4Linux2 device (/dev/video<id>) into
+ * kernel buffers mapped into this process. Each frame is converted from
+ * the mapped buffer directly into the shared memory segment (YUYV and
+ * NV12 in one pass, MJPEG decoded into it), i.e. it is copied once, and
+ * stamped with the time the driver captured it. When frames queue up,
+ * the latest one is used.
+ *
+ * It can be tried without a camera with the vivid or v4l2loopback
+ * virtual devices.
+ */
+class V4L2Camera : public Camera {
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     *
+     * @param obj Reference to an object of this class.
+     */
+    V4L2Camera(const V4L2Camera & /*obj*/);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     *
+     * @param obj Reference to an object of this class.
+     * @return Reference to this instance.
+     */
+    V4L2Camera &operator=(const V4L2Camera & /*obj*/);
+
+   public:
+    enum PixelFormat {
+        YUYV = 0,
+        MJPEG = 1,
+        NV12 = 2
+    };
+
+    static const uint32_t DEFAULT_BUFFERS = 4;
+
+    /**
+     * Constructor.
+     *
+     * @param name Name of the shared memory segment.
+     * @param id Camera identifier (/dev/video<id>).
+     * @param width Expected image width.
+     * @param height Expected image height.
+     * @param bpp Bytes per pixel of the shared image: 1 (grey) or 3 (BGR).
+     * @param flipped Is the camera mounted upside down?
+     * @param format Pixel format requested from the driver.
+     * @param buffers Number of kernel buffers.
+     */
+    V4L2Camera(const string &name, const uint32_t &id, const uint32_t &width, const uint32_t &height, const uint32_t &bpp, const bool &flipped, const PixelFormat &format, const uint32_t &buffers);
+    virtual ~V4L2Camera();
+
+    /**
+     * @param name YUYV, MJPEG or NV12.
+     * @param format Pixel format of the name.
+     * @return true if the name is known.
+     */
+    static bool getPixelFormat(const string &name, PixelFormat &format);
+
+    /**
+     * @return Number of frames dropped as newer ones were already captured.
+     */
+    uint32_t getSkippedFrames() const;
+
+   private:
+    virtual bool copyImageTo(char *dest, const uint32_t &size);
+    virtual bool isValid() const;
+    virtual bool captureFrame();
+    virtual odcore::data::TimeStamp getFrameTimeStamp() const;
+
+    bool open(const uint32_t &buffers);
+    void close();
+    bool requeue();
+
+   private:
+    struct Buffer {
+        void *m_start;
+        uint32_t m_length;
+    };
+
+    bool m_flipped;
+    PixelFormat m_format;
+    int32_t m_fd;
+    std::vector< Buffer > m_buffers;
+    bool m_streaming;
+    uint32_t m_stride; //bytes per row of the driver's image
+    int32_t m_current; //buffer dequeued by the last captureFrame or -1
+    uint32_t m_bytesUsed;
+    odcore::data::TimeStamp m_frameTimeStamp;
+    uint32_t m_skippedFrames;
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*V4L2CAMERA_H_*/
@@ -34,6 +34,8 @@ using namespace odcore::base;
 Camera::Camera(const string &name, const uint32_t &id, const uint32_t &width, const uint32_t &height, const uint32_t &bpp)
     : m_sharedImage()
     , m_sharedMemory()
+    , m_ring()
+    , m_captureTimeStamp()
     , m_name(name)
     , m_id(id)
     , m_width(width)
@@ -77,17 +79,55 @@ uint32_t Camera::getSize() const {
     return m_size;
 }
 
-odcore::data::image::SharedImage Camera::capture() {
+odcore::data::TimeStamp Camera::getFrameTimeStamp() const {
+    return odcore::data::TimeStamp();
+}
+
+odcore::data::TimeStamp Camera::getCaptureTimeStamp() const {
+    return m_captureTimeStamp;
+}
+
+bool Camera::capture(odcore::data::image::SharedImage &sharedImage) {
+    bool retVal = false;
     if (isValid()) {
         if (captureFrame()) {
-            if (m_sharedMemory.get() && m_sharedMemory->isValid()) {
+            const odcore::data::TimeStamp captured = getFrameTimeStamp();
+            if (m_ring.get() != NULL) {
+                //A slot that could not be written stays marked as being written and is reused for the next image
+                if (copyImageTo(m_ring->beginFrame(), m_size)) {
+                    m_sharedImage.setName(m_ring->publishFrame(captured.toMicroseconds()));
+                    retVal = true;
+                }
+            } else if (m_sharedMemory.get() && m_sharedMemory->isValid()) {
                 Lock l(m_sharedMemory);
-                copyImageTo(static_cast<char*>(m_sharedMemory->getSharedMemory()), m_size);
+                retVal = copyImageTo(static_cast<char*>(m_sharedMemory->getSharedMemory()), m_size);
+            }
+            if (retVal) {
+                m_captureTimeStamp = captured;
+                sharedImage = m_sharedImage;
             }
         }
     }
 
-    return m_sharedImage;
+    return retVal;
+}
+
+bool Camera::setSlots(const uint32_t &numberOfSlots) {
+    if (numberOfSlots < 2) {
+        m_ring.reset();
+        m_sharedImage.setName(m_name);
+        return false;
+    }
+    std::shared_ptr< SharedImageRing > ring(new SharedImageRing(m_name, numberOfSlots, m_size));
+    if (!ring->isValid()) {
+        return false;
+    }
+    m_ring = ring;
+    return true;
+}
+
+uint32_t Camera::getNumberOfSlots() const {
+    return (m_ring.get() != NULL) ? m_ring->getNumberOfSlots() : 1;
 }
 }
 }
@@ -0,0 +1,107 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <chrono>
+
+#include "CameraCaptureThread.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+CameraCaptureThread::CameraCaptureThread(Camera &camera)
+    : m_camera(camera)
+    , m_frames()
+    , m_running(false)
+    , m_thread()
+    , m_captured(0)
+    , m_taken(0)
+    , m_overwritten(0)
+    , m_failed(0) {}
+
+CameraCaptureThread::~CameraCaptureThread() {
+    stop();
+}
+
+bool CameraCaptureThread::start() {
+    if (m_running.load() || m_camera.getSize() == 0) {
+        return false;
+    }
+    //The single segment would be overwritten under its lock while the newest image is announced
+    if (m_camera.getNumberOfSlots() < 2 && !m_camera.setSlots(3)) {
+        return false;
+    }
+    m_running.store(true);
+    m_thread = std::thread(&CameraCaptureThread::capture, this);
+    return true;
+}
+
+void CameraCaptureThread::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool CameraCaptureThread::nextFrame() {
+    if (!m_frames.update()) {
+        return false;
+    }
+    m_taken++;
+    return true;
+}
+
+const CameraFrame &CameraCaptureThread::getFrame() {
+    return m_frames.getFront();
+}
+
+CameraCaptureStatistics CameraCaptureThread::getStatistics() const {
+    CameraCaptureStatistics statistics;
+    statistics.captured = m_captured.load();
+    statistics.taken = m_taken.load();
+    statistics.overwritten = m_overwritten.load();
+    statistics.failed = m_failed.load();
+    return statistics;
+}
+
+void CameraCaptureThread::capture() {
+    uint64_t sequence = 0;
+    while (m_running.load(std::memory_order_relaxed)) {
+        CameraFrame &frame = m_frames.getBack();
+        if (m_camera.capture(frame.m_sharedImage)) {
+            frame.m_captured = m_camera.getCaptureTimeStamp();
+            frame.m_sequence = ++sequence;
+            m_captured++;
+            if (m_frames.publish()) {
+                m_overwritten++;
+            }
+        } else {
+            //Cameras block until the next image; one that fails right away is not polled at full speed
+            m_failed++;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+}
+}
+}
+} // opendlv::core::system::proxy
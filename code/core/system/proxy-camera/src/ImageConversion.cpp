@@ -0,0 +1,476 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define IMAGE_CONVERSION_X86 1
+#include <immintrin.h>
+#endif
+
+#include "ImageConversion.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+namespace {
+
+uint8_t clamp(const int32_t &value) {
+    return static_cast< uint8_t >((value < 0) ? 0 : ((value > 255) ? 255 : value));
+}
+
+//The rows below convert the pixels x to width - 1; the vectorized kernels leave the last pixels of a row to them
+
+void bgrToGreyRow(const uint8_t *s, uint8_t *d, const uint32_t &width, const bool &flipped, uint32_t x) {
+    for (; x < width; x++) {
+        d[flipped ? width - 1 - x : x] = ImageConversion::bgrToGrey(s + 3 * x);
+    }
+}
+
+void bgrToBGRRow(const uint8_t *s, uint8_t *d, const uint32_t &width, const bool &flipped, uint32_t x) {
+    if (!flipped) {
+        ::memcpy(d + 3 * x, s + 3 * x, 3 * (width - x));
+        return;
+    }
+    for (; x < width; x++) {
+        const uint8_t *p = s + 3 * x;
+        uint8_t *q = d + 3 * (width - 1 - x);
+        q[0] = p[0];
+        q[1] = p[1];
+        q[2] = p[2];
+    }
+}
+
+void greyRow(const uint8_t *s, uint8_t *d, const uint32_t &width, const bool &flipped, uint32_t x) {
+    if (!flipped) {
+        ::memcpy(d + x, s + x, width - x);
+        return;
+    }
+    for (; x < width; x++) {
+        d[width - 1 - x] = s[x];
+    }
+}
+
+void yuyvToBGRRow(const uint8_t *s, uint8_t *d, const uint32_t &width, const bool &flipped, uint32_t x) {
+    for (s += 2 * x; x < width; x += 2, s += 4) {
+        //Turned by 180 degrees, the pixels x and x + 1 of the source row end up at width - 1 - x and width - 2 - x
+        ImageConversion::yuvToBGR(s[0], s[1], s[3], d + 3 * (flipped ? width - 1 - x : x));
+        ImageConversion::yuvToBGR(s[2], s[1], s[3], d + 3 * (flipped ? width - 2 - x : x + 1));
+    }
+}
+
+void yuyvToGreyRow(const uint8_t *s, uint8_t *d, const uint32_t &width, const bool &flipped, uint32_t x) {
+    for (; x < width; x++) {
+        d[flipped ? width - 1 - x : x] = s[2 * x];
+    }
+}
+
+void nv12ToBGRRow(const uint8_t *s, const uint8_t *uv, uint8_t *d, const uint32_t &width, const bool &flipped, uint32_t x) {
+    for (uv += x; x < width; x += 2, uv += 2) {
+        ImageConversion::yuvToBGR(s[x], uv[0], uv[1], d + 3 * (flipped ? width - 1 - x : x));
+        ImageConversion::yuvToBGR(s[x + 1], uv[0], uv[1], d + 3 * (flipped ? width - 2 - x : x + 1));
+    }
+}
+
+#ifdef IMAGE_CONVERSION_X86
+//Each kernel returns the number of pixels it converted from the start of the row
+
+__attribute__((target("ssse3"))) __m128i loadSSSE3(const uint8_t *p) {
+    return _mm_loadu_si128(reinterpret_cast< const __m128i * >(p));
+}
+
+__attribute__((target("ssse3"))) void storeSSSE3(uint8_t *p, const __m128i &v) {
+    _mm_storeu_si128(reinterpret_cast< __m128i * >(p), v);
+}
+
+__attribute__((target("ssse3"))) __m128i reverseSSSE3(const __m128i &v) {
+    return _mm_shuffle_epi8(v, _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+}
+
+//Grey of the 8 pixels in the 24 bytes from lo (bytes 0-15) and hi (bytes 8-23) as 8 x 16 bit
+__attribute__((target("ssse3"))) __m128i bgrToGrey8SSSE3(const __m128i &lo, const __m128i &hi) {
+    //B G pairs and R 1 pairs of 16 bit each; _mm_madd_epi16 weights them with B G and R 0.5 in 14 bit fixed point
+    const __m128i bg0 = _mm_shuffle_epi8(lo, _mm_setr_epi8(0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1));
+    const __m128i bg1 = _mm_or_si128(_mm_shuffle_epi8(lo, _mm_setr_epi8(12, -1, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                                     _mm_shuffle_epi8(hi, _mm_setr_epi8(-1, -1, -1, -1, 7, -1, 8, -1, 10, -1, 11, -1, 13, -1, 14, -1)));
+    const __m128i one = _mm_set1_epi32(0x00010000);
+    const __m128i r0 = _mm_or_si128(one, _mm_shuffle_epi8(lo, _mm_setr_epi8(2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1)));
+    const __m128i r1 = _mm_or_si128(one, _mm_or_si128(_mm_shuffle_epi8(lo, _mm_setr_epi8(14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                                                      _mm_shuffle_epi8(hi, _mm_setr_epi8(-1, -1, -1, -1, 9, -1, -1, -1, 12, -1, -1, -1, 15, -1, -1, -1))));
+    const __m128i weightsBG = _mm_set1_epi32((9617 << 16) | 1868);
+    const __m128i weightsR = _mm_set1_epi32((8192 << 16) | 4899);
+    const __m128i grey0 = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(bg0, weightsBG), _mm_madd_epi16(r0, weightsR)), 14);
+    const __m128i grey1 = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(bg1, weightsBG), _mm_madd_epi16(r1, weightsR)), 14);
+    return _mm_packs_epi32(grey0, grey1);
+}
+
+__attribute__((target("ssse3"))) uint32_t bgrToGreySSSE3(const uint8_t *s, uint8_t *d, const uint32_t &width, const bool &flipped) {
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i grey = _mm_packus_epi16(bgrToGrey8SSSE3(loadSSSE3(s + 3 * x), loadSSSE3(s + 3 * x + 8)), _mm_setzero_si128());
+        if (flipped) {
+            grey = _mm_shuffle_epi8(grey, _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, -1, -1, -1, -1, -1, -1, -1, -1));
+        }
+        _mm_storel_epi64(reinterpret_cast< __m128i * >(d + (flipped ? width - 8 - x : x)), grey);
+    }
+    return x;
+}
+
+__attribute__((target("ssse3"))) uint32_t bgrToBGRSSSE3(const uint8_t *s, uint8_t *d, const uint32_t &width, const bool &flipped) {
+    if (!flipped) {
+        return 0;
+    }
+    //5 pixels at a time; the byte in front of them belongs to the pixel converted next and is overwritten then
+    const __m128i reverse = _mm_setr_epi8(-1, 12, 13, 14, 9, 10, 11, 6, 7, 8, 3, 4, 5, 0, 1, 2);
+    uint32_t x = 0;
+    for (; x + 6 <= width; x += 5) {
+        storeSSSE3(d + 3 * (width - 5 - x) - 1, _mm_shuffle_epi8(loadSSSE3(s + 3 * x), reverse));
+    }
+    return x;
+}
+
+__attribute__((target("ssse3"))) uint32_t greySSSE3(const uint8_t *s, uint8_t *d, const uint32_t &width, const bool &flipped) {
+    if (!flipped) {
+        return 0;
+    }
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        storeSSSE3(d + width - 16 - x, reverseSSSE3(loadSSSE3(s + x)));
+    }
+    return x;
+}
+
+__attribute__((target("ssse3"))) uint32_t yuyvToGreySSSE3(const uint8_t *s, uint8_t *d, const uint32_t &width, const bool &flipped) {
+    const __m128i luma = _mm_set1_epi16(0x00FF);
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i grey = _mm_packus_epi16(_mm_and_si128(loadSSSE3(s + 2 * x), luma), _mm_and_si128(loadSSSE3(s + 2 * x + 16), luma));
+        if (flipped) {
+            storeSSSE3(d + width - 16 - x, reverseSSSE3(grey));
+        } else {
+            storeSSSE3(d + x, grey);
+        }
+    }
+    return x;
+}
+
+//BGR of 8 pixels from their Y, U, V as 16 bit each; the arithmetic follows ImageConversion::yuvToBGR
+__attribute__((target("ssse3"))) void yuvToBGR8SSSE3(const __m128i &y, const __m128i &u, const __m128i &v, uint8_t *d, const bool &flipped) {
+    const __m128i c = _mm_sub_epi16(y, _mm_set1_epi16(16));
+    const __m128i dd = _mm_sub_epi16(u, _mm_set1_epi16(128));
+    const __m128i e = _mm_sub_epi16(v, _mm_set1_epi16(128));
+    const __m128i e1 = _mm_set1_epi16(1);
+    const __m128i half = _mm_set1_epi32(128);
+    const __m128i weightsB = _mm_set1_epi32((516 << 16) | 298);
+    const __m128i weightsG = _mm_set1_epi32(static_cast< int32_t >((static_cast< uint32_t >(-100) << 16) | 298));
+    const __m128i weightsGe = _mm_set1_epi32(static_cast< int32_t >((128u << 16) | (static_cast< uint32_t >(-208) & 0xFFFF)));
+    const __m128i weightsR = _mm_set1_epi32((409 << 16) | 298);
+
+    const __m128i cdLo = _mm_unpacklo_epi16(c, dd);
+    const __m128i cdHi = _mm_unpackhi_epi16(c, dd);
+    const __m128i ceLo = _mm_unpacklo_epi16(c, e);
+    const __m128i ceHi = _mm_unpackhi_epi16(c, e);
+    const __m128i eLo = _mm_unpacklo_epi16(e, e1);
+    const __m128i eHi = _mm_unpackhi_epi16(e, e1);
+
+    const __m128i b = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, weightsB), half), 8),
+                                      _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, weightsB), half), 8));
+    const __m128i g = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdLo, weightsG), _mm_madd_epi16(eLo, weightsGe)), 8),
+                                      _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(cdHi, weightsG), _mm_madd_epi16(eHi, weightsGe)), 8));
+    const __m128i r = _mm_packs_epi32(_mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceLo, weightsR), half), 8),
+                                      _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(ceHi, weightsR), half), 8));
+
+    //B0..7 G0..7 and R0..7 saturated to 8 bit as clamp()
+    __m128i bg = _mm_packus_epi16(b, g);
+    __m128i rr = _mm_packus_epi16(r, r);
+    if (flipped) {
+        const __m128i reverse = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+        bg = _mm_shuffle_epi8(bg, reverse);
+        rr = _mm_shuffle_epi8(rr, reverse);
+    }
+    const __m128i out0 = _mm_or_si128(_mm_shuffle_epi8(bg, _mm_setr_epi8(0, 8, -1, 1, 9, -1, 2, 10, -1, 3, 11, -1, 4, 12, -1, 5)),
+                                      _mm_shuffle_epi8(rr, _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1)));
+    const __m128i out1 = _mm_or_si128(_mm_shuffle_epi8(bg, _mm_setr_epi8(13, -1, 6, 14, -1, 7, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                                      _mm_shuffle_epi8(rr, _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, -1, -1, -1, -1, -1, -1)));
+    storeSSSE3(d, out0);
+    _mm_storel_epi64(reinterpret_cast< __m128i * >(d + 16), out1);
+}
+
+__attribute__((target("ssse3"))) uint32_t yuyvToBGRSSSE3(const uint8_t *s, uint8_t *d, const uint32_t &width, const bool &flipped) {
+    const __m128i luma = _mm_set1_epi16(0x00FF);
+    const __m128i u = _mm_setr_epi8(1, -1, 1, -1, 5, -1, 5, -1, 9, -1, 9, -1, 13, -1, 13, -1);
+    const __m128i v = _mm_setr_epi8(3, -1, 3, -1, 7, -1, 7, -1, 11, -1, 11, -1, 15, -1, 15, -1);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const __m128i yuyv = loadSSSE3(s + 2 * x);
+        yuvToBGR8SSSE3(_mm_and_si128(yuyv, luma), _mm_shuffle_epi8(yuyv, u), _mm_shuffle_epi8(yuyv, v), d + 3 * (flipped ? width - 8 - x : x), flipped);
+    }
+    return x;
+}
+
+__attribute__((target("ssse3"))) uint32_t nv12ToBGRSSSE3(const uint8_t *s, const uint8_t *uv, uint8_t *d, const uint32_t &width, const bool &flipped) {
+    const __m128i u = _mm_setr_epi8(0, -1, 0, -1, 2, -1, 2, -1, 4, -1, 4, -1, 6, -1, 6, -1);
+    const __m128i v = _mm_setr_epi8(1, -1, 1, -1, 3, -1, 3, -1, 5, -1, 5, -1, 7, -1, 7, -1);
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8) {
+        const __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast< const __m128i * >(s + x)), _mm_setzero_si128());
+        const __m128i chroma = _mm_loadl_epi64(reinterpret_cast< const __m128i * >(uv + x));
+        yuvToBGR8SSSE3(y, _mm_shuffle_epi8(chroma, u), _mm_shuffle_epi8(chroma, v), d + 3 * (flipped ? width - 8 - x : x), flipped);
+    }
+    return x;
+}
+
+__attribute__((target("avx2"))) __m256i loadAVX2(const uint8_t *p) {
+    return _mm256_loadu_si256(reinterpret_cast< const __m256i * >(p));
+}
+
+__attribute__((target("avx2"))) void storeAVX2(uint8_t *p, const __m256i &v) {
+    _mm256_storeu_si256(reinterpret_cast< __m256i * >(p), v);
+}
+
+__attribute__((target("avx2"))) __m256i reverseAVX2(const __m256i &v) {
+    const __m256i reverse = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+    return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, reverse), _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+__attribute__((target("avx2"))) uint32_t bgrToGreyAVX2(const uint8_t *s, uint8_t *d, const uint32_t &width, const bool &flipped) {
+    //The 128 bit lanes hold the pixels 0-7 and 8-15 and are converted as in bgrToGrey8SSSE3
+    const __m256i bg0 = _mm256_broadcastsi128_si256(_mm_setr_epi8(0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10, -1));
+    const __m256i bg1Lo = _mm256_broadcastsi128_si256(_mm_setr_epi8(12, -1, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+    const __m256i bg1Hi = _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, -1, -1, 7, -1, 8, -1, 10, -1, 11, -1, 13, -1, 14, -1));
+    const __m256i r0 = _mm256_broadcastsi128_si256(_mm_setr_epi8(2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1));
+    const __m256i r1Lo = _mm256_broadcastsi128_si256(_mm_setr_epi8(14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+    const __m256i r1Hi = _mm256_broadcastsi128_si256(_mm_setr_epi8(-1, -1, -1, -1, 9, -1, -1, -1, 12, -1, -1, -1, 15, -1, -1, -1));
+    const __m256i one = _mm256_set1_epi32(0x00010000);
+    const __m256i weightsBG = _mm256_set1_epi32((9617 << 16) | 1868);
+    const __m256i weightsR = _mm256_set1_epi32((8192 << 16) | 4899);
+    uint32_t x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8_t *p = s + 3 * x;
+        const __m256i lo = _mm256_inserti128_si256(_mm256_castsi128_si256(loadSSSE3(p)), loadSSSE3(p + 24), 1);
+        const __m256i hi = _mm256_inserti128_si256(_mm256_castsi128_si256(loadSSSE3(p + 8)), loadSSSE3(p + 32), 1);
+        const __m256i grey0 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(_mm256_shuffle_epi8(lo, bg0), weightsBG),
+                                                                 _mm256_madd_epi16(_mm256_or_si256(one, _mm256_shuffle_epi8(lo, r0)), weightsR)), 14);
+        const __m256i bg1 = _mm256_or_si256(_mm256_shuffle_epi8(lo, bg1Lo), _mm256_shuffle_epi8(hi, bg1Hi));
+        const __m256i r1 = _mm256_or_si256(one, _mm256_or_si256(_mm256_shuffle_epi8(lo, r1Lo), _mm256_shuffle_epi8(hi, r1Hi)));
+        const __m256i grey1 = _mm256_srai_epi32(_mm256_add_epi32(_mm256_madd_epi16(bg1, weightsBG), _mm256_madd_epi16(r1, weightsR)), 14);
+        //Per lane 8 grey bytes in the low half; gather both halves into the low 128 bits
+        const __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(grey0, grey1), _mm256_setzero_si256());
+        const __m128i grey = _mm256_castsi256_si128(_mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+        if (flipped) {
+            storeSSSE3(d + width - 16 - x, reverseSSSE3(grey));
+        } else {
+            storeSSSE3(d + x, grey);
+        }
+    }
+    return x;
+}
+
+__attribute__((target("avx2"))) uint32_t greyAVX2(const uint8_t *s, uint8_t *d, const uint32_t &width, const bool &flipped) {
+    if (!flipped) {
+        return 0;
+    }
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32) {
+        storeAVX2(d + width - 32 - x, reverseAVX2(loadAVX2(s + x)));
+    }
+    return x;
+}
+
+__attribute__((target("avx2"))) uint32_t yuyvToGreyAVX2(const uint8_t *s, uint8_t *d, const uint32_t &width, const bool &flipped) {
+    const __m256i luma = _mm256_set1_epi16(0x00FF);
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const __m256i packed = _mm256_packus_epi16(_mm256_and_si256(loadAVX2(s + 2 * x), luma), _mm256_and_si256(loadAVX2(s + 2 * x + 32), luma));
+        //_mm256_packus_epi16 works per lane
+        const __m256i grey = _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0));
+        if (flipped) {
+            storeAVX2(d + width - 32 - x, reverseAVX2(grey));
+        } else {
+            storeAVX2(d + x, grey);
+        }
+    }
+    return x;
+}
+#endif
+}
+
+ImageConversion::Kernel ImageConversion::best() {
+#ifdef IMAGE_CONVERSION_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return AVX2;
+    }
+    if (__builtin_cpu_supports("ssse3")) {
+        return SSSE3;
+    }
+#endif
+    return SCALAR;
+}
+
+bool ImageConversion::isSupported(const Kernel &kernel) {
+    return kernel <= best();
+}
+
+const char *ImageConversion::getName(const Kernel &kernel) {
+    switch (kernel) {
+        case SCALAR: return "scalar";
+        case SSSE3: return "SSSE3";
+        case AVX2: return "AVX2";
+    }
+    return "unknown";
+}
+
+uint8_t ImageConversion::bgrToGrey(const uint8_t *bgr) {
+    //BT.601 luma in 14 bit fixed point as OpenCV's CV_BGR2GRAY
+    return static_cast< uint8_t >((1868 * static_cast< int32_t >(bgr[0]) + 9617 * static_cast< int32_t >(bgr[1]) + 4899 * static_cast< int32_t >(bgr[2]) + 8192) >> 14);
+}
+
+void ImageConversion::yuvToBGR(const uint8_t &y, const uint8_t &u, const uint8_t &v, uint8_t *bgr) {
+    //BT.601 limited range in 8 bit fixed point
+    const int32_t c = 298 * (static_cast< int32_t >(y) - 16) + 128;
+    const int32_t d = static_cast< int32_t >(u) - 128;
+    const int32_t e = static_cast< int32_t >(v) - 128;
+    bgr[0] = clamp((c + 516 * d) >> 8);
+    bgr[1] = clamp((c - 100 * d - 208 * e) >> 8);
+    bgr[2] = clamp((c + 409 * e) >> 8);
+}
+
+void ImageConversion::bgrToGrey(const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped) {
+    static const Kernel kernel = best();
+    bgrToGrey(kernel, src, srcStride, width, height, dest, flipped);
+}
+
+void ImageConversion::bgrToBGR(const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped) {
+    static const Kernel kernel = best();
+    bgrToBGR(kernel, src, srcStride, width, height, dest, flipped);
+}
+
+void ImageConversion::yuyvToBGR(const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped) {
+    static const Kernel kernel = best();
+    yuyvToBGR(kernel, src, srcStride, width, height, dest, flipped);
+}
+
+void ImageConversion::yuyvToGrey(const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped) {
+    static const Kernel kernel = best();
+    yuyvToGrey(kernel, src, srcStride, width, height, dest, flipped);
+}
+
+void ImageConversion::nv12ToBGR(const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped) {
+    static const Kernel kernel = best();
+    nv12ToBGR(kernel, src, srcStride, width, height, dest, flipped);
+}
+
+void ImageConversion::nv12ToGrey(const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped) {
+    static const Kernel kernel = best();
+    nv12ToGrey(kernel, src, srcStride, width, height, dest, flipped);
+}
+
+void ImageConversion::bgrToGrey(const Kernel &kernel, const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped) {
+    for (uint32_t row = 0; row < height; row++) {
+        const uint8_t *s = src + (flipped ? height - 1 - row : row) * srcStride;
+        uint8_t *d = dest + row * width;
+        uint32_t x = 0;
+#ifdef IMAGE_CONVERSION_X86
+        x = (kernel == AVX2) ? bgrToGreyAVX2(s, d, width, flipped) : ((kernel == SSSE3) ? bgrToGreySSSE3(s, d, width, flipped) : 0);
+#else
+        (void)kernel;
+#endif
+        bgrToGreyRow(s, d, width, flipped, x);
+    }
+}
+
+void ImageConversion::bgrToBGR(const Kernel &kernel, const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped) {
+    for (uint32_t row = 0; row < height; row++) {
+        const uint8_t *s = src + (flipped ? height - 1 - row : row) * srcStride;
+        uint8_t *d = dest + row * width * 3;
+        uint32_t x = 0;
+#ifdef IMAGE_CONVERSION_X86
+        x = (kernel != SCALAR) ? bgrToBGRSSSE3(s, d, width, flipped) : 0;
+#else
+        (void)kernel;
+#endif
+        bgrToBGRRow(s, d, width, flipped, x);
+    }
+}
+
+void ImageConversion::yuyvToBGR(const Kernel &kernel, const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped) {
+    for (uint32_t row = 0; row < height; row++) {
+        const uint8_t *s = src + (flipped ? height - 1 - row : row) * srcStride;
+        uint8_t *d = dest + row * width * 3;
+        uint32_t x = 0;
+#ifdef IMAGE_CONVERSION_X86
+        x = (kernel != SCALAR) ? yuyvToBGRSSSE3(s, d, width, flipped) : 0;
+#else
+        (void)kernel;
+#endif
+        yuyvToBGRRow(s, d, width, flipped, x);
+    }
+}
+
+void ImageConversion::yuyvToGrey(const Kernel &kernel, const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped) {
+    for (uint32_t row = 0; row < height; row++) {
+        const uint8_t *s = src + (flipped ? height - 1 - row : row) * srcStride;
+        uint8_t *d = dest + row * width;
+        uint32_t x = 0;
+#ifdef IMAGE_CONVERSION_X86
+        x = (kernel == AVX2) ? yuyvToGreyAVX2(s, d, width, flipped) : ((kernel == SSSE3) ? yuyvToGreySSSE3(s, d, width, flipped) : 0);
+#else
+        (void)kernel;
+#endif
+        yuyvToGreyRow(s, d, width, flipped, x);
+    }
+}
+
+void ImageConversion::nv12ToBGR(const Kernel &kernel, const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped) {
+    const uint8_t *uvPlane = src + srcStride * height;
+    for (uint32_t row = 0; row < height; row++) {
+        const uint32_t srcRow = flipped ? height - 1 - row : row;
+        const uint8_t *s = src + srcRow * srcStride;
+        const uint8_t *uv = uvPlane + (srcRow / 2) * srcStride;
+        uint8_t *d = dest + row * width * 3;
+        uint32_t x = 0;
+#ifdef IMAGE_CONVERSION_X86
+        x = (kernel != SCALAR) ? nv12ToBGRSSSE3(s, uv, d, width, flipped) : 0;
+#else
+        (void)kernel;
+#endif
+        nv12ToBGRRow(s, uv, d, width, flipped, x);
+    }
+}
+
+void ImageConversion::nv12ToGrey(const Kernel &kernel, const uint8_t *src, const uint32_t &srcStride, const uint32_t &width, const uint32_t &height, uint8_t *dest, const bool &flipped) {
+    for (uint32_t row = 0; row < height; row++) {
+        const uint8_t *s = src + (flipped ? height - 1 - row : row) * srcStride;
+        uint8_t *d = dest + row * width;
+        uint32_t x = 0;
+#ifdef IMAGE_CONVERSION_X86
+        x = (kernel == AVX2) ? greyAVX2(s, d, width, flipped) : ((kernel == SSSE3) ? greySSSE3(s, d, width, flipped) : 0);
+#else
+        (void)kernel;
+#endif
+        greyRow(s, d, width, flipped, x);
+    }
+}
+}
+}
+}
+} // opendlv::core::system::proxy
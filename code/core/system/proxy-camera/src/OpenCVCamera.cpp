@@ -22,6 +22,7 @@
 #include <opencv2/imgproc/imgproc.hpp>
 #include <opencv2/imgproc/imgproc_c.h>
 
+#include "ImageConversion.h"
 #include "OpenCVCamera.h"
 
 namespace opendlv {
@@ -60,20 +61,9 @@ bool OpenCVCamera::captureFrame() {
     bool retVal = false;
     if (m_capture != NULL) {
         if (cvGrabFrame(m_capture)) {
-            if (getBPP() == 1) {
-                IplImage *tmpFrame = cvRetrieveFrame(m_capture);
-
-                if (m_image == NULL) {
-                    m_image = cvCreateImage(cvGetSize(tmpFrame), IPL_DEPTH_8U, 1);
-                }
-
-                cvCvtColor(tmpFrame, m_image, CV_BGR2GRAY);
-            }
-            else {
-                m_image = cvRetrieveFrame(m_capture);
-            }
-
-            retVal = true;
+            //The BGR frame of the driver is converted into the shared memory by copyImageTo
+            m_image = cvRetrieveFrame(m_capture);
+            retVal = (m_image != NULL);
         }
     }
     return retVal;
@@ -83,13 +73,27 @@ bool OpenCVCamera::copyImageTo(char *dest, const uint32_t &size) {
     bool retVal = false;
 
     if ((dest != NULL) && (size > 0) && (m_image != NULL)) {
-        if (m_flipped) {
-            cvFlip(m_image, m_image, -1);
+        if ((m_image->depth != IPL_DEPTH_8U) || (m_image->nChannels != 3)
+            || (static_cast< uint32_t >(m_image->width) != getWidth()) || (static_cast< uint32_t >(m_image->height) != getHeight())
+            || (size < getWidth() * getHeight() * getBPP())) {
+            cerr << "[proxy-camera] Camera delivers " << m_image->width << "x" << m_image->height << "x" << m_image->nChannels << " instead of " << getWidth() << "x" << getHeight() << "x3" << endl;
+            return false;
+        }
+
+        //Grey conversion, turning and copying in one pass over the frame
+        const uint8_t *src = reinterpret_cast< const uint8_t * >(m_image->imageData);
+        const uint32_t stride = static_cast< uint32_t >(m_image->widthStep);
+        if (getBPP() == 1) {
+            ImageConversion::bgrToGrey(src, stride, getWidth(), getHeight(), reinterpret_cast< uint8_t * >(dest), m_flipped);
+        } else {
+            ImageConversion::bgrToBGR(src, stride, getWidth(), getHeight(), reinterpret_cast< uint8_t * >(dest), m_flipped);
         }
-        ::memcpy(dest, m_image->imageData, size);
 
         if (m_debug) {
-            cvShowImage("[proxy-camera]", m_image);
+            IplImage *view = cvCreateImageHeader(cvSize(static_cast< int >(getWidth()), static_cast< int >(getHeight())), IPL_DEPTH_8U, static_cast< int >(getBPP()));
+            cvSetData(view, dest, static_cast< int >(getWidth() * getBPP()));
+            cvShowImage("[proxy-camera]", view);
+            cvReleaseImageHeader(&view);
             cvWaitKey(10);
         }
 
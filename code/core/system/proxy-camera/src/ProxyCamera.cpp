@@ -29,6 +29,8 @@
 #include <opendavinci/odcore/strings/StringToolbox.h>
 
 #include "OpenCVCamera.h"
+#include "SyntheticCamera.h"
+#include "V4L2Camera.h"
 
 #include "ProxyCamera.h"
 
@@ -43,7 +45,8 @@ using namespace odcore::data;
 
 ProxyCamera::ProxyCamera(const int &argc, char **argv)
     : TimeTriggeredConferenceClientModule(argc, argv, "proxy-camera")
-    , m_camera() {}
+    , m_camera()
+    , m_captureThread() {}
 
 ProxyCamera::~ProxyCamera() {}
 
@@ -56,30 +59,125 @@ void ProxyCamera::setUp() {
     const bool DEBUG = getKeyValueConfiguration().getValue< bool >("proxy-camera.camera.debug") == 1;
     const bool FLIPPED = getKeyValueConfiguration().getValue< uint32_t >("proxy-camera.camera.flipped") == 1;
 
-    m_camera = unique_ptr< Camera >(new OpenCVCamera(NAME, ID, WIDTH, HEIGHT, BPP, DEBUG, FLIPPED));
+    //Optional: OpenCV (default), V4L2 (Linux; mmap'd kernel buffers, frames stamped by the driver) or Synthetic (test pattern without a device)
+    string type = "OpenCV";
+    try {
+        type = getKeyValueConfiguration().getValue< string >("proxy-camera.camera.type");
+    }
+    catch(...) {
+        type = "OpenCV";
+    }
+    cout << "[" << getName() << "] Camera type: " << type << endl;
+
+    if (type == "V4L2") {
+        //Optional: pixel format requested from the driver: YUYV (default), MJPEG or NV12
+        string formatName = "YUYV";
+        try {
+            formatName = getKeyValueConfiguration().getValue< string >("proxy-camera.camera.format");
+        }
+        catch(...) {
+            formatName = "YUYV";
+        }
+        V4L2Camera::PixelFormat format = V4L2Camera::YUYV;
+        if (!V4L2Camera::getPixelFormat(formatName, format)) {
+            cerr << "[" << getName() << "] Unknown pixel format " << formatName << "; using YUYV." << endl;
+        }
+        //Optional: number of kernel buffers
+        uint32_t buffers = V4L2Camera::DEFAULT_BUFFERS;
+        try {
+            buffers = getKeyValueConfiguration().getValue< uint32_t >("proxy-camera.camera.buffers");
+        }
+        catch(...) {
+            buffers = V4L2Camera::DEFAULT_BUFFERS;
+        }
+        cout << "[" << getName() << "] Pixel format: " << formatName << ", kernel buffers: " << buffers << endl;
+        m_camera = unique_ptr< Camera >(new V4L2Camera(NAME, ID, WIDTH, HEIGHT, BPP, FLIPPED, format, buffers));
+    } else if (type == "Synthetic") {
+        //Optional: frames per second of the test pattern (0: as fast as taken)
+        float fps = 30.0f;
+        try {
+            fps = getKeyValueConfiguration().getValue< float >("proxy-camera.camera.fps");
+        }
+        catch(...) {
+            fps = 30.0f;
+        }
+        cout << "[" << getName() << "] Frames per second (0: as fast as taken): " << fps << endl;
+        m_camera = unique_ptr< Camera >(new SyntheticCamera(NAME, ID, WIDTH, HEIGHT, BPP, fps));
+    } else {
+        m_camera = unique_ptr< Camera >(new OpenCVCamera(NAME, ID, WIDTH, HEIGHT, BPP, DEBUG, FLIPPED));
+    }
     if (m_camera.get() == NULL) {
         cerr << "[" << getName() << "] No valid camera type defined." << endl;
+        return;
+    }
+
+    //Optional: number of shared memory slots "<name>.<k>" the images are written into in turn (1, default: overwrite "<name>" under its lock)
+    uint32_t slots = 1;
+    try {
+        slots = getKeyValueConfiguration().getValue< uint32_t >("proxy-camera.camera.slots");
+    }
+    catch(...) {
+        slots = 1;
+    }
+    cout << "[" << getName() << "] Shared memory slots (1: single segment; >1: ring of slots):" << slots << endl;
+    if (slots > 1 && !m_camera->setSlots(slots)) {
+        cerr << "[" << getName() << "] Shared memory slots could not be created; using the single segment instead." << endl;
+    }
+
+    //Optional: capture in a dedicated thread into the slots (3 unless slots is set) and announce the newest frame at --freq (1) instead of capturing within each timeslice (0)
+    uint32_t captureThread = 0;
+    try {
+        captureThread = getKeyValueConfiguration().getValue< uint32_t >("proxy-camera.camera.captureThread");
+    }
+    catch(...) {
+        captureThread = 0;
+    }
+    cout << "[" << getName() << "] Capture thread (1: capture thread; 0: capture in the timeslice):" << captureThread << endl;
+    if (captureThread == 1) {
+        m_captureThread = unique_ptr< CameraCaptureThread >(new CameraCaptureThread(*m_camera));
+        if (!m_captureThread->start()) {
+            cerr << "[" << getName() << "] Capture thread could not be started; capturing in the timeslice instead." << endl;
+            m_captureThread.reset();
+        }
     }
 }
 
-void ProxyCamera::tearDown() {}
+void ProxyCamera::tearDown() {
+    if (m_captureThread.get() != NULL) {
+        m_captureThread->stop();
+        const CameraCaptureStatistics statistics = m_captureThread->getStatistics();
+        cout << "[" << getName() << "] Frames captured: " << statistics.captured << ", published: " << statistics.taken << ", replaced by a newer frame before publishing: " << statistics.overwritten << ", failed captures: " << statistics.failed << endl;
+        m_captureThread.reset();
+    }
+}
 
 odcore::data::dmcp::ModuleExitCodeMessage::ModuleExitCode ProxyCamera::body() {
     uint32_t captureCounter = 0;
     while (getModuleStateAndWaitForRemainingTimeInTimeslice() == odcore::data::dmcp::ModuleStateMessage::RUNNING) {
-        if (m_camera.get() != NULL) {
+        if (m_captureThread.get() != NULL) {
+            // Announce the slot of the newest frame of the capture thread, if any.
+            if (m_captureThread->nextFrame()) {
+                const CameraFrame &frame = m_captureThread->getFrame();
+
+                Container c(frame.m_sharedImage);
+                c.setSampleTimeStamp(frame.m_captured);
+                getConference().send(c);
+
+                captureCounter++;
+            }
+        } else if (m_camera.get() != NULL) {
             // Capture frame.
-            odcore::data::image::SharedImage si = m_camera->capture();
-            TimeStamp now;
-
-            // Create container with meta-information about captured frame.
-            Container c(si);
-            c.setSampleTimeStamp(now);
+            odcore::data::image::SharedImage si;
+            if (m_camera->capture(si)) {
+                // Create container with meta-information about captured frame.
+                Container c(si);
+                c.setSampleTimeStamp(m_camera->getCaptureTimeStamp());
 
-            // Share container for recording.
-            getConference().send(c);
+                // Share container for recording.
+                getConference().send(c);
 
-            captureCounter++;
+                captureCounter++;
+            }
         }
     }
     cout << "[" << getName() << "] Captured " << captureCounter << " frames." << endl;
@@ -0,0 +1,86 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <cstring>
+#include <thread>
+
+#include "SyntheticCamera.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+SyntheticCamera::SyntheticCamera(const string &name, const uint32_t &id, const uint32_t &width, const uint32_t &height, const uint32_t &bpp, const float &fps)
+    : Camera(name, id, width, height, bpp)
+    , m_start(chrono::steady_clock::now())
+    , m_period(chrono::steady_clock::duration::zero())
+    , m_frame(0)
+    , m_line((width + 256) * bpp) {
+    if (fps > 0.0f) {
+        m_period = chrono::duration_cast< chrono::steady_clock::duration >(chrono::duration< double >(1.0 / static_cast< double >(fps)));
+    }
+    for (uint32_t x = 0; x < width + 256; x++) {
+        for (uint32_t c = 0; c < bpp; c++) {
+            m_line[x * bpp + c] = getPixel(0, x, 0, c);
+        }
+    }
+}
+
+SyntheticCamera::~SyntheticCamera() {}
+
+uint8_t SyntheticCamera::getPixel(const uint64_t &frame, const uint32_t &x, const uint32_t &y, const uint32_t &channel) {
+    return static_cast< uint8_t >(x + 2 * y + 3 * frame + 85 * channel);
+}
+
+uint64_t SyntheticCamera::getFrame() const {
+    return m_frame;
+}
+
+bool SyntheticCamera::isValid() const {
+    return (getSize() > 0);
+}
+
+bool SyntheticCamera::captureFrame() {
+    if (m_period > chrono::steady_clock::duration::zero()) {
+        //The next frame is due at the next multiple of the period; frames not taken in time are dropped as by a camera
+        const chrono::steady_clock::duration elapsed = chrono::steady_clock::now() - m_start;
+        const int64_t due = static_cast< int64_t >(elapsed / m_period) + 1;
+        this_thread::sleep_until(m_start + m_period * due);
+    }
+    m_frame++;
+    return true;
+}
+
+bool SyntheticCamera::copyImageTo(char *dest, const uint32_t &size) {
+    if ((dest == NULL) || (size < getSize())) {
+        return false;
+    }
+    //Each row is the first row shifted by 2 * y + 3 * frame pixels modulo 256
+    const uint32_t rowSize = getWidth() * getBPP();
+    for (uint32_t y = 0; y < getHeight(); y++) {
+        const uint32_t offset = static_cast< uint32_t >((2 * y + 3 * m_frame) & 0xFF);
+        ::memcpy(dest + y * rowSize, &m_line[offset * getBPP()], rowSize);
+    }
+    return true;
+}
+}
+}
+}
+} // opendlv::core::system::proxy
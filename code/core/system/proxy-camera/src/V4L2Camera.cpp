@@ -0,0 +1,327 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/videodev2.h>
+#endif
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <opencv2/core/core.hpp>
+#include <opencv2/highgui/highgui.hpp>
+
+#include "ImageConversion.h"
+#include "V4L2Camera.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+#ifdef __linux__
+//Retries an ioctl interrupted by a signal
+static int32_t xioctl(const int32_t &fd, const unsigned long request, void *argument) {
+    int32_t result = 0;
+    do {
+        result = ::ioctl(fd, request, argument);
+    } while (result == -1 && errno == EINTR);
+    return result;
+}
+#endif
+
+V4L2Camera::V4L2Camera(const string &name, const uint32_t &id, const uint32_t &width, const uint32_t &height, const uint32_t &bpp, const bool &flipped, const PixelFormat &format, const uint32_t &buffers)
+    : Camera(name, id, width, height, bpp)
+    , m_flipped(flipped)
+    , m_format(format)
+    , m_fd(-1)
+    , m_buffers()
+    , m_streaming(false)
+    , m_stride(0)
+    , m_current(-1)
+    , m_bytesUsed(0)
+    , m_frameTimeStamp()
+    , m_skippedFrames(0) {
+    if (bpp != 1 && bpp != 3) {
+        cerr << "[proxy-camera] V4L2 camera '" << name << "' supports 1 (grey) or 3 (BGR) bytes per pixel, not " << bpp << endl;
+    } else if ((format == YUYV || format == NV12) && (width % 2 != 0 || height % 2 != 0)) {
+        cerr << "[proxy-camera] V4L2 camera '" << name << "' needs an even width and height for YUYV and NV12" << endl;
+    } else if (!open(buffers)) {
+        close();
+    }
+}
+
+V4L2Camera::~V4L2Camera() {
+    close();
+}
+
+bool V4L2Camera::getPixelFormat(const string &name, PixelFormat &format) {
+    if (name == "YUYV") {
+        format = YUYV;
+    } else if (name == "MJPEG") {
+        format = MJPEG;
+    } else if (name == "NV12") {
+        format = NV12;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+uint32_t V4L2Camera::getSkippedFrames() const {
+    return m_skippedFrames;
+}
+
+bool V4L2Camera::isValid() const {
+    return m_streaming;
+}
+
+odcore::data::TimeStamp V4L2Camera::getFrameTimeStamp() const {
+    return m_frameTimeStamp;
+}
+
+#ifdef __linux__
+bool V4L2Camera::open(const uint32_t &buffers) {
+    stringstream device;
+    device << "/dev/video" << getID();
+    m_fd = ::open(device.str().c_str(), O_RDWR | O_NONBLOCK);
+    if (m_fd < 0) {
+        cerr << "[proxy-camera] Could not open " << device.str() << ": " << strerror(errno) << endl;
+        return false;
+    }
+
+    struct v4l2_capability capability;
+    ::memset(&capability, 0, sizeof(capability));
+    if (xioctl(m_fd, VIDIOC_QUERYCAP, &capability) == -1 || !(capability.capabilities & V4L2_CAP_VIDEO_CAPTURE) || !(capability.capabilities & V4L2_CAP_STREAMING)) {
+        cerr << "[proxy-camera] " << device.str() << " is no video capture device with streaming I/O" << endl;
+        return false;
+    }
+
+    const uint32_t PIXEL_FORMATS[3] = {V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_MJPEG, V4L2_PIX_FMT_NV12};
+    struct v4l2_format fmt;
+    ::memset(&fmt, 0, sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = getWidth();
+    fmt.fmt.pix.height = getHeight();
+    fmt.fmt.pix.pixelformat = PIXEL_FORMATS[m_format];
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    if (xioctl(m_fd, VIDIOC_S_FMT, &fmt) == -1) {
+        cerr << "[proxy-camera] " << device.str() << " could not be set to " << getWidth() << "x" << getHeight() << ": " << strerror(errno) << endl;
+        return false;
+    }
+    //The driver adjusts the format to the nearest it supports
+    if (fmt.fmt.pix.width != getWidth() || fmt.fmt.pix.height != getHeight() || fmt.fmt.pix.pixelformat != PIXEL_FORMATS[m_format]) {
+        cerr << "[proxy-camera] " << device.str() << " does not support the requested format at " << getWidth() << "x" << getHeight() << " (offers " << fmt.fmt.pix.width << "x" << fmt.fmt.pix.height << ")" << endl;
+        return false;
+    }
+    m_stride = (fmt.fmt.pix.bytesperline > 0) ? fmt.fmt.pix.bytesperline : ((m_format == YUYV) ? 2 * getWidth() : getWidth());
+
+    struct v4l2_requestbuffers request;
+    ::memset(&request, 0, sizeof(request));
+    request.count = buffers;
+    request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    request.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(m_fd, VIDIOC_REQBUFS, &request) == -1 || request.count < 2) {
+        cerr << "[proxy-camera] " << device.str() << " could not allocate " << buffers << " buffers" << endl;
+        return false;
+    }
+
+    for (uint32_t i = 0; i < request.count; i++) {
+        struct v4l2_buffer buffer;
+        ::memset(&buffer, 0, sizeof(buffer));
+        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buffer.memory = V4L2_MEMORY_MMAP;
+        buffer.index = i;
+        if (xioctl(m_fd, VIDIOC_QUERYBUF, &buffer) == -1) {
+            return false;
+        }
+        Buffer mapped;
+        mapped.m_length = buffer.length;
+        mapped.m_start = ::mmap(NULL, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, buffer.m.offset);
+        if (mapped.m_start == MAP_FAILED) {
+            cerr << "[proxy-camera] " << device.str() << " buffer " << i << " could not be mapped: " << strerror(errno) << endl;
+            return false;
+        }
+        m_buffers.push_back(mapped);
+        if (xioctl(m_fd, VIDIOC_QBUF, &buffer) == -1) {
+            return false;
+        }
+    }
+
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(m_fd, VIDIOC_STREAMON, &type) == -1) {
+        cerr << "[proxy-camera] " << device.str() << " could not start streaming: " << strerror(errno) << endl;
+        return false;
+    }
+    m_streaming = true;
+    cout << "[proxy-camera] Capturing from " << device.str() << " (" << capability.card << ") with " << m_buffers.size() << " buffers" << endl;
+    return true;
+}
+
+void V4L2Camera::close() {
+    if (m_streaming) {
+        enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(m_fd, VIDIOC_STREAMOFF, &type);
+        m_streaming = false;
+    }
+    for (uint32_t i = 0; i < m_buffers.size(); i++) {
+        ::munmap(m_buffers[i].m_start, m_buffers[i].m_length);
+    }
+    m_buffers.clear();
+    m_current = -1;
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool V4L2Camera::requeue() {
+    if (m_current < 0) {
+        return true;
+    }
+    struct v4l2_buffer buffer;
+    ::memset(&buffer, 0, sizeof(buffer));
+    buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buffer.memory = V4L2_MEMORY_MMAP;
+    buffer.index = static_cast< uint32_t >(m_current);
+    m_current = -1;
+    return xioctl(m_fd, VIDIOC_QBUF, &buffer) != -1;
+}
+
+bool V4L2Camera::captureFrame() {
+    //The buffer of the previous frame is given back to the driver only now as it was read after captureFrame
+    if (!m_streaming || !requeue()) {
+        return false;
+    }
+
+    struct pollfd p;
+    p.fd = m_fd;
+    p.events = POLLIN;
+    p.revents = 0;
+    if (::poll(&p, 1, 1000) <= 0) {
+        return false;
+    }
+
+    //Take the newest of the completed frames and give the older ones back
+    struct v4l2_buffer buffer;
+    ::memset(&buffer, 0, sizeof(buffer));
+    while (true) {
+        struct v4l2_buffer next;
+        ::memset(&next, 0, sizeof(next));
+        next.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        next.memory = V4L2_MEMORY_MMAP;
+        if (xioctl(m_fd, VIDIOC_DQBUF, &next) == -1) {
+            break;
+        }
+        if (m_current >= 0) {
+            m_skippedFrames++;
+            requeue();
+        }
+        buffer = next;
+        m_current = static_cast< int32_t >(next.index);
+    }
+    if (m_current < 0) {
+        return false;
+    }
+    if ((buffer.flags & V4L2_BUF_FLAG_ERROR) || buffer.index >= m_buffers.size()) {
+        requeue();
+        return false;
+    }
+    m_bytesUsed = buffer.bytesused;
+
+    //Frames are stamped by the driver, mostly with the monotonic clock; it is moved onto the wall clock of the other modules
+    int64_t captured = static_cast< int64_t >(buffer.timestamp.tv_sec) * 1000000L + static_cast< int64_t >(buffer.timestamp.tv_usec);
+    if ((buffer.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+        struct timespec monotonic;
+        struct timespec realtime;
+        ::clock_gettime(CLOCK_MONOTONIC, &monotonic);
+        ::clock_gettime(CLOCK_REALTIME, &realtime);
+        captured += (static_cast< int64_t >(realtime.tv_sec) - static_cast< int64_t >(monotonic.tv_sec)) * 1000000L + (static_cast< int64_t >(realtime.tv_nsec) - static_cast< int64_t >(monotonic.tv_nsec)) / 1000L;
+    }
+    m_frameTimeStamp = (captured > 0) ? odcore::data::TimeStamp(static_cast< int32_t >(captured / 1000000L), static_cast< int32_t >(captured % 1000000L)) : odcore::data::TimeStamp();
+    return true;
+}
+#else
+bool V4L2Camera::open(const uint32_t &) {
+    cerr << "[proxy-camera] V4L2 cameras are only available on Linux" << endl;
+    return false;
+}
+
+void V4L2Camera::close() {}
+
+bool V4L2Camera::requeue() {
+    return false;
+}
+
+bool V4L2Camera::captureFrame() {
+    return false;
+}
+#endif
+
+bool V4L2Camera::copyImageTo(char *dest, const uint32_t &size) {
+    if (m_current < 0 || dest == NULL || size < getWidth() * getHeight() * getBPP()) {
+        return false;
+    }
+    const uint8_t *src = static_cast< const uint8_t * >(m_buffers[static_cast< uint32_t >(m_current)].m_start);
+    uint8_t *image = reinterpret_cast< uint8_t * >(dest);
+    const uint32_t planeSize = m_stride * getHeight();
+    if (m_format == YUYV) {
+        if (m_bytesUsed < planeSize) {
+            return false;
+        }
+        if (getBPP() == 3) {
+            ImageConversion::yuyvToBGR(src, m_stride, getWidth(), getHeight(), image, m_flipped);
+        } else {
+            ImageConversion::yuyvToGrey(src, m_stride, getWidth(), getHeight(), image, m_flipped);
+        }
+    } else if (m_format == NV12) {
+        if (m_bytesUsed < planeSize + planeSize / 2) {
+            return false;
+        }
+        if (getBPP() == 3) {
+            ImageConversion::nv12ToBGR(src, m_stride, getWidth(), getHeight(), image, m_flipped);
+        } else {
+            ImageConversion::nv12ToGrey(src, m_stride, getWidth(), getHeight(), image, m_flipped);
+        }
+    } else {
+        //The JPEG is decoded straight into the shared memory; a frame of another size would be decoded elsewhere and is dropped
+        const cv::Mat jpeg(1, static_cast< int >(m_bytesUsed), CV_8UC1, const_cast< uint8_t * >(src));
+        cv::Mat decoded(static_cast< int >(getHeight()), static_cast< int >(getWidth()), (getBPP() == 3) ? CV_8UC3 : CV_8UC1, image);
+        cv::imdecode(jpeg, (getBPP() == 3) ? cv::IMREAD_COLOR : cv::IMREAD_GRAYSCALE, &decoded);
+        if (decoded.data != image) {
+            return false;
+        }
+        if (m_flipped) {
+            cv::flip(decoded, decoded, -1);
+        }
+    }
+    return true;
+}
+}
+}
+}
+} // opendlv::core::system::proxy
@@ -0,0 +1,175 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROXY_CAMERACAPTURETHREAD_TESTSUITE_H
+#define PROXY_CAMERACAPTURETHREAD_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <opendavinci/odcore/wrapper/SharedMemory.h>
+#include <opendavinci/odcore/wrapper/SharedMemoryFactory.h>
+
+#include "../include/CameraCaptureThread.h"
+#include "../include/SharedImageRing.h"
+#include "../include/TripleBuffer.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+// Fills every byte of frame n with n, one frame every period.
+class CountingCamera : public Camera {
+   public:
+    CountingCamera(const string &name, const chrono::microseconds &period)
+        : Camera(name, 0, 64, 48, 3)
+        , m_period(period)
+        , m_frames(0) {}
+
+   protected:
+    virtual bool captureFrame() {
+        this_thread::sleep_for(m_period);
+        m_frames++;
+        return true;
+    }
+
+    virtual bool copyImageTo(char *dest, const uint32_t &size) {
+        ::memset(dest, static_cast< int >(m_frames & 0xFF), size);
+        return true;
+    }
+
+    virtual bool isValid() const {
+        return true;
+    }
+
+   private:
+    chrono::microseconds m_period;
+    uint32_t m_frames;
+};
+
+class CameraCaptureThreadTest : public CxxTest::TestSuite {
+   public:
+    void testTripleBuffer() {
+        TripleBuffer< uint32_t > buffer;
+        TS_ASSERT(!buffer.update());
+        buffer.getBack() = 1;
+        TS_ASSERT(!buffer.publish());
+        buffer.getBack() = 2;
+        // The first value was not taken and is replaced.
+        TS_ASSERT(buffer.publish());
+        TS_ASSERT(buffer.update());
+        TS_ASSERT_EQUALS(buffer.getFront(), 2u);
+        TS_ASSERT(!buffer.update());
+        TS_ASSERT_EQUALS(buffer.getFront(), 2u);
+        buffer.getBack() = 3;
+        TS_ASSERT(!buffer.publish());
+        TS_ASSERT(buffer.update());
+        TS_ASSERT_EQUALS(buffer.getFront(), 3u);
+    }
+
+    void testTripleBufferThreads() {
+        // The consumer sees increasing, complete values while the producer never waits.
+        TripleBuffer< vector< uint32_t > > buffer;
+        for (uint32_t i = 0; i < 3; i++) {
+            buffer.getSlots()[i].assign(256, 0);
+        }
+        const uint32_t values = 200000;
+        thread producer([&buffer, values]() {
+            for (uint32_t v = 1; v <= values; v++) {
+                vector< uint32_t > &back = buffer.getBack();
+                for (uint32_t i = 0; i < back.size(); i++) {
+                    back[i] = v;
+                }
+                buffer.publish();
+            }
+        });
+        uint32_t last = 0;
+        uint32_t taken = 0;
+        bool complete = true;
+        while (last < values) {
+            if (buffer.update()) {
+                const vector< uint32_t > &front = buffer.getFront();
+                for (uint32_t i = 1; i < front.size(); i++) {
+                    complete = complete && (front[i] == front[0]);
+                }
+                TS_ASSERT(front[0] > last);
+                last = front[0];
+                taken++;
+            }
+        }
+        producer.join();
+        TS_ASSERT(complete);
+        TS_ASSERT(taken > 0);
+    }
+
+    void testCaptureThread() {
+        CountingCamera camera("testCaptureThreadSI", chrono::microseconds(2000));
+        CameraCaptureThread capture(camera);
+        TS_ASSERT(!capture.nextFrame());
+        TS_ASSERT(capture.start());
+        TS_ASSERT(!capture.start());
+
+        // A slow consumer gets the newest frame; the ones in between are replaced.
+        uint64_t lastSequence = 0;
+        uint32_t frames = 0;
+        uint32_t verified = 0;
+        const chrono::steady_clock::time_point end = chrono::steady_clock::now() + chrono::milliseconds(200);
+        while (chrono::steady_clock::now() < end) {
+            this_thread::sleep_for(chrono::milliseconds(10));
+            if (capture.nextFrame()) {
+                const CameraFrame &frame = capture.getFrame();
+                TS_ASSERT(frame.m_sequence > lastSequence);
+                // The frame was captured straight into the slot it names.
+                const odcore::data::image::SharedImage &si = frame.m_sharedImage;
+                TS_ASSERT_EQUALS(si.getName(), SharedImageRing::getSlotName("testCaptureThreadSI", static_cast< uint32_t >((frame.m_sequence - 1) % 3)));
+                TS_ASSERT_EQUALS(si.getSize(), 64u * 48u * 3u);
+                shared_ptr< odcore::wrapper::SharedMemory > slot = odcore::wrapper::SharedMemoryFactory::attachToSharedMemory(si.getName());
+                vector< char > image(si.getSize());
+                uint32_t number = 0;
+                int64_t captured = 0;
+                // The camera may have overwritten the slot meanwhile.
+                if (SharedImageRing::read(slot->getSharedMemory(), slot->getSize(), &image[0], si.getSize(), number, &captured)) {
+                    TS_ASSERT_EQUALS(number + 1, frame.m_sequence);
+                    TS_ASSERT_EQUALS(captured, frame.m_captured.toMicroseconds());
+                    TS_ASSERT_EQUALS(static_cast< uint8_t >(image[0]), static_cast< uint8_t >(frame.m_sequence & 0xFF));
+                    TS_ASSERT_EQUALS(image[0], image[image.size() - 1]);
+                    verified++;
+                }
+                lastSequence = frame.m_sequence;
+                frames++;
+            }
+        }
+        capture.stop();
+        TS_ASSERT_EQUALS(camera.getNumberOfSlots(), 3u);
+        const CameraCaptureStatistics statistics = capture.getStatistics();
+        TS_ASSERT(frames > 5);
+        TS_ASSERT(verified > 0);
+        TS_ASSERT_EQUALS(statistics.taken, frames);
+        TS_ASSERT(statistics.captured > statistics.taken);
+        TS_ASSERT(statistics.overwritten > 0);
+        TS_ASSERT(statistics.captured - statistics.overwritten >= statistics.taken);
+        TS_ASSERT_EQUALS(statistics.failed, 0u);
+    }
+};
+
+#endif /*PROXY_CAMERACAPTURETHREAD_TESTSUITE_H*/
@@ -0,0 +1,116 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROXY_IMAGECONVERSION_TESTSUITE_H
+#define PROXY_IMAGECONVERSION_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <vector>
+
+#include "../include/ImageConversion.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+// Pseudo random bytes covering the full range.
+inline vector< uint8_t > createNoise(const uint32_t &size, uint32_t seed) {
+    vector< uint8_t > data(size);
+    for (uint32_t i = 0; i < size; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        data[i] = static_cast< uint8_t >(seed >> 24);
+    }
+    return data;
+}
+
+typedef void (*Conversion)(const ImageConversion::Kernel &, const uint8_t *, const uint32_t &, const uint32_t &, const uint32_t &, uint8_t *, const bool &);
+
+class ImageConversionTest : public CxxTest::TestSuite {
+   public:
+    void testGrey() {
+        const uint8_t black[3] = {0, 0, 0};
+        const uint8_t white[3] = {255, 255, 255};
+        const uint8_t red[3] = {0, 0, 255};
+        const uint8_t green[3] = {0, 255, 0};
+        const uint8_t blue[3] = {255, 0, 0};
+        TS_ASSERT_EQUALS(ImageConversion::bgrToGrey(black), 0);
+        TS_ASSERT_EQUALS(ImageConversion::bgrToGrey(white), 255);
+        TS_ASSERT_EQUALS(ImageConversion::bgrToGrey(red), 76);
+        TS_ASSERT_EQUALS(ImageConversion::bgrToGrey(green), 150);
+        TS_ASSERT_EQUALS(ImageConversion::bgrToGrey(blue), 29);
+    }
+
+    void testBGRReference() {
+        const uint32_t width = 5;
+        const uint32_t height = 3;
+        const uint32_t stride = 3 * width + 1;
+        const vector< uint8_t > bgr = createNoise(stride * height, 1);
+        vector< uint8_t > grey(width * height);
+        vector< uint8_t > flipped(width * height * 3);
+        ImageConversion::bgrToGrey(ImageConversion::SCALAR, &bgr[0], stride, width, height, &grey[0], false);
+        ImageConversion::bgrToBGR(ImageConversion::SCALAR, &bgr[0], stride, width, height, &flipped[0], true);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                const uint8_t *p = &bgr[y * stride + 3 * x];
+                TS_ASSERT_EQUALS(grey[y * width + x], ImageConversion::bgrToGrey(p));
+                const uint8_t *q = &flipped[((height - 1 - y) * width + width - 1 - x) * 3];
+                TS_ASSERT(q[0] == p[0] && q[1] == p[1] && q[2] == p[2]);
+            }
+        }
+    }
+
+    void testKernelsMatchScalar() {
+        // Widths with and without a remainder after the vectorized pixels.
+        const uint32_t widths[] = {2, 6, 16, 34, 62, 640};
+        const Conversion conversions[] = {&ImageConversion::bgrToGrey, &ImageConversion::bgrToBGR, &ImageConversion::yuyvToBGR,
+                                          &ImageConversion::yuyvToGrey, &ImageConversion::nv12ToBGR, &ImageConversion::nv12ToGrey};
+        const uint32_t outputBytes[] = {1, 3, 3, 1, 3, 1};
+        const uint32_t inputBytes[] = {3, 3, 2, 2, 1, 1};
+        const uint32_t height = 6;
+        for (uint32_t k = ImageConversion::SSSE3; k <= ImageConversion::AVX2; k++) {
+            const ImageConversion::Kernel kernel = static_cast< ImageConversion::Kernel >(k);
+            if (!ImageConversion::isSupported(kernel)) {
+                continue;
+            }
+            for (uint32_t c = 0; c < 6; c++) {
+                for (uint32_t w = 0; w < 6; w++) {
+                    const uint32_t width = widths[w];
+                    const uint32_t stride = inputBytes[c] * width + 8;
+                    // NV12 has the chroma plane after the luma.
+                    const vector< uint8_t > src = createNoise(stride * height * 2, width + c);
+                    for (uint32_t f = 0; f < 2; f++) {
+                        vector< uint8_t > expected(width * height * outputBytes[c], 0);
+                        vector< uint8_t > actual(width * height * outputBytes[c], 0);
+                        conversions[c](ImageConversion::SCALAR, &src[0], stride, width, height, &expected[0], f == 1);
+                        conversions[c](kernel, &src[0], stride, width, height, &actual[0], f == 1);
+                        TSM_ASSERT(ImageConversion::getName(kernel), expected == actual);
+                    }
+                }
+            }
+        }
+    }
+
+    void testBestKernel() {
+        TS_ASSERT(ImageConversion::isSupported(ImageConversion::SCALAR));
+        TS_ASSERT(ImageConversion::isSupported(ImageConversion::best()));
+        TS_ASSERT_EQUALS(string(ImageConversion::getName(ImageConversion::SCALAR)), "scalar");
+    }
+};
+
+#endif /*PROXY_IMAGECONVERSION_TESTSUITE_H*/
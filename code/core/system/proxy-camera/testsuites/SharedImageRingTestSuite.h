@@ -0,0 +1,188 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROXY_SHAREDIMAGERING_TESTSUITE_H
+#define PROXY_SHAREDIMAGERING_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <opendavinci/odcore/wrapper/SharedMemory.h>
+#include <opendavinci/odcore/wrapper/SharedMemoryFactory.h>
+
+#include "../include/Camera.h"
+#include "../include/SharedImageRing.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+// Fills every byte of frame n with n; the copy fails while m_fail is set.
+class RingCamera : public Camera {
+   public:
+    RingCamera(const string &name)
+        : Camera(name, 0, 8, 4, 1)
+        , m_fail(false)
+        , m_frames(0) {}
+
+    bool m_fail;
+
+   protected:
+    virtual bool captureFrame() {
+        m_frames++;
+        return true;
+    }
+
+    virtual bool copyImageTo(char *dest, const uint32_t &size) {
+        if (m_fail) {
+            return false;
+        }
+        ::memset(dest, static_cast< int >(m_frames & 0xFF), size);
+        return true;
+    }
+
+    virtual bool isValid() const {
+        return true;
+    }
+
+   private:
+    uint32_t m_frames;
+};
+
+class SharedImageRingTest : public CxxTest::TestSuite {
+   public:
+    void testSlots() {
+        TS_ASSERT_EQUALS(SharedImageRing::getSlotName("cam", 2), "cam.2");
+        // The trailer is 8 bytes aligned after the image.
+        TS_ASSERT_EQUALS(SharedImageRing::getSlotSize(32), 32u + sizeof(SharedImageSlotTrailer));
+        TS_ASSERT_EQUALS(SharedImageRing::getSlotSize(33), 40u + sizeof(SharedImageSlotTrailer));
+
+        SharedImageRing ring("testSlots", 3, 33);
+        TS_ASSERT(ring.isValid());
+        TS_ASSERT_EQUALS(ring.getNumberOfSlots(), 3u);
+        TS_ASSERT_EQUALS(ring.getSize(), 33u);
+        TS_ASSERT_EQUALS(ring.getFrame(), 0u);
+
+        // Nothing was published yet.
+        shared_ptr< odcore::wrapper::SharedMemory > slot = odcore::wrapper::SharedMemoryFactory::attachToSharedMemory("testSlots.0");
+        uint32_t frame = 0;
+        TS_ASSERT_EQUALS(SharedImageRing::beginRead(slot->getSharedMemory(), slot->getSize(), 33, frame), 0u);
+    }
+
+    void testPublishAndRead() {
+        SharedImageRing ring("testPublishAndRead", 2, 16);
+        for (uint32_t i = 0; i < 5; i++) {
+            ::memset(ring.beginFrame(), static_cast< int >(i + 1), 16);
+            TS_ASSERT_EQUALS(ring.publishFrame(1000 + i), SharedImageRing::getSlotName("testPublishAndRead", i % 2));
+        }
+        TS_ASSERT_EQUALS(ring.getFrame(), 5u);
+
+        // Slot 0 holds the image number 4, slot 1 the image number 3.
+        vector< char > image(16, 0);
+        uint32_t frame = 0;
+        int64_t captured = 0;
+        shared_ptr< odcore::wrapper::SharedMemory > slot = odcore::wrapper::SharedMemoryFactory::attachToSharedMemory("testPublishAndRead.0");
+        TS_ASSERT(SharedImageRing::read(slot->getSharedMemory(), slot->getSize(), &image[0], 16, frame, &captured));
+        TS_ASSERT_EQUALS(frame, 4u);
+        TS_ASSERT_EQUALS(captured, 1004);
+        TS_ASSERT_EQUALS(image[0], 5);
+        TS_ASSERT_EQUALS(image[15], 5);
+
+        slot = odcore::wrapper::SharedMemoryFactory::attachToSharedMemory("testPublishAndRead.1");
+        TS_ASSERT(SharedImageRing::read(slot->getSharedMemory(), slot->getSize(), &image[0], 16, frame, &captured));
+        TS_ASSERT_EQUALS(frame, 3u);
+        TS_ASSERT_EQUALS(captured, 1003);
+        TS_ASSERT_EQUALS(image[0], 4);
+
+        // A segment rounded up by the system (e.g. to whole pages) holds the trailer at the same place.
+        TS_ASSERT(SharedImageRing::read(slot->getSharedMemory(), 4096, &image[0], 16, frame, &captured));
+        TS_ASSERT_EQUALS(frame, 3u);
+
+        // A segment too small for the announced image is rejected.
+        TS_ASSERT(!SharedImageRing::read(slot->getSharedMemory(), 16, &image[0], 16, frame, &captured));
+    }
+
+    void testOverwrittenWhileReading() {
+        SharedImageRing ring("testOverwrittenWhileReading", 2, 16);
+        ::memset(ring.beginFrame(), 1, 16);
+        ring.publishFrame(0);
+        ::memset(ring.beginFrame(), 2, 16);
+        ring.publishFrame(0);
+
+        shared_ptr< odcore::wrapper::SharedMemory > slot = odcore::wrapper::SharedMemoryFactory::attachToSharedMemory("testOverwrittenWhileReading.0");
+        uint32_t frame = 0;
+        const uint32_t sequence = SharedImageRing::beginRead(slot->getSharedMemory(), slot->getSize(), 16, frame);
+        TS_ASSERT(sequence != 0);
+        TS_ASSERT_EQUALS(frame, 0u);
+        TS_ASSERT(SharedImageRing::endRead(slot->getSharedMemory(), slot->getSize(), 16, sequence));
+
+        // The camera laps the reader: the slot is written again during the read.
+        ring.beginFrame();
+        TS_ASSERT(!SharedImageRing::endRead(slot->getSharedMemory(), slot->getSize(), 16, sequence));
+        uint32_t next = 0;
+        TS_ASSERT_EQUALS(SharedImageRing::beginRead(slot->getSharedMemory(), slot->getSize(), 16, next), 0u);
+        ring.publishFrame(0);
+        TS_ASSERT(!SharedImageRing::endRead(slot->getSharedMemory(), slot->getSize(), 16, sequence));
+        TS_ASSERT(SharedImageRing::beginRead(slot->getSharedMemory(), slot->getSize(), 16, next) != 0);
+        // Image number 1 in the other slot was missed by a reader that only follows slot 0.
+        TS_ASSERT_EQUALS(next, 2u);
+    }
+
+    void testCameraSlots() {
+        RingCamera camera("testCameraSlots");
+        odcore::data::image::SharedImage si;
+        TS_ASSERT(camera.capture(si));
+        TS_ASSERT_EQUALS(si.getName(), "testCameraSlots");
+
+        TS_ASSERT(camera.setSlots(3));
+        for (uint32_t i = 0; i < 6; i++) {
+            TS_ASSERT(camera.capture(si));
+            TS_ASSERT_EQUALS(si.getName(), SharedImageRing::getSlotName("testCameraSlots", i % 3));
+
+            shared_ptr< odcore::wrapper::SharedMemory > slot = odcore::wrapper::SharedMemoryFactory::attachToSharedMemory(si.getName());
+            TS_ASSERT(slot->getSize() >= camera.getSize());
+            vector< char > image(camera.getSize(), 0);
+            uint32_t frame = 0;
+            int64_t captured = 0;
+            TS_ASSERT(SharedImageRing::read(slot->getSharedMemory(), slot->getSize(), &image[0], camera.getSize(), frame, &captured));
+            TS_ASSERT_EQUALS(frame, i);
+            TS_ASSERT_EQUALS(captured, camera.getCaptureTimeStamp().toMicroseconds());
+            // The first image went to the single segment.
+            TS_ASSERT_EQUALS(image[0], static_cast< char >(i + 2));
+        }
+
+        // A frame that could not be copied is not published and keeps the capture time of the last one.
+        const int64_t captured = camera.getCaptureTimeStamp().toMicroseconds();
+        camera.m_fail = true;
+        si.setName("");
+        TS_ASSERT(!camera.capture(si));
+        TS_ASSERT_EQUALS(si.getName(), "");
+        TS_ASSERT_EQUALS(camera.getCaptureTimeStamp().toMicroseconds(), captured);
+        camera.m_fail = false;
+
+        // Back to the single segment.
+        TS_ASSERT(!camera.setSlots(1));
+        TS_ASSERT(camera.capture(si));
+        TS_ASSERT_EQUALS(si.getName(), "testCameraSlots");
+    }
+};
+
+#endif /*PROXY_SHAREDIMAGERING_TESTSUITE_H*/
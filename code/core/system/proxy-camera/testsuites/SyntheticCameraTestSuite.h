@@ -0,0 +1,120 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROXY_SYNTHETICCAMERA_TESTSUITE_H
+#define PROXY_SYNTHETICCAMERA_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <opendavinci/odcore/wrapper/SharedMemory.h>
+#include <opendavinci/odcore/wrapper/SharedMemoryFactory.h>
+
+#include "../include/CameraCaptureThread.h"
+#include "../include/SharedImageRing.h"
+#include "../include/SyntheticCamera.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+// true if image holds the test pattern of the frame.
+inline bool isPattern(const vector< char > &image, const uint64_t &frame, const uint32_t &width, const uint32_t &height, const uint32_t &bpp) {
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            for (uint32_t c = 0; c < bpp; c++) {
+                if (static_cast< uint8_t >(image[(y * width + x) * bpp + c]) != SyntheticCamera::getPixel(frame, x, y, c)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+class SyntheticCameraTest : public CxxTest::TestSuite {
+   public:
+    void testPattern() {
+        TS_ASSERT_EQUALS(SyntheticCamera::getPixel(0, 0, 0, 0), 0);
+        TS_ASSERT_EQUALS(SyntheticCamera::getPixel(1, 0, 0, 0), 3);
+        TS_ASSERT_EQUALS(SyntheticCamera::getPixel(0, 1, 2, 1), 90);
+        TS_ASSERT_EQUALS(SyntheticCamera::getPixel(100, 250, 0, 2), static_cast< uint8_t >(300 + 250 + 170));
+
+        SyntheticCamera camera("testPatternSI", 0, 300, 7, 3, 0.0f);
+        shared_ptr< odcore::wrapper::SharedMemory > memory = odcore::wrapper::SharedMemoryFactory::attachToSharedMemory("testPatternSI");
+        vector< char > image(camera.getSize());
+        for (uint64_t frame = 1; frame <= 3; frame++) {
+            odcore::data::image::SharedImage si;
+            TS_ASSERT(camera.capture(si));
+            TS_ASSERT_EQUALS(si.getName(), "testPatternSI");
+            TS_ASSERT_EQUALS(camera.getFrame(), frame);
+            ::memcpy(&image[0], memory->getSharedMemory(), camera.getSize());
+            TS_ASSERT(isPattern(image, frame, 300, 7, 3));
+        }
+    }
+
+    void testSharedMemory() {
+        SyntheticCamera camera("testSharedMemorySI", 0, 64, 48, 1, 0.0f);
+        TS_ASSERT(camera.setSlots(2));
+        odcore::data::image::SharedImage si;
+        TS_ASSERT(camera.capture(si));
+        TS_ASSERT_EQUALS(si.getName(), "testSharedMemorySI.0");
+        TS_ASSERT_EQUALS(si.getWidth(), 64u);
+        TS_ASSERT_EQUALS(si.getBytesPerPixel(), 1u);
+
+        shared_ptr< odcore::wrapper::SharedMemory > slot = odcore::wrapper::SharedMemoryFactory::attachToSharedMemory(si.getName());
+        vector< char > image(camera.getSize());
+        uint32_t frame = 0;
+        int64_t captured = 0;
+        TS_ASSERT(SharedImageRing::read(slot->getSharedMemory(), slot->getSize(), &image[0], camera.getSize(), frame, &captured));
+        TS_ASSERT_EQUALS(frame, 0u);
+        TS_ASSERT_EQUALS(captured, camera.getCaptureTimeStamp().toMicroseconds());
+        TS_ASSERT(isPattern(image, 1, 64, 48, 1));
+    }
+
+    void testFrameRate() {
+        // 10 frames at 200 fps take 50 ms; the capture thread keeps up.
+        SyntheticCamera camera("testFrameRateSI", 0, 32, 32, 3, 200.0f);
+        CameraCaptureThread capture(camera);
+        vector< char > image(camera.getSize());
+        const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        TS_ASSERT(capture.start());
+        uint32_t frames = 0;
+        while (frames < 10) {
+            if (capture.nextFrame()) {
+                const CameraFrame &frame = capture.getFrame();
+                shared_ptr< odcore::wrapper::SharedMemory > slot = odcore::wrapper::SharedMemoryFactory::attachToSharedMemory(frame.m_sharedImage.getName());
+                uint32_t number = 0;
+                if (SharedImageRing::read(slot->getSharedMemory(), slot->getSize(), &image[0], camera.getSize(), number)) {
+                    TS_ASSERT(isPattern(image, frame.m_sequence, 32, 32, 3));
+                }
+                frames++;
+            }
+        }
+        capture.stop();
+        const int64_t elapsed = chrono::duration_cast< chrono::milliseconds >(chrono::steady_clock::now() - start).count();
+        TS_ASSERT(elapsed >= 40);
+        TS_ASSERT(elapsed < 1000);
+    }
+};
+
+#endif /*PROXY_SYNTHETICCAMERA_TESTSUITE_H*/
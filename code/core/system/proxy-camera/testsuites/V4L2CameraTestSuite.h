@@ -0,0 +1,146 @@
+/**
+ * proxy-camera - Interface to OpenCV-based cameras.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROXY_V4L2CAMERA_TESTSUITE_H
+#define PROXY_V4L2CAMERA_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <vector>
+
+#include "../include/ImageConversion.h"
+#include "../include/V4L2Camera.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+// A YUYV image of width x height with varying luma and chroma.
+inline vector< uint8_t > createYUYV(const uint32_t &width, const uint32_t &height, const uint32_t &stride) {
+    vector< uint8_t > image(stride * height, 0);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x += 2) {
+            uint8_t *p = &image[y * stride + 2 * x];
+            p[0] = static_cast< uint8_t >(16 + (x * 7 + y * 13) % 220);
+            p[1] = static_cast< uint8_t >((x * 31 + y * 3) % 256);
+            p[2] = static_cast< uint8_t >(16 + (x * 11 + y * 5) % 220);
+            p[3] = static_cast< uint8_t >((x * 17 + y * 29) % 256);
+        }
+    }
+    return image;
+}
+
+class V4L2CameraTest : public CxxTest::TestSuite {
+   public:
+    void testYUVToBGR() {
+        uint8_t bgr[3] = {1, 1, 1};
+        ImageConversion::yuvToBGR(16, 128, 128, bgr);
+        TS_ASSERT(bgr[0] == 0 && bgr[1] == 0 && bgr[2] == 0);
+        ImageConversion::yuvToBGR(235, 128, 128, bgr);
+        TS_ASSERT(bgr[0] == 255 && bgr[1] == 255 && bgr[2] == 255);
+        // Red, green and blue at 100 % in BT.601 limited range.
+        ImageConversion::yuvToBGR(81, 90, 240, bgr);
+        TS_ASSERT(bgr[0] <= 1 && bgr[1] <= 1 && bgr[2] >= 254);
+        ImageConversion::yuvToBGR(145, 54, 34, bgr);
+        TS_ASSERT(bgr[0] <= 1 && bgr[1] >= 254 && bgr[2] <= 1);
+        ImageConversion::yuvToBGR(41, 240, 110, bgr);
+        TS_ASSERT(bgr[0] >= 254 && bgr[1] <= 1 && bgr[2] <= 1);
+    }
+
+    void testYUYV() {
+        const uint32_t width = 8;
+        const uint32_t height = 4;
+        const uint32_t stride = 2 * width + 4;
+        const vector< uint8_t > yuyv = createYUYV(width, height, stride);
+        vector< uint8_t > bgr(width * height * 3);
+        vector< uint8_t > flipped(width * height * 3);
+        vector< uint8_t > grey(width * height);
+        vector< uint8_t > greyFlipped(width * height);
+        ImageConversion::yuyvToBGR(&yuyv[0], stride, width, height, &bgr[0], false);
+        ImageConversion::yuyvToBGR(&yuyv[0], stride, width, height, &flipped[0], true);
+        ImageConversion::yuyvToGrey(&yuyv[0], stride, width, height, &grey[0], false);
+        ImageConversion::yuyvToGrey(&yuyv[0], stride, width, height, &greyFlipped[0], true);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                const uint8_t *p = &yuyv[y * stride + 2 * (x & ~1u)];
+                uint8_t expected[3];
+                ImageConversion::yuvToBGR(p[(x & 1) * 2], p[1], p[3], expected);
+                const uint32_t i = y * width + x;
+                const uint32_t turned = (height - 1 - y) * width + (width - 1 - x);
+                for (uint32_t c = 0; c < 3; c++) {
+                    TS_ASSERT_EQUALS(bgr[3 * i + c], expected[c]);
+                    TS_ASSERT_EQUALS(flipped[3 * turned + c], expected[c]);
+                }
+                TS_ASSERT_EQUALS(grey[i], p[(x & 1) * 2]);
+                TS_ASSERT_EQUALS(greyFlipped[turned], p[(x & 1) * 2]);
+            }
+        }
+    }
+
+    void testNV12() {
+        const uint32_t width = 6;
+        const uint32_t height = 4;
+        const uint32_t stride = 8;
+        vector< uint8_t > nv12(stride * height * 3 / 2, 0);
+        for (uint32_t i = 0; i < nv12.size(); i++) {
+            nv12[i] = static_cast< uint8_t >((i * 37 + 11) % 256);
+        }
+        vector< uint8_t > bgr(width * height * 3);
+        vector< uint8_t > flipped(width * height * 3);
+        vector< uint8_t > grey(width * height);
+        ImageConversion::nv12ToBGR(&nv12[0], stride, width, height, &bgr[0], false);
+        ImageConversion::nv12ToBGR(&nv12[0], stride, width, height, &flipped[0], true);
+        ImageConversion::nv12ToGrey(&nv12[0], stride, width, height, &grey[0], true);
+        for (uint32_t y = 0; y < height; y++) {
+            for (uint32_t x = 0; x < width; x++) {
+                const uint8_t *uv = &nv12[stride * height + (y / 2) * stride + (x & ~1u)];
+                uint8_t expected[3];
+                ImageConversion::yuvToBGR(nv12[y * stride + x], uv[0], uv[1], expected);
+                const uint32_t i = y * width + x;
+                const uint32_t turned = (height - 1 - y) * width + (width - 1 - x);
+                for (uint32_t c = 0; c < 3; c++) {
+                    TS_ASSERT_EQUALS(bgr[3 * i + c], expected[c]);
+                    TS_ASSERT_EQUALS(flipped[3 * turned + c], expected[c]);
+                }
+                TS_ASSERT_EQUALS(grey[turned], nv12[y * stride + x]);
+            }
+        }
+    }
+
+    void testPixelFormat() {
+        V4L2Camera::PixelFormat format = V4L2Camera::YUYV;
+        TS_ASSERT(V4L2Camera::getPixelFormat("MJPEG", format));
+        TS_ASSERT_EQUALS(format, V4L2Camera::MJPEG);
+        TS_ASSERT(V4L2Camera::getPixelFormat("NV12", format));
+        TS_ASSERT_EQUALS(format, V4L2Camera::NV12);
+        TS_ASSERT(!V4L2Camera::getPixelFormat("RGB3", format));
+        TS_ASSERT_EQUALS(format, V4L2Camera::NV12);
+    }
+
+    void testMissingDevice() {
+        // Without a device, the camera stays invalid and captures nothing.
+        V4L2Camera camera("testV4L2CameraSI", 99, 640, 480, 3, false, V4L2Camera::YUYV, 4);
+        const int64_t created = camera.getCaptureTimeStamp().toMicroseconds();
+        odcore::data::image::SharedImage si;
+        TS_ASSERT(!camera.capture(si));
+        TS_ASSERT_EQUALS(camera.getCaptureTimeStamp().toMicroseconds(), created);
+        TS_ASSERT_EQUALS(camera.getSkippedFrames(), 0u);
+    }
+};
+
+#endif /*PROXY_V4L2CAMERA_TESTSUITE_H*/
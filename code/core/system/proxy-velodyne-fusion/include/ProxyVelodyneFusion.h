@@ -0,0 +1,103 @@
+/**
+ * proxy-velodyne-fusion - Merges several Velodyne sensors into one point cloud.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROXY_PROXYVELODYNEFUSION_H
+#define PROXY_PROXYVELODYNEFUSION_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "opendavinci/odcore/base/module/DataTriggeredConferenceClientModule.h"
+#include "opendavinci/odcore/wrapper/SharedMemory.h"
+#include <opendavinci/odcore/io/udp/UDPFactory.h>
+#include <opendavinci/odcore/io/udp/UDPReceiver.h>
+#include "VelodyneFusionPublisher.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+using namespace std;
+using namespace odcore::wrapper;
+
+/**
+ * ProxyVelodyneFusion receives several Velodyne sensors (VLP-16, HDL-32E,
+ * HDL-64E), each on its own port and decoding thread, and publishes one
+ * shared point cloud per frame of the first sensor with the frames of all
+ * sensors that were recorded at about the same time, transformed into a
+ * common frame with the pose of each sensor.
+ */
+class ProxyVelodyneFusion : public odcore::base::module::DataTriggeredConferenceClientModule {
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     *
+     * @param obj Reference to an object of this class.
+     */
+    ProxyVelodyneFusion(const ProxyVelodyneFusion & /*obj*/);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     *
+     * @param obj Reference to an object of this class.
+     * @return Reference to this instance.
+     */
+    ProxyVelodyneFusion &operator=(const ProxyVelodyneFusion & /*obj*/);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param argc Number of command line arguments.
+     * @param argv Command line arguments.
+     */
+    ProxyVelodyneFusion(const int32_t &argc, char **argv);
+
+    virtual ~ProxyVelodyneFusion();
+
+    virtual void nextContainer(odcore::data::Container &);
+
+   private:
+    virtual void setUp();
+    virtual void tearDown();
+
+    //Adds sensor <index> as configured in proxy-velodyne-fusion.sensor<index>.*
+    void addSensor(const uint32_t &index);
+
+   private:
+    string m_memoryName;   //Name of the shared memory
+    uint32_t m_memorySize; //Size of the shared memory: the points of all sensors (POINT_CAPACITY * 16 bytes each) and their sensor indices if enabled
+
+    std::shared_ptr< SharedMemory > m_sharedMemory;
+    std::shared_ptr< VelodyneFusionPublisher > m_publisher;
+    std::vector< std::shared_ptr< VelodyneUDPReceiver > > m_packetReceivers; //one receive and one decode thread per sensor
+    std::vector< std::shared_ptr< odcore::io::udp::UDPReceiver > > m_udpreceivers; //decoding in the UDPReceiver callback where the receive threads could not be started
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*PROXY_PROXYVELODYNEFUSION_H*/
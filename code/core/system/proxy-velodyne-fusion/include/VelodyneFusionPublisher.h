@@ -0,0 +1,123 @@
+/**
+ * proxy-velodyne-fusion - Merges several Velodyne sensors into one point cloud.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VELODYNEFUSIONPUBLISHER_H_
+#define VELODYNEFUSIONPUBLISHER_H_
+
+#include <memory>
+
+#include "opendavinci/generated/odcore/data/SharedPointCloud.h"
+#include "opendavinci/odcore/io/conference/ContainerConference.h"
+#include "opendavinci/odcore/wrapper/SharedMemory.h"
+
+#include "VelodyneFusion.h"
+#include "VelodyneSharedMemoryRing.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * VelodyneFusionPublisher sends the merged point cloud of its
+ * VelodyneFusion as shared point cloud (xyz+intensity floats) once per
+ * frame of the reference sensor. The points are written directly into the
+ * shared memory (or the next slot of a ring); optionally, the index of the
+ * sensor of each point (uint8_t) follows the points.
+ */
+class VelodyneFusionPublisher : public VelodyneFusionListener {
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    VelodyneFusionPublisher(const VelodyneFusionPublisher &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    VelodyneFusionPublisher &operator=(const VelodyneFusionPublisher &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param m shared memory for the merged point cloud.
+     * @param c container conference.
+     */
+    VelodyneFusionPublisher(const std::shared_ptr< odcore::wrapper::SharedMemory > m, odcore::io::conference::ContainerConference &c);
+
+    virtual ~VelodyneFusionPublisher();
+
+    /**
+     * @return Sensors and their merge; sensors must be added before the first packet.
+     */
+    VelodyneFusion &getFusion() {
+        return m_fusion;
+    }
+
+    /**
+     * This method appends the index of the sensor of each point (uint8_t,
+     * in the order the sensors were added) after the points; the size of
+     * the SPC then covers width * (4 floats + 1 byte).
+     *
+     * @param sensorIndices true to append the sensor indices.
+     */
+    void setSensorIndices(const bool &sensorIndices);
+
+    /**
+     * @return Size in bytes of the largest merged point cloud including the sensor indices if enabled.
+     */
+    uint32_t getFrameSize() const;
+
+    /**
+     * This method lets the merged point clouds be written into the slots
+     * of the given ring instead of the shared memory passed to the
+     * constructor. It must be called before the first packet.
+     *
+     * @param ring ring with slots of at least getFrameSize() bytes.
+     * @return true if the ring is used.
+     */
+    bool setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing > ring);
+
+    /**
+     * @return Number of merged point clouds not sent as they did not fit into the shared memory.
+     */
+    uint32_t getOversizedFrames() const;
+
+    virtual void nextMergedFrame();
+
+   private:
+    std::shared_ptr< odcore::wrapper::SharedMemory > m_sharedMemory;
+    std::shared_ptr< VelodyneSharedMemoryRing > m_ring; //slots the merged point clouds are written into; empty to use m_sharedMemory
+    odcore::io::conference::ContainerConference &m_conference;
+    odcore::data::SharedPointCloud m_spc;
+    VelodyneFusion m_fusion;
+    bool m_publishSensorIndices;
+    uint32_t m_oversizedFrames;
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNEFUSIONPUBLISHER_H_*/
@@ -0,0 +1,254 @@
+/**
+ * proxy-velodyne-fusion - Merges several Velodyne sensors into one point cloud.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+#include "ProxyVelodyneFusion.h"
+#include "opendavinci/odcore/base/KeyValueConfiguration.h"
+#include "opendavinci/odcore/data/Container.h"
+#include "opendavinci/odcore/io/conference/ContainerConference.h"
+#include "opendavinci/odcore/wrapper/SharedMemoryFactory.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+using namespace std;
+using namespace odcore::wrapper;
+using namespace odcore::io::udp;
+
+ProxyVelodyneFusion::ProxyVelodyneFusion(const int32_t &argc, char **argv)
+    : DataTriggeredConferenceClientModule(argc, argv, "proxy-velodyne-fusion")
+    , m_memoryName()
+    , m_memorySize(0)
+    , m_sharedMemory()
+    , m_publisher()
+    , m_packetReceivers()
+    , m_udpreceivers() {}
+
+ProxyVelodyneFusion::~ProxyVelodyneFusion() {}
+
+void ProxyVelodyneFusion::setUp() {
+    //Optional: directory for a binary cache of the parsed calibration files; none by default
+    string calibrationCache;
+    try {
+        calibrationCache = getKeyValueConfiguration().getValue< string >("proxy-velodyne-fusion.calibrationCache");
+    }
+    catch(...) {
+        calibrationCache = "";
+    }
+    cout << "Calibration cache directory:" << calibrationCache << endl;
+    VelodyneCalibrationFile::setCacheDirectory(calibrationCache);
+
+    m_memoryName = getKeyValueConfiguration().getValue< string >("proxy-velodyne-fusion.sharedMemory.name");
+    m_memorySize = getKeyValueConfiguration().getValue< uint32_t >("proxy-velodyne-fusion.sharedMemory.size");
+    m_sharedMemory = SharedMemoryFactory::createSharedMemory(m_memoryName, m_memorySize);
+    m_publisher = shared_ptr< VelodyneFusionPublisher >(new VelodyneFusionPublisher(m_sharedMemory, getConference()));
+
+    const uint32_t numberOfSensors = getKeyValueConfiguration().getValue< uint32_t >("proxy-velodyne-fusion.numberOfSensors");
+    cout << "Number of sensors (the first one is the reference for the merged frames):" << numberOfSensors << endl;
+    if (numberOfSensors < 1 || numberOfSensors > 255) {
+        throw invalid_argument( "Invalid number of sensors! 1 to 255 sensors can be merged" );
+    }
+    for (uint32_t index = 0; index < numberOfSensors; index++) {
+        addSensor(index);
+    }
+
+    //Optional: microseconds the middle of a frame may lie from the middle of the frame of the reference sensor to be merged
+    int64_t maxTimeDifference = VelodyneFusion::DEFAULT_MAX_TIME_DIFFERENCE;
+    try {
+        maxTimeDifference = getKeyValueConfiguration().getValue< int64_t >("proxy-velodyne-fusion.maxTimeDifference");
+    }
+    catch(...) {
+        maxTimeDifference = VelodyneFusion::DEFAULT_MAX_TIME_DIFFERENCE;
+    }
+    cout << "Maximum time difference to the reference frame in microseconds:" << maxTimeDifference << endl;
+    m_publisher->getFusion().setMaxTimeDifference(maxTimeDifference);
+
+    //Optional: append the index of the sensor of each point after the points of the shared point cloud (1) or not (0, default)
+    bool sensorIndices = false;
+    try {
+        sensorIndices = (getKeyValueConfiguration().getValue< uint32_t >("proxy-velodyne-fusion.sensorIndices") == 1);
+    }
+    catch(...) {
+        sensorIndices = false;
+    }
+    cout << "Sensor index per point (0: no; 1: appended to the shared point cloud):" << sensorIndices << endl;
+    m_publisher->setSensorIndices(sensorIndices);
+    if (m_memorySize < m_publisher->getFrameSize()) {
+        cerr << "sharedMemory.size is smaller than the largest merged frame (" << m_publisher->getFrameSize() << " bytes); larger frames are not sent." << endl;
+    }
+
+    //Optional: number of shared memory slots "<name>.<k>" the merged frames are written into (1, default: write each frame into "<name>")
+    uint32_t slots = 1;
+    try {
+        slots = getKeyValueConfiguration().getValue< uint32_t >("proxy-velodyne-fusion.sharedMemory.slots");
+    }
+    catch(...) {
+        slots = 1;
+    }
+    cout << "Shared memory slots (1: one segment; >1: ring of slots):" << slots << endl;
+    if (slots > 1) {
+        if (!m_publisher->setSharedMemoryRing(shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing(m_memoryName, slots, m_memorySize)))) {
+            cerr << "Shared memory slots could not be created (sharedMemory.size too small?); writing into one segment instead." << endl;
+        }
+    }
+
+    //Optional: number of packets buffered between the receive and the decode thread of each sensor
+    uint32_t queueSize = 4096;
+    try {
+        queueSize = getKeyValueConfiguration().getValue< uint32_t >("proxy-velodyne-fusion.receiveQueueSize");
+    }
+    catch(...) {
+        queueSize = 4096;
+    }
+    //Optional: maximum number of packets read per system call
+    uint32_t batchSize = VelodyneUDPReceiver::DEFAULT_BATCH_SIZE;
+    try {
+        batchSize = getKeyValueConfiguration().getValue< uint32_t >("proxy-velodyne-fusion.receiveBatchSize");
+    }
+    catch(...) {
+        batchSize = VelodyneUDPReceiver::DEFAULT_BATCH_SIZE;
+    }
+    //Optional: socket receive buffer in bytes (0: system default)
+    uint32_t receiveBufferSize = 0;
+    try {
+        receiveBufferSize = getKeyValueConfiguration().getValue< uint32_t >("proxy-velodyne-fusion.receiveBufferSize");
+    }
+    catch(...) {
+        receiveBufferSize = 0;
+    }
+    cout << "Receive queue size: " << queueSize << ", batch size: " << batchSize << ", socket receive buffer (0: system default): " << receiveBufferSize << endl;
+
+    //Each sensor is decoded by its own thread; the merge runs on the thread of the reference sensor
+    for (uint32_t index = 0; index < numberOfSensors; index++) {
+        stringstream prefix;
+        prefix << "proxy-velodyne-fusion.sensor" << index << ".";
+        const string udpReceiverIP = getKeyValueConfiguration().getValue< string >(prefix.str() + "udpReceiverIP");
+        const uint32_t udpPort = getKeyValueConfiguration().getValue< uint32_t >(prefix.str() + "udpPort");
+        VelodyneFusionSensor &sensor = m_publisher->getFusion().getSensor(index);
+        shared_ptr< VelodyneUDPReceiver > packetReceiver(new VelodyneUDPReceiver(udpReceiverIP, udpPort, sensor, queueSize));
+        packetReceiver->setBatchSize(batchSize);
+        packetReceiver->setReceiveBufferSize(receiveBufferSize);
+        if (packetReceiver->start()) {
+            m_packetReceivers.push_back(packetReceiver);
+        } else {
+            cerr << "Receive thread of sensor " << index << " could not be started; decoding in the UDP callback instead." << endl;
+            shared_ptr< UDPReceiver > udpreceiver = UDPFactory::createUDPReceiver(udpReceiverIP, udpPort);
+            udpreceiver->setStringListener(&sensor);
+            udpreceiver->start();
+            m_udpreceivers.push_back(udpreceiver);
+        }
+    }
+}
+
+void ProxyVelodyneFusion::addSensor(const uint32_t &index) {
+    stringstream prefix;
+    prefix << "proxy-velodyne-fusion.sensor" << index << ".";
+    const uint32_t model = getKeyValueConfiguration().getValue< uint32_t >(prefix.str() + "model");
+    const string calibration = getKeyValueConfiguration().getValue< string >(prefix.str() + "calibration");
+
+    //Optional: pose of the sensor in the merged point cloud (x right, y forward, z up) in meters and degrees; 0 by default
+    double pose[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    const string keys[6] = {"x", "y", "z", "roll", "pitch", "yaw"};
+    for (uint32_t i = 0; i < 6; i++) {
+        try {
+            pose[i] = getKeyValueConfiguration().getValue< double >(prefix.str() + keys[i]);
+        }
+        catch(...) {
+            pose[i] = 0.0;
+        }
+    }
+    cout << "Sensor " << index << " (model " << model << ", " << calibration << ") at x, y, z: " << pose[0] << ", " << pose[1] << ", " << pose[2] << " m, roll, pitch, yaw: " << pose[3] << ", " << pose[4] << ", " << pose[5] << " degrees" << endl;
+    VelodyneExtrinsics extrinsics;
+    extrinsics.setPose(pose[0], pose[1], pose[2], pose[3] * M_PI / 180.0, pose[4] * M_PI / 180.0, pose[5] * M_PI / 180.0);
+
+    VelodyneFusion &fusion = m_publisher->getFusion();
+    if (model == 16) {
+        fusion.addSensor< VLP16 >(calibration, extrinsics);
+    } else if (model == 32) {
+        fusion.addSensor< HDL32E >(calibration, extrinsics);
+    } else if (model == 64) {
+        fusion.addSensor< HDL64E >(calibration, extrinsics);
+    } else {
+        throw invalid_argument( "Invalid sensor model! 16: VLP-16; 32: HDL-32E; 64: HDL-64E" );
+    }
+    VelodyneFusionSensor &sensor = fusion.getSensor(index);
+
+    //Optional: project cartesian points with precomputed sin/cos tables (1, default) or sin/cos per point (0)
+    bool lookupTables = true;
+    try {
+        lookupTables = (getKeyValueConfiguration().getValue< uint32_t >(prefix.str() + "lookupTables") == 1);
+    }
+    catch(...) {
+        lookupTables = true;
+    }
+    sensor.setLookupTables(lookupTables);
+
+    //Optional: all corrections of the HDL-64E S2/S3 calibration (1, default) or the basic model (0)
+    bool fullCalibration = true;
+    try {
+        fullCalibration = (getKeyValueConfiguration().getValue< uint32_t >(prefix.str() + "fullCalibration") == 1);
+    }
+    catch(...) {
+        fullCalibration = true;
+    }
+    sensor.setFullCalibration(fullCalibration);
+
+    //Optional: align the frames with the GPS time of the sensor (1) instead of the receive time of the packets (0, default)
+    bool deviceTime = false;
+    try {
+        deviceTime = (getKeyValueConfiguration().getValue< uint32_t >(prefix.str() + "deviceTime") == 1);
+    }
+    catch(...) {
+        deviceTime = false;
+    }
+    cout << "Sensor " << index << " lookup tables: " << lookupTables << ", full calibration: " << fullCalibration << ", frame time (0: receive time; 1: GPS time of the sensor): " << deviceTime << endl;
+    sensor.setDeviceTime(deviceTime);
+}
+
+void ProxyVelodyneFusion::tearDown() {
+    for (shared_ptr< VelodyneUDPReceiver > &packetReceiver : m_packetReceivers) {
+        packetReceiver->stop();
+    }
+    for (shared_ptr< UDPReceiver > &udpreceiver : m_udpreceivers) {
+        udpreceiver->stop();
+        udpreceiver->setStringListener(NULL);
+    }
+    if (m_publisher.get() != NULL) {
+        VelodyneFusion &fusion = m_publisher->getFusion();
+        cout << "Merged frames: " << fusion.getMergedFrames() << ", not sent (larger than sharedMemory.size): " << m_publisher->getOversizedFrames() << endl;
+        for (uint32_t index = 0; index < fusion.getNumberOfSensors(); index++) {
+            const VelodyneFusionStatistics statistics = fusion.getSensor(index).getStatistics();
+            cout << "Sensor " << index << ": decoded frames: " << statistics.decoded << ", merged: " << statistics.merged << ", replaced before the merge: " << statistics.overwritten << ", too far in time: " << statistics.outOfTime << endl;
+        }
+    }
+}
+
+void ProxyVelodyneFusion::nextContainer(odcore::data::Container &) {}
+
+}
+}
+}
+} // opendlv::core::system::proxy
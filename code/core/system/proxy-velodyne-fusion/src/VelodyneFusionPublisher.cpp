@@ -0,0 +1,102 @@
+/**
+ * proxy-velodyne-fusion - Merges several Velodyne sensors into one point cloud.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <memory>
+
+#include "opendavinci/odcore/base/Lock.h"
+#include "opendavinci/odcore/data/Container.h"
+#include "opendavinci/odcore/data/TimeStamp.h"
+#include "opendavinci/odcore/io/conference/ContainerConference.h"
+#include "opendavinci/odcore/wrapper/SharedMemory.h"
+
+#include "VelodyneFusionPublisher.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+using namespace std;
+using namespace odcore::wrapper;
+
+VelodyneFusionPublisher::VelodyneFusionPublisher(const std::shared_ptr< SharedMemory > m, odcore::io::conference::ContainerConference &c)
+    : m_sharedMemory(m)
+    , m_ring()
+    , m_conference(c)
+    , m_spc()
+    , m_fusion(*this)
+    , m_publishSensorIndices(false)
+    , m_oversizedFrames(0) {
+    m_spc.setName(m_sharedMemory->getName());
+    m_spc.setHeight(1);
+    m_spc.setNumberOfComponentsPerPoint(4);
+    m_spc.setComponentDataType(odcore::data::SharedPointCloud::FLOAT_T);
+    m_spc.setUserInfo(odcore::data::SharedPointCloud::XYZ_INTENSITY);
+}
+
+VelodyneFusionPublisher::~VelodyneFusionPublisher() {}
+
+void VelodyneFusionPublisher::setSensorIndices(const bool &sensorIndices) {
+    m_publishSensorIndices = sensorIndices;
+}
+
+uint32_t VelodyneFusionPublisher::getFrameSize() const {
+    return m_fusion.getMaxPointSize() * (4 * static_cast< uint32_t >(sizeof(float)) + (m_publishSensorIndices ? 1 : 0));
+}
+
+bool VelodyneFusionPublisher::setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing > ring) {
+    if (ring.get() == NULL || !ring->isValid() || ring->getSize() < getFrameSize()) {
+        return false;
+    }
+    m_ring = ring;
+    return true;
+}
+
+uint32_t VelodyneFusionPublisher::getOversizedFrames() const {
+    return m_oversizedFrames;
+}
+
+void VelodyneFusionPublisher::nextMergedFrame() {
+    const uint32_t numberOfPoints = m_fusion.getNumberOfPoints();
+    const uint32_t pointsSize = numberOfPoints * 4 * static_cast< uint32_t >(sizeof(float));
+    const uint32_t size = pointsSize + (m_publishSensorIndices ? numberOfPoints : 0);
+    //The points are transformed from the buffers of the decoders directly into the shared memory
+    if (m_ring.get() != NULL) {
+        float *slot = m_ring->beginFrame();
+        m_fusion.write(slot, m_publishSensorIndices ? reinterpret_cast< uint8_t * >(slot) + pointsSize : NULL);
+        m_spc.setName(m_ring->publishFrame(numberOfPoints, m_fusion.getFrameStartTime(), m_fusion.getFrameEndTime()));
+    } else if (m_sharedMemory->isValid() && size <= m_sharedMemory->getSize()) {
+        odcore::base::Lock l(m_sharedMemory);
+        float *points = static_cast< float * >(m_sharedMemory->getSharedMemory());
+        m_fusion.write(points, m_publishSensorIndices ? reinterpret_cast< uint8_t * >(points) + pointsSize : NULL);
+    } else {
+        m_oversizedFrames++;
+        return;
+    }
+    m_spc.setSize(size);
+    m_spc.setWidth(numberOfPoints);
+    odcore::data::Container c(m_spc);
+    const int64_t startTime = m_fusion.getFrameStartTime();
+    c.setSampleTimeStamp(odcore::data::TimeStamp(static_cast< int32_t >(startTime / 1000000L), static_cast< int32_t >(startTime % 1000000L)));
+    m_conference.send(c);
+}
+}
+}
+}
+} // opendlv::core::system::proxy
@@ -0,0 +1,160 @@
+/**
+ * proxy-velodyne-fusion - Merges several Velodyne sensors into one point cloud.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PROXY_PROXYVELODYNEFUSION_TESTSUITE_H
+#define PROXY_PROXYVELODYNEFUSION_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "opendavinci/generated/odcore/data/SharedPointCloud.h"
+#include "opendavinci/odcore/data/Container.h"
+#include "opendavinci/odcore/io/conference/ContainerConference.h"
+#include "opendavinci/odcore/wrapper/SharedMemory.h"
+#include "opendavinci/odcore/wrapper/SharedMemoryFactory.h"
+
+#include "../include/VelodyneFusionPublisher.h"
+#include "VelodynePcapReader.h"
+
+using namespace std;
+using namespace odcore::data;
+using namespace odcore::wrapper;
+using namespace opendlv::core::system::proxy;
+
+// Keeps a copy of the announcement and the shared memory of every merged point cloud.
+class MergedCloudConference : public odcore::io::conference::ContainerConference {
+   public:
+    MergedCloudConference()
+        : ContainerConference()
+        , m_clouds()
+        , m_data() {}
+
+    virtual void send(odcore::data::Container &c) const {
+        if (c.getDataType() == SharedPointCloud::ID()) {
+            const SharedPointCloud spc = c.getData< SharedPointCloud >();
+            std::shared_ptr< SharedMemory > memory = SharedMemoryFactory::attachToSharedMemory(spc.getName());
+            m_clouds.push_back(spc);
+            const char *data = static_cast< const char * >(memory->getSharedMemory());
+            m_data.push_back(string(data, data + spc.getSize()));
+        }
+    }
+
+    mutable vector< SharedPointCloud > m_clouds;
+    mutable vector< string > m_data;
+};
+
+// Decodes the VLP-16 and HDL-32E recordings as if both sensors were received together.
+inline void replay(VelodyneFusion &fusion) {
+    const vector< string > vlp16 = VelodynePcapReader::readDataPackets("../sampleShort.pcap");
+    const vector< string > hdl32e = VelodynePcapReader::readDataPackets("../sampleShort_velodyne32.pcap");
+    const int64_t start = 1500000000000000L;
+    uint32_t a = 0;
+    uint32_t b = 0;
+    // 754 (VLP-16) and 1808 (HDL-32E) packets per second.
+    while (a < vlp16.size() || b < hdl32e.size()) {
+        const int64_t timeA = start + a * 1326L;
+        const int64_t timeB = start + b * 553L;
+        if (b >= hdl32e.size() || (a < vlp16.size() && timeA <= timeB)) {
+            fusion.getSensor(0).nextPacket(reinterpret_cast< const uint8_t * >(vlp16[a].data()), static_cast< uint32_t >(vlp16[a].size()), TimeStamp(static_cast< int32_t >(timeA / 1000000L), static_cast< int32_t >(timeA % 1000000L)));
+            a++;
+        } else {
+            fusion.getSensor(1).nextPacket(reinterpret_cast< const uint8_t * >(hdl32e[b].data()), static_cast< uint32_t >(hdl32e[b].size()), TimeStamp(static_cast< int32_t >(timeB / 1000000L), static_cast< int32_t >(timeB % 1000000L)));
+            b++;
+        }
+    }
+}
+
+class ProxyVelodyneFusionTest : public CxxTest::TestSuite {
+   public:
+    void testMergedPointCloud() {
+        MergedCloudConference conference;
+        std::shared_ptr< SharedMemory > memory = SharedMemoryFactory::createSharedMemory("testVelodyneFusionSM", (VelodyneDecoderCore< VLP16 >::POINT_CAPACITY + VelodyneDecoderCore< HDL32E >::POINT_CAPACITY) * 17);
+        VelodyneFusionPublisher publisher(memory, conference);
+        publisher.setSensorIndices(true);
+        VelodyneExtrinsics rear;
+        rear.setPose(0.0, -2.0, 1.0, 0.0, 0.0, M_PI);
+        publisher.getFusion().addSensor< VLP16 >("../VLP-16.xml", VelodyneExtrinsics());
+        publisher.getFusion().addSensor< HDL32E >("../HDL-32E.xml", rear);
+        TS_ASSERT_EQUALS(publisher.getFrameSize(), (VelodyneDecoderCore< VLP16 >::POINT_CAPACITY + VelodyneDecoderCore< HDL32E >::POINT_CAPACITY) * 17);
+        replay(publisher.getFusion());
+
+        TS_ASSERT(!conference.m_clouds.empty());
+        TS_ASSERT_EQUALS(conference.m_clouds.size(), publisher.getFusion().getMergedFrames());
+        TS_ASSERT_EQUALS(publisher.getOversizedFrames(), 0u);
+        uint32_t withBoth = 0;
+        for (uint32_t k = 0; k < conference.m_clouds.size(); k++) {
+            const SharedPointCloud &spc = conference.m_clouds[k];
+            TS_ASSERT_EQUALS(spc.getName(), "testVelodyneFusionSM");
+            TS_ASSERT_EQUALS(spc.getHeight(), 1u);
+            TS_ASSERT_EQUALS(spc.getNumberOfComponentsPerPoint(), 4u);
+            TS_ASSERT_EQUALS(spc.getComponentDataType(), SharedPointCloud::FLOAT_T);
+            TS_ASSERT_EQUALS(spc.getUserInfo(), SharedPointCloud::XYZ_INTENSITY);
+            TS_ASSERT_EQUALS(spc.getSize(), spc.getWidth() * 17);
+
+            // The points of the reference sensor come first; the others are turned around and moved behind it.
+            const float *points = reinterpret_cast< const float * >(conference.m_data[k].data());
+            const uint8_t *sensorIndices = reinterpret_cast< const uint8_t * >(conference.m_data[k].data()) + spc.getWidth() * 16;
+            uint32_t count[2] = {0, 0};
+            for (uint32_t i = 0; i < spc.getWidth(); i++) {
+                TS_ASSERT(sensorIndices[i] < 2);
+                TS_ASSERT(i == 0 || sensorIndices[i] >= sensorIndices[i - 1]);
+                count[sensorIndices[i] & 1]++;
+                TS_ASSERT(!std::isnan(points[i * 4]));
+            }
+            TS_ASSERT(count[0] > 0);
+            withBoth += (count[1] > 0) ? 1 : 0;
+        }
+        TS_ASSERT(withBoth > 0);
+    }
+
+    void testOversizedFrames() {
+        MergedCloudConference conference;
+        std::shared_ptr< SharedMemory > memory = SharedMemoryFactory::createSharedMemory("testVelodyneFusionSmallSM", 1000);
+        VelodyneFusionPublisher publisher(memory, conference);
+        publisher.getFusion().addSensor< VLP16 >("../VLP-16.xml", VelodyneExtrinsics());
+        publisher.getFusion().addSensor< HDL32E >("../HDL-32E.xml", VelodyneExtrinsics());
+        TS_ASSERT(!publisher.setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing("testVelodyneFusionSmallSM", 3, 1000))));
+        replay(publisher.getFusion());
+        TS_ASSERT(conference.m_clouds.empty());
+        TS_ASSERT_EQUALS(publisher.getOversizedFrames(), publisher.getFusion().getMergedFrames());
+    }
+
+    void testSharedMemoryRing() {
+        MergedCloudConference conference;
+        const uint32_t size = (VelodyneDecoderCore< VLP16 >::POINT_CAPACITY + VelodyneDecoderCore< HDL32E >::POINT_CAPACITY) * 16;
+        std::shared_ptr< SharedMemory > memory = SharedMemoryFactory::createSharedMemory("testVelodyneFusionRingSM", size);
+        VelodyneFusionPublisher publisher(memory, conference);
+        publisher.getFusion().addSensor< VLP16 >("../VLP-16.xml", VelodyneExtrinsics());
+        publisher.getFusion().addSensor< HDL32E >("../HDL-32E.xml", VelodyneExtrinsics());
+        TS_ASSERT(publisher.setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing("testVelodyneFusionRingSM", 2, size))));
+        replay(publisher.getFusion());
+
+        TS_ASSERT(conference.m_clouds.size() > 2);
+        for (uint32_t k = 0; k < conference.m_clouds.size(); k++) {
+            TS_ASSERT_EQUALS(conference.m_clouds[k].getName(), VelodyneSharedMemoryRing::getSlotName("testVelodyneFusionRingSM", k % 2));
+            TS_ASSERT_EQUALS(conference.m_clouds[k].getSize(), conference.m_clouds[k].getWidth() * 16);
+        }
+    }
+};
+
+#endif /*PROXY_PROXYVELODYNEFUSION_TESTSUITE_H*/
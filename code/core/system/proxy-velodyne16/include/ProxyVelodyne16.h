@@ -27,6 +27,7 @@
 #include <opendavinci/odcore/io/udp/UDPFactory.h>
 #include <opendavinci/odcore/io/udp/UDPReceiver.h>
 #include "velodyne16Decoder.h"
+#include "VelodynePcapReplay.h"
 
 namespace opendlv {
 namespace core {
@@ -90,7 +91,12 @@ class ProxyVelodyne16 : public odcore::base::module::DataTriggeredConferenceClie
     uint32_t m_udpPort;     //2368 for velodyne
 
     std::shared_ptr< SharedMemory > m_velodyneSharedMemory;
+    bool m_receiveThread;   //true: receive and decode in separate threads; false: decode in the UDPReceiver callback
     std::shared_ptr< odcore::io::udp::UDPReceiver > m_udpreceiver;
+    std::shared_ptr< VelodyneUDPReceiver > m_packetReceiver;
+    std::shared_ptr< VelodynePcapReplay< Velodyne16Decoder > > m_replay; //decodes a recording instead of the packets received from the sensor
+    uint8_t m_poseSource;   //0: no motion compensation; 1: poses from Applanix Grp1Data; 2: orientation from AngularVelocityReading
+    std::shared_ptr< VelodynePoseBuffer > m_poses;
     std::shared_ptr< opendlv::core::system::proxy::Velodyne16Decoder > m_velodyne16decoder;
 };
 }
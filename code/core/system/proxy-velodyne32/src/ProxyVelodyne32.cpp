@@ -23,10 +23,13 @@
 #include <stdexcept>
 
 #include "ProxyVelodyne32.h"
+#include "VelodyneDecoderConfiguration.h"
 #include "opendavinci/odcore/base/KeyValueConfiguration.h"
 #include "opendavinci/odcore/data/Container.h"
 #include "opendavinci/odcore/io/conference/ContainerConference.h"
 #include "opendavinci/odcore/wrapper/SharedMemoryFactory.h"
+#include "odvdapplanix/GeneratedHeaders_ODVDApplanix.h"
+#include "odvdopendlvstandardmessageset/GeneratedHeaders_ODVDOpenDLVStandardMessageSet.h"
 
 
 namespace opendlv {
@@ -51,7 +54,12 @@ ProxyVelodyne32::ProxyVelodyne32(const int32_t &argc, char **argv)
     , m_udpReceiverIP()
     , m_udpPort(0)
     , m_velodyneSharedMemory(NULL)
+    , m_receiveThread(false)
     , m_udpreceiver(NULL)
+    , m_packetReceiver(NULL)
+    , m_replay()
+    , m_poseSource(0)
+    , m_poses()
     , m_velodyne32decoder(NULL) {}
 
 ProxyVelodyne32::~ProxyVelodyne32() {}
@@ -59,7 +67,11 @@ ProxyVelodyne32::~ProxyVelodyne32() {}
 void ProxyVelodyne32::setUp() {
     m_udpReceiverIP = getKeyValueConfiguration().getValue< string >("proxy-velodyne32.udpReceiverIP");
     m_udpPort = getKeyValueConfiguration().getValue< uint32_t >("proxy-velodyne32.udpPort");
-    m_udpreceiver = UDPFactory::createUDPReceiver(m_udpReceiverIP, m_udpPort);
+    const VelodyneSourceOptions source(getKeyValueConfiguration(), "proxy-velodyne32");
+    m_receiveThread = source.receiveThread;
+    if (!m_receiveThread && source.replayFile.empty()) {
+        m_udpreceiver = UDPFactory::createUDPReceiver(m_udpReceiverIP, m_udpPort);
+    }
 
     m_pointCloudOption = getKeyValueConfiguration().getValue< uint16_t >("proxy-velodyne32.pointCloudOption");
     cout << "Point cloud option (0: SPC only; 1: CPC only; 2: both):" << +m_pointCloudOption << endl;
@@ -112,18 +124,78 @@ void ProxyVelodyne32::setUp() {
     else { //m_pointCloudOption == 1
         m_velodyne32decoder = shared_ptr< Velodyne32Decoder >(new Velodyne32Decoder(getConference(), getKeyValueConfiguration().getValue< string >("proxy-velodyne32.calibration"), m_CPCIntensityOption, m_numberOfBitsForIntensity, m_intensityPlacement, m_distanceEncoding));
     }
-    
-    m_udpreceiver->setStringListener(m_velodyne32decoder.get());
-    // Start receiving bytes.
-    m_udpreceiver->start();
+
+    m_poseSource = configureVelodyneDecoder(getKeyValueConfiguration(), "proxy-velodyne32", *m_velodyne32decoder, m_memoryName, m_memorySize, m_poses);
+
+    if (m_receiveThread && source.replayFile.empty()) {
+        m_packetReceiver = shared_ptr< VelodyneUDPReceiver >(new VelodyneUDPReceiver(m_udpReceiverIP, m_udpPort, *m_velodyne32decoder, source.receiveQueueSize));
+        m_packetReceiver->setBatchSize(source.receiveBatchSize);
+        m_packetReceiver->setReceiveBufferSize(source.receiveBufferSize);
+        if (!m_packetReceiver->start()) {
+            cerr << "Receive thread could not be started; decoding in the UDP callback instead." << endl;
+            m_packetReceiver.reset();
+            m_udpreceiver = UDPFactory::createUDPReceiver(m_udpReceiverIP, m_udpPort);
+        }
+    }
+
+    if (!source.replayFile.empty()) {
+        m_replay = shared_ptr< VelodynePcapReplay< Velodyne32Decoder > >(new VelodynePcapReplay< Velodyne32Decoder >(source.replayFile, *m_velodyne32decoder, source.replaySpeed));
+        if (!m_replay->start()) {
+            cerr << "Recording " << source.replayFile << " could not be read; nothing is replayed." << endl;
+            m_replay.reset();
+        }
+    }
+
+    if (m_udpreceiver.get() != NULL) {
+        m_udpreceiver->setStringListener(m_velodyne32decoder.get());
+        // Start receiving bytes.
+        m_udpreceiver->start();
+    }
 }
 
 void ProxyVelodyne32::tearDown() {
-    m_udpreceiver->stop();
-    m_udpreceiver->setStringListener(NULL);
+    if (m_replay.get() != NULL) {
+        m_replay->stop();
+        const VelodyneReplayStatistics statistics = m_replay->getStatistics();
+        const double seconds = static_cast< double >(statistics.replayDuration) / 1000000.0;
+        cout << "Replayed packets: " << statistics.packets << (m_replay->isFinished() ? "" : " (stopped)") << ", frames: " << statistics.frames << " in " << seconds << " s"
+             << ", packets per second: " << (seconds > 0.0 ? static_cast< double >(statistics.packets) / seconds : 0.0)
+             << ", speed: " << (statistics.replayDuration > 0 ? static_cast< double >(statistics.recordedDuration) / static_cast< double >(statistics.replayDuration) : 0.0) << "x real time"
+             << ", decode time per packet: " << (statistics.packets > 0 ? static_cast< double >(statistics.decodeTime) / static_cast< double >(statistics.packets) : 0.0) << " us"
+             << ", frame latency (mean/max): " << (statistics.frames > 0 ? statistics.frameLatencySum / static_cast< int64_t >(statistics.frames) : 0) << "/" << statistics.maxFrameLatency << " us"
+             << ", packets replayed late (> 1 ms): " << statistics.latePackets << endl;
+    }
+    if (m_packetReceiver.get() != NULL) {
+        m_packetReceiver->stop();
+        const VelodyneReceiverStatistics statistics = m_packetReceiver->getStatistics();
+        cout << "Decoded packets: " << statistics.packets << ", dropped (queue full): " << statistics.queueDrops << ", dropped (socket buffer full): " << statistics.kernelDrops << ", queue high-water mark: " << statistics.highWaterMark << "/" << statistics.capacity << ", packets per system call: " << (statistics.batches > 0 ? static_cast< double >(statistics.packets + statistics.queueDrops) / static_cast< double >(statistics.batches) : 0.0) << ", socket receive buffer: " << statistics.receiveBufferSize << endl;
+    }
+    if (m_udpreceiver.get() != NULL) {
+        m_udpreceiver->stop();
+        m_udpreceiver->setStringListener(NULL);
+    }
+    if (m_poses.get() != NULL && m_velodyne32decoder.get() != NULL) {
+        cout << "Motion compensated frames: " << m_velodyne32decoder->getDeskewedFrames() << endl;
+    }
+    if (m_velodyne32decoder.get() != NULL) {
+        const VelodyneDecoderCounters counters = m_velodyne32decoder->getCounters();
+        cout << "Decoder packets: " << counters.packets << ", bad packets: " << counters.badPackets << ", missing packets: " << counters.missingPackets << ", truncated frames: " << counters.truncatedFrames << endl;
+    }
 }
 
-void ProxyVelodyne32::nextContainer(odcore::data::Container &){}
+void ProxyVelodyne32::nextContainer(odcore::data::Container &c) {
+    if (m_poses.get() == NULL) {
+        return;
+    }
+    if (m_poseSource == 1 && c.getDataType() == opendlv::core::sensors::applanix::Grp1Data::ID()) {
+        opendlv::core::sensors::applanix::Grp1Data g1Data = c.getData< opendlv::core::sensors::applanix::Grp1Data >();
+        m_poses->pushGeodetic(c.getSampleTimeStamp().toMicroseconds(), g1Data.getLat(), g1Data.getLon(), g1Data.getAlt(), g1Data.getRoll(), g1Data.getPitch(), g1Data.getHeading());
+    } else if (m_poseSource == 2 && c.getDataType() == opendlv::proxy::AngularVelocityReading::ID()) {
+        opendlv::proxy::AngularVelocityReading reading = c.getData< opendlv::proxy::AngularVelocityReading >();
+        const double angularVelocity[3] = {reading.getAngularVelocityX(), reading.getAngularVelocityY(), reading.getAngularVelocityZ()};
+        m_poses->pushAngularVelocity(c.getSampleTimeStamp().toMicroseconds(), angularVelocity);
+    }
+}
 
 }
 }
@@ -53,7 +53,8 @@ class MyContainerConference : public odcore::io::conference::ContainerConference
     MyContainerConference(std::shared_ptr< odcore::wrapper::SharedMemory > m)
         : ContainerConference()
         , m_counter(0)
-        , m_velodyneMemory(m) {}
+        , m_velodyneMemory(m)
+        , m_frameSize(0) {}
 
     virtual void send(odcore::data::Container &c) const {
         m_counter++;
@@ -66,7 +67,9 @@ class MyContainerConference : public odcore::io::conference::ContainerConference
                     if (vsm->isValid()) {
                         //odcore::base::Lock l(vsm); //No need to lock shared resource as the test suite runs in a single thread. If the lock is enabled, the test suite will not terminate
                         if (velodyneFrame.getComponentDataType() == SharedPointCloud::FLOAT_T && (velodyneFrame.getNumberOfComponentsPerPoint() == 4) && (velodyneFrame.getUserInfo() == SharedPointCloud::XYZ_INTENSITY)) {
+                            TS_ASSERT(velodyneFrame.getSize() == velodyneFrame.getWidth() * 4 * sizeof(float)); //Only the points of the frame are shipped
                             memcpy(m_velodyneMemory->getSharedMemory(), vsm->getSharedMemory(), velodyneFrame.getSize());
+                            m_frameSize = velodyneFrame.getSize();
                             cout << "Copy decoded data in Frame 1 to a memory segment" << endl;
                         }
                     }
@@ -77,6 +80,7 @@ class MyContainerConference : public odcore::io::conference::ContainerConference
 
     mutable uint8_t m_counter;
     mutable std::shared_ptr< odcore::wrapper::SharedMemory > m_velodyneMemory;
+    mutable uint32_t m_frameSize; //Size in bytes of the copied frame
 };
 
 class packetToByte : public odcore::io::conference::ContainerListener {
@@ -88,6 +92,10 @@ class packetToByte : public odcore::io::conference::ContainerListener {
 
     ~packetToByte() {}
 
+    uint32_t getFrameSize() const {
+        return m_mcc.m_frameSize;
+    }
+
     virtual void nextContainer(odcore::data::Container &c) {
         if (c.getDataType() == odcore::data::pcap::Packet::ID()) {
             // Here, we have a valid packet.
@@ -174,7 +182,8 @@ class ProxyVelodyne32Test : public CxxTest::TestSuite {
             
             cout << "Before comparing:" << compare << endl;
             
-            for (uint32_t vCounter = 0; vCounter < m_xDataV.size(); vCounter++) {
+            const uint32_t numberOfPoints = p2b.getFrameSize() / (4 * sizeof(float)); //Only the points of Frame 1 were copied
+            for (uint32_t vCounter = 0; vCounter < m_xDataV.size() && vCounter < numberOfPoints; vCounter++) {
                 if ((abs(velodyneRawData[vCounter*4] - m_xDataV[vCounter]) < 0.1f) && ((abs(velodyneRawData[vCounter*4 + 1] - m_yDataV[vCounter])) < 0.1f) &&
                 ((abs(velodyneRawData[vCounter*4 + 2] - m_zDataV[vCounter])) < 0.1f) && ((abs(velodyneRawData[vCounter*4 + 3] - m_intensityV[vCounter])) < 1.0f)) {
                     compare++;
@@ -53,7 +53,8 @@ class MyContainerConference : public odcore::io::conference::ContainerConference
     MyContainerConference(std::shared_ptr< odcore::wrapper::SharedMemory > m)
         : ContainerConference()
         , m_counter(0)
-        , m_velodyneMemory(m) {}
+        , m_velodyneMemory(m)
+        , m_frameSize(0) {}
 
     virtual void send(odcore::data::Container &c) const {
         m_counter++;
@@ -66,7 +67,9 @@ class MyContainerConference : public odcore::io::conference::ContainerConference
                     if (vsm->isValid()) {
                         //odcore::base::Lock l(vsm); //No need to lock shared resource as the test suite runs in a single thread. If the lock is enabled, the test suite will not terminate
                         if (velodyneFrame.getComponentDataType() == SharedPointCloud::FLOAT_T && (velodyneFrame.getNumberOfComponentsPerPoint() == 4) && (velodyneFrame.getUserInfo() == SharedPointCloud::XYZ_INTENSITY)) {
+                            TS_ASSERT(velodyneFrame.getSize() == velodyneFrame.getWidth() * 4 * sizeof(float)); //Only the points of the frame are shipped
                             memcpy(m_velodyneMemory->getSharedMemory(), vsm->getSharedMemory(), velodyneFrame.getSize());
+                            m_frameSize = velodyneFrame.getSize();
                             cout << "Copy decoded data in Frame 1 to a memory segment" << endl;
                         }
                     }
@@ -77,17 +80,24 @@ class MyContainerConference : public odcore::io::conference::ContainerConference
 
     mutable uint8_t m_counter;
     mutable std::shared_ptr< odcore::wrapper::SharedMemory > m_velodyneMemory;
+    mutable uint32_t m_frameSize; //Size in bytes of the copied frame
 };
 
 class packetToByte : public odcore::io::conference::ContainerListener {
    public:
-    packetToByte(std::shared_ptr< odcore::wrapper::SharedMemory > m1, std::shared_ptr< odcore::wrapper::SharedMemory > m2)
+    packetToByte(std::shared_ptr< odcore::wrapper::SharedMemory > m1, std::shared_ptr< odcore::wrapper::SharedMemory > m2, const bool &fullCalibration)
         : m_mcc(m2)
         , m_velodyne64decoder(m1, m_mcc, "../db.xml") //The calibration file db.xml is automatically copied to the parent folder of the test suite binary
-    {}
+    {
+        m_velodyne64decoder.setFullCalibration(fullCalibration);
+    }
 
     ~packetToByte() {}
 
+    uint32_t getFrameSize() const {
+        return m_mcc.m_frameSize;
+    }
+
     virtual void nextContainer(odcore::data::Container &c) {
         if (c.getDataType() == odcore::data::pcap::Packet::ID()) {
             // Here, we have a valid packet.
@@ -147,10 +157,10 @@ class ProxyVelodyne64Test : public CxxTest::TestSuite {
     }
 
 
-    void testVelodyneDecodingFromFile() {
-        readCsvFile();
+    //Decodes the recording and returns the size in bytes of Frame 1, which is copied to m_segment
+    uint32_t decodeFrame1(const bool &fullCalibration) {
         PCAPProtocol pcap;                     //Use the PCAP decoder of OpenDaVINCI to read the .pcap recording
-        packetToByte p2b(m_velodyneSharedMemory, m_segment); //This class extracts Velodyne payload from pcap packets
+        packetToByte p2b(m_velodyneSharedMemory, m_segment, fullCalibration); //This class extracts Velodyne payload from pcap packets
         pcap.setContainerListener(&p2b);       //Set the packetToByte class as the container listener of the PCAP decoder
 
         fstream lidarStream("../atwallshort.pcap", ios::binary | ios::in); //A sample .pcap file containing several Velodyne frames in the parent folder
@@ -166,12 +176,18 @@ class ProxyVelodyne64Test : public CxxTest::TestSuite {
 
         cout << "File read complete." << endl;
         delete[] buffer;
+        return p2b.getFrameSize();
+    }
+
+    void testVelodyneDecodingFromFile() {
+        readCsvFile();
+        const uint32_t frameSize = decodeFrame1(false); //VeloView 3 exports the points of the basic calibration model
 
         uint32_t compare = 0; //Number of points matched between VeloView and our Velodyne decoder
 
         if (m_segment->isValid()) {
             float *velodyneRawData = static_cast< float * >(m_segment->getSharedMemory()); //the shared memory "m_segment" should already contain Velodyne data of Frame 0 decoded by our Velodyne64 decoder and stored in the send method of the MyContainerConference class
-            uint32_t mSize = m_segment->getSize() / 4;                                     //m_segment->getSize() returns to the memory size. Divide it by 4 because of float *velodyneRawData (4 bytes for float type)
+            uint32_t mSize = frameSize / 4;                                                //frameSize is the size of Frame 1 in bytes. Divide it by 4 because of float *velodyneRawData (4 bytes for float type)
 
             uint32_t mIndex = 0; //This variable searches the list of our decoded Velodyen64 values point by point to find points whose values match points provided by VeloView
             cout << "Before comparing:" << compare << "," << mIndex << endl;
@@ -193,6 +209,33 @@ class ProxyVelodyne64Test : public CxxTest::TestSuite {
         TS_ASSERT(compare == m_xDataV.size()); //All points from VeloView must be included by the data from our Velodyne decoder
     }
 
+    void testFullCalibrationReferencePoints() {
+        //Points of Frame 1 computed in double precision with all corrections of db.xml (vertical offset perpendicular to the beam,
+        //two-point distance correction along x and y); they are 2 to 15 cm away from the points of the basic model.
+        //Laser, raw distance: 34, 619 (2.5 m); 33, 2221; 32, 2310; 37, 2384; 56, 4760; 57, 4882; 24, 50567 (102 m); 27, 27829
+        const float reference[8][4] = {{1.2515f, 2.1706f, -0.3904f, 54.0f},
+                                       {3.3718f, 3.9001f, -2.0082f, 22.0f},
+                                       {3.9038f, 3.8048f, -2.1532f, 28.0f},
+                                       {3.3010f, 4.2850f, -2.0033f, 34.0f},
+                                       {7.7932f, 7.2139f, -1.8329f, 28.0f},
+                                       {7.4455f, 7.6554f, -1.7756f, 20.0f},
+                                       {77.2584f, 66.9300f, 1.7845f, 167.0f},
+                                       {42.6590f, 37.6890f, -0.6508f, 130.0f}};
+        const uint32_t frameSize = decodeFrame1(true);
+        TS_ASSERT(m_segment->isValid());
+        TS_ASSERT(frameSize > 0);
+
+        const float *velodyneRawData = static_cast< float * >(m_segment->getSharedMemory());
+        for (uint32_t r = 0; r < 8; r++) {
+            bool found = false;
+            for (uint32_t mCounter = 0; mCounter < frameSize / 4 && !found; mCounter += 4) {
+                found = (abs(velodyneRawData[mCounter] - reference[r][0]) < 0.001f) && (abs(velodyneRawData[mCounter + 1] - reference[r][1]) < 0.001f) &&
+                        (abs(velodyneRawData[mCounter + 2] - reference[r][2]) < 0.001f) && (abs(velodyneRawData[mCounter + 3] - reference[r][3]) < 0.5f);
+            }
+            TSM_ASSERT(r, found);
+        }
+    }
+
    private:
     const uint32_t m_BUFFER_SIZE = 4000;
     const std::string m_NAME = "testVelodyne64SM"; //The name for the shared memory m_velodyneSharedMemory
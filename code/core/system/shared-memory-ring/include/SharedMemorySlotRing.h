@@ -0,0 +1,295 @@
+/**
+ * SharedMemorySlotRing - Ring of shared memory slots guarded by seqlocks
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef SHAREDMEMORYSLOTRING_H_
+#define SHAREDMEMORYSLOTRING_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "opendavinci/odcore/wrapper/SharedMemory.h"
+#include "opendavinci/odcore/wrapper/SharedMemoryFactory.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * Trailer stored after the data of each slot. The sequence follows the
+ * seqlock protocol: odd while the data is written, 2 * (frame + 1) once
+ * frame number "frame" is published. The payload describes the published
+ * frame and is only valid if the sequence did not change while reading it.
+ */
+template < typename Payload >
+struct SharedMemorySlotTrailer {
+    std::atomic< uint32_t > sequence;
+    Payload payload;
+};
+
+/**
+ * SharedMemorySlotRing provides N shared memory segments named "<name>.<k>"
+ * that a producer writes its frames into in turn. A frame is published by
+ * announcing its slot; the producer never waits for readers. Readers either
+ * copy the data out with read() or process it in place between beginRead()
+ * and endRead(); both tell whether the slot was overwritten meanwhile, and
+ * a gap in the frame numbers means missed frames.
+ *
+ * The data starts at offset 0 of each slot, so readers that only copy the
+ * announced number of bytes from a segment keep working. The trailer is 8
+ * bytes aligned after the data the slots were created for; the constructor
+ * requires segments of exactly getSlotSize() bytes so that readers can
+ * locate the trailer from either that size or the size of the segment.
+ *
+ * Payload must be trivially copyable.
+ */
+template < typename Payload >
+class SharedMemorySlotRing {
+   public:
+    typedef SharedMemorySlotTrailer< Payload > Trailer;
+
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    SharedMemorySlotRing(const SharedMemorySlotRing &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    SharedMemorySlotRing &operator=(const SharedMemorySlotRing &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param name base name of the shared memory segments.
+     * @param numberOfSlots number of slots (at least 2 to never overwrite the latest frame).
+     * @param size size in bytes of the data per slot.
+     */
+    SharedMemorySlotRing(const std::string &name, const uint32_t &numberOfSlots, const uint32_t &size)
+        : m_name(name)
+        , m_size(size)
+        , m_slots()
+        , m_frame(0)
+        , m_valid(true) {
+        for (uint32_t k = 0; k < numberOfSlots; k++) {
+            std::shared_ptr< odcore::wrapper::SharedMemory > slot = odcore::wrapper::SharedMemoryFactory::createSharedMemory(getSlotName(name, k), getSlotSize(size));
+            if (slot.get() == NULL || !slot->isValid() || slot->getSize() != getSlotSize(size)) {
+                m_valid = false; //readers could not locate the trailer in a segment of a different size
+            } else {
+                Trailer *trailer = new (getTrailer(slot->getSharedMemory(), size)) Trailer();
+                trailer->sequence.store(0, std::memory_order_relaxed);
+                memset(&trailer->payload, 0, sizeof(Payload));
+            }
+            m_slots.push_back(slot);
+        }
+        m_valid = m_valid && !m_slots.empty();
+    }
+
+    virtual ~SharedMemorySlotRing() {}
+
+    /**
+     * @param name base name of the shared memory segments.
+     * @param slot slot index.
+     * @return Name of the shared memory segment of the slot.
+     */
+    static std::string getSlotName(const std::string &name, const uint32_t &slot) {
+        std::stringstream sstr;
+        sstr << name << "." << slot;
+        return sstr.str();
+    }
+
+    /**
+     * @param size size in bytes of the data per slot.
+     * @return Size in bytes of a slot including the trailer.
+     */
+    static uint32_t getSlotSize(const uint32_t &size) {
+        return getTrailerOffset(size) + static_cast< uint32_t >(sizeof(Trailer));
+    }
+
+    /**
+     * @param slotSize size in bytes of a slot including the trailer.
+     * @return Size in bytes of the data the slot was created for; 0 if slotSize is not the size of a slot.
+     */
+    static uint32_t getCapacity(const uint32_t &slotSize) {
+        if (slotSize < sizeof(Trailer)) {
+            return 0;
+        }
+        const uint32_t capacity = slotSize - static_cast< uint32_t >(sizeof(Trailer));
+        return (getTrailerOffset(capacity) == capacity) ? capacity : 0;
+    }
+
+    bool isValid() const {
+        return m_valid;
+    }
+
+    uint32_t getNumberOfSlots() const {
+        return static_cast< uint32_t >(m_slots.size());
+    }
+
+    /**
+     * @return Size in bytes of the data per slot.
+     */
+    uint32_t getSize() const {
+        return m_size;
+    }
+
+    /**
+     * @return Number of the frame currently written.
+     */
+    uint32_t getFrame() const {
+        return m_frame;
+    }
+
+    /**
+     * This method marks the slot of the current frame as being written.
+     *
+     * @return Memory for the data of the current frame.
+     */
+    char *beginFrame() {
+        void *memory = m_slots[getSlot()]->getSharedMemory();
+        getTrailer(memory, m_size)->sequence.store(2 * m_frame + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return static_cast< char * >(memory);
+    }
+
+    /**
+     * This method publishes the current frame and advances to the next slot.
+     *
+     * @param payload description of the current frame.
+     * @return Name of the shared memory segment holding the published frame.
+     */
+    std::string publishFrame(const Payload &payload) {
+        const uint32_t slot = getSlot();
+        Trailer *trailer = getTrailer(m_slots[slot]->getSharedMemory(), m_size);
+        trailer->payload = payload;
+        trailer->sequence.store(2 * m_frame + 2, std::memory_order_release);
+        m_frame++;
+        return m_slots[slot]->getName();
+    }
+
+    /**
+     * This method starts reading a published frame in place.
+     *
+     * @param slot memory of the slot as attached by the reader.
+     * @param slotSize size in bytes of the attached shared memory segment.
+     * @param capacity size in bytes of the data the slot was created for.
+     * @param frame number of the frame in the slot; a gap to the previous one means missed frames.
+     * @param payload if not NULL, description of the frame.
+     * @return Sequence to pass to endRead(); 0 if the slot holds no complete frame.
+     */
+    static uint32_t beginRead(const void *slot, const uint32_t &slotSize, const uint32_t &capacity, uint32_t &frame, Payload *payload = NULL) {
+        if (slotSize < getSlotSize(capacity)) {
+            return 0;
+        }
+        const Trailer *trailer = getTrailer(slot, capacity);
+        const uint32_t sequence = trailer->sequence.load(std::memory_order_acquire);
+        if ((sequence == 0) || (sequence % 2 == 1)) {
+            return 0;
+        }
+        frame = sequence / 2 - 1;
+        if (payload != NULL) {
+            memcpy(payload, &trailer->payload, sizeof(Payload));
+        }
+        return sequence;
+    }
+
+    /**
+     * @param slot memory of the slot as attached by the reader.
+     * @param slotSize size in bytes of the attached shared memory segment.
+     * @param capacity size in bytes of the data the slot was created for.
+     * @param sequence result of beginRead().
+     * @return true if the frame was not overwritten since beginRead(); otherwise, whatever was read must be discarded.
+     */
+    static bool endRead(const void *slot, const uint32_t &slotSize, const uint32_t &capacity, const uint32_t &sequence) {
+        if (sequence == 0 || slotSize < getSlotSize(capacity)) {
+            return false;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return getTrailer(slot, capacity)->sequence.load(std::memory_order_relaxed) == sequence;
+    }
+
+    /**
+     * This method copies a published frame out of a slot without blocking
+     * the producer.
+     *
+     * @param slot memory of the slot as attached by the reader.
+     * @param slotSize size in bytes of the attached shared memory segment.
+     * @param capacity size in bytes of the data the slot was created for.
+     * @param destination memory for size bytes.
+     * @param size number of bytes to copy; at most capacity.
+     * @param frame number of the copied frame; a gap to the previous one means missed frames.
+     * @param payload if not NULL, description of the copied frame.
+     * @return true if a complete frame was copied; false if the slot was written meanwhile.
+     */
+    static bool read(const void *slot, const uint32_t &slotSize, const uint32_t &capacity, void *destination, const uint32_t &size, uint32_t &frame, Payload *payload = NULL) {
+        if (size > capacity) {
+            return false;
+        }
+        const uint32_t sequence = beginRead(slot, slotSize, capacity, frame, payload);
+        if (sequence == 0) {
+            return false;
+        }
+        memcpy(destination, slot, size);
+        return endRead(slot, slotSize, capacity, sequence);
+    }
+
+   private:
+    uint32_t getSlot() const {
+        return m_frame % static_cast< uint32_t >(m_slots.size());
+    }
+
+    //The trailer is 8 bytes aligned after the data
+    static uint32_t getTrailerOffset(const uint32_t &size) {
+        return (size + 7) & ~static_cast< uint32_t >(7);
+    }
+
+    static Trailer *getTrailer(void *slot, const uint32_t &size) {
+        return reinterpret_cast< Trailer * >(static_cast< char * >(slot) + getTrailerOffset(size));
+    }
+
+    static const Trailer *getTrailer(const void *slot, const uint32_t &size) {
+        return reinterpret_cast< const Trailer * >(static_cast< const char * >(slot) + getTrailerOffset(size));
+    }
+
+   private:
+    std::string m_name;
+    uint32_t m_size; //size in bytes of the data per slot
+    std::vector< std::shared_ptr< odcore::wrapper::SharedMemory > > m_slots;
+    uint32_t m_frame; //number of the frame currently written
+    bool m_valid;
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*SHAREDMEMORYSLOTRING_H_*/
@@ -0,0 +1,131 @@
+/**
+ * VelodyneCPCCodecBenchmark - Ratio and throughput of the compact point cloud compression
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <stdint.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "VelodyneCPCCodec.h"
+#include "VelodyneDecoderCore.h"
+#include "VelodynePcapReader.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+namespace {
+
+// Keeps a copy of the compact point clouds (with or without intensity) of every completed frame.
+template < typename Model >
+class CPCCopier : public VelodyneFrameListener {
+   private:
+    CPCCopier(const CPCCopier &);
+    CPCCopier &operator=(const CPCCopier &);
+
+   public:
+    CPCCopier()
+        : m_core(NULL)
+        , m_withIntensity(false)
+        , m_parts() {}
+
+    virtual void nextFrame() {
+        for (uint8_t part = 0; part < Model::NUMBER_OF_CPC_PARTS; part++) {
+            m_parts.push_back(make_pair(m_core->getCompactPointCloud(part, m_withIntensity), m_core->getEntriesPerAzimuth(part)));
+        }
+    }
+
+    const VelodyneDecoderCore< Model > *m_core;
+    bool m_withIntensity;
+    vector< pair< string, uint8_t > > m_parts;
+};
+
+// Compresses (as the decoder) and restores (as a player) all parts repeatedly.
+template < typename Model >
+void run(const string &name, const vector< string > &packets, const string &calibration, const bool &withIntensity, const uint32_t &repetitions) {
+    CPCCopier< Model > copier;
+    copier.m_withIntensity = withIntensity;
+    VelodyneDecoderOptions options = {false, 0, true, static_cast< uint8_t >(withIntensity ? 1 : 0), 3, 0, 1};
+    VelodyneDecoderCore< Model > core(calibration, options, copier);
+    copier.m_core = &core;
+    for (auto &packet : packets) {
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+    }
+    if (copier.m_parts.empty()) {
+        cerr << name << ": no complete frame" << endl;
+        return;
+    }
+
+    string compressed;
+    string restored;
+    uint64_t uncompressedBytes = 0;
+    uint64_t compressedBytes = 0;
+    uint32_t mismatches = 0;
+    double compressSeconds = 0.0;
+    double decompressSeconds = 0.0;
+    for (uint32_t r = 0; r < repetitions; r++) {
+        for (auto &part : copier.m_parts) {
+            const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            VelodyneCPCCodec::compress(part.first, part.second, compressed);
+            const chrono::steady_clock::time_point packed = chrono::steady_clock::now();
+            mismatches += !VelodyneCPCCodec::decompress(compressed, part.second, restored);
+            const chrono::steady_clock::time_point unpacked = chrono::steady_clock::now();
+            compressSeconds += chrono::duration< double >(packed - start).count();
+            decompressSeconds += chrono::duration< double >(unpacked - packed).count();
+            mismatches += (restored != part.first);
+            uncompressedBytes += part.first.size();
+            compressedBytes += compressed.size();
+        }
+    }
+
+    const double frames = static_cast< double >(copier.m_parts.size()) / Model::NUMBER_OF_CPC_PARTS * repetitions;
+    const double megabytes = static_cast< double >(uncompressedBytes) / 1e6;
+    cout << name << (withIntensity ? " (with intensity): " : " (without intensity): ")
+         << static_cast< double >(uncompressedBytes) / frames / 1024.0 << " KiB per frame compressed to "
+         << static_cast< double >(compressedBytes) / static_cast< double >(uncompressedBytes) << ", "
+         << "compressing " << (megabytes / compressSeconds) << " MB/s (" << (compressSeconds / frames * 1e6) << " us per frame), "
+         << "decompressing " << (megabytes / decompressSeconds) << " MB/s"
+         << ((mismatches > 0) ? ", MISMATCHES" : "") << endl;
+}
+
+template < typename Model >
+void run(const string &name, const string &recording, const string &calibration, const uint32_t &repetitions) {
+    const vector< string > packets = VelodynePcapReader::readDataPackets(recording);
+    if (packets.empty()) {
+        cerr << name << ": no packets found in " << recording << endl;
+        return;
+    }
+    run< Model >(name, packets, calibration, false, repetitions);
+    run< Model >(name, packets, calibration, true, repetitions);
+}
+}
+
+int32_t main(int32_t argc, char **argv) {
+    // Usage: VelodyneCPCCodecBenchmark [folder with recordings] [repetitions]
+    const string folder = (argc > 1) ? string(argv[1]) : string("..");
+    const uint32_t repetitions = (argc > 2) ? static_cast< uint32_t >(atoi(argv[2])) : 100;
+
+    run< VLP16 >("VLP-16", folder + "/sampleShort.pcap", folder + "/VLP-16.xml", repetitions);
+    run< HDL32E >("HDL-32E", folder + "/sampleShort_velodyne32.pcap", folder + "/HDL-32E.xml", repetitions);
+    run< HDL64E >("HDL-64E", folder + "/atwallshort.pcap", folder + "/db.xml", repetitions);
+    return 0;
+}
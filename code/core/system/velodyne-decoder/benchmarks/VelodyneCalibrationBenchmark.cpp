@@ -0,0 +1,77 @@
+/**
+ * VelodyneCalibrationBenchmark - Time to load a calibration file with and without cache
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <stdint.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "VelodyneCalibrationFile.h"
+#include "VelodyneDecoderCore.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+namespace {
+
+// Returns the average time in microseconds of loading the file through the
+// cache in the given directory (empty to parse the XML file every time).
+double timeLoad(const string &fileName, const string &cacheDirectory, const uint32_t &repetitions) {
+    VelodyneCalibrationFile::setCacheDirectory(cacheDirectory);
+    vector< VelodyneLaserCalibration > lasers;
+    string error;
+    bool fromCache = false;
+    if (!VelodyneCalibrationFile::load(fileName, lasers, error, &fromCache)) {
+        cerr << error << endl;
+        return 0.0;
+    }
+
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (uint32_t r = 0; r < repetitions; r++) {
+        VelodyneCalibrationFile::load(fileName, lasers, error, &fromCache);
+    }
+    const chrono::steady_clock::time_point end = chrono::steady_clock::now();
+    if (!cacheDirectory.empty() && !fromCache) {
+        cerr << fileName << ": cache in " << cacheDirectory << " not used" << endl;
+    }
+    return chrono::duration< double >(end - start).count() / repetitions * 1e6;
+}
+
+void run(const string &name, const string &fileName, const string &cacheDirectory, const uint32_t &repetitions) {
+    const double parseMicroseconds = timeLoad(fileName, "", repetitions);
+    const double cacheMicroseconds = timeLoad(fileName, cacheDirectory, repetitions);
+    cout << name << ": parsing " << parseMicroseconds << " us, from cache " << cacheMicroseconds << " us" << endl;
+}
+}
+
+int32_t main(int32_t argc, char **argv) {
+    // Usage: VelodyneCalibrationBenchmark [folder with calibration files] [repetitions] [cache folder]
+    const string folder = (argc > 1) ? string(argv[1]) : string("..");
+    const uint32_t repetitions = (argc > 2) ? static_cast< uint32_t >(atoi(argv[2])) : 1000;
+    const string cacheDirectory = (argc > 3) ? string(argv[3]) : string(".");
+
+    run("VLP-16", folder + "/VLP-16.xml", cacheDirectory, repetitions);
+    run("HDL-32E", folder + "/HDL-32E.xml", cacheDirectory, repetitions);
+    run("HDL-64E", folder + "/db.xml", cacheDirectory, repetitions);
+    return 0;
+}
@@ -0,0 +1,113 @@
+/**
+ * VelodyneDecoderBenchmark - Replays recordings through the decoder core
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <stdint.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "VelodyneDecoderCore.h"
+#include "VelodynePcapReader.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+namespace {
+
+// Counts the completed frames and touches the first point to keep the work observable.
+template < typename Model >
+class FrameCounter : public VelodyneFrameListener {
+   private:
+    FrameCounter(const FrameCounter &);
+    FrameCounter &operator=(const FrameCounter &);
+
+   public:
+    FrameCounter()
+        : m_core(NULL)
+        , m_frames(0)
+        , m_points(0)
+        , m_checksum(0.0f) {}
+
+    virtual void nextFrame() {
+        m_frames++;
+        m_points += m_core->getNumberOfPoints();
+        if (m_core->getSegment() != NULL && m_core->getNumberOfPoints() > 0) {
+            m_checksum += m_core->getSegment()[0];
+        }
+    }
+
+    const VelodyneDecoderCore< Model > *m_core;
+    uint64_t m_frames;
+    uint64_t m_points;
+    float m_checksum;
+};
+
+template < typename Model >
+void run(const string &name, const vector< string > &packets, const string &calibration, const bool &lookupTables, const VelodyneProjection::Kernel &kernel, const uint32_t &repetitions) {
+    FrameCounter< Model > counter;
+    VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+    VelodyneDecoderCore< Model > core(calibration, options, counter);
+    core.setLookupTables(lookupTables);
+    core.setProjectionKernel(kernel);
+    counter.m_core = &core;
+
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (uint32_t r = 0; r < repetitions; r++) {
+        for (auto &packet : packets) {
+            core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+        }
+    }
+    const chrono::steady_clock::time_point end = chrono::steady_clock::now();
+
+    const double seconds = chrono::duration< double >(end - start).count();
+    const double numberOfPackets = static_cast< double >(packets.size()) * repetitions;
+    cout << name << (lookupTables ? " (lookup tables, " : " (sin/cos per point, ") << VelodyneProjection::getName(kernel) << "): "
+         << numberOfPackets << " packets in " << seconds << " s, "
+         << (numberOfPackets / seconds) << " packets/s, "
+         << (static_cast< double >(counter.m_points) / seconds) << " points/s, "
+         << counter.m_frames << " frames (checksum " << counter.m_checksum << ")" << endl;
+}
+
+template < typename Model >
+void run(const string &name, const string &recording, const string &calibration, const uint32_t &repetitions) {
+    const vector< string > packets = VelodynePcapReader::readDataPackets(recording);
+    if (packets.empty()) {
+        cerr << name << ": no packets found in " << recording << endl;
+        return;
+    }
+    run< Model >(name, packets, calibration, false, VelodyneProjection::SCALAR, repetitions);
+    for (uint32_t k = VelodyneProjection::SCALAR; k <= VelodyneProjection::best(); k++) {
+        run< Model >(name, packets, calibration, true, static_cast< VelodyneProjection::Kernel >(k), repetitions);
+    }
+}
+}
+
+int32_t main(int32_t argc, char **argv) {
+    // Usage: VelodyneDecoderBenchmark [folder with recordings] [repetitions]
+    const string folder = (argc > 1) ? string(argv[1]) : string("..");
+    const uint32_t repetitions = (argc > 2) ? static_cast< uint32_t >(atoi(argv[2])) : 200;
+
+    run< VLP16 >("VLP-16", folder + "/sampleShort.pcap", folder + "/VLP-16.xml", repetitions);
+    run< HDL32E >("HDL-32E", folder + "/sampleShort_velodyne32.pcap", folder + "/HDL-32E.xml", repetitions);
+    run< HDL64E >("HDL-64E", folder + "/atwallshort.pcap", folder + "/db.xml", repetitions);
+    return 0;
+}
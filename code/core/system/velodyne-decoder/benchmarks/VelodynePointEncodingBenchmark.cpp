@@ -0,0 +1,133 @@
+/**
+ * VelodynePointEncodingBenchmark - Throughput of the shared point cloud encodings
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <stdint.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "VelodyneDecoderCore.h"
+#include "VelodynePcapReader.h"
+#include "VelodynePointEncoding.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+namespace {
+
+// Keeps a copy of the points of every completed frame.
+template < typename Model >
+class FrameCopier : public VelodyneFrameListener {
+   private:
+    FrameCopier(const FrameCopier &);
+    FrameCopier &operator=(const FrameCopier &);
+
+   public:
+    FrameCopier()
+        : m_core(NULL)
+        , m_frames() {}
+
+    virtual void nextFrame() {
+        const float *points = m_core->getSegment();
+        m_frames.push_back(vector< float >(points, points + m_core->getNumberOfPoints() * VelodynePointEncoding::NUMBER_OF_COMPONENTS_PER_POINT));
+    }
+
+    const VelodyneDecoderCore< Model > *m_core;
+    vector< vector< float > > m_frames;
+};
+
+// Encodes (as the publisher) and decodes (as a receiver) all frames repeatedly.
+void run(const string &name, const vector< vector< float > > &frames, const VelodynePointEncoding::Encoding &encoding, const bool &useF16C, const uint32_t &repetitions) {
+    uint32_t maximum = 0;
+    uint64_t points = 0;
+    for (auto &frame : frames) {
+        const uint32_t numberOfPoints = static_cast< uint32_t >(frame.size() / VelodynePointEncoding::NUMBER_OF_COMPONENTS_PER_POINT);
+        maximum = (numberOfPoints > maximum) ? numberOfPoints : maximum;
+        points += numberOfPoints;
+    }
+    vector< char > shared(maximum * VelodynePointEncoding::getBytesPerPoint(encoding));
+    vector< float > received(maximum * VelodynePointEncoding::NUMBER_OF_COMPONENTS_PER_POINT);
+
+    double encodeSeconds = 0.0;
+    double decodeSeconds = 0.0;
+    float checksum = 0.0f;
+    for (uint32_t r = 0; r < repetitions; r++) {
+        for (auto &frame : frames) {
+            const uint32_t numberOfPoints = static_cast< uint32_t >(frame.size() / VelodynePointEncoding::NUMBER_OF_COMPONENTS_PER_POINT);
+            const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            VelodynePointEncoding::encode(encoding, frame.data(), numberOfPoints, shared.data(), useF16C);
+            const chrono::steady_clock::time_point encoded = chrono::steady_clock::now();
+            VelodynePointEncoding::decode(encoding, shared.data(), numberOfPoints, received.data(), useF16C);
+            const chrono::steady_clock::time_point decoded = chrono::steady_clock::now();
+            encodeSeconds += chrono::duration< double >(encoded - start).count();
+            decodeSeconds += chrono::duration< double >(decoded - encoded).count();
+            checksum += (numberOfPoints > 0) ? received[0] : 0.0f;
+        }
+    }
+
+    const double totalPoints = static_cast< double >(points) * repetitions;
+    const double bytesPerFrame = static_cast< double >(points) * VelodynePointEncoding::getBytesPerPoint(encoding) / static_cast< double >(frames.size());
+    const string names[] = {"float32", "int16", "float16"};
+    cout << name << " (" << names[encoding] << ((encoding == VelodynePointEncoding::FLOAT16) ? (useF16C ? ", F16C" : ", scalar") : "") << "): "
+         << bytesPerFrame / 1024.0 << " KiB per frame, "
+         << "encoding " << (totalPoints / encodeSeconds) << " points/s (" << (totalPoints * 16.0 / encodeSeconds / 1e9) << " GB/s of floats), "
+         << "decoding " << (totalPoints / decodeSeconds) << " points/s (checksum " << checksum << ")" << endl;
+}
+
+template < typename Model >
+void run(const string &name, const string &recording, const string &calibration, const uint32_t &repetitions) {
+    const vector< string > packets = VelodynePcapReader::readDataPackets(recording);
+    if (packets.empty()) {
+        cerr << name << ": no packets found in " << recording << endl;
+        return;
+    }
+    FrameCopier< Model > copier;
+    VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+    VelodyneDecoderCore< Model > core(calibration, options, copier);
+    copier.m_core = &core;
+    for (auto &packet : packets) {
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+    }
+    if (copier.m_frames.empty()) {
+        cerr << name << ": no complete frame in " << recording << endl;
+        return;
+    }
+
+    run(name, copier.m_frames, VelodynePointEncoding::FLOAT32, false, repetitions);
+    run(name, copier.m_frames, VelodynePointEncoding::INT16, false, repetitions);
+    run(name, copier.m_frames, VelodynePointEncoding::FLOAT16, false, repetitions);
+    if (VelodynePointEncoding::hasF16C()) {
+        run(name, copier.m_frames, VelodynePointEncoding::FLOAT16, true, repetitions);
+    }
+}
+}
+
+int32_t main(int32_t argc, char **argv) {
+    // Usage: VelodynePointEncodingBenchmark [folder with recordings] [repetitions]
+    const string folder = (argc > 1) ? string(argv[1]) : string("..");
+    const uint32_t repetitions = (argc > 2) ? static_cast< uint32_t >(atoi(argv[2])) : 100;
+
+    run< VLP16 >("VLP-16", folder + "/sampleShort.pcap", folder + "/VLP-16.xml", repetitions);
+    run< HDL32E >("HDL-32E", folder + "/sampleShort_velodyne32.pcap", folder + "/HDL-32E.xml", repetitions);
+    run< HDL64E >("HDL-64E", folder + "/atwallshort.pcap", folder + "/db.xml", repetitions);
+    return 0;
+}
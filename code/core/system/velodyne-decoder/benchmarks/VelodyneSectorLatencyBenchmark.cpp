@@ -0,0 +1,133 @@
+/**
+ * VelodyneSectorLatencyBenchmark - Time from the first packet to the first published frame
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <stdint.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "VelodyneDecoderCore.h"
+#include "VelodynePcapReader.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+namespace {
+
+// Remembers when the first frame (or sector) was completed and counts all of them.
+class PublicationClock : public VelodyneFrameListener {
+   public:
+    PublicationClock()
+        : m_frames(0)
+        , m_first() {}
+
+    virtual void nextFrame() {
+        if (m_frames == 0) {
+            m_first = chrono::steady_clock::now();
+        }
+        m_frames++;
+    }
+
+    uint64_t m_frames;
+    chrono::steady_clock::time_point m_first;
+};
+
+// Replays the packets from start at the rate of the sensor until the first frame is completed.
+template < typename Model >
+bool replayUntilFirstFrame(const vector< string > &packets, const uint32_t &start, const string &calibration, const float &sectorSize, double &milliseconds) {
+    PublicationClock clock;
+    VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+    VelodyneDecoderCore< Model > core(calibration, options, clock);
+    core.setSectorSize(sectorSize);
+
+    const chrono::nanoseconds packetDuration(static_cast< int64_t >(static_cast< double >(Model::FIRINGS_PER_PACKET) * static_cast< double >(Model::FIRING_DURATION) * 1000.0));
+    const chrono::steady_clock::time_point first = chrono::steady_clock::now();
+    for (uint32_t i = start; i < packets.size() && clock.m_frames == 0; i++) {
+        const chrono::steady_clock::time_point arrival = first + packetDuration * (i - start);
+        while (chrono::steady_clock::now() < arrival) {
+        }
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packets[i].data()), static_cast< uint32_t >(packets[i].size()));
+    }
+    milliseconds = chrono::duration< double, milli >(clock.m_first - first).count();
+    return (clock.m_frames > 0);
+}
+
+template < typename Model >
+void run(const string &name, const vector< string > &packets, const string &calibration, const float &sectorSize, const uint32_t &starts, const uint32_t &repetitions) {
+    // Latency: the replay starts at different azimuths spread over the first half of the recording.
+    double sum = 0.0;
+    double maximum = 0.0;
+    uint32_t published = 0;
+    for (uint32_t s = 0; s < starts; s++) {
+        double milliseconds = 0.0;
+        if (replayUntilFirstFrame< Model >(packets, static_cast< uint32_t >(s * packets.size() / (2 * starts)), calibration, sectorSize, milliseconds)) {
+            sum += milliseconds;
+            maximum = (milliseconds > maximum) ? milliseconds : maximum;
+            published++;
+        }
+    }
+
+    // Throughput: the cost of completing more, smaller frames.
+    PublicationClock clock;
+    VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+    VelodyneDecoderCore< Model > core(calibration, options, clock);
+    core.setSectorSize(sectorSize);
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (uint32_t r = 0; r < repetitions; r++) {
+        for (auto &packet : packets) {
+            core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+        }
+    }
+    const double seconds = chrono::duration< double >(chrono::steady_clock::now() - start).count();
+
+    cout << name << " (" << ((sectorSize > 0.0f) ? to_string(static_cast< uint32_t >(sectorSize)) + " degree sectors" : string("complete rotations")) << "): "
+         << "first packet to first frame " << ((published > 0) ? sum / published : 0.0) << " ms on average, " << maximum << " ms at most ("
+         << published << "/" << starts << " replays published); "
+         << (static_cast< double >(packets.size()) * repetitions / seconds) << " packets/s decoding "
+         << clock.m_frames << " frames" << endl;
+}
+
+template < typename Model >
+void run(const string &name, const string &recording, const string &calibration, const uint32_t &starts, const uint32_t &repetitions) {
+    const vector< string > packets = VelodynePcapReader::readDataPackets(recording);
+    if (packets.empty()) {
+        cerr << name << ": no packets found in " << recording << endl;
+        return;
+    }
+    const float sectorSizes[] = {0.0f, 90.0f, 45.0f, 10.0f};
+    for (const float sectorSize : sectorSizes) {
+        run< Model >(name, packets, calibration, sectorSize, starts, repetitions);
+    }
+}
+}
+
+int32_t main(int32_t argc, char **argv) {
+    // Usage: VelodyneSectorLatencyBenchmark [folder with recordings] [start positions] [repetitions]
+    const string folder = (argc > 1) ? string(argv[1]) : string("..");
+    const uint32_t starts = (argc > 2) ? static_cast< uint32_t >(atoi(argv[2])) : 10;
+    const uint32_t repetitions = (argc > 3) ? static_cast< uint32_t >(atoi(argv[3])) : 100;
+
+    run< VLP16 >("VLP-16", folder + "/sampleShort.pcap", folder + "/VLP-16.xml", starts, repetitions);
+    run< HDL32E >("HDL-32E", folder + "/sampleShort_velodyne32.pcap", folder + "/HDL-32E.xml", starts, repetitions);
+    run< HDL64E >("HDL-64E", folder + "/atwallshort.pcap", folder + "/db.xml", starts, repetitions);
+    return 0;
+}
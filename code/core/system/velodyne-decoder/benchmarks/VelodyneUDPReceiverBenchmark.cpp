@@ -0,0 +1,201 @@
+/**
+ * VelodyneUDPReceiverBenchmark - Streams recordings through the UDP receiver
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <stdint.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "opendavinci/odcore/data/TimeStamp.h"
+
+#include "VelodynePcapReader.h"
+#include "VelodyneUDPReceiver.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+#ifdef __linux__
+namespace {
+
+// Counts the packets and remembers when the last one was handed over.
+class PacketCounter : public VelodynePacketListener {
+   public:
+    PacketCounter()
+        : m_packets(0)
+        , m_bytes(0)
+        , m_last(chrono::steady_clock::now()) {}
+
+    virtual void nextPacket(const uint8_t *, const uint32_t &length, const odcore::data::TimeStamp &) {
+        m_packets++;
+        m_bytes += length;
+        m_last = chrono::steady_clock::now();
+    }
+
+    uint64_t m_packets;
+    uint64_t m_bytes;
+    chrono::steady_clock::time_point m_last;
+};
+
+int32_t openSender(const uint32_t &port, struct sockaddr_in &address) {
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast< uint16_t >(port));
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    return socket(AF_INET, SOCK_DGRAM, 0);
+}
+
+// Sends the packets of the recording in batches of 64 until total packets are sent.
+void send(const vector< string > &packets, const uint32_t &port, const uint64_t &total) {
+    struct sockaddr_in address;
+    const int32_t s = openSender(port, address);
+    vector< struct mmsghdr > messages(64);
+    vector< struct iovec > iovecs(64);
+    uint64_t sent = 0;
+    while (sent < total) {
+        const uint32_t count = (total - sent < 64) ? static_cast< uint32_t >(total - sent) : 64;
+        for (uint32_t i = 0; i < count; i++) {
+            const string &packet = packets[(sent + i) % packets.size()];
+            iovecs[i].iov_base = const_cast< char * >(packet.data());
+            iovecs[i].iov_len = packet.size();
+            memset(&messages[i], 0, sizeof(struct mmsghdr));
+            messages[i].msg_hdr.msg_name = &address;
+            messages[i].msg_hdr.msg_namelen = sizeof(address);
+            messages[i].msg_hdr.msg_iov = &iovecs[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+        const int32_t n = sendmmsg(s, &messages[0], count, 0);
+        if (n > 0) {
+            sent += static_cast< uint64_t >(n);
+        }
+    }
+    close(s);
+}
+
+void report(const string &name, const uint64_t &total, const uint64_t &received, const uint64_t &bytes, const double &seconds) {
+    cout << name << ": " << received << "/" << total << " packets (" << bytes << " bytes) in " << seconds << " s, "
+         << (static_cast< double >(received) / seconds) << " packets/s, "
+         << (100.0 * static_cast< double >(total - received) / static_cast< double >(total)) << " % lost" << endl;
+}
+
+// Reference: one datagram per system call into a new string, as odcore::io::udp::UDPReceiver does.
+void runStringPerPacket(const vector< string > &packets, const uint32_t &receiveBufferSize, const uint64_t &total) {
+    const int32_t s = socket(AF_INET, SOCK_DGRAM, 0);
+    const int32_t size = static_cast< int32_t >(receiveBufferSize);
+    if (setsockopt(s, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) < 0) {
+        setsockopt(s, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+    struct timeval timeout;
+    timeout.tv_sec = 0;
+    timeout.tv_usec = 100000;
+    setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    bind(s, reinterpret_cast< struct sockaddr * >(&address), sizeof(address));
+    socklen_t length = sizeof(address);
+    getsockname(s, reinterpret_cast< struct sockaddr * >(&address), &length);
+
+    uint64_t received = 0;
+    uint64_t bytes = 0;
+    chrono::steady_clock::time_point last = chrono::steady_clock::now();
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    thread sender(send, std::cref(packets), static_cast< uint32_t >(ntohs(address.sin_port)), total);
+    char buffer[VelodynePacketQueue::MAX_PACKET_SIZE];
+    while (received < total) {
+        const ssize_t n = recv(s, buffer, sizeof(buffer), 0);
+        if (n <= 0) {
+            break; //nothing for 100 ms: the remaining packets are lost
+        }
+        const string packet(buffer, static_cast< size_t >(n));
+        bytes += packet.size();
+        received++;
+        last = chrono::steady_clock::now();
+    }
+    sender.join();
+    close(s);
+    report("recv per packet", total, received, bytes, chrono::duration< double >(last - start).count());
+}
+
+void runBatched(const vector< string > &packets, const uint32_t &batchSize, const uint32_t &receiveBufferSize, const uint64_t &total) {
+    PacketCounter counter;
+    VelodyneUDPReceiver receiver("127.0.0.1", 0, counter, 4096);
+    receiver.setBatchSize(batchSize);
+    receiver.setReceiveBufferSize(receiveBufferSize);
+    if (!receiver.start()) {
+        return;
+    }
+
+    const chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    thread sender(send, std::cref(packets), receiver.getPort(), total);
+    sender.join();
+    //Wait until the decode thread caught up or nothing arrives anymore
+    uint64_t previous = 0;
+    for (uint32_t i = 0; i < 100; i++) {
+        this_thread::sleep_for(chrono::milliseconds(20));
+        const VelodyneReceiverStatistics statistics = receiver.getStatistics();
+        if ((statistics.packets >= total) || (i > 0 && statistics.packets == previous)) {
+            break;
+        }
+        previous = statistics.packets;
+    }
+    receiver.stop();
+
+    const VelodyneReceiverStatistics statistics = receiver.getStatistics();
+    report("recvmmsg batch " + to_string(batchSize), total, statistics.packets, counter.m_bytes, chrono::duration< double >(counter.m_last - start).count());
+    cout << "  packets per system call: " << (static_cast< double >(statistics.packets + statistics.queueDrops) / static_cast< double >(statistics.batches))
+         << ", dropped (queue full): " << statistics.queueDrops
+         << ", dropped (socket buffer full): " << statistics.kernelDrops
+         << ", queue high-water mark: " << statistics.highWaterMark << "/" << statistics.capacity
+         << ", socket receive buffer: " << statistics.receiveBufferSize << endl;
+}
+}
+#endif
+
+int32_t main(int32_t argc, char **argv) {
+    // Usage: VelodyneUDPReceiverBenchmark [folder with recordings] [packets] [socket receive buffer in bytes]
+    const string folder = (argc > 1) ? string(argv[1]) : string("..");
+    const uint64_t total = (argc > 2) ? static_cast< uint64_t >(atol(argv[2])) : 500000;
+    const uint32_t receiveBufferSize = (argc > 3) ? static_cast< uint32_t >(atol(argv[3])) : (8 << 20);
+
+#ifdef __linux__
+    vector< string > packets = VelodynePcapReader::readDataPackets(folder + "/atwallshort.pcap");
+    const vector< string > vlp16 = VelodynePcapReader::readDataPackets(folder + "/sampleShort.pcap");
+    const vector< string > hdl32 = VelodynePcapReader::readDataPackets(folder + "/sampleShort_velodyne32.pcap");
+    packets.insert(packets.end(), vlp16.begin(), vlp16.end());
+    packets.insert(packets.end(), hdl32.begin(), hdl32.end());
+    if (packets.empty()) {
+        cerr << "No packets found in " << folder << endl;
+        return 1;
+    }
+
+    runStringPerPacket(packets, receiveBufferSize, total);
+    const uint32_t batchSizes[] = {1, 8, 32, 128};
+    for (const uint32_t batchSize : batchSizes) {
+        runBatched(packets, batchSize, receiveBufferSize, total);
+    }
+#else
+    cerr << "VelodyneUDPReceiverBenchmark needs Linux (" << folder << ", " << total << ", " << receiveBufferSize << ")." << endl;
+#endif
+    return 0;
+}
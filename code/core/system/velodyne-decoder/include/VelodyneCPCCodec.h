@@ -0,0 +1,331 @@
+/**
+ * VelodyneCPCCodec - Lossless compression of compact point clouds
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNECPCCODEC_H_
+#define VELODYNECPCCODEC_H_
+
+#include <stdint.h>
+
+#include <cstring>
+#include <string>
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * VelodyneCPCCodec compresses the distances of a compact point cloud (big
+ * endian uint16, entriesPerAzimuth per azimuth) without loss. Each entry is
+ * predicted by the entry of the same laser at the previous azimuth; the
+ * differences are zigzag mapped and Rice coded with one parameter per block
+ * of BLOCK_SIZE entries, the one giving the fewest bits. Entries that
+ * would need ESCAPE or more unary bits are stored with 16 bits instead.
+ *
+ * Compressed format: one byte with the method, then for DELTA_RICE the
+ * number of entries (uint32, little endian) followed by the bit stream
+ * (least significant bit first): per block 4 bits for the Rice parameter k,
+ * then per entry the quotient in unary (ones terminated by a zero) and the
+ * k lower bits, or ESCAPE ones and the 16 bits of the difference.
+ *
+ * The coder tries 16 parameters per block and writes each entry once, a
+ * bounded cost per entry, so the time per frame is linear in the number of
+ * points; if the result would not be smaller, the distances are STORED as
+ * they are.
+ */
+class VelodyneCPCCodec {
+   public:
+    enum Method {
+        STORED = 0,
+        DELTA_RICE = 1,
+    };
+
+    static constexpr uint32_t BLOCK_SIZE = 64; //entries per Rice parameter
+    static constexpr uint32_t ESCAPE = 16; //unary length of an escaped entry
+    static constexpr uint32_t HEADER_SIZE = 5; //method and number of entries
+
+    /**
+     * This method compresses the distances of a compact point cloud.
+     *
+     * @param distances big endian uint16 entries.
+     * @param entriesPerAzimuth entries per azimuth.
+     * @param compressed output; its capacity is kept for the next frame.
+     */
+    static void compress(const std::string &distances, const uint8_t &entriesPerAzimuth, std::string &compressed) {
+        const uint32_t count = static_cast< uint32_t >(distances.size() / 2);
+        const uint8_t *in = reinterpret_cast< const uint8_t * >(distances.data());
+        //Worst case: every entry escaped plus the Rice parameters
+        compressed.resize(HEADER_SIZE + count * 4 + (count / BLOCK_SIZE + 1) + 8);
+        uint8_t *out = reinterpret_cast< uint8_t * >(&compressed[0]);
+        out[0] = DELTA_RICE;
+        out[1] = static_cast< uint8_t >(count & 0xFF);
+        out[2] = static_cast< uint8_t >((count >> 8) & 0xFF);
+        out[3] = static_cast< uint8_t >((count >> 16) & 0xFF);
+        out[4] = static_cast< uint8_t >(count >> 24);
+
+        BitWriter writer(out + HEADER_SIZE);
+        uint16_t residuals[BLOCK_SIZE];
+        const uint32_t stride = (entriesPerAzimuth > 0) ? entriesPerAzimuth : 1;
+        for (uint32_t start = 0; start < count; start += BLOCK_SIZE) {
+            const uint32_t length = (count - start < BLOCK_SIZE) ? count - start : BLOCK_SIZE;
+            for (uint32_t i = 0; i < length; i++) {
+                const uint32_t index = start + i;
+                const uint16_t previous = (index >= stride) ? readBigEndian(in + 2 * (index - stride)) : 0;
+                residuals[i] = zigzag(static_cast< uint16_t >(readBigEndian(in + 2 * index) - previous));
+            }
+            const uint32_t k = getRiceParameter(residuals, length);
+            writer.put(k, 4);
+            for (uint32_t i = 0; i < length; i++) {
+                const uint32_t quotient = static_cast< uint32_t >(residuals[i]) >> k;
+                if (quotient < ESCAPE) {
+                    //Unary quotient and remainder take at most 32 bits
+                    writer.put(((1u << quotient) - 1) | ((residuals[i] & ((1u << k) - 1)) << (quotient + 1)), quotient + 1 + k);
+                } else {
+                    writer.put(((1u << ESCAPE) - 1) | (static_cast< uint32_t >(residuals[i]) << ESCAPE), ESCAPE + 16);
+                }
+            }
+        }
+        const uint32_t size = HEADER_SIZE + writer.finish();
+
+        if (size >= distances.size() + 1) {
+            compressed.resize(distances.size() + 1);
+            compressed[0] = static_cast< char >(STORED);
+            if (!distances.empty()) {
+                memcpy(&compressed[1], distances.data(), distances.size());
+            }
+        } else {
+            compressed.resize(size);
+        }
+    }
+
+    /**
+     * This method restores the distances of a compact point cloud.
+     *
+     * @param compressed output of compress().
+     * @param entriesPerAzimuth entries per azimuth as passed to compress().
+     * @param distances big endian uint16 entries; its capacity is kept for the next frame.
+     * @return false if the compressed data is truncated or malformed.
+     */
+    static bool decompress(const std::string &compressed, const uint8_t &entriesPerAzimuth, std::string &distances) {
+        if (compressed.empty()) {
+            distances.clear();
+            return false;
+        }
+        const uint8_t *in = reinterpret_cast< const uint8_t * >(compressed.data());
+        if (in[0] == STORED) {
+            distances.assign(compressed, 1, std::string::npos);
+            return true;
+        }
+        if (in[0] != DELTA_RICE || compressed.size() < HEADER_SIZE) {
+            distances.clear();
+            return false;
+        }
+        const uint32_t count = static_cast< uint32_t >(in[1]) | (static_cast< uint32_t >(in[2]) << 8) | (static_cast< uint32_t >(in[3]) << 16) | (static_cast< uint32_t >(in[4]) << 24);
+        //Each entry needs at least one bit
+        if (count > (compressed.size() - HEADER_SIZE) * 8) {
+            distances.clear();
+            return false;
+        }
+        distances.resize(count * 2);
+        uint8_t *out = reinterpret_cast< uint8_t * >(&distances[0]);
+
+        BitReader reader(in + HEADER_SIZE, static_cast< uint32_t >(compressed.size() - HEADER_SIZE));
+        const uint32_t stride = (entriesPerAzimuth > 0) ? entriesPerAzimuth : 1;
+        for (uint32_t start = 0; start < count; start += BLOCK_SIZE) {
+            const uint32_t length = (count - start < BLOCK_SIZE) ? count - start : BLOCK_SIZE;
+            reader.refill();
+            const uint32_t k = reader.get(4);
+            for (uint32_t i = 0; i < length; i++) {
+                //An entry takes at most the 32 bits buffered
+                reader.refill();
+                const uint32_t quotient = reader.unary(ESCAPE);
+                const uint32_t residual = (quotient < ESCAPE) ? ((quotient << k) | reader.get(k)) : reader.get(16);
+                const uint32_t index = start + i;
+                const uint16_t previous = (index >= stride) ? readBigEndian(out + 2 * (index - stride)) : 0;
+                const uint16_t value = static_cast< uint16_t >(previous + unzigzag(static_cast< uint16_t >(residual)));
+                out[2 * index] = static_cast< uint8_t >(value >> 8);
+                out[2 * index + 1] = static_cast< uint8_t >(value & 0xFF);
+            }
+        }
+        if (reader.failed()) {
+            distances.clear();
+            return false;
+        }
+        return true;
+    }
+
+   private:
+    //Chooses the Rice parameter with the fewest bits for the block from the counts and sums of its residuals per bit length
+    static uint32_t getRiceParameter(const uint16_t *residuals, const uint32_t &length) {
+        uint32_t counts[17] = {0};
+        uint32_t sums[17] = {0};
+        for (uint32_t i = 0; i < length; i++) {
+            const uint32_t bitLength = (residuals[i] == 0) ? 0 : 32 - static_cast< uint32_t >(__builtin_clz(residuals[i]));
+            counts[bitLength]++;
+            sums[bitLength] += residuals[i];
+        }
+        //The best parameter is close to the bit length of the median residual
+        uint32_t median = 0;
+        for (uint32_t below = counts[0]; 2 * below < length; below += counts[median]) {
+            median++;
+        }
+        uint32_t best = 0;
+        uint32_t bestBits = 0xFFFFFFFF;
+        const uint32_t first = (median > 2) ? median - 2 : 0;
+        const uint32_t last = (median + 2 < 15) ? median + 2 : 15;
+        for (uint32_t k = first; k <= last; k++) {
+            //Residuals of up to k + 4 bits have a quotient below ESCAPE; the sum of the quotients is approximated by the shifted sum
+            uint32_t bits = 0;
+            for (uint32_t b = 0; b <= 16; b++) {
+                bits += (b <= k + 4) ? counts[b] * (1 + k) + (sums[b] >> k) : counts[b] * (ESCAPE + 16);
+            }
+            if (bits < bestBits) {
+                best = k;
+                bestBits = bits;
+            }
+        }
+        return best;
+    }
+
+    static uint16_t readBigEndian(const uint8_t *data) {
+        return static_cast< uint16_t >((data[0] << 8) | data[1]);
+    }
+
+    //Small differences of either sign become small numbers: 0, -1, 1, -2, ... -> 0, 1, 2, 3, ...
+    static uint16_t zigzag(const uint16_t &difference) {
+        return static_cast< uint16_t >((difference << 1) ^ ((difference & 0x8000) ? 0xFFFF : 0));
+    }
+
+    static uint16_t unzigzag(const uint16_t &value) {
+        return static_cast< uint16_t >((value >> 1) ^ ((value & 1) ? 0xFFFF : 0));
+    }
+
+    //Least significant bit first; the output must have room for the worst case
+    class BitWriter {
+       public:
+        explicit BitWriter(uint8_t *out)
+            : m_begin(out)
+            , m_out(out)
+            , m_buffer(0)
+            , m_bits(0) {}
+
+        //Appends up to 32 bits; whole 32 bit words are written out
+        void put(const uint32_t &value, const uint32_t &bits) {
+            m_buffer |= static_cast< uint64_t >(value) << m_bits;
+            m_bits += bits;
+            if (m_bits >= 32) {
+                m_out[0] = static_cast< uint8_t >(m_buffer & 0xFF);
+                m_out[1] = static_cast< uint8_t >((m_buffer >> 8) & 0xFF);
+                m_out[2] = static_cast< uint8_t >((m_buffer >> 16) & 0xFF);
+                m_out[3] = static_cast< uint8_t >((m_buffer >> 24) & 0xFF);
+                m_out += 4;
+                m_buffer >>= 32;
+                m_bits -= 32;
+            }
+        }
+
+        //Flushes the last bits and returns the number of bytes written
+        uint32_t finish() {
+            while (m_bits > 0) {
+                *m_out++ = static_cast< uint8_t >(m_buffer & 0xFF);
+                m_buffer >>= 8;
+                m_bits = (m_bits > 8) ? m_bits - 8 : 0;
+            }
+            return static_cast< uint32_t >(m_out - m_begin);
+        }
+
+       private:
+        BitWriter(const BitWriter &);
+        BitWriter &operator=(const BitWriter &);
+
+        uint8_t *m_begin;
+        uint8_t *m_out;
+        uint64_t m_buffer;
+        uint32_t m_bits;
+    };
+
+    //Reading beyond the end yields zero bits and marks the reader as failed
+    class BitReader {
+       public:
+        BitReader(const uint8_t *in, const uint32_t &size)
+            : m_in(in)
+            , m_size(size)
+            , m_position(0)
+            , m_buffer(0)
+            , m_bits(0)
+            , m_consumed(0) {}
+
+        //Keeps at least 32 bits buffered
+        void refill() {
+            if (m_bits < 32 && m_position + 4 <= m_size) {
+                m_buffer |= (static_cast< uint64_t >(m_in[m_position]) | (static_cast< uint64_t >(m_in[m_position + 1]) << 8) | (static_cast< uint64_t >(m_in[m_position + 2]) << 16) | (static_cast< uint64_t >(m_in[m_position + 3]) << 24)) << m_bits;
+                m_position += 4;
+                m_bits += 32;
+            }
+            while (m_bits < 32) {
+                const uint64_t byte = (m_position < m_size) ? m_in[m_position] : 0;
+                m_buffer |= byte << m_bits;
+                m_position++;
+                m_bits += 8;
+            }
+        }
+
+        //Takes bits from the buffer; refill() must have buffered them
+        uint32_t get(const uint32_t &bits) {
+            const uint32_t value = static_cast< uint32_t >(m_buffer & ((static_cast< uint64_t >(1) << bits) - 1));
+            consume(bits);
+            return value;
+        }
+
+        //Number of ones before the next zero, at most limit (the zero is not consumed then)
+        uint32_t unary(const uint32_t &limit) {
+            uint32_t ones = static_cast< uint32_t >(__builtin_ctzll(~m_buffer));
+            ones = (ones < limit) ? ones : limit;
+            consume((ones < limit) ? ones + 1 : limit);
+            return ones;
+        }
+
+        bool failed() const {
+            return m_consumed > static_cast< uint64_t >(m_size) * 8;
+        }
+
+       private:
+        BitReader(const BitReader &);
+        BitReader &operator=(const BitReader &);
+
+        void consume(const uint32_t &bits) {
+            m_buffer >>= bits;
+            m_bits -= bits;
+            m_consumed += bits;
+        }
+
+        const uint8_t *m_in;
+        uint32_t m_size;
+        uint32_t m_position;
+        uint64_t m_buffer;
+        uint32_t m_bits;
+        uint64_t m_consumed;
+    };
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNECPCCODEC_H_*/
@@ -0,0 +1,562 @@
+/**
+ * VelodyneCalibrationFile - Parser and binary cache of VeloView calibration files
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNECALIBRATIONFILE_H_
+#define VELODYNECALIBRATIONFILE_H_
+
+#include <stdint.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * Calibration of one laser as given in the calibration file: angles in
+ * degrees, distances and offsets in cm.
+ */
+struct VelodyneLaserCalibration {
+    float rotCorrection;
+    float vertCorrection;
+    float distCorrection;
+    float distCorrectionX;
+    float distCorrectionY;
+    float vertOffsetCorrection;
+    float horizOffsetCorrection;
+    float focalDistance;
+    float focalSlope;
+    uint8_t minIntensity;
+    uint8_t maxIntensity;
+};
+
+/**
+ * VelodyneCalibrationFile reads the calibration files of VeloView (boost
+ * serialization XML as db.xml, VLP-16.xml and HDL-32E.xml) in a single pass
+ * over the tags and validates every laser entry: each id_ from 0 to the
+ * announced count appears exactly once with finite values for all required
+ * corrections.
+ *
+ * With a cache directory set, the lasers of a successfully parsed file are
+ * stored there in a compact binary file named after a 64 bit FNV-1a hash
+ * (over 8 byte words) of the XML; loading the same XML again only hashes it
+ * and reads the cache. Caches of other files, versions or with a wrong
+ * checksum are ignored and rewritten.
+ */
+class VelodyneCalibrationFile {
+   public:
+    static constexpr uint32_t CACHE_VERSION = 1;
+
+    /**
+     * This method selects the directory of the binary calibration caches.
+     *
+     * @param directory existing directory; empty to parse the XML every time (default).
+     */
+    static void setCacheDirectory(const std::string &directory) {
+        getCacheDirectory() = directory;
+    }
+
+    static std::string &getCacheDirectory() {
+        static std::string directory;
+        return directory;
+    }
+
+    /**
+     * This method loads the lasers of a calibration file, from the cache if
+     * it holds the same file.
+     *
+     * @param fileName calibration file.
+     * @param lasers lasers indexed by their id_.
+     * @param error description of the problem if the file is not valid.
+     * @param fromCache set to true if the lasers were read from the cache.
+     * @return true if the file was read and is valid.
+     */
+    static bool load(const std::string &fileName, std::vector< VelodyneLaserCalibration > &lasers, std::string &error, bool *fromCache = NULL) {
+        if (fromCache != NULL) {
+            *fromCache = false;
+        }
+        std::ifstream in(fileName.c_str(), std::ios::binary);
+        if (!in.is_open()) {
+            error = "Calibration file " + fileName + " not found.";
+            return false;
+        }
+        in.seekg(0, std::ios::end);
+        std::string xml(static_cast< size_t >(in.tellg()), '\0');
+        in.seekg(0, std::ios::beg);
+        if (!xml.empty() && !in.read(&xml[0], static_cast< std::streamsize >(xml.size()))) {
+            error = "Calibration file " + fileName + " cannot be read.";
+            return false;
+        }
+
+        const uint64_t hash = hashFile(xml);
+        const std::string cache = getCacheFileName(hash);
+        if (!cache.empty() && readCache(cache, hash, xml.size(), lasers)) {
+            if (fromCache != NULL) {
+                *fromCache = true;
+            }
+            return true;
+        }
+        if (!parse(xml, lasers, error)) {
+            error = fileName + ": " + error;
+            return false;
+        }
+        if (!cache.empty()) {
+            writeCache(cache, hash, xml.size(), lasers);
+        }
+        return true;
+    }
+
+    /**
+     * This method parses the lasers of a calibration file.
+     *
+     * @param xml content of the calibration file.
+     * @param lasers lasers indexed by their id_.
+     * @param error line and description of the problem if the content is not valid.
+     * @return true if the content is valid.
+     */
+    static bool parse(const std::string &xml, std::vector< VelodyneLaserCalibration > &lasers, std::string &error) {
+        Parser parser(xml, error);
+        return parser.parse(lasers);
+    }
+
+    /**
+     * @param hash hash of the calibration file.
+     * @return Name of the cache file in the cache directory; empty without cache directory.
+     */
+    static std::string getCacheFileName(const uint64_t &hash) {
+        const std::string &directory = getCacheDirectory();
+        if (directory.empty()) {
+            return "";
+        }
+        std::stringstream name;
+        name << directory << ((directory[directory.size() - 1] == '/') ? "" : "/")
+             << "velodyne-calibration-" << std::hex << std::setw(16) << std::setfill('0') << hash << ".bin";
+        return name.str();
+    }
+
+    /**
+     * @param xml content of a calibration file.
+     * @return Hash the cache of the file is named after.
+     */
+    static uint64_t hashFile(const std::string &xml) {
+        return fnv1a(xml.data(), xml.size(), FNV_OFFSET);
+    }
+
+   private:
+    static constexpr uint64_t FNV_OFFSET = (static_cast< uint64_t >(0xcbf29ce4) << 32) | 0x84222325;
+    static constexpr uint64_t FNV_PRIME = (static_cast< uint64_t >(0x100) << 32) | 0x1b3;
+    static constexpr uint32_t CACHE_HEADER_SIZE = 28; //magic, version, hash, size of the XML, number of lasers
+    static constexpr uint32_t CACHE_LASER_SIZE = 9 * sizeof(float) + 2;
+
+    static uint64_t fnv1a(const char *data, const size_t &size, uint64_t hash) {
+        // Eight bytes per step: the calibration file is hashed on every start.
+        size_t i = 0;
+        for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+            uint64_t word;
+            memcpy(&word, data + i, sizeof(word));
+            hash ^= word;
+            hash *= FNV_PRIME;
+        }
+        for (; i < size; i++) {
+            hash ^= static_cast< uint8_t >(data[i]);
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+
+    template < typename T >
+    static void append(std::string &buffer, const T value) {
+        buffer.append(reinterpret_cast< const char * >(&value), sizeof(T));
+    }
+
+    template < typename T >
+    static T extract(const std::string &buffer, uint32_t &position) {
+        T value;
+        memcpy(&value, buffer.data() + position, sizeof(T));
+        position += static_cast< uint32_t >(sizeof(T));
+        return value;
+    }
+
+    //The cache is written in the byte order of this machine; it is only read where it was written
+    static void writeCache(const std::string &fileName, const uint64_t &hash, const uint64_t &xmlSize, const std::vector< VelodyneLaserCalibration > &lasers) {
+        std::string buffer("VCAL");
+        append(buffer, CACHE_VERSION);
+        append(buffer, hash);
+        append(buffer, xmlSize);
+        append(buffer, static_cast< uint32_t >(lasers.size()));
+        for (auto &laser : lasers) {
+            append(buffer, laser.rotCorrection);
+            append(buffer, laser.vertCorrection);
+            append(buffer, laser.distCorrection);
+            append(buffer, laser.distCorrectionX);
+            append(buffer, laser.distCorrectionY);
+            append(buffer, laser.vertOffsetCorrection);
+            append(buffer, laser.horizOffsetCorrection);
+            append(buffer, laser.focalDistance);
+            append(buffer, laser.focalSlope);
+            append(buffer, laser.minIntensity);
+            append(buffer, laser.maxIntensity);
+        }
+        append(buffer, fnv1a(buffer.data(), buffer.size(), FNV_OFFSET));
+
+        //Written under a temporary name and renamed so that concurrent readers never see a partial cache
+        const std::string temporary = fileName + ".tmp";
+        {
+            std::ofstream out(temporary.c_str(), std::ios::binary | std::ios::trunc);
+            if (!out.is_open() || !out.write(buffer.data(), static_cast< std::streamsize >(buffer.size()))) {
+                remove(temporary.c_str());
+                return;
+            }
+        }
+        if (rename(temporary.c_str(), fileName.c_str()) != 0) {
+            remove(temporary.c_str());
+        }
+    }
+
+    static bool readCache(const std::string &fileName, const uint64_t &hash, const uint64_t &xmlSize, std::vector< VelodyneLaserCalibration > &lasers) {
+        std::ifstream in(fileName.c_str(), std::ios::binary);
+        if (!in.is_open()) {
+            return false;
+        }
+        const std::string buffer((std::istreambuf_iterator< char >(in)), std::istreambuf_iterator< char >());
+        if (buffer.size() < CACHE_HEADER_SIZE + sizeof(uint64_t) || buffer.compare(0, 4, "VCAL") != 0) {
+            return false;
+        }
+        uint32_t position = 4;
+        const uint32_t version = extract< uint32_t >(buffer, position);
+        const uint64_t cachedHash = extract< uint64_t >(buffer, position);
+        const uint64_t cachedXmlSize = extract< uint64_t >(buffer, position);
+        const uint32_t numberOfLasers = extract< uint32_t >(buffer, position);
+        if (version != CACHE_VERSION || cachedHash != hash || cachedXmlSize != xmlSize || numberOfLasers == 0
+            || buffer.size() != CACHE_HEADER_SIZE + static_cast< uint64_t >(numberOfLasers) * CACHE_LASER_SIZE + sizeof(uint64_t)) {
+            return false;
+        }
+        uint32_t checksumPosition = static_cast< uint32_t >(buffer.size() - sizeof(uint64_t));
+        if (extract< uint64_t >(buffer, checksumPosition) != fnv1a(buffer.data(), buffer.size() - sizeof(uint64_t), FNV_OFFSET)) {
+            return false;
+        }
+        lasers.resize(numberOfLasers);
+        for (auto &laser : lasers) {
+            laser.rotCorrection = extract< float >(buffer, position);
+            laser.vertCorrection = extract< float >(buffer, position);
+            laser.distCorrection = extract< float >(buffer, position);
+            laser.distCorrectionX = extract< float >(buffer, position);
+            laser.distCorrectionY = extract< float >(buffer, position);
+            laser.vertOffsetCorrection = extract< float >(buffer, position);
+            laser.horizOffsetCorrection = extract< float >(buffer, position);
+            laser.focalDistance = extract< float >(buffer, position);
+            laser.focalSlope = extract< float >(buffer, position);
+            laser.minIntensity = extract< uint8_t >(buffer, position);
+            laser.maxIntensity = extract< uint8_t >(buffer, position);
+        }
+        return true;
+    }
+
+    /**
+     * Parser moves from tag to tag through the XML; only the values of the
+     * elements it looks for are converted, everything else is skipped.
+     */
+    class Parser {
+       private:
+        Parser(const Parser &);
+        Parser &operator=(const Parser &);
+
+       public:
+        Parser(const std::string &xml, std::string &error)
+            : m_begin(xml.c_str())
+            , m_position(xml.c_str())
+            , m_end(xml.c_str() + xml.size())
+            , m_error(error)
+            , m_name(NULL)
+            , m_length(0)
+            , m_closing(false) {}
+
+        bool parse(std::vector< VelodyneLaserCalibration > &lasers) {
+            std::vector< bool > seen;
+            std::vector< uint8_t > minIntensity;
+            std::vector< uint8_t > maxIntensity;
+            bool havePoints = false;
+            while (nextTag()) {
+                if (m_closing) {
+                    continue;
+                }
+                if (is("points_")) {
+                    if (havePoints) {
+                        return fail("second points_ element");
+                    }
+                    havePoints = true;
+                    if (!parsePoints(lasers, seen)) {
+                        return false;
+                    }
+                } else if (is("minIntensity_")) {
+                    if (!parseIntensities("minIntensity_", minIntensity)) {
+                        return false;
+                    }
+                } else if (is("maxIntensity_")) {
+                    if (!parseIntensities("maxIntensity_", maxIntensity)) {
+                        return false;
+                    }
+                }
+            }
+            if (!havePoints) {
+                return fail("no points_ element with the lasers");
+            }
+            if ((!minIntensity.empty() && minIntensity.size() != lasers.size()) || (!maxIntensity.empty() && maxIntensity.size() != lasers.size())) {
+                return fail("minIntensity_ or maxIntensity_ does not have an entry per laser");
+            }
+            for (uint32_t i = 0; i < lasers.size(); i++) {
+                lasers[i].minIntensity = minIntensity.empty() ? 0 : minIntensity[i];
+                lasers[i].maxIntensity = maxIntensity.empty() ? 255 : maxIntensity[i];
+            }
+            return true;
+        }
+
+       private:
+        enum Field {
+            ID = 0,
+            ROT_CORRECTION,
+            VERT_CORRECTION,
+            DIST_CORRECTION,
+            DIST_CORRECTION_X,
+            DIST_CORRECTION_Y,
+            VERT_OFFSET_CORRECTION,
+            HORIZ_OFFSET_CORRECTION,
+            FOCAL_DISTANCE,
+            FOCAL_SLOPE,
+            NUMBER_OF_FIELDS
+        };
+
+        //Fields every laser must have; the others default to distCorrection_ (X, Y) and 0 (focal)
+        static constexpr uint32_t REQUIRED = (1u << ID) | (1u << ROT_CORRECTION) | (1u << VERT_CORRECTION) | (1u << DIST_CORRECTION) | (1u << VERT_OFFSET_CORRECTION) | (1u << HORIZ_OFFSET_CORRECTION);
+
+        static const char *getFieldName(const uint32_t &field) {
+            static const char *NAMES[NUMBER_OF_FIELDS] = {"id_", "rotCorrection_", "vertCorrection_", "distCorrection_", "distCorrectionX_", "distCorrectionY_", "vertOffsetCorrection_", "horizOffsetCorrection_", "focalDistance_", "focalSlope_"};
+            return NAMES[field];
+        }
+
+        //<count>N</count><item_version>V</item_version>? <item>...
+        bool parseCount(const char *element, uint32_t &count) {
+            double value = 0.0;
+            if (!nextTag() || m_closing || !is("count") || !readValue(value) || !closes("count")) {
+                return fail(std::string("expected <count> in ") + element);
+            }
+            if (!(value >= 0.0 && value <= 256.0) || std::floor(value) < value) {
+                return fail(std::string("invalid count in ") + element);
+            }
+            count = static_cast< uint32_t >(value);
+            return true;
+        }
+
+        bool parsePoints(std::vector< VelodyneLaserCalibration > &lasers, std::vector< bool > &seen) {
+            uint32_t count = 0;
+            if (!parseCount("points_", count)) {
+                return false;
+            }
+            if (count == 0) {
+                return fail("no lasers in points_");
+            }
+            lasers.assign(count, VelodyneLaserCalibration());
+            seen.assign(count, false);
+            uint32_t parsed = 0;
+            while (nextTag()) {
+                if (m_closing && is("points_")) {
+                    if (parsed != count) {
+                        return fail("points_ announces " + std::to_string(count) + " lasers but has " + std::to_string(parsed));
+                    }
+                    return true;
+                }
+                if (!m_closing && is("px")) {
+                    if (!parseLaser(lasers, seen)) {
+                        return false;
+                    }
+                    parsed++;
+                }
+            }
+            return fail("points_ is not closed");
+        }
+
+        bool parseLaser(std::vector< VelodyneLaserCalibration > &lasers, std::vector< bool > &seen) {
+            float values[NUMBER_OF_FIELDS] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+            uint32_t found = 0;
+            while (nextTag()) {
+                if (m_closing && is("px")) {
+                    break;
+                }
+                if (m_closing) {
+                    return fail("unexpected closing tag in px");
+                }
+                for (uint32_t field = 0; field < NUMBER_OF_FIELDS; field++) {
+                    if (is(getFieldName(field))) {
+                        double value = 0.0;
+                        if ((found & (1u << field)) != 0) {
+                            return fail(std::string("second ") + getFieldName(field));
+                        }
+                        if (!readValue(value) || !std::isfinite(value) || !closes(getFieldName(field))) {
+                            return fail(std::string("invalid value of ") + getFieldName(field));
+                        }
+                        values[field] = static_cast< float >(value);
+                        found |= (1u << field);
+                        break;
+                    }
+                }
+            }
+            if ((found & REQUIRED) != REQUIRED) {
+                for (uint32_t field = 0; field < NUMBER_OF_FIELDS; field++) {
+                    if ((REQUIRED & ~found & (1u << field)) != 0) {
+                        return fail(std::string("laser without ") + getFieldName(field));
+                    }
+                }
+            }
+            const float id = values[ID];
+            if (!(id >= 0.0f && id < static_cast< float >(lasers.size())) || std::floor(id) < id) {
+                return fail("laser id_ out of range");
+            }
+            const uint32_t index = static_cast< uint32_t >(id);
+            if (seen[index]) {
+                return fail("second laser with id_ " + std::to_string(index));
+            }
+            seen[index] = true;
+
+            VelodyneLaserCalibration &laser = lasers[index];
+            laser.rotCorrection = values[ROT_CORRECTION];
+            laser.vertCorrection = values[VERT_CORRECTION];
+            laser.distCorrection = values[DIST_CORRECTION];
+            laser.distCorrectionX = ((found & (1u << DIST_CORRECTION_X)) != 0) ? values[DIST_CORRECTION_X] : values[DIST_CORRECTION];
+            laser.distCorrectionY = ((found & (1u << DIST_CORRECTION_Y)) != 0) ? values[DIST_CORRECTION_Y] : values[DIST_CORRECTION];
+            laser.vertOffsetCorrection = values[VERT_OFFSET_CORRECTION];
+            laser.horizOffsetCorrection = values[HORIZ_OFFSET_CORRECTION];
+            laser.focalDistance = values[FOCAL_DISTANCE];
+            laser.focalSlope = values[FOCAL_SLOPE];
+            laser.minIntensity = 0;
+            laser.maxIntensity = 255;
+            return true;
+        }
+
+        bool parseIntensities(const char *element, std::vector< uint8_t > &intensities) {
+            uint32_t count = 0;
+            if (!parseCount(element, count)) {
+                return false;
+            }
+            intensities.clear();
+            while (nextTag()) {
+                if (m_closing && is(element)) {
+                    if (intensities.size() != count) {
+                        return fail(std::string(element) + " announces " + std::to_string(count) + " entries but has " + std::to_string(intensities.size()));
+                    }
+                    return true;
+                }
+                if (!m_closing && is("item")) {
+                    double value = 0.0;
+                    if (!readValue(value) || !(value >= 0.0 && value <= 255.0) || !closes("item")) {
+                        return fail(std::string("invalid intensity in ") + element);
+                    }
+                    intensities.push_back(static_cast< uint8_t >(value));
+                }
+            }
+            return fail(std::string(element) + " is not closed");
+        }
+
+        //Moves behind the next element tag and keeps its name; declarations and comments are skipped
+        bool nextTag() {
+            while (m_position < m_end) {
+                const char *open = static_cast< const char * >(memchr(m_position, '<', static_cast< size_t >(m_end - m_position)));
+                if (open == NULL || open + 1 >= m_end) {
+                    m_position = m_end;
+                    return false;
+                }
+                const char *terminator = (strncmp(open, "<!--", 4) == 0) ? "-->" : ">";
+                const char *close = strstr(open, terminator);
+                if (close == NULL) {
+                    m_position = m_end;
+                    return false;
+                }
+                m_position = close + strlen(terminator);
+                if (open[1] == '?' || open[1] == '!') {
+                    continue;
+                }
+                m_closing = (open[1] == '/');
+                m_name = open + (m_closing ? 2 : 1);
+                m_length = 0;
+                while (m_name + m_length < close && m_name[m_length] != ' ' && m_name[m_length] != '\t' && m_name[m_length] != '\r' && m_name[m_length] != '\n' && m_name[m_length] != '/') {
+                    m_length++;
+                }
+                return true;
+            }
+            return false;
+        }
+
+        bool is(const char *name) const {
+            return (strlen(name) == m_length) && (strncmp(m_name, name, m_length) == 0);
+        }
+
+        bool closes(const char *name) {
+            return nextTag() && m_closing && is(name);
+        }
+
+        //Converts the text behind the current tag up to the next tag
+        bool readValue(double &value) {
+            char *end = NULL;
+            value = strtod(m_position, &end);
+            if (end == m_position) {
+                return false;
+            }
+            while (end < m_end && (*end == ' ' || *end == '\t' || *end == '\r' || *end == '\n')) {
+                end++;
+            }
+            if (end >= m_end || *end != '<') {
+                return false;
+            }
+            m_position = end;
+            return true;
+        }
+
+        bool fail(const std::string &message) {
+            uint32_t line = 1;
+            for (const char *c = m_begin; c < m_position; c++) {
+                line += (*c == '\n');
+            }
+            m_error = "line " + std::to_string(line) + ": " + message;
+            return false;
+        }
+
+       private:
+        const char *m_begin;
+        const char *m_position;
+        const char *m_end;
+        std::string &m_error;
+        const char *m_name; //name of the current tag
+        uint32_t m_length;
+        bool m_closing; //the current tag is a closing tag
+    };
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNECALIBRATIONFILE_H_*/
@@ -0,0 +1,555 @@
+/**
+ * VelodyneDecoder publishes point clouds decoded by VelodyneDecoderCore
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNEDECODER_H_
+#define VELODYNEDECODER_H_
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "opendavinci/generated/odcore/data/CompactPointCloud.h"
+#include "opendavinci/generated/odcore/data/SharedPointCloud.h"
+#include "opendavinci/odcore/base/Lock.h"
+#include "opendavinci/odcore/data/Container.h"
+#include "opendavinci/odcore/data/TimeStamp.h"
+#include "opendavinci/odcore/io/StringListener.h"
+#include "opendavinci/odcore/io/conference/ContainerConference.h"
+#include "opendavinci/odcore/wrapper/SharedMemory.h"
+#include "odvdopendlvstandardmessageset/GeneratedHeaders_ODVDOpenDLVStandardMessageSet.h"
+
+#include "VelodyneCPCCodec.h"
+#include "VelodyneDecoderCore.h"
+#include "VelodyneDecoderStatistics.h"
+#include "VelodynePointEncoding.h"
+#include "VelodynePoseBuffer.h"
+#include "VelodyneSharedMemoryRing.h"
+#include "VelodyneUDPReceiver.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * VelodyneDecoder handles the bytes received via a UDP socket and sends
+ * shared point clouds (SPC) and compact point clouds (CPC) for each
+ * complete scan; the CPC may be sent compressed without loss. The sample
+ * time stamp of the containers is the time of the first firing of the
+ * frame; the last firing follows after the duration measured with the
+ * firing times of the sensor.
+ */
+template < typename Model >
+class VelodyneDecoder : public odcore::io::StringListener, public VelodynePacketListener, public VelodyneFrameListener {
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    VelodyneDecoder(const VelodyneDecoder &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    VelodyneDecoder &operator=(const VelodyneDecoder &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param m shared memory for SPC; NULL if no SPC is expected.
+     * @param c container conference.
+     * @param s name of the calibration file.
+     * @param options representations to be sent.
+     */
+    VelodyneDecoder(const std::shared_ptr< odcore::wrapper::SharedMemory > m,
+    odcore::io::conference::ContainerConference &c, const std::string &s, const VelodyneDecoderOptions &options)
+        : m_velodyneSharedMemory(m)
+        , m_ring()
+        , m_slot(NULL)
+        , m_conference(c)
+        , m_spc()
+        , m_encoding(VelodynePointEncoding::FLOAT32)
+        , m_core(s, options, *this)
+        , m_packetTimeStamp()
+        , m_frameTimeStamp()
+        , m_haveReceiveTimeStamps(false)
+        , m_useDeviceTime(false)
+        , m_publishTimeOffsets(false)
+        , m_publishReturnIndices(false)
+        , m_poses()
+        , m_deskewedFrames(0)
+        , m_numberOfFrames(0)
+        , m_statistics()
+        , m_frameStartTime(0)
+        , m_frameEndTime(0)
+        , m_compressCPC(false)
+        , m_compressed() {
+        if (options.withSPC) {
+            //Initial setup of the shared point cloud (N.B. The size and width of the shared point cloud depends on the number of points of a frame, hence they are not set up in the constructor)
+            m_spc.setName(m_velodyneSharedMemory->getName()); // Name of the shared memory segment with the data.
+            m_spc.setHeight(1); // We have just a sequence of vectors.
+            m_spc.setNumberOfComponentsPerPoint(VelodyneDecoderCore< Model >::NUMBER_OF_COMPONENTS_PER_POINT);
+            m_spc.setComponentDataType(odcore::data::SharedPointCloud::FLOAT_T); // Data type per component.
+            if (options.SPCOption == 0) {
+                m_spc.setUserInfo(odcore::data::SharedPointCloud::XYZ_INTENSITY);
+            } else {
+                m_spc.setUserInfo(odcore::data::SharedPointCloud::POLAR_INTENSITY);
+            }
+        }
+    }
+
+    virtual ~VelodyneDecoder() {}
+
+    /**
+     * This method selects between the precomputed sin/cos tables (default)
+     * and the per-point sin/cos reference path.
+     *
+     * @param useLookupTables true to use the precomputed tables.
+     */
+    void setLookupTables(const bool &useLookupTables) {
+        m_core.setLookupTables(useLookupTables);
+    }
+
+    /**
+     * This method selects all corrections of the HDL-64E S2/S3 calibration
+     * (default) or the basic model of VeloView 3 (see VelodyneCalibration).
+     *
+     * @param fullCalibration true for the full model.
+     */
+    void setFullCalibration(const bool &fullCalibration) {
+        m_core.setFullCalibration(fullCalibration);
+    }
+
+    /**
+     * This method selects the clock the frames are stamped with: the GPS
+     * time stamps of the sensor (requires a sensor synchronized to GPS) or
+     * the time the packets were received (default).
+     *
+     * @param useDeviceTime true to use the time stamps of the sensor.
+     */
+    void setDeviceTime(const bool &useDeviceTime) {
+        m_useDeviceTime = useDeviceTime;
+    }
+
+    /**
+     * This method appends the time offset of each point since the start of
+     * the frame (microseconds, float) after the points of the shared point
+     * cloud; the size of the SPC then covers width * (components + 1) floats.
+     * It must be called before setSharedMemoryRing() and the first packet.
+     *
+     * @param timeOffsets true to append the time offsets.
+     * @return true if the time offsets are appended.
+     */
+    bool setTimeOffsets(const bool &timeOffsets) {
+        m_publishTimeOffsets = m_core.setTimeOffsets(timeOffsets || m_poses.get() != NULL) && timeOffsets;
+        return m_publishTimeOffsets;
+    }
+
+    /**
+     * This method appends the return index of each point (uint8_t; 0: single
+     * return mode or last return, 1: strongest return in dual return mode)
+     * after the points and the time offsets of the shared point cloud. It
+     * must be called before setSharedMemoryRing() and the first packet.
+     *
+     * @param returnIndices true to append the return indices.
+     * @return true if the return indices are appended.
+     */
+    bool setReturnIndices(const bool &returnIndices) {
+        m_publishReturnIndices = m_core.setReturnIndices(returnIndices);
+        return m_publishReturnIndices;
+    }
+
+    /**
+     * This method selects the organised layout of the shared point cloud:
+     * its height is the number of lasers and its width the number of
+     * firings of the frame. The points are stored column-major: the columns
+     * (one per firing, lasers ordered by increasing vertical angle) follow
+     * each other, i.e. row r of column c is point c * height + r. Returns
+     * that are not valid have NaN coordinates. As the frames of this layout
+     * are larger, it must be called before setSharedMemoryRing() and the
+     * first packet.
+     *
+     * @param organised true for the organised layout.
+     * @return true if the layout is organised.
+     */
+    bool setOrganised(const bool &organised) {
+        if (m_ring.get() != NULL) {
+            return (m_core.isOrganised() == organised); //the slots are sized and decoded into for the current layout
+        }
+        const bool isOrganised = m_core.setOrganised(organised);
+        m_spc.setHeight(isOrganised ? Model::NUMBER_OF_LASERS : 1);
+        return isOrganised;
+    }
+
+    /**
+     * This method selects the encoding of the points in the shared point
+     * cloud: 4 floats (FLOAT32, default), 4 int16_t with x, y, z in units of
+     * 5 mm (INT16) or 4 half precision floats announced as UINT16_T
+     * (FLOAT16); see VelodynePointEncoding for decoding them. The compact
+     * encodings need xyz+intensity (SPCOption 0) and halve the size of each
+     * frame. It must be called before setSharedMemoryRing() and the first
+     * packet.
+     *
+     * @param encoding encoding of the points.
+     * @return true if the points are published with the given encoding; otherwise they stay floats.
+     */
+    bool setEncoding(const VelodynePointEncoding::Encoding &encoding) {
+        const VelodyneDecoderOptions &options = m_core.getOptions();
+        if (m_ring.get() != NULL) {
+            return (m_encoding == encoding); //the slots are sized and decoded into for the current encoding
+        }
+        m_encoding = VelodynePointEncoding::FLOAT32;
+        if (options.withSPC && (encoding == VelodynePointEncoding::FLOAT32 || options.SPCOption == 0)) {
+            m_encoding = encoding;
+        }
+        if (m_encoding == VelodynePointEncoding::INT16) {
+            m_spc.setComponentDataType(odcore::data::SharedPointCloud::INT16_T);
+        } else if (m_encoding == VelodynePointEncoding::FLOAT16) {
+            m_spc.setComponentDataType(odcore::data::SharedPointCloud::UINT16_T); // IEEE 754 half precision.
+        } else {
+            m_spc.setComponentDataType(odcore::data::SharedPointCloud::FLOAT_T);
+        }
+        return (m_encoding == encoding);
+    }
+
+    VelodynePointEncoding::Encoding getEncoding() const {
+        return m_encoding;
+    }
+
+    /**
+     * This method sends the compact point clouds as PointCloudReadingCompressed
+     * instead of CompactPointCloud: same fields, but the distances are
+     * compressed with VelodyneCPCCodec (typically to less than half their
+     * size) at a cost linear in the number of points of the frame.
+     *
+     * @param compressCPC true to send compressed compact point clouds.
+     */
+    void setCPCCompression(const bool &compressCPC) {
+        m_compressCPC = compressCPC;
+    }
+
+    /**
+     * This method enables the motion compensation of the shared point cloud:
+     * before a frame is published, the points of each firing are transformed
+     * into the sensor pose at the end of the frame, using the poses of the
+     * vehicle interpolated at the firing times. Requires cartesian points
+     * (SPCOption 0); frames without poses are published as decoded.
+     *
+     * @param poses poses of the vehicle; empty to disable the compensation.
+     * @return true if the frames are compensated.
+     */
+    bool setPoseBuffer(std::shared_ptr< VelodynePoseBuffer > poses) {
+        const VelodyneDecoderOptions &options = m_core.getOptions();
+        if (poses.get() == NULL || !options.withSPC || options.SPCOption != 0 || !m_core.setTimeOffsets(true)) {
+            m_poses.reset();
+            m_core.setTimeOffsets(m_publishTimeOffsets);
+            return false;
+        }
+        m_poses = poses;
+        return true;
+    }
+
+    /**
+     * @return Number of frames transformed with poses of the vehicle.
+     */
+    uint32_t getDeskewedFrames() const {
+        return m_deskewedFrames;
+    }
+
+    /**
+     * @return Number of frames (or sectors) completed so far.
+     */
+    uint64_t getNumberOfFrames() const {
+        return m_numberOfFrames;
+    }
+
+    /**
+     * This method lets the decoder send a PointCloudDecoderStatistics with
+     * the packets, frames, dropped points and decode times of the past
+     * interval; it is sent after the first frame completed once the
+     * interval has passed.
+     *
+     * @param seconds time between two reports; 0 (default) to send none.
+     */
+    void setStatisticsInterval(const float &seconds) {
+        m_statistics.setInterval(seconds);
+    }
+
+    /**
+     * @return Counters of the packets and frames since the decoder was created.
+     */
+    const VelodyneDecoderCounters &getCounters() const {
+        return m_core.getCounters();
+    }
+
+    /**
+     * This method publishes a frame whenever the azimuth enters the next
+     * sector of the given size instead of once per rotation, so that the
+     * first points reach the receivers after a fraction of a rotation. The
+     * compact point clouds and the slots of a shared memory ring carry the
+     * start and end azimuth of each sector.
+     *
+     * @param sectorSize degrees per sector; 0 for complete rotations.
+     */
+    void setSectorSize(const float &sectorSize) {
+        m_core.setSectorSize(sectorSize);
+    }
+
+    /**
+     * @return Size in bytes of the largest frame in the selected encoding including the time offsets and return indices if enabled.
+     */
+    uint32_t getFrameSize() const {
+        const uint32_t capacity = m_core.getPointCapacity();
+        return capacity * VelodynePointEncoding::getBytesPerPoint(m_encoding) + (m_publishTimeOffsets ? capacity * static_cast< uint32_t >(sizeof(float)) : 0)
+            + (m_publishReturnIndices ? capacity * static_cast< uint32_t >(sizeof(uint8_t)) : 0);
+    }
+
+    /**
+     * @return true if the last packet was sent in dual return mode.
+     */
+    bool isDualReturn() const {
+        return m_core.isDualReturn();
+    }
+
+    /**
+     * @return Time of the first firing of the last frame in microseconds since the epoch.
+     */
+    int64_t getFrameStartTime() const {
+        return m_frameStartTime;
+    }
+
+    /**
+     * @return Time of the last firing of the last frame in microseconds since the epoch.
+     */
+    int64_t getFrameEndTime() const {
+        return m_frameEndTime;
+    }
+
+    /**
+     * This method lets the decoder write the points of each frame directly
+     * into the slots of the given ring instead of copying them into the
+     * shared memory passed to the constructor; with a compact encoding, the
+     * points are encoded into the slots when the frame is completed. It must
+     * be called before the first packet is decoded.
+     *
+     * @param ring ring with slots of at least getFrameSize() bytes.
+     * @return true if the ring is used.
+     */
+    bool setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing > ring) {
+        if (!m_core.getOptions().withSPC || ring.get() == NULL || !ring->isValid() || ring->getSize() < getFrameSize()) {
+            return false;
+        }
+        m_ring = ring;
+        m_slot = m_ring->beginFrame();
+        if (m_encoding == VelodynePointEncoding::FLOAT32) {
+            m_core.setSegment(m_slot);
+        }
+        return true;
+    }
+
+    virtual void nextString(const std::string &s) {
+        decode(reinterpret_cast< const uint8_t * >(s.data()), static_cast< uint32_t >(s.length()));
+    }
+
+    virtual void nextPacket(const uint8_t *data, const uint32_t &length, const odcore::data::TimeStamp &received) {
+        m_packetTimeStamp = received;
+        if (!m_haveReceiveTimeStamps) {
+            m_frameTimeStamp = received;
+            m_haveReceiveTimeStamps = true;
+        }
+        decode(data, length);
+    }
+
+    //Update the shared or compact point cloud when a complete scan is completed.
+    virtual void nextFrame() {
+        const VelodyneDecoderOptions &options = m_core.getOptions();
+        m_numberOfFrames++;
+        m_statistics.addFrame(m_core.getNumberOfPoints(), m_core.getFrameDuration());
+        const odcore::data::TimeStamp now = updateFrameTime();
+
+        //Send shared point cloud; only the points of the current frame, their time offsets and return indices are shipped
+        const uint32_t pointsSize = m_core.getNumberOfPoints() * VelodynePointEncoding::getBytesPerPoint(m_encoding);
+        const uint32_t timeOffsetsSize = m_publishTimeOffsets ? m_core.getNumberOfPoints() * static_cast< uint32_t >(sizeof(float)) : 0;
+        const uint32_t returnIndicesSize = m_publishReturnIndices ? m_core.getNumberOfPoints() * static_cast< uint32_t >(sizeof(uint8_t)) : 0;
+        const uint32_t size = pointsSize + timeOffsetsSize + returnIndicesSize;
+        if (options.withSPC && m_ring.get() != NULL) {
+            //The frame has been decoded into the current slot (or is encoded into it now); publish it and continue with the next slot
+            deskew(m_core.getSegment());
+            if (m_encoding != VelodynePointEncoding::FLOAT32) {
+                VelodynePointEncoding::encode(m_encoding, m_core.getSegment(), m_core.getNumberOfPoints(), m_slot);
+            }
+            appendChannels(reinterpret_cast< char * >(m_slot) + pointsSize, timeOffsetsSize, returnIndicesSize);
+            m_spc.setName(m_ring->publishFrame(m_core.getNumberOfPoints(), m_frameStartTime, m_frameEndTime, m_core.getStartAzimuth(), m_core.getEndAzimuth()));
+            m_spc.setSize(size); // Size in raw bytes.
+            m_spc.setWidth(m_core.getNumberOfPoints() / m_spc.getHeight()); // Number of points (or columns if organised; column-major).
+            odcore::data::Container c(m_spc);
+            c.setSampleTimeStamp(now);
+            m_conference.send(c);
+            m_slot = m_ring->beginFrame();
+            if (m_encoding == VelodynePointEncoding::FLOAT32) {
+                m_core.setSegment(m_slot);
+            }
+        } else if (options.withSPC && m_velodyneSharedMemory->isValid() && size <= m_velodyneSharedMemory->getSize()) {
+            deskew(m_core.getSegment());
+            {
+                odcore::base::Lock l(m_velodyneSharedMemory);
+                VelodynePointEncoding::encode(m_encoding, m_core.getSegment(), m_core.getNumberOfPoints(), m_velodyneSharedMemory->getSharedMemory());
+                appendChannels(static_cast< char * >(m_velodyneSharedMemory->getSharedMemory()) + pointsSize, timeOffsetsSize, returnIndicesSize);
+            }
+            //Set the size and width of the shared point cloud of the current frame
+            m_spc.setSize(size); // Size in raw bytes.
+            m_spc.setWidth(m_core.getNumberOfPoints() / m_spc.getHeight()); // Number of points (or columns if organised; column-major).
+            odcore::data::Container c(m_spc);
+            c.setSampleTimeStamp(now);
+            m_conference.send(c);
+        }
+
+        //Send compact point cloud (format: start azimuth, end azimuth, entries per azimuth, distances, number if bits for intensity, intensity placement, distance decoding)
+        if (options.withCPC) {
+            if (options.CPCIntensityOption == 0 || options.CPCIntensityOption == 2) {
+                sendCPC(false, now);
+            }
+            if (options.CPCIntensityOption == 1 || options.CPCIntensityOption == 2) {
+                sendCPC(true, now);
+            }
+        }
+
+        if (m_statistics.isEnabled()) {
+            opendlv::proxy::PointCloudDecoderStatistics statistics;
+            if (m_statistics.report(m_core.getCounters(), statistics)) {
+                odcore::data::Container c(statistics);
+                c.setSampleTimeStamp(now);
+                m_conference.send(c);
+            }
+        }
+    }
+
+   private:
+    //Decodes a packet; one packet in VelodyneDecoderStatistics::SAMPLING is timed if statistics are sent
+    void decode(const uint8_t *data, const uint32_t &length) {
+        if (m_statistics.sampleNext()) {
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            m_core.nextPacket(data, length);
+            m_statistics.addDecodeTime(std::chrono::steady_clock::now() - start);
+        } else {
+            m_core.nextPacket(data, length);
+        }
+    }
+
+    static odcore::data::TimeStamp toTimeStamp(const int64_t &microseconds) {
+        return odcore::data::TimeStamp(static_cast< int32_t >(microseconds / 1000000L), static_cast< int32_t >(microseconds % 1000000L));
+    }
+
+    //Determines the start and end of the completed frame and returns the start
+    odcore::data::TimeStamp updateFrameTime() {
+        const int64_t duration = static_cast< int64_t >(m_core.getFrameDuration());
+        //Packets with a receive time stamp the frame with the time its first packet arrived; otherwise the frame ends now
+        if (m_haveReceiveTimeStamps) {
+            m_frameStartTime = m_frameTimeStamp.toMicroseconds();
+            m_frameTimeStamp = m_packetTimeStamp; //the current packet starts the next frame
+        } else {
+            m_frameStartTime = odcore::data::TimeStamp().toMicroseconds() - duration;
+        }
+        if (m_useDeviceTime && m_core.hasDeviceTime()) {
+            m_frameStartTime = VelodyneDeviceTime::toAbsolute(m_core.getFrameStartTime(), m_frameStartTime);
+        }
+        m_frameEndTime = m_frameStartTime + duration;
+        return toTimeStamp(m_frameStartTime);
+    }
+
+    //Copies the enabled per-point channels behind the points
+    void appendChannels(char *destination, const uint32_t &timeOffsetsSize, const uint32_t &returnIndicesSize) {
+        if (timeOffsetsSize > 0) {
+            memcpy(destination, m_core.getTimeOffsets(), timeOffsetsSize);
+        }
+        if (returnIndicesSize > 0) {
+            memcpy(destination + timeOffsetsSize, m_core.getReturnIndices(), returnIndicesSize);
+        }
+    }
+
+    //Transforms the points of the completed frame into the sensor pose at its end
+    void deskew(float *points) {
+        if (m_poses.get() != NULL) {
+            const float firingDuration = Model::FIRING_DURATION;
+            if (m_poses->deskew(points, m_core.getTimeOffsets(), m_core.getNumberOfPoints(), m_frameStartTime, m_frameEndTime, firingDuration) > 0) {
+                m_deskewedFrames++;
+            }
+        }
+    }
+
+    void sendCPC(const bool &withIntensity, const odcore::data::TimeStamp &now) {
+        const VelodyneDecoderOptions &options = m_core.getOptions();
+        for (uint8_t part = 0; part < Model::NUMBER_OF_CPC_PARTS; part++) {
+            if (m_compressCPC) {
+                //The buffer of the compressed distances is reused for every part and frame
+                VelodyneCPCCodec::compress(m_core.getCompactPointCloud(part, withIntensity), m_core.getEntriesPerAzimuth(part), m_compressed);
+                opendlv::proxy::PointCloudReadingCompressed compressed;
+                compressed.setStartAzimuth(m_core.getStartAzimuth());
+                compressed.setEndAzimuth(m_core.getEndAzimuth());
+                compressed.setEntriesPerAzimuth(m_core.getEntriesPerAzimuth(part));
+                compressed.setDistances(m_compressed);
+                compressed.setNumberOfBitsForIntensity(withIntensity ? options.numberOfBitsForIntensity : 0);
+                compressed.setIntensityPlacement(options.intensityPlacement);
+                compressed.setDistanceEncoding(options.distanceEncoding);
+                odcore::data::Container c(compressed);
+                c.setSampleTimeStamp(now);
+                m_conference.send(c);
+            } else {
+                odcore::data::CompactPointCloud cpc(m_core.getStartAzimuth(), m_core.getEndAzimuth(), m_core.getEntriesPerAzimuth(part), m_core.getCompactPointCloud(part, withIntensity), (withIntensity ? options.numberOfBitsForIntensity : 0), static_cast< odcore::data::CompactPointCloud::INTENSITY_PLACEMENT >(options.intensityPlacement), static_cast< odcore::data::CompactPointCloud::DISTANCE_ENCODING >(options.distanceEncoding));
+                odcore::data::Container c(cpc);
+                c.setSampleTimeStamp(now);
+                m_conference.send(c);
+            }
+        }
+    }
+
+   private:
+    std::shared_ptr< odcore::wrapper::SharedMemory > m_velodyneSharedMemory; //shared memory for shared point cloud
+    std::shared_ptr< VelodyneSharedMemoryRing > m_ring; //slots the frames are decoded into; empty to copy each frame into m_velodyneSharedMemory
+    float *m_slot; //slot of the current frame
+    odcore::io::conference::ContainerConference &m_conference;
+    odcore::data::SharedPointCloud m_spc; //shared point cloud
+    VelodynePointEncoding::Encoding m_encoding; //encoding of the points in the shared point cloud
+    VelodyneDecoderCore< Model > m_core;
+    odcore::data::TimeStamp m_packetTimeStamp; //receive time of the packet being decoded
+    odcore::data::TimeStamp m_frameTimeStamp; //receive time of the first packet of the current frame
+    bool m_haveReceiveTimeStamps;
+    bool m_useDeviceTime; //stamp the frames with the GPS time of the sensor
+    bool m_publishTimeOffsets; //append the time offsets to the shared point cloud
+    bool m_publishReturnIndices; //append the return indices to the shared point cloud
+    std::shared_ptr< VelodynePoseBuffer > m_poses; //poses of the vehicle for motion compensation; empty to publish the points as decoded
+    uint32_t m_deskewedFrames;
+    uint64_t m_numberOfFrames; //frames completed by the core
+    VelodyneDecoderStatistics m_statistics; //sent as PointCloudDecoderStatistics if enabled
+    int64_t m_frameStartTime; //first firing of the last frame in microseconds since the epoch
+    int64_t m_frameEndTime; //last firing of the last frame in microseconds since the epoch
+    bool m_compressCPC; //send the compact point clouds compressed
+    std::string m_compressed; //compressed distances of the compact point cloud being sent
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNEDECODER_H_*/
@@ -0,0 +1,216 @@
+/**
+ * VelodyneDecoderConfiguration reads the options shared by the Velodyne proxies
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNEDECODERCONFIGURATION_H_
+#define VELODYNEDECODERCONFIGURATION_H_
+
+#include <stdint.h>
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "opendavinci/odcore/base/KeyValueConfiguration.h"
+
+#include "VelodyneCalibrationFile.h"
+#include "VelodyneDecoder.h"
+#include "VelodynePointEncoding.h"
+#include "VelodynePoseBuffer.h"
+#include "VelodyneSharedMemoryRing.h"
+#include "VelodyneUDPReceiver.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * This method reads an optional value of the configuration.
+ *
+ * @param kv configuration.
+ * @param key complete key.
+ * @param defaultValue value if the key is not configured.
+ * @return Configured value or defaultValue.
+ */
+template < typename T >
+T getVelodyneOption(const odcore::base::KeyValueConfiguration &kv, const std::string &key, const T defaultValue) {
+    try {
+        return kv.getValue< T >(key);
+    }
+    catch(...) {
+        return defaultValue;
+    }
+}
+
+/**
+ * VelodyneSourceOptions reads where the packets of a Velodyne proxy come
+ * from and sets the directory of the calibration cache; it must be created
+ * before the decoder, as the decoder parses its calibration file.
+ */
+struct VelodyneSourceOptions {
+    /**
+     * Constructor.
+     *
+     * @param kv configuration.
+     * @param prefix prefix of the keys, e.g. "proxy-velodyne16".
+     */
+    VelodyneSourceOptions(const odcore::base::KeyValueConfiguration &kv, const std::string &prefix)
+        //Optional: receive with recvmmsg in a dedicated thread and decode in a second thread (1) instead of decoding in the UDPReceiver callback (0, default)
+        : receiveThread(getVelodyneOption< uint32_t >(kv, prefix + ".receiveThread", 0) == 1)
+        //Optional: number of packets buffered between the receive and the decode thread, maximum number of packets read per system call and socket receive buffer in bytes (0: system default)
+        , receiveQueueSize(getVelodyneOption< uint32_t >(kv, prefix + ".receiveQueueSize", 4096))
+        , receiveBatchSize(getVelodyneOption< uint32_t >(kv, prefix + ".receiveBatchSize", VelodyneUDPReceiver::DEFAULT_BATCH_SIZE))
+        , receiveBufferSize(getVelodyneOption< uint32_t >(kv, prefix + ".receiveBufferSize", 0))
+        //Optional: decode the data packets of a pcap recording instead of receiving them from the sensor; none by default
+        , replayFile(getVelodyneOption< std::string >(kv, prefix + ".replay", ""))
+        //Optional: replay speed relative to the recording: paced by the capture times (1, default), N times faster (N) or as fast as possible (0)
+        , replaySpeed(getVelodyneOption< double >(kv, prefix + ".replaySpeed", 1.0)) {
+        std::cout << "Receive thread (0: decode in the UDP callback; 1: separate receive and decode threads):" << receiveThread << std::endl;
+        std::cout << "Replayed recording (none: receive from the sensor):" << replayFile << std::endl;
+        if (receiveThread && replayFile.empty()) {
+            std::cout << "Receive queue size: " << receiveQueueSize << ", batch size: " << receiveBatchSize << ", socket receive buffer (0: system default): " << receiveBufferSize << std::endl;
+        }
+        if (!replayFile.empty()) {
+            std::cout << "Replay speed (0: as fast as possible; 1: real time; N: N times real time):" << replaySpeed << std::endl;
+        }
+
+        //Optional: directory for a binary cache of the parsed calibration file, so that restarts with the same file skip parsing the XML; none by default
+        const std::string calibrationCache = getVelodyneOption< std::string >(kv, prefix + ".calibrationCache", "");
+        std::cout << "Calibration cache directory:" << calibrationCache << std::endl;
+        VelodyneCalibrationFile::setCacheDirectory(calibrationCache);
+    }
+
+    bool receiveThread;         //true: receive and decode in separate threads; false: decode in the UDPReceiver callback
+    uint32_t receiveQueueSize;  //number of packets buffered between the receive and the decode thread
+    uint32_t receiveBatchSize;  //maximum number of packets read per system call
+    uint32_t receiveBufferSize; //socket receive buffer in bytes; 0: system default
+    std::string replayFile;     //pcap recording decoded instead of the packets received from the sensor; empty: receive from the sensor
+    double replaySpeed;         //0: as fast as possible; 1: real time; N: N times real time
+};
+
+/**
+ * This method applies the optional settings shared by the Velodyne proxies
+ * to a decoder: projection, time stamps, layout and encoding of the shared
+ * point cloud, sectors, compression of the compact point cloud, motion
+ * compensation, shared memory slots and statistics; for models with a
+ * dual return mode, also the return index of each point.
+ *
+ * @param kv configuration.
+ * @param prefix prefix of the keys, e.g. "proxy-velodyne16".
+ * @param decoder decoder to be configured.
+ * @param memoryName name of the shared memory of the SPC; empty if no SPC is sent.
+ * @param memorySize size of the shared memory of the SPC.
+ * @param poses buffer for the poses of the vehicle if the motion is compensated; otherwise reset.
+ * @return Source of the poses (0: no motion compensation; 1: Applanix Grp1Data; 2: AngularVelocityReading).
+ */
+template < typename Model >
+uint8_t configureVelodyneDecoder(const odcore::base::KeyValueConfiguration &kv, const std::string &prefix, VelodyneDecoder< Model > &decoder,
+const std::string &memoryName, const uint32_t &memorySize, std::shared_ptr< VelodynePoseBuffer > &poses) {
+    //Optional: project cartesian points with precomputed sin/cos tables (1, default) or sin/cos per point (0)
+    const bool lookupTables = (getVelodyneOption< uint32_t >(kv, prefix + ".lookupTables", 1) == 1);
+    std::cout << "Lookup tables for projection (0: sin/cos per point; 1: lookup tables):" << lookupTables << std::endl;
+    decoder.setLookupTables(lookupTables);
+
+    //Optional: stamp the frames with the GPS time of the sensor (1) instead of the receive time of the packets (0, default)
+    const bool deviceTime = (getVelodyneOption< uint32_t >(kv, prefix + ".deviceTime", 0) == 1);
+    std::cout << "Frame time (0: receive time; 1: GPS time of the sensor):" << deviceTime << std::endl;
+    decoder.setDeviceTime(deviceTime);
+
+    //Optional: encoding of the points in the shared point cloud: 4 floats (0, default), 4 int16_t with x, y, z in units of 5 mm (1) or 4 half precision floats (2)
+    const uint32_t encoding = getVelodyneOption< uint32_t >(kv, prefix + ".encoding", VelodynePointEncoding::FLOAT32);
+    std::cout << "Point encoding of the shared point cloud (0: float; 1: int16, 5 mm; 2: half precision float):" << encoding << std::endl;
+    if (encoding > VelodynePointEncoding::FLOAT16 || !decoder.setEncoding(static_cast< VelodynePointEncoding::Encoding >(encoding))) {
+        std::cerr << "Invalid point encoding or no shared point cloud with xyz+intensity; publishing floats." << std::endl;
+    }
+
+    //Optional: append the time offset of each point since the start of the frame after the points of the shared point cloud (1) or not (0, default)
+    const bool timeOffsets = (getVelodyneOption< uint32_t >(kv, prefix + ".timeOffsets", 0) == 1);
+    std::cout << "Time offset per point (0: no; 1: appended to the shared point cloud):" << timeOffsets << std::endl;
+    if (decoder.setTimeOffsets(timeOffsets) && !memoryName.empty() && memorySize < decoder.getFrameSize()) {
+        std::cerr << "sharedMemory.size is smaller than the points and time offsets of a full frame (" << decoder.getFrameSize() << " bytes); larger frames are not sent." << std::endl;
+    }
+
+    if (Model::DUAL_RETURN) {
+        //Optional: append the return index of each point (dual return mode) after the points and time offsets of the shared point cloud (1) or not (0, default)
+        const bool returnIndices = (getVelodyneOption< uint32_t >(kv, prefix + ".returnIndices", 0) == 1);
+        std::cout << "Return index per point (0: no; 1: appended to the shared point cloud):" << returnIndices << std::endl;
+        if (decoder.setReturnIndices(returnIndices) && !memoryName.empty() && memorySize < decoder.getFrameSize()) {
+            std::cerr << "sharedMemory.size is smaller than the points, time offsets and return indices of a full frame (" << decoder.getFrameSize() << " bytes); larger frames are not sent." << std::endl;
+        }
+    }
+
+    //Optional: organised shared point cloud with one column of all lasers per firing (column-major) and NaN for invalid returns (1) or only the valid returns (0, default)
+    const bool organised = (getVelodyneOption< uint32_t >(kv, prefix + ".organised", 0) == 1);
+    std::cout << "Organised shared point cloud (0: valid returns only; 1: lasers x firings, column-major):" << organised << std::endl;
+    if (decoder.setOrganised(organised) && !memoryName.empty() && memorySize < decoder.getFrameSize()) {
+        std::cerr << "sharedMemory.size is smaller than an organised frame of a rotation at 5 Hz (" << decoder.getFrameSize() << " bytes); larger frames are not sent." << std::endl;
+    }
+
+    //Optional: publish a frame every sectorSize degrees of azimuth instead of once per rotation (0, default)
+    const float sectorSize = getVelodyneOption< float >(kv, prefix + ".sectorSize", 0.0f);
+    std::cout << "Sector size in degrees (0: complete rotations):" << sectorSize << std::endl;
+    decoder.setSectorSize(sectorSize);
+
+    //Optional: send the compact point clouds compressed without loss as PointCloudReadingCompressed (1) or as CompactPointCloud (0, default)
+    const bool CPCCompression = (getVelodyneOption< uint32_t >(kv, prefix + ".CPCCompression", 0) == 1);
+    std::cout << "Compressed compact point cloud (0: CompactPointCloud; 1: PointCloudReadingCompressed):" << CPCCompression << std::endl;
+    decoder.setCPCCompression(CPCCompression);
+
+    //Optional: transform the points of each firing into the sensor pose at the end of the frame with poses from Applanix Grp1Data (1) or the orientation integrated from AngularVelocityReading (2); 0 (default): no motion compensation
+    const uint8_t poseSource = static_cast< uint8_t >(getVelodyneOption< uint32_t >(kv, prefix + ".deskew", 0));
+    std::cout << "Motion compensation (0: none; 1: Grp1Data; 2: AngularVelocityReading):" << static_cast< uint32_t >(poseSource) << std::endl;
+    poses.reset();
+    if (poseSource == 1 || poseSource == 2) {
+        //Optional: orientation of the sensor on the vehicle in degrees; 0: y axis of the sensor forward, z axis up
+        const double roll = getVelodyneOption< double >(kv, prefix + ".deskew.mount.roll", 0.0);
+        const double pitch = getVelodyneOption< double >(kv, prefix + ".deskew.mount.pitch", 0.0);
+        const double yaw = getVelodyneOption< double >(kv, prefix + ".deskew.mount.yaw", 0.0);
+        std::cout << "Sensor mounting for motion compensation (roll, pitch, yaw in degrees):" << roll << ", " << pitch << ", " << yaw << std::endl;
+        const uint32_t capacity = VelodynePoseBuffer::DEFAULT_CAPACITY;
+        poses = std::shared_ptr< VelodynePoseBuffer >(new VelodynePoseBuffer(capacity));
+        poses->setMounting(roll * M_PI / 180.0, pitch * M_PI / 180.0, yaw * M_PI / 180.0);
+        if (!decoder.setPoseBuffer(poses)) {
+            std::cerr << "Motion compensation needs shared point clouds with xyz+intensity; publishing the points as decoded." << std::endl;
+            poses.reset();
+        }
+    }
+
+    //Optional: number of shared memory slots "<name>.<k>" the frames are decoded into directly (1, default: copy each frame into "<name>")
+    const uint32_t slots = getVelodyneOption< uint32_t >(kv, prefix + ".sharedMemory.slots", 1);
+    std::cout << "Shared memory slots (1: copy each frame; >1: decode into a ring of slots):" << slots << std::endl;
+    if (slots > 1 && !memoryName.empty()) {
+        if (!decoder.setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing(memoryName, slots, memorySize)))) {
+            std::cerr << "Shared memory slots could not be created (sharedMemory.size too small?); copying each frame instead." << std::endl;
+        }
+    }
+
+    //Optional: seconds between two PointCloudDecoderStatistics (1, default; 0: none)
+    const float statisticsInterval = getVelodyneOption< float >(kv, prefix + ".statisticsInterval", 1.0f);
+    std::cout << "Decoder statistics interval in seconds (0: none):" << statisticsInterval << std::endl;
+    decoder.setStatisticsInterval(statisticsInterval);
+
+    return poseSource;
+}
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNEDECODERCONFIGURATION_H_*/
@@ -0,0 +1,1398 @@
+/**
+ * VelodyneDecoderCore is the packet decoder shared by the Velodyne proxies
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNEDECODERCORE_H_
+#define VELODYNEDECODERCORE_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "VelodyneCalibrationFile.h"
+#include "VelodyneProjection.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * Compile-time description of the VLP-16: 16 lasers fired twice per data
+ * block; the azimuth of the second firing is interpolated.
+ */
+struct VLP16 {
+    static constexpr uint8_t NUMBER_OF_LASERS = 16;
+    static constexpr uint8_t FIRINGS_PER_BLOCK = 2;
+    static constexpr uint32_t MAX_POINT_SIZE = 30000; //the maximum number of points per frame and return. This upper bound should be set as low as possible, as it affects the shared memory size and thus the frame updating speed.
+    static constexpr uint8_t NUMBER_OF_CPC_PARTS = 1;
+
+    static bool isLowerBlock(const uint16_t &) {
+        return false;
+    }
+
+    static constexpr float DISTANCE_SCALE = 1.0f;
+    static constexpr float DISTANCE_DIVISOR = 500.0f; //2mm-->/1000 for meter
+
+    static float toDistance(const uint16_t &raw) {
+        return raw * DISTANCE_SCALE / DISTANCE_DIVISOR;
+    }
+
+    static constexpr float FIRING_DURATION = 55.296f; //microseconds between two firing sequences
+    static constexpr float LASER_DURATION = 2.304f; //microseconds between two lasers of a firing sequence
+    static constexpr uint8_t FIRINGS_PER_PACKET = 24;
+    static constexpr bool DUAL_RETURN = true; //the factory byte announces dual return packets
+    static constexpr uint32_t MAX_FIRINGS_PER_ROTATION = 3617; //at the lowest rotation rate of 5 Hz: 200 ms / FIRING_DURATION
+
+    static uint8_t firingSequence(const uint8_t &blockID, const uint8_t &firing) {
+        return static_cast< uint8_t >(blockID * FIRINGS_PER_BLOCK + firing);
+    }
+
+    static uint8_t compactPointCloudPart(const uint8_t &) {
+        return 0;
+    }
+};
+
+/**
+ * Compile-time description of the HDL-32E: 32 lasers fired once per data
+ * block. The compact point cloud is split into 12+11+9 layers.
+ */
+struct HDL32E {
+    static constexpr uint8_t NUMBER_OF_LASERS = 32;
+    static constexpr uint8_t FIRINGS_PER_BLOCK = 1;
+    static constexpr uint32_t MAX_POINT_SIZE = 70000;
+    static constexpr uint8_t NUMBER_OF_CPC_PARTS = 3;
+
+    static bool isLowerBlock(const uint16_t &) {
+        return false;
+    }
+
+    static constexpr float DISTANCE_SCALE = 1.0f;
+    static constexpr float DISTANCE_DIVISOR = 500.0f; //2mm-->/1000 for meter
+
+    static float toDistance(const uint16_t &raw) {
+        return raw * DISTANCE_SCALE / DISTANCE_DIVISOR;
+    }
+
+    static constexpr float FIRING_DURATION = 46.08f;
+    static constexpr float LASER_DURATION = 1.152f;
+    static constexpr uint8_t FIRINGS_PER_PACKET = 12;
+    static constexpr bool DUAL_RETURN = true;
+    static constexpr uint32_t MAX_FIRINGS_PER_ROTATION = 4341; //at 5 Hz
+
+    static uint8_t firingSequence(const uint8_t &blockID, const uint8_t &) {
+        return blockID;
+    }
+
+    static uint8_t compactPointCloudPart(const uint8_t &layer) {
+        if (layer == 0 || layer % 3 == 1) {//Layer 0, 1, 4, 7..., i.e., in addition to Layer 0, every 3rd layer from Layer 1 and resulting in 12 layers
+            return 0;
+        } else if (layer == 2 || layer % 3 == 0) {//Layer 2, 3, 6, 9..., i.e., in addition to Layer 2, every 3rd layer from Layer 3 and resulting in 11 layers
+            return 1;
+        }
+        return 2; //Layer 5, 8, 11..., i.e., every 3rd layer from Layer 5 and resulting in 9 layers
+    }
+};
+
+/**
+ * Compile-time description of the HDL-64E: an upper block (lasers 0-31)
+ * and a lower block (lasers 32-63, flag 0xDDFF) form one firing.
+ */
+struct HDL64E {
+    static constexpr uint8_t NUMBER_OF_LASERS = 64;
+    static constexpr uint8_t FIRINGS_PER_BLOCK = 1;
+    static constexpr uint32_t MAX_POINT_SIZE = 101000;
+    static constexpr uint8_t NUMBER_OF_CPC_PARTS = 1;
+
+    static bool isLowerBlock(const uint16_t &flag) {
+        return flag == 0xDDFF;
+    }
+
+    static constexpr float DISTANCE_SCALE = 0.2f; //2mm resolution
+    static constexpr float DISTANCE_DIVISOR = 100.0f;
+
+    static float toDistance(const uint16_t &raw) {
+        return raw * DISTANCE_SCALE / DISTANCE_DIVISOR;
+    }
+
+    //An upper and a lower block are fired together; the timing of the lasers within a block is not published
+    static constexpr float FIRING_DURATION = 64.0f;
+    static constexpr float LASER_DURATION = 0.0f;
+    static constexpr uint8_t FIRINGS_PER_PACKET = 6;
+    static constexpr bool DUAL_RETURN = false; //the factory bytes carry status information instead of the return mode
+    static constexpr uint32_t MAX_FIRINGS_PER_ROTATION = 4750; //upper blocks at 5 Hz; a rotation at 10 Hz was recorded with about 2370
+
+    static uint8_t firingSequence(const uint8_t &blockID, const uint8_t &) {
+        return static_cast< uint8_t >(blockID / 2);
+    }
+
+    static uint8_t compactPointCloudPart(const uint8_t &) {
+        return 0;
+    }
+};
+
+/**
+ * Per-laser calibration as read from a VeloView calibration file. Angles
+ * are in degrees, offsets are converted from cm to m when loaded.
+ *
+ * The full model (default) applies all corrections of the HDL-64E S2/S3
+ * calibration: the vertical offset is perpendicular to the beam, the
+ * distance correction along x and y varies linearly with the distance on
+ * the respective axis between the two calibration points at 2.4 m (x) or
+ * 1.93 m (y) and 25.04 m, and the intensity is corrected for the focal
+ * distance of the laser and limited to the range of the laser. The basic
+ * model only applies the distance correction and adds the vertical offset
+ * to z, as VeloView 3 exports. Files without these corrections (VLP-16,
+ * HDL-32E) give the same points with both models.
+ */
+template < uint8_t N >
+struct VelodyneCalibration {
+    std::array< float, N > rotCorrection;
+    std::array< float, N > vertCorrection;
+    std::array< float, N > distCorrection;
+    std::array< float, N > distCorrectionX; //distance correction at 2.4 m on the x axis
+    std::array< float, N > distCorrectionY; //distance correction at 1.93 m on the y axis
+    std::array< float, N > vertOffsetCorrection;
+    std::array< float, N > horizOffsetCorrection;
+    std::array< float, N > focalDistance; //cm
+    std::array< float, N > focalSlope;
+    std::array< float, N > minIntensity;
+    std::array< float, N > maxIntensity;
+    std::array< uint8_t, N > sensorOrderIndex; //sensor IDs ordered by increasing vertical angle
+    bool fullModel; //apply all corrections of the HDL-64E S2/S3 calibration
+
+    //Precomputed per laser from the corrections above
+    std::array< float, N > cosVertical;
+    std::array< float, N > sinVertical;
+    std::array< float, N > cosRotation;
+    std::array< float, N > sinRotation;
+    std::array< float, N > xyVertOffset; //subtracted from the distance in the xy plane
+    std::array< float, N > zVertOffset; //added to z
+    std::array< float, N > distSlopeX; //distance correction along x: distSlopeX * |x| + distOffsetX
+    std::array< float, N > distOffsetX;
+    std::array< float, N > distSlopeY; //distance correction along y: distSlopeY * |y| + distOffsetY
+    std::array< float, N > distOffsetY;
+    std::array< float, N > focalOffset;
+    bool twoPointCorrection; //at least one laser has a distance correction along x or y
+    bool intensityCorrection; //at least one laser has a focal slope or a limited intensity range
+
+    VelodyneCalibration()
+        : rotCorrection()
+        , vertCorrection()
+        , distCorrection()
+        , distCorrectionX()
+        , distCorrectionY()
+        , vertOffsetCorrection()
+        , horizOffsetCorrection()
+        , focalDistance()
+        , focalSlope()
+        , minIntensity()
+        , maxIntensity()
+        , sensorOrderIndex()
+        , fullModel(true)
+        , cosVertical()
+        , sinVertical()
+        , cosRotation()
+        , sinRotation()
+        , xyVertOffset()
+        , zVertOffset()
+        , distSlopeX()
+        , distOffsetX()
+        , distSlopeY()
+        , distOffsetY()
+        , focalOffset()
+        , twoPointCorrection(false)
+        , intensityCorrection(false) {
+        rotCorrection.fill(0.0f);
+        vertCorrection.fill(0.0f);
+        distCorrection.fill(0.0f);
+        distCorrectionX.fill(0.0f);
+        distCorrectionY.fill(0.0f);
+        vertOffsetCorrection.fill(0.0f);
+        horizOffsetCorrection.fill(0.0f);
+        focalDistance.fill(0.0f);
+        focalSlope.fill(0.0f);
+        minIntensity.fill(0.0f);
+        maxIntensity.fill(255.0f);
+        precompute();
+    }
+
+    /**
+     * This method loads the lasers 0 to N - 1 of the given calibration file
+     * (see VelodyneCalibrationFile); the corrections stay 0 if the file is
+     * missing or not valid.
+     *
+     * @param calibration name of the calibration file.
+     * @return true if the file was valid and has at least N lasers.
+     */
+    bool load(const std::string &calibration) {
+        std::vector< VelodyneLaserCalibration > lasers;
+        std::string error;
+        if (!VelodyneCalibrationFile::load(calibration, lasers, error)) {
+            std::cerr << error << std::endl;
+            return false;
+        }
+        if (lasers.size() < N) {
+            std::cerr << calibration << ": " << lasers.size() << " lasers instead of " << +N << "." << std::endl;
+            return false;
+        }
+
+        // Offsets are given in cm.
+        for (uint8_t i = 0; i < N; i++) {
+            rotCorrection[i] = lasers[i].rotCorrection;
+            vertCorrection[i] = lasers[i].vertCorrection;
+            distCorrection[i] = lasers[i].distCorrection / 100.0f;
+            distCorrectionX[i] = lasers[i].distCorrectionX / 100.0f;
+            distCorrectionY[i] = lasers[i].distCorrectionY / 100.0f;
+            vertOffsetCorrection[i] = lasers[i].vertOffsetCorrection / 100.0f;
+            horizOffsetCorrection[i] = lasers[i].horizOffsetCorrection / 100.0f;
+            focalDistance[i] = lasers[i].focalDistance;
+            focalSlope[i] = lasers[i].focalSlope;
+            minIntensity[i] = lasers[i].minIntensity;
+            maxIntensity[i] = lasers[i].maxIntensity;
+        }
+
+        precompute();
+        return true;
+    }
+
+    /**
+     * This method selects the full model (default) or the basic model.
+     *
+     * @param full true for the full model.
+     */
+    void setFullModel(const bool &full) {
+        fullModel = full;
+        precompute();
+    }
+
+    /**
+     * @param laser sensor ID.
+     * @param raw distance as sent by the sensor.
+     * @param intensity intensity as sent by the sensor.
+     * @return Intensity corrected for the focal distance and limited to the range of the laser.
+     */
+    float calibrateIntensity(const uint8_t &laser, const uint16_t &raw, const uint8_t &intensity) const {
+        const float remaining = 1.0f - static_cast< float >(raw) / 65535.0f;
+        float calibrated = static_cast< float >(intensity) + focalSlope[laser] * std::fabs(focalOffset[laser] - 256.0f * remaining * remaining);
+        calibrated = (calibrated < minIntensity[laser]) ? minIntensity[laser] : calibrated;
+        return (calibrated > maxIntensity[laser]) ? maxIntensity[laser] : calibrated;
+    }
+
+   private:
+    void precompute() {
+        const float TO_RADIAN = static_cast< float >(M_PI) / 180.0f;
+        twoPointCorrection = false;
+        intensityCorrection = false;
+        for (uint8_t i = 0; i < N; i++) {
+            cosVertical[i] = std::cos(vertCorrection[i] * TO_RADIAN);
+            sinVertical[i] = std::sin(vertCorrection[i] * TO_RADIAN);
+            cosRotation[i] = std::cos(rotCorrection[i] * TO_RADIAN);
+            sinRotation[i] = std::sin(rotCorrection[i] * TO_RADIAN);
+
+            xyVertOffset[i] = fullModel ? vertOffsetCorrection[i] * sinVertical[i] : 0.0f;
+            zVertOffset[i] = fullModel ? vertOffsetCorrection[i] * cosVertical[i] : vertOffsetCorrection[i];
+
+            //The correction along an axis is distCorrectionX (Y) at the near and distCorrection at the far calibration point
+            distSlopeX[i] = fullModel ? (distCorrection[i] - distCorrectionX[i]) / (25.04f - 2.4f) : 0.0f;
+            distOffsetX[i] = fullModel ? distCorrectionX[i] - distCorrection[i] - distSlopeX[i] * 2.4f : 0.0f;
+            distSlopeY[i] = fullModel ? (distCorrection[i] - distCorrectionY[i]) / (25.04f - 1.93f) : 0.0f;
+            distOffsetY[i] = fullModel ? distCorrectionY[i] - distCorrection[i] - distSlopeY[i] * 1.93f : 0.0f;
+            twoPointCorrection = twoPointCorrection || (std::fabs(distSlopeX[i]) + std::fabs(distOffsetX[i]) + std::fabs(distSlopeY[i]) + std::fabs(distOffsetY[i]) > 0.0f);
+
+            const float focal = 1.0f - focalDistance[i] / 13100.0f;
+            focalOffset[i] = 256.0f * focal * focal;
+            intensityCorrection = intensityCorrection || (fullModel && (std::fabs(focalSlope[i]) > 0.0f || minIntensity[i] > 0.0f || maxIntensity[i] < 255.0f));
+        }
+
+        //Order the sensor IDs with increasing vertical angle (stable for equal angles)
+        for (uint8_t i = 0; i < N; i++) {
+            sensorOrderIndex[i] = i;
+        }
+        for (uint8_t i = 1; i < N; i++) {
+            const uint8_t id = sensorOrderIndex[i];
+            uint8_t j = i;
+            while (j > 0 && vertCorrection[sensorOrderIndex[j - 1]] > vertCorrection[id]) {
+                sensorOrderIndex[j] = sensorOrderIndex[j - 1];
+                j--;
+            }
+            sensorOrderIndex[j] = id;
+        }
+    }
+};
+
+/**
+ * Sine and cosine of all azimuths of a revolution in steps of 0.01 degree,
+ * the resolution of the azimuth field in a data packet.
+ */
+class VelodyneAzimuthTable {
+   public:
+    static constexpr uint32_t SIZE = 36000;
+
+    static const VelodyneAzimuthTable &getInstance() {
+        static const VelodyneAzimuthTable instance;
+        return instance;
+    }
+
+    /**
+     * @param azimuth in degree (0 - 360).
+     * @return Index of the closest entry.
+     */
+    static uint32_t index(const float &azimuth) {
+        return static_cast< uint32_t >(azimuth * 100.0f + 0.5f) % SIZE;
+    }
+
+    float sin(const uint32_t &index) const {
+        return m_sinCos[2 * index];
+    }
+
+    float cos(const uint32_t &index) const {
+        return m_sinCos[2 * index + 1];
+    }
+
+   private:
+    VelodyneAzimuthTable()
+        : m_sinCos(2 * SIZE) {
+        for (uint32_t i = 0; i < SIZE; i++) {
+            const double angle = i * M_PI / 18000.0;
+            m_sinCos[2 * i] = static_cast< float >(std::sin(angle));
+            m_sinCos[2 * i + 1] = static_cast< float >(std::cos(angle));
+        }
+    }
+
+   private:
+    std::vector< float > m_sinCos; //interleaved to have both values in the same cache line
+};
+
+/**
+ * Time stamps of a Velodyne sensor: microseconds past the top of the hour,
+ * synchronized to UTC when a GPS receiver is connected.
+ */
+class VelodyneDeviceTime {
+   public:
+    static constexpr uint32_t HOUR = 3600000000u;
+    static constexpr uint32_t MAX_PACKET_GAP = 100000; //larger gaps between two packets are taken as invalid time stamps
+
+    /**
+     * @param later time past the hour.
+     * @param earlier time past the hour.
+     * @return Microseconds from earlier to later, assuming less than an hour in between.
+     */
+    static uint32_t difference(const uint32_t &later, const uint32_t &earlier) {
+        return (later >= earlier) ? (later - earlier) : (later + (HOUR - earlier));
+    }
+
+    /**
+     * @param pastHour time past the hour.
+     * @param reference microseconds since the epoch within half an hour of the sought time.
+     * @return Microseconds since the epoch.
+     */
+    static int64_t toAbsolute(const uint32_t &pastHour, const int64_t &reference) {
+        const int64_t hour = static_cast< int64_t >(HOUR);
+        int64_t absolute = reference - (reference % hour) + pastHour;
+        if (absolute - reference > hour / 2) {
+            absolute -= hour;
+        } else if (reference - absolute > hour / 2) {
+            absolute += hour;
+        }
+        return absolute;
+    }
+};
+
+/**
+ * Interface to be notified when the decoder has completed one revolution
+ * (or one sector of it).
+ */
+class VelodyneFrameListener {
+   public:
+    virtual ~VelodyneFrameListener() {}
+
+    /**
+     * This method is called when a complete scan (or sector) is available;
+     * the frame is reset after this method returns.
+     */
+    virtual void nextFrame() = 0;
+};
+
+/**
+ * Options controlling which representations are built per frame.
+ */
+struct VelodyneDecoderOptions {
+    bool withSPC;  //if SPC is expected
+    uint8_t SPCOption; //0: xyz+intensity; 1: distance+azimuth+vertical angle+intensity
+    bool withCPC;  //if CPC is expected
+    uint8_t CPCIntensityOption; //Only used when CPC is enabled. 0: without intensity; 1: with intensity; 2: both
+    uint8_t numberOfBitsForIntensity; //Range 0-7. Only used when CPC is enabled
+    uint8_t intensityPlacement;  //0: higher bits; 1: lower bits
+    uint8_t distanceEncoding; //0: cm; 1: 2mm
+};
+
+/**
+ * Counters of a VelodyneDecoderCore since its construction.
+ */
+struct VelodyneDecoderCounters {
+    uint64_t packets; //data packets decoded
+    uint64_t badPackets; //payloads that are not 1206 bytes long
+    uint64_t missingPackets; //packets missing according to the azimuth advanced since the previous packet
+    uint64_t truncatedFrames; //frames that dropped returns as the point capacity was reached
+};
+
+/**
+ * VelodyneDecoderCore decodes 1206 bytes Velodyne data packets into a
+ * frame-wise point cloud (SPC layout) and compact point cloud (CPC layout).
+ * The inner loop is specialized at compile time for the sensor model.
+ */
+template < typename Model >
+class VelodyneDecoderCore {
+   public:
+    static constexpr uint32_t PACKET_SIZE = 1206;
+    static constexpr uint8_t NUMBER_OF_BLOCKS = 12;
+    static constexpr uint8_t BLOCK_SIZE = 100;
+    static constexpr uint8_t RETURNS_PER_BLOCK = 32;
+    static constexpr uint8_t RETURNS_PER_FIRING = RETURNS_PER_BLOCK / Model::FIRINGS_PER_BLOCK;
+    static constexpr uint8_t NUMBER_OF_COMPONENTS_PER_POINT = 4; //4 components per vector: (1) cartesian: xyz+intensity; (2) polar: distance+azimuth+vertical angle+intensity
+    static constexpr uint32_t POINT_CAPACITY = Model::MAX_POINT_SIZE * (Model::DUAL_RETURN ? 2 : 1); //the maximum number of points per frame; both returns of each firing are kept in dual return mode
+    static constexpr uint32_t SIZE = POINT_CAPACITY * NUMBER_OF_COMPONENTS_PER_POINT * sizeof(float); //the total size of one frame
+    static constexpr uint32_t TIME_OFFSETS_SIZE = POINT_CAPACITY * sizeof(float); //the size of the time offsets of one frame
+    static constexpr uint32_t RETURN_INDICES_SIZE = POINT_CAPACITY * sizeof(uint8_t); //the size of the return indices of one frame
+    static constexpr uint32_t ORGANISED_POINT_CAPACITY = Model::NUMBER_OF_LASERS * Model::MAX_FIRINGS_PER_ROTATION; //one column per firing of a rotation at the lowest rotation rate
+    static constexpr uint32_t RETURN_MODE_OFFSET = 1204; //first factory byte: 0x37 strongest, 0x38 last, 0x39 dual return
+    static constexpr uint8_t DUAL_RETURN_MODE = 0x39;
+
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    VelodyneDecoderCore(const VelodyneDecoderCore &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    VelodyneDecoderCore &operator=(const VelodyneDecoderCore &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param calibration name of the calibration file.
+     * @param options representations to be built.
+     * @param listener to be notified for each complete frame.
+     */
+    VelodyneDecoderCore(const std::string &calibration, const VelodyneDecoderOptions &options, VelodyneFrameListener &listener)
+        : m_options(options)
+        , m_listener(listener)
+        , m_calibration()
+        , m_mask(0)
+        , m_azimuthTable(VelodyneAzimuthTable::getInstance())
+        , m_useLookupTables(true)
+        , m_kernel(VelodyneProjection::best())
+        , m_buffer(NULL)
+        , m_segment(NULL)
+        , m_pointCapacity(POINT_CAPACITY)
+        , m_timeOffsets(NULL)
+        , m_returnIndices(NULL)
+        , m_returnIndex(0)
+        , m_dualReturn(false)
+        , m_organised(false)
+        , m_columnStarted(false)
+        , m_rowOfSensor()
+        , m_pointIndexSPC(0)
+        , m_pointIndexCPC(0)
+        , m_startID(0)
+        , m_previousAzimuth(0.0f)
+        , m_currentAzimuth(0.0f)
+        , m_nextAzimuth(0.0f)
+        , m_deltaAzimuth(0.0f)
+        , m_startAzimuth(0.0f)
+        , m_endAzimuth(0.0f)
+        , m_sectorSize(0.0f)
+        , m_haveAzimuth(false)
+        , m_packetAzimuth(0)
+        , m_havePacketAzimuth(false)
+        , m_truncated(false)
+        , m_counters()
+        , m_packetTime(0)
+        , m_rawPacketTime(0)
+        , m_havePacketTime(false)
+        , m_hasDeviceTime(false)
+        , m_firingTime(0)
+        , m_lastFiringTime(0)
+        , m_frameStartTime(0)
+        , m_frameDuration(0)
+        , m_haveFrameStartTime(false)
+        , m_entriesPerAzimuth()
+        , m_distancesNoIntensity()
+        , m_distancesWithIntensity()
+        , m_rawDistance()
+        , m_intensity() {
+        m_calibration.load(calibration);
+        for (uint8_t layer = 0; layer < Model::NUMBER_OF_LASERS; layer++) {
+            m_rowOfSensor[m_calibration.sensorOrderIndex[layer]] = layer;
+        }
+
+        if (m_options.withSPC) {
+            //Create memory for temporary storage of point cloud data for each frame
+            m_buffer = static_cast< float * >(malloc(SIZE));
+            if (m_buffer == NULL) {
+                throw std::bad_alloc();
+            }
+            m_segment = m_buffer;
+        }
+
+        if (m_options.numberOfBitsForIntensity != 0) {
+            m_mask = 0xFFFF;
+            if (m_options.intensityPlacement == 0) {//higher bits for intensity
+                m_mask = m_mask >> m_options.numberOfBitsForIntensity;
+            } else {
+                m_mask = static_cast< uint16_t >(m_mask << m_options.numberOfBitsForIntensity);
+            }
+        }
+
+        m_entriesPerAzimuth.fill(0);
+        for (uint8_t layer = 0; layer < Model::NUMBER_OF_LASERS; layer++) {
+            m_entriesPerAzimuth[Model::compactPointCloudPart(layer)]++;
+        }
+
+        //Reserve the distances of a full frame once; the buffers are only cleared between frames
+        if (m_options.withCPC) {
+            for (uint8_t part = 0; part < Model::NUMBER_OF_CPC_PARTS; part++) {
+                if (m_options.CPCIntensityOption == 0 || m_options.CPCIntensityOption == 2) {
+                    m_distancesNoIntensity[part].reserve(Model::MAX_POINT_SIZE * 2);
+                }
+                if (m_options.CPCIntensityOption == 1 || m_options.CPCIntensityOption == 2) {
+                    m_distancesWithIntensity[part].reserve(Model::MAX_POINT_SIZE * 2);
+                }
+            }
+        }
+    }
+
+    virtual ~VelodyneDecoderCore() {
+        free(m_buffer);
+        free(m_timeOffsets);
+        free(m_returnIndices);
+    }
+
+    /**
+     * This method decodes one data packet.
+     *
+     * @param payload UDP payload.
+     * @param length length of the payload.
+     * @return true if the payload was a data packet.
+     */
+    bool nextPacket(const uint8_t *payload, const uint32_t &length) {
+        if (length != PACKET_SIZE) {
+            m_counters.badPackets++;
+            return false;
+        }
+
+        //In dual return mode, two consecutive blocks hold the last and the strongest return of the same firings
+        m_dualReturn = Model::DUAL_RETURN && (payload[RETURN_MODE_OFFSET] == DUAL_RETURN_MODE);
+        const uint8_t blocksPerFiring = m_dualReturn ? 2 : 1;
+        m_counters.packets++;
+        countMissingPackets(payload, blocksPerFiring);
+
+        //The last 6 bytes: 4 bytes timestamp of the first firing (little endian, microseconds past the hour) and 2 factory bytes
+        updatePacketTime(readUint32(payload + NUMBER_OF_BLOCKS * BLOCK_SIZE), Model::FIRINGS_PER_PACKET / blocksPerFiring);
+
+        //The payload consists of 12 blocks with 100 bytes each. Decode each block (or each pair of blocks in dual return mode) separately.
+        for (uint8_t blockID = 0; blockID < NUMBER_OF_BLOCKS; blockID = static_cast< uint8_t >(blockID + blocksPerFiring)) {
+            const uint8_t *block = payload + blockID * BLOCK_SIZE;
+            const uint8_t sequence = static_cast< uint8_t >(blockID / blocksPerFiring);
+
+            //Flag: 0xEEFF for upper block or 0xDDFF for lower block (2 bytes)
+            const uint8_t laserOffset = Model::isLowerBlock(readUint16(block)) ? RETURNS_PER_BLOCK : 0;
+
+            //Decode azimuth information: 2 bytes, little endian, in 0.01 degree. Due to azimuth interpolation, the azimuth of blocks 1-11 is already decoded in the middle of the previous block.
+            if (Model::FIRINGS_PER_BLOCK == 1 || blockID == 0) {
+                m_currentAzimuth = static_cast< float >(readUint16(block + 2) / 100.0f);
+            } else {
+                m_currentAzimuth = m_nextAzimuth;
+                if (m_currentAzimuth > 360.0f) {
+                    m_currentAzimuth -= 360.0f;
+                }
+            }
+            m_firingTime = getFiringTime(sequence, 0);
+            if (!m_haveFrameStartTime) {
+                m_frameStartTime = m_firingTime;
+                m_haveFrameStartTime = true;
+            }
+            if (m_currentAzimuth < m_previousAzimuth) {
+                completeFrame(); //Send a complete scan as one frame
+            } else if (crossesSector()) {
+                completeFrame(); //Send the completed sector
+            }
+            m_previousAzimuth = m_currentAzimuth;
+            m_haveAzimuth = true;
+
+            for (uint8_t firing = 0; firing < Model::FIRINGS_PER_BLOCK; firing++) {
+                if (firing > 0) {
+                    m_firingTime = getFiringTime(sequence, firing);
+                    interpolateAzimuth(payload, blockID, blocksPerFiring);
+                }
+
+                const uint32_t azimuthIndex = VelodyneAzimuthTable::index(m_currentAzimuth);
+                const float sinAzimuth = m_azimuthTable.sin(azimuthIndex);
+                const float cosAzimuth = m_azimuthTable.cos(azimuthIndex);
+                const float timeOffset = static_cast< float >(VelodyneDeviceTime::difference(m_firingTime, m_frameStartTime));
+                //Both returns of a firing share its azimuth and time; the strongest return (second block) is the one kept for CPC and the organised layout
+                for (m_returnIndex = static_cast< uint8_t >(m_organised ? blocksPerFiring - 1 : 0); m_returnIndex < blocksPerFiring; m_returnIndex++) {
+                    const uint8_t *data = block + m_returnIndex * BLOCK_SIZE + 4 + firing * RETURNS_PER_FIRING * 3;
+                    if (m_organised) {
+                        organiseFiring(laserOffset, data, sinAzimuth, cosAzimuth, timeOffset);
+                    } else if (m_kernel != VelodyneProjection::SCALAR && m_useLookupTables && m_options.withSPC && m_options.SPCOption == 0
+                        && m_pointIndexSPC + RETURNS_PER_FIRING <= m_pointCapacity) {
+                        projectFiring(laserOffset, data, sinAzimuth, cosAzimuth, timeOffset);
+                    } else {
+                        for (uint8_t counter = 0; counter < RETURNS_PER_FIRING; counter++) {
+                            decodeReturn(laserOffset + counter, data + counter * 3, sinAzimuth, cosAzimuth, timeOffset + counter * Model::LASER_DURATION);
+                        }
+                    }
+                }
+                m_lastFiringTime = m_firingTime;
+
+                if (m_options.withCPC && (laserOffset + RETURNS_PER_FIRING == Model::NUMBER_OF_LASERS)) {
+                    appendFiringToCPC();
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+     * This method selects the projection of cartesian points: With lookup
+     * tables (default), the azimuth is rounded to 0.01 degree and each point
+     * is computed by multiply-adds only; without, sin/cos are evaluated per
+     * point as in the reference implementation.
+     *
+     * @param useLookupTables true to use the precomputed tables.
+     */
+    void setLookupTables(const bool &useLookupTables) {
+        m_useLookupTables = useLookupTables;
+    }
+
+    bool hasLookupTables() const {
+        return m_useLookupTables;
+    }
+
+    /**
+     * This method enables the time offset channel: for each point of the
+     * shared point cloud, the microseconds since the start of the frame are
+     * recorded as float. Requires SPC; must be called between frames.
+     *
+     * @param timeOffsets true to record the time offset of each point.
+     * @return true if the channel is recorded.
+     */
+    bool setTimeOffsets(const bool &timeOffsets) {
+        if (timeOffsets && m_timeOffsets == NULL && m_options.withSPC) {
+            m_timeOffsets = static_cast< float * >(malloc(m_pointCapacity * sizeof(float)));
+            if (m_timeOffsets == NULL) {
+                throw std::bad_alloc();
+            }
+        } else if (!timeOffsets) {
+            free(m_timeOffsets);
+            m_timeOffsets = NULL;
+        }
+        return (m_timeOffsets != NULL);
+    }
+
+    /**
+     * @return Microseconds since the start of the frame of each point of the current frame; NULL if disabled.
+     */
+    const float *getTimeOffsets() const {
+        return m_timeOffsets;
+    }
+
+    /**
+     * This method enables the return index channel: for each point of the
+     * shared point cloud, the return it belongs to is recorded as uint8_t
+     * (0: single return mode or last return; 1: strongest return in dual
+     * return mode). Requires SPC; must be called between frames.
+     *
+     * @param returnIndices true to record the return index of each point.
+     * @return true if the channel is recorded.
+     */
+    bool setReturnIndices(const bool &returnIndices) {
+        if (returnIndices && m_returnIndices == NULL && m_options.withSPC) {
+            m_returnIndices = static_cast< uint8_t * >(malloc(m_pointCapacity * sizeof(uint8_t)));
+            if (m_returnIndices == NULL) {
+                throw std::bad_alloc();
+            }
+        } else if (!returnIndices) {
+            free(m_returnIndices);
+            m_returnIndices = NULL;
+        }
+        return (m_returnIndices != NULL);
+    }
+
+    /**
+     * @return Return index of each point of the current frame; NULL if disabled.
+     */
+    const uint8_t *getReturnIndices() const {
+        return m_returnIndices;
+    }
+
+    /**
+     * @return true if the last packet was sent in dual return mode.
+     */
+    bool isDualReturn() const {
+        return m_dualReturn;
+    }
+
+    /**
+     * This method selects the organised layout of the shared point cloud:
+     * each firing yields one column of NUMBER_OF_LASERS points, ordered by
+     * increasing vertical angle of the lasers as in the calibration; returns
+     * that are not valid have NaN coordinates and intensity 0. The columns
+     * are stored one after another, i.e. the point of row r (laser) in
+     * column c (firing) is at index c * NUMBER_OF_LASERS + r (column-major).
+     * In dual return mode, the strongest return is kept. The point capacity
+     * grows to ORGANISED_POINT_CAPACITY so that a rotation at the lowest
+     * rotation rate fits. Requires SPC; must be called between frames and
+     * before an external segment is set.
+     *
+     * @param organised true for the organised layout; false to keep only valid returns (default).
+     * @return true if the layout is organised.
+     */
+    bool setOrganised(const bool &organised) {
+        m_organised = organised && m_options.withSPC;
+        const uint32_t capacity = (m_organised && ORGANISED_POINT_CAPACITY > POINT_CAPACITY) ? ORGANISED_POINT_CAPACITY : POINT_CAPACITY;
+        if (capacity != m_pointCapacity) {
+            const bool internal = (m_segment == m_buffer);
+            m_buffer = reallocate(m_buffer, capacity * NUMBER_OF_COMPONENTS_PER_POINT);
+            m_segment = internal ? m_buffer : m_segment;
+            m_timeOffsets = reallocate(m_timeOffsets, capacity);
+            m_returnIndices = reallocate(m_returnIndices, capacity);
+            m_pointCapacity = capacity;
+        }
+        return m_organised;
+    }
+
+    bool isOrganised() const {
+        return m_organised;
+    }
+
+    /**
+     * @return Maximum number of points per frame: POINT_CAPACITY, or ORGANISED_POINT_CAPACITY if larger in the organised layout.
+     */
+    uint32_t getPointCapacity() const {
+        return m_pointCapacity;
+    }
+
+    /**
+     * @return true if the last packet carried a plausible time stamp of the sensor; otherwise the packet times are derived from the firing rate.
+     */
+    bool hasDeviceTime() const {
+        return m_hasDeviceTime;
+    }
+
+    /**
+     * @return Time of the first firing of the current frame in microseconds past the hour.
+     */
+    uint32_t getFrameStartTime() const {
+        return m_frameStartTime;
+    }
+
+    /**
+     * @return Microseconds from the first to the last firing of the frame; valid in VelodyneFrameListener::nextFrame().
+     */
+    uint32_t getFrameDuration() const {
+        return m_frameDuration;
+    }
+
+    /**
+     * This method selects the kernel projecting whole firings with lookup
+     * tables. The widest kernel supported by the CPU is chosen by default;
+     * unsupported kernels fall back to the scalar path.
+     *
+     * @param kernel projection kernel.
+     */
+    void setProjectionKernel(const VelodyneProjection::Kernel &kernel) {
+        m_kernel = VelodyneProjection::isSupported(kernel) ? kernel : VelodyneProjection::SCALAR;
+    }
+
+    VelodyneProjection::Kernel getProjectionKernel() const {
+        return m_kernel;
+    }
+
+    /**
+     * This method selects the calibration model (see VelodyneCalibration):
+     * all corrections of the HDL-64E S2/S3 calibration (default) or the
+     * basic model of VeloView 3.
+     *
+     * @param fullCalibration true for the full model.
+     */
+    void setFullCalibration(const bool &fullCalibration) {
+        m_calibration.setFullModel(fullCalibration);
+    }
+
+    bool hasFullCalibration() const {
+        return m_calibration.fullModel;
+    }
+
+    const VelodyneCalibration< Model::NUMBER_OF_LASERS > &getCalibration() const {
+        return m_calibration;
+    }
+
+    const VelodyneDecoderOptions &getOptions() const {
+        return m_options;
+    }
+
+    /**
+     * This method sets the memory the points are decoded into, e.g. a slot
+     * in shared memory; it must be called between frames and hold
+     * getPointCapacity() points.
+     *
+     * @param segment memory for the points of the next frame; NULL for the internal buffer.
+     */
+    void setSegment(float *segment) {
+        if (m_buffer != NULL) {
+            m_segment = (segment != NULL) ? segment : m_buffer;
+        }
+    }
+
+    /**
+     * @return Points of the current frame (NUMBER_OF_COMPONENTS_PER_POINT floats each).
+     */
+    const float *getSegment() const {
+        return m_segment;
+    }
+
+    float *getSegment() {
+        return m_segment;
+    }
+
+    uint32_t getNumberOfPoints() const {
+        return m_pointIndexSPC;
+    }
+
+    /**
+     * @return true if the completed frame dropped returns as the point capacity (or MAX_POINT_SIZE points of the compact point cloud) was reached; valid in VelodyneFrameListener::nextFrame().
+     */
+    bool isTruncated() const {
+        return m_truncated;
+    }
+
+    const VelodyneDecoderCounters &getCounters() const {
+        return m_counters;
+    }
+
+    /**
+     * This method lets the decoder complete a frame whenever the azimuth
+     * enters the next sector of the given size (sectors start at multiples
+     * of it from 0 degrees) instead of once per rotation; the last sector
+     * of a rotation ends at the wrap around. Must be called between frames.
+     *
+     * @param sectorSize degrees per sector; 0 (or 360 and more) for complete rotations.
+     */
+    void setSectorSize(const float &sectorSize) {
+        m_sectorSize = (sectorSize > 0.0f && sectorSize < 360.0f) ? sectorSize : 0.0f;
+    }
+
+    float getSectorSize() const {
+        return m_sectorSize;
+    }
+
+    float getStartAzimuth() const {
+        return m_startAzimuth;
+    }
+
+    float getEndAzimuth() const {
+        return m_endAzimuth;
+    }
+
+    uint8_t getEntriesPerAzimuth(const uint8_t &part) const {
+        return m_entriesPerAzimuth[part];
+    }
+
+    /**
+     * @param part CPC part (0 .. Model::NUMBER_OF_CPC_PARTS - 1).
+     * @param withIntensity distances with or without intensity bits.
+     * @return Big endian distances of the current frame; valid until the next frame starts.
+     */
+    const std::string &getCompactPointCloud(const uint8_t &part, const bool &withIntensity) const {
+        return (withIntensity ? m_distancesWithIntensity[part] : m_distancesNoIntensity[part]);
+    }
+
+   private:
+    //Resizes a buffer to the given number of elements; buffers that are not allocated stay NULL
+    template < typename T >
+    static T *reallocate(T *buffer, const uint32_t &size) {
+        if (buffer == NULL) {
+            return NULL;
+        }
+        T *resized = static_cast< T * >(realloc(buffer, size * sizeof(T)));
+        if (resized == NULL) {
+            throw std::bad_alloc(); //the buffer is kept
+        }
+        return resized;
+    }
+
+    static uint16_t readUint16(const uint8_t *p) {
+        return static_cast< uint16_t >(p[0] | (p[1] << 8));
+    }
+
+    static uint32_t readUint32(const uint8_t *p) {
+        return static_cast< uint32_t >(p[0]) | (static_cast< uint32_t >(p[1]) << 8) | (static_cast< uint32_t >(p[2]) << 16) | (static_cast< uint32_t >(p[3]) << 24);
+    }
+
+    //Sensors without GPS time stamps (e.g. older HDL-64E firmware sending status bytes instead) get the packet time from the firing rate
+    void updatePacketTime(const uint32_t &raw, const uint8_t &firingsPerPacket) {
+        const uint32_t gap = VelodyneDeviceTime::difference(raw, m_rawPacketTime);
+        m_hasDeviceTime = m_havePacketTime && (raw < VelodyneDeviceTime::HOUR) && (gap > 0) && (gap <= VelodyneDeviceTime::MAX_PACKET_GAP);
+        if (m_hasDeviceTime || !m_havePacketTime) {
+            m_packetTime = (raw < VelodyneDeviceTime::HOUR) ? raw : 0;
+        } else {
+            m_packetTime = (m_packetTime + static_cast< uint32_t >(firingsPerPacket * Model::FIRING_DURATION + 0.5f)) % VelodyneDeviceTime::HOUR;
+        }
+        m_rawPacketTime = raw;
+        m_havePacketTime = true;
+    }
+
+    //Compares the azimuth advanced since the previous packet with the advance of one packet as derived from the azimuth span of this packet
+    void countMissingPackets(const uint8_t *payload, const uint8_t &blocksPerFiring) {
+        const uint32_t azimuth = readUint16(payload + 2) % 36000; //0.01 degree
+        const uint8_t lastBlock = static_cast< uint8_t >(NUMBER_OF_BLOCKS - blocksPerFiring);
+        const uint32_t span = (readUint16(payload + lastBlock * BLOCK_SIZE + 2) % 36000 + 36000 - azimuth) % 36000;
+        const uint32_t firingsOfSpan = Model::firingSequence(static_cast< uint8_t >(lastBlock / blocksPerFiring), 0);
+        const uint32_t firingsPerPacket = Model::FIRINGS_PER_PACKET / blocksPerFiring;
+        if (m_havePacketAzimuth && span > 0) {
+            const uint32_t advance = (azimuth + 36000 - m_packetAzimuth) % 36000;
+            const uint32_t packetAdvance = span * firingsPerPacket; //in units of 1 / firingsOfSpan
+            const uint32_t packets = (2 * advance * firingsOfSpan + packetAdvance) / (2 * packetAdvance);
+            if (packets > 1) {
+                m_counters.missingPackets += packets - 1;
+            }
+        }
+        m_packetAzimuth = azimuth;
+        m_havePacketAzimuth = true;
+    }
+
+    //blockID counts the pairs of blocks in dual return mode
+    uint32_t getFiringTime(const uint8_t &blockID, const uint8_t &firing) const {
+        return (m_packetTime + static_cast< uint32_t >(Model::firingSequence(blockID, firing) * Model::FIRING_DURATION + 0.5f)) % VelodyneDeviceTime::HOUR;
+    }
+
+    //The azimuth is interpolated towards the next block with other firings, i.e. blocksPerFiring blocks ahead
+    void interpolateAzimuth(const uint8_t *payload, const uint8_t &blockID, const uint8_t &blocksPerFiring) {
+        if (blockID + blocksPerFiring < NUMBER_OF_BLOCKS) {
+            m_nextAzimuth = static_cast< float >(readUint16(payload + (blockID + blocksPerFiring) * BLOCK_SIZE + 2) / 100.0f);
+            if (m_nextAzimuth < m_currentAzimuth) {
+                m_nextAzimuth += 360.0f;
+            }
+            m_deltaAzimuth = (m_nextAzimuth - m_currentAzimuth) / 2.0f;
+        }
+        m_currentAzimuth += m_deltaAzimuth;
+        if (m_currentAzimuth > 360.0f) {
+            m_currentAzimuth -= 360.0f;
+            completeFrame(); //Send a complete scan as one frame
+        } else if (crossesSector()) {
+            completeFrame(); //Send the completed sector
+        }
+        m_previousAzimuth = m_currentAzimuth;
+    }
+
+    //Sectors start at multiples of the sector size; the wrap around is handled as end of a complete scan
+    bool crossesSector() const {
+        return m_haveAzimuth && (m_sectorSize > 0.0f) && (static_cast< uint32_t >(m_currentAzimuth / m_sectorSize) != static_cast< uint32_t >(m_previousAzimuth / m_sectorSize));
+    }
+
+    //Computes the point of one return; returns closer than 1 m are not valid
+    bool projectReturn(const uint8_t &sensorID, const uint16_t &raw, const uint8_t &intensity, const float &sinAzimuth, const float &cosAzimuth, float *point) const {
+        const float distance = Model::toDistance(raw) + m_calibration.distCorrection[sensorID];
+        if (distance <= 1.0f) {
+            return false;
+        }
+        if (m_options.SPCOption == 0) {//xyz+intensity
+            float sinRotated;
+            float cosRotated;
+            float sinVertical;
+            float cosVertical;
+            if (m_useLookupTables) {//sin/cos(azimuth - rotCorrection) by angle difference
+                sinRotated = sinAzimuth * m_calibration.cosRotation[sensorID] - cosAzimuth * m_calibration.sinRotation[sensorID];
+                cosRotated = cosAzimuth * m_calibration.cosRotation[sensorID] + sinAzimuth * m_calibration.sinRotation[sensorID];
+                sinVertical = m_calibration.sinVertical[sensorID];
+                cosVertical = m_calibration.cosVertical[sensorID];
+            } else {
+                const float verticalAngle = m_calibration.vertCorrection[sensorID] * TO_RADIAN;
+                const float azimuth = (m_currentAzimuth - m_calibration.rotCorrection[sensorID]) * TO_RADIAN;
+                sinRotated = std::sin(azimuth);
+                cosRotated = std::cos(azimuth);
+                sinVertical = std::sin(verticalAngle);
+                cosVertical = std::cos(verticalAngle);
+            }
+            const float horizOffset = m_calibration.horizOffsetCorrection[sensorID];
+            const float xyVertOffset = m_calibration.xyVertOffset[sensorID];
+            const float xyDistance = distance * cosVertical - xyVertOffset;
+            point[0] = xyDistance * sinRotated - horizOffset * cosRotated;
+            point[1] = xyDistance * cosRotated + horizOffset * sinRotated;
+            point[2] = distance * sinVertical + m_calibration.zVertOffset[sensorID];
+            if (m_calibration.twoPointCorrection) {//the distance corrections along x and y depend on the uncorrected point
+                const float distanceX = distance + m_calibration.distSlopeX[sensorID] * std::fabs(point[0]) + m_calibration.distOffsetX[sensorID];
+                const float distanceY = distance + m_calibration.distSlopeY[sensorID] * std::fabs(point[1]) + m_calibration.distOffsetY[sensorID];
+                point[0] = (distanceX * cosVertical - xyVertOffset) * sinRotated - horizOffset * cosRotated;
+                point[1] = (distanceY * cosVertical - xyVertOffset) * cosRotated + horizOffset * sinRotated;
+                point[2] = distanceY * sinVertical + m_calibration.zVertOffset[sensorID];
+            }
+        } else {//distance+azimuth+vertical angle+intensity
+            point[0] = distance;
+            point[1] = m_currentAzimuth;
+            point[2] = m_calibration.vertCorrection[sensorID];
+        }
+        point[3] = m_calibration.intensityCorrection ? m_calibration.calibrateIntensity(sensorID, raw, intensity) : static_cast< float >(intensity);
+        return true;
+    }
+
+    //Keeps the distance and the (calibrated) intensity of one return for the compact point cloud
+    void keepForCPC(const uint8_t &sensorID, const uint8_t *data) {
+        const uint16_t raw = readUint16(data);
+        m_rawDistance[sensorID] = raw;
+        m_intensity[sensorID] = m_calibration.intensityCorrection ? static_cast< uint8_t >(m_calibration.calibrateIntensity(sensorID, raw, data[2]) + 0.5f) : data[2];
+    }
+
+    void decodeReturn(const uint8_t &sensorID, const uint8_t *data, const float &sinAzimuth, const float &cosAzimuth, const float &timeOffset) {
+        const uint16_t raw = readUint16(data);
+        const uint8_t intensity = data[2];
+
+        if (m_options.withSPC && m_pointIndexSPC < m_pointCapacity && projectReturn(sensorID, raw, intensity, sinAzimuth, cosAzimuth, m_segment + m_startID)) {
+            if (m_timeOffsets != NULL) {
+                m_timeOffsets[m_pointIndexSPC] = timeOffset;
+            }
+            if (m_returnIndices != NULL) {
+                m_returnIndices[m_pointIndexSPC] = m_returnIndex;
+            }
+            m_pointIndexSPC++;
+            m_startID += NUMBER_OF_COMPONENTS_PER_POINT;
+        } else if (m_options.withSPC && m_pointIndexSPC >= m_pointCapacity) {
+            m_truncated = true;
+        }
+
+        if (m_options.withCPC) {
+            keepForCPC(sensorID, data);
+        }
+    }
+
+    VelodyneFiring getFiring(const uint8_t &laserOffset, const uint8_t *data, const float &sinAzimuth, const float &cosAzimuth) const {
+        VelodyneFiring firing;
+        firing.data = data;
+        firing.numberOfReturns = RETURNS_PER_FIRING;
+        firing.sinAzimuth = sinAzimuth;
+        firing.cosAzimuth = cosAzimuth;
+        firing.distanceScale = Model::DISTANCE_SCALE;
+        firing.distanceDivisor = Model::DISTANCE_DIVISOR;
+        firing.distCorrection = m_calibration.distCorrection.data() + laserOffset;
+        firing.cosVertical = m_calibration.cosVertical.data() + laserOffset;
+        firing.sinVertical = m_calibration.sinVertical.data() + laserOffset;
+        firing.cosRotation = m_calibration.cosRotation.data() + laserOffset;
+        firing.sinRotation = m_calibration.sinRotation.data() + laserOffset;
+        firing.horizOffsetCorrection = m_calibration.horizOffsetCorrection.data() + laserOffset;
+        firing.xyVertOffset = m_calibration.xyVertOffset.data() + laserOffset;
+        firing.zVertOffset = m_calibration.zVertOffset.data() + laserOffset;
+        firing.twoPointCorrection = m_calibration.twoPointCorrection;
+        firing.distSlopeX = m_calibration.distSlopeX.data() + laserOffset;
+        firing.distOffsetX = m_calibration.distOffsetX.data() + laserOffset;
+        firing.distSlopeY = m_calibration.distSlopeY.data() + laserOffset;
+        firing.distOffsetY = m_calibration.distOffsetY.data() + laserOffset;
+        firing.intensityCorrection = m_calibration.intensityCorrection;
+        firing.focalOffset = m_calibration.focalOffset.data() + laserOffset;
+        firing.focalSlope = m_calibration.focalSlope.data() + laserOffset;
+        firing.minIntensity = m_calibration.minIntensity.data() + laserOffset;
+        firing.maxIntensity = m_calibration.maxIntensity.data() + laserOffset;
+        return firing;
+    }
+
+    //Projects all returns of one firing at once; the segment must have room for all of them
+    void projectFiring(const uint8_t &laserOffset, const uint8_t *data, const float &sinAzimuth, const float &cosAzimuth, const float &timeOffset) {
+        uint32_t kept = 0;
+        const uint32_t numberOfPoints = VelodyneProjection::project(m_kernel, getFiring(laserOffset, data, sinAzimuth, cosAzimuth), m_segment + m_startID, kept);
+        if (m_timeOffsets != NULL) {
+            float *timeOffsets = m_timeOffsets + m_pointIndexSPC;
+            for (uint8_t counter = 0; counter < RETURNS_PER_FIRING; counter++) {
+                if ((kept >> counter) & 1) {
+                    *timeOffsets++ = timeOffset + counter * Model::LASER_DURATION;
+                }
+            }
+        }
+        if (m_returnIndices != NULL) {
+            memset(m_returnIndices + m_pointIndexSPC, m_returnIndex, numberOfPoints);
+        }
+        m_pointIndexSPC += numberOfPoints;
+        m_startID += numberOfPoints * NUMBER_OF_COMPONENTS_PER_POINT;
+
+        if (m_options.withCPC) {
+            for (uint8_t counter = 0; counter < RETURNS_PER_FIRING; counter++) {
+                keepForCPC(static_cast< uint8_t >(laserOffset + counter), data + counter * 3);
+            }
+        }
+    }
+
+    //Writes the returns of one firing into the rows of the current column; returns that are not valid get NaN coordinates.
+    //The HDL-64E fires its lower block once per three upper blocks: a lower block joins the column of the next upper block.
+    void organiseFiring(const uint8_t &laserOffset, const uint8_t *data, const float &sinAzimuth, const float &cosAzimuth, const float &timeOffset) {
+        if (laserOffset > 0 && m_columnStarted) {
+            closeColumn(false, timeOffset); //two lower blocks in a row
+        }
+        if (m_pointIndexSPC + Model::NUMBER_OF_LASERS <= m_pointCapacity) {
+            float projected[RETURNS_PER_FIRING * NUMBER_OF_COMPONENTS_PER_POINT];
+            uint32_t kept = 0;
+            if (m_kernel != VelodyneProjection::SCALAR && m_useLookupTables && m_options.SPCOption == 0) {
+                VelodyneProjection::project(m_kernel, getFiring(laserOffset, data, sinAzimuth, cosAzimuth), projected, kept);
+            } else {
+                float *point = projected;
+                for (uint8_t counter = 0; counter < RETURNS_PER_FIRING; counter++) {
+                    if (projectReturn(laserOffset + counter, readUint16(data + counter * 3), data[counter * 3 + 2], sinAzimuth, cosAzimuth, point)) {
+                        kept |= 1u << counter;
+                        point += NUMBER_OF_COMPONENTS_PER_POINT;
+                    }
+                }
+            }
+
+            const float *next = projected;
+            for (uint8_t counter = 0; counter < RETURNS_PER_FIRING; counter++) {
+                const uint32_t index = m_pointIndexSPC + m_rowOfSensor[laserOffset + counter];
+                if ((kept >> counter) & 1) {
+                    memcpy(m_segment + index * NUMBER_OF_COMPONENTS_PER_POINT, next, NUMBER_OF_COMPONENTS_PER_POINT * sizeof(float));
+                    next += NUMBER_OF_COMPONENTS_PER_POINT;
+                } else {
+                    setInvalid(index, timeOffset);
+                }
+                if (m_timeOffsets != NULL) {
+                    m_timeOffsets[index] = timeOffset + counter * Model::LASER_DURATION;
+                }
+                if (m_returnIndices != NULL) {
+                    m_returnIndices[index] = m_returnIndex;
+                }
+            }
+        }
+
+        if (laserOffset == 0) {
+            closeColumn(true, timeOffset);
+        } else {
+            m_columnStarted = true;
+        }
+
+        if (m_options.withCPC) {
+            for (uint8_t counter = 0; counter < RETURNS_PER_FIRING; counter++) {
+                keepForCPC(static_cast< uint8_t >(laserOffset + counter), data + counter * 3);
+            }
+        }
+    }
+
+    //Completes the current column with NaN for the rows no block was decoded for and starts the next one
+    void closeColumn(const bool &haveUpper, const float &timeOffset) {
+        if (m_pointIndexSPC + Model::NUMBER_OF_LASERS <= m_pointCapacity) {
+            const uint8_t first = haveUpper ? RETURNS_PER_FIRING : 0;
+            const uint8_t last = m_columnStarted ? RETURNS_PER_FIRING : Model::NUMBER_OF_LASERS;
+            for (uint8_t sensorID = first; sensorID < last; sensorID++) {
+                setInvalid(m_pointIndexSPC + m_rowOfSensor[sensorID], timeOffset);
+            }
+            m_pointIndexSPC += Model::NUMBER_OF_LASERS;
+            m_startID += Model::NUMBER_OF_LASERS * NUMBER_OF_COMPONENTS_PER_POINT;
+        } else {
+            m_truncated = true;
+        }
+        m_columnStarted = false;
+    }
+
+    void setInvalid(const uint32_t &index, const float &timeOffset) {
+        float *point = m_segment + index * NUMBER_OF_COMPONENTS_PER_POINT;
+        point[0] = std::numeric_limits< float >::quiet_NaN();
+        point[1] = std::numeric_limits< float >::quiet_NaN();
+        point[2] = std::numeric_limits< float >::quiet_NaN();
+        point[3] = 0.0f;
+        if (m_timeOffsets != NULL) {
+            m_timeOffsets[index] = timeOffset;
+        }
+        if (m_returnIndices != NULL) {
+            m_returnIndices[index] = m_returnIndex;
+        }
+    }
+
+    void appendFiringToCPC() {
+        //Only complete firings are added as long as the maximum number of points of the current frame has not been reached
+        if (m_pointIndexCPC + Model::NUMBER_OF_LASERS > Model::MAX_POINT_SIZE) {
+            m_truncated = true;
+            return;
+        }
+        m_pointIndexCPC += Model::NUMBER_OF_LASERS;
+
+        const bool noIntensity = (m_options.CPCIntensityOption == 0 || m_options.CPCIntensityOption == 2);
+        const bool withIntensity = (m_options.CPCIntensityOption == 1 || m_options.CPCIntensityOption == 2);
+        const uint8_t bits = m_options.numberOfBitsForIntensity;
+
+        //Grow each buffer by the entries of this firing (within the reserved capacity) and store into it directly
+        std::array< char *, Model::NUMBER_OF_CPC_PARTS > outNoIntensity;
+        std::array< char *, Model::NUMBER_OF_CPC_PARTS > outWithIntensity;
+        for (uint8_t part = 0; part < Model::NUMBER_OF_CPC_PARTS; part++) {
+            outNoIntensity[part] = noIntensity ? grow(m_distancesNoIntensity[part], m_entriesPerAzimuth[part]) : NULL;
+            outWithIntensity[part] = withIntensity ? grow(m_distancesWithIntensity[part], m_entriesPerAzimuth[part]) : NULL;
+        }
+
+        //Distance values are ordered based on vertical angle
+        for (uint8_t layer = 0; layer < Model::NUMBER_OF_LASERS; layer++) {
+            const uint8_t sensorID = m_calibration.sensorOrderIndex[layer];
+            const uint8_t part = Model::compactPointCloudPart(layer);
+
+            //Distance with resolution 2mm or 1cm
+            uint16_t distance = m_rawDistance[sensorID];
+            if (m_options.distanceEncoding == 0) {
+                distance = distance / 5;  //Store distance with resolution 1cm instead
+            }
+
+            if (noIntensity) {
+                outNoIntensity[part] = writeBigEndian(outNoIntensity[part], distance);
+            }
+
+            if (withIntensity) {
+                uint16_t intensityLevel = m_intensity[sensorID];
+                uint16_t value = 0;
+                if (m_options.intensityPlacement == 0) {//higher bits for intensity
+                    if (distance <= m_mask) {//m_mask determines the number of bits for the covered distance. Distance longer than that should return 0.
+                        intensityLevel = intensityLevel >> (8 - bits);
+                        value = static_cast< uint16_t >((intensityLevel << (16 - bits)) + (distance & m_mask));
+                    }
+                } else {//lower bits for intensity
+                    intensityLevel = intensityLevel >> (8 - bits);
+                    value = static_cast< uint16_t >((distance & m_mask) + intensityLevel); //(16-n) bits for distance + n bits for intensity
+                }
+                outWithIntensity[part] = writeBigEndian(outWithIntensity[part], value);
+            }
+        }
+    }
+
+    static char *grow(std::string &distances, const uint8_t &entries) {
+        const std::string::size_type length = distances.size();
+        distances.resize(length + entries * 2);
+        return &distances[length];
+    }
+
+    static char *writeBigEndian(char *out, const uint16_t &value) {
+        out[0] = static_cast< char >(value >> 8);
+        out[1] = static_cast< char >(value & 0xFF);
+        return out + 2;
+    }
+
+    void completeFrame() {
+        if (m_columnStarted) {
+            closeColumn(false, static_cast< float >(VelodyneDeviceTime::difference(m_lastFiringTime, m_frameStartTime)));
+        }
+        m_endAzimuth = m_previousAzimuth;
+        m_frameDuration = VelodyneDeviceTime::difference(m_lastFiringTime, m_frameStartTime);
+        if (m_truncated) {
+            m_counters.truncatedFrames++;
+        }
+        m_listener.nextFrame();
+        m_truncated = false;
+
+        m_frameStartTime = m_firingTime; //the current firing starts the next frame
+        m_pointIndexSPC = 0;
+        m_startID = 0;
+        m_pointIndexCPC = 0;
+        m_columnStarted = false;
+        m_startAzimuth = m_currentAzimuth;
+        for (uint8_t part = 0; part < Model::NUMBER_OF_CPC_PARTS; part++) {
+            m_distancesNoIntensity[part].clear(); //keeps the capacity
+            m_distancesWithIntensity[part].clear();
+        }
+    }
+
+   private:
+    const float TO_RADIAN = static_cast< float >(M_PI) / 180.0f;  //degree to radian
+
+    const VelodyneDecoderOptions m_options;
+    VelodyneFrameListener &m_listener;
+    VelodyneCalibration< Model::NUMBER_OF_LASERS > m_calibration;
+    uint16_t m_mask;  //for combining distance and intensity in 16 bits
+    const VelodyneAzimuthTable &m_azimuthTable;
+    bool m_useLookupTables; //project with the precomputed tables instead of sin/cos per point
+    VelodyneProjection::Kernel m_kernel; //vectorized projection of whole firings; SCALAR decodes return by return
+    float *m_buffer;  //temporary memory for the point cloud of each frame
+    float *m_segment;  //memory the current frame is decoded into: m_buffer or an external segment
+    uint32_t m_pointCapacity; //points m_segment, m_timeOffsets and m_returnIndices have room for
+    float *m_timeOffsets; //microseconds since the frame start per point; NULL if disabled
+    uint8_t *m_returnIndices; //return index per point; NULL if disabled
+    uint8_t m_returnIndex; //return of the firing being decoded
+    bool m_dualReturn; //the last packet was sent in dual return mode
+    bool m_organised; //one column of NUMBER_OF_LASERS points per firing
+    bool m_columnStarted; //the current column has the rows of a lower block but not yet those of an upper block
+    std::array< uint8_t, Model::NUMBER_OF_LASERS > m_rowOfSensor; //row of each laser in a column, by increasing vertical angle
+    uint32_t m_pointIndexSPC; //current number of points of the current frame for shared point cloud
+    uint32_t m_pointIndexCPC; //current number of points of the current frame for compact point cloud
+    uint32_t m_startID;
+    float m_previousAzimuth;
+    float m_currentAzimuth;
+    float m_nextAzimuth;
+    float m_deltaAzimuth;
+    float m_startAzimuth;
+    float m_endAzimuth;
+    float m_sectorSize; //degrees per frame; 0 for complete rotations
+    bool m_haveAzimuth; //m_previousAzimuth was decoded from a packet
+    uint32_t m_packetAzimuth; //azimuth of the first block of the previous packet in 0.01 degree
+    bool m_havePacketAzimuth;
+    bool m_truncated; //the current frame dropped returns
+    VelodyneDecoderCounters m_counters;
+
+    //Times in microseconds past the hour:
+    uint32_t m_packetTime; //first firing of the current packet
+    uint32_t m_rawPacketTime; //as sent by the sensor
+    bool m_havePacketTime;
+    bool m_hasDeviceTime; //if m_packetTime was sent by the sensor
+    uint32_t m_firingTime; //current firing
+    uint32_t m_lastFiringTime; //last decoded firing
+    uint32_t m_frameStartTime; //first firing of the current frame
+    uint32_t m_frameDuration; //first to last firing of the completed frame
+    bool m_haveFrameStartTime;
+
+    //For compact point cloud:
+    std::array< uint8_t, Model::NUMBER_OF_CPC_PARTS > m_entriesPerAzimuth;
+    std::array< std::string, Model::NUMBER_OF_CPC_PARTS > m_distancesNoIntensity; //Big endian distance values for all points of one frame, excluding intensity; reserved for MAX_POINT_SIZE
+    std::array< std::string, Model::NUMBER_OF_CPC_PARTS > m_distancesWithIntensity; //Big endian distance values for all points of one frame, including intensity; reserved for MAX_POINT_SIZE
+    std::array< uint16_t, Model::NUMBER_OF_LASERS > m_rawDistance; //Raw distances of the current firing
+    std::array< uint8_t, Model::NUMBER_OF_LASERS > m_intensity; //Intensities of the current firing, calibrated if the calibration corrects them
+};
+
+template < typename Model > constexpr uint32_t VelodyneDecoderCore< Model >::PACKET_SIZE;
+template < typename Model > constexpr uint8_t VelodyneDecoderCore< Model >::NUMBER_OF_BLOCKS;
+template < typename Model > constexpr uint8_t VelodyneDecoderCore< Model >::BLOCK_SIZE;
+template < typename Model > constexpr uint8_t VelodyneDecoderCore< Model >::RETURNS_PER_BLOCK;
+template < typename Model > constexpr uint8_t VelodyneDecoderCore< Model >::RETURNS_PER_FIRING;
+template < typename Model > constexpr uint8_t VelodyneDecoderCore< Model >::NUMBER_OF_COMPONENTS_PER_POINT;
+template < typename Model > constexpr uint32_t VelodyneDecoderCore< Model >::POINT_CAPACITY;
+template < typename Model > constexpr uint32_t VelodyneDecoderCore< Model >::SIZE;
+template < typename Model > constexpr uint32_t VelodyneDecoderCore< Model >::TIME_OFFSETS_SIZE;
+template < typename Model > constexpr uint32_t VelodyneDecoderCore< Model >::RETURN_INDICES_SIZE;
+template < typename Model > constexpr uint32_t VelodyneDecoderCore< Model >::ORGANISED_POINT_CAPACITY;
+template < typename Model > constexpr uint32_t VelodyneDecoderCore< Model >::RETURN_MODE_OFFSET;
+template < typename Model > constexpr uint8_t VelodyneDecoderCore< Model >::DUAL_RETURN_MODE;
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNEDECODERCORE_H_*/
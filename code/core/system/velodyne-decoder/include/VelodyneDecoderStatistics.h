@@ -0,0 +1,235 @@
+/**
+ * VelodyneDecoderStatistics summarizes the decoding of a Velodyne proxy
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNEDECODERSTATISTICS_H_
+#define VELODYNEDECODERSTATISTICS_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+
+#include "odvdopendlvstandardmessageset/GeneratedHeaders_ODVDOpenDLVStandardMessageSet.h"
+
+#include "VelodyneDecoderCore.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * VelodyneDecodeTimeHistogram keeps decode times in logarithmic bins with
+ * eight bins per power of two, i.e. percentiles are resolved within 12.5%.
+ */
+class VelodyneDecodeTimeHistogram {
+   public:
+    static const uint32_t BINS_PER_OCTAVE = 8;
+    static const uint32_t NUMBER_OF_BINS = 40 * BINS_PER_OCTAVE; //up to 2^42 nanoseconds
+
+    VelodyneDecodeTimeHistogram()
+        : m_bins()
+        , m_count(0)
+        , m_max(0) {
+        m_bins.fill(0);
+    }
+
+    void add(const uint64_t &nanoseconds) {
+        m_bins[bin(nanoseconds)]++;
+        m_count++;
+        m_max = (nanoseconds > m_max) ? nanoseconds : m_max;
+    }
+
+    void clear() {
+        m_bins.fill(0);
+        m_count = 0;
+        m_max = 0;
+    }
+
+    uint64_t getCount() const {
+        return m_count;
+    }
+
+    uint64_t getMax() const {
+        return m_max;
+    }
+
+    /**
+     * @param fraction 0 .. 1, e.g. 0.99 for the 99th percentile.
+     * @return Middle of the bin holding the percentile in nanoseconds (not above the maximum); 0 without samples.
+     */
+    uint64_t getPercentile(const double &fraction) const {
+        const uint64_t rank = static_cast< uint64_t >(fraction * static_cast< double >(m_count));
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < NUMBER_OF_BINS; i++) {
+            seen += m_bins[i];
+            if (seen > rank) {
+                const uint64_t middle = lowerBound(i) + (lowerBound(i + 1) - lowerBound(i)) / 2;
+                return (middle < m_max) ? middle : m_max;
+            }
+        }
+        return m_max;
+    }
+
+    //Values below BINS_PER_OCTAVE have a bin each; above, the three bits following the highest set bit select the bin in its octave
+    static uint32_t bin(const uint64_t &value) {
+        if (value < BINS_PER_OCTAVE) {
+            return static_cast< uint32_t >(value);
+        }
+        const uint32_t msb = 63 - static_cast< uint32_t >(__builtin_clzll(value));
+        const uint32_t index = (msb - 2) * BINS_PER_OCTAVE + static_cast< uint32_t >((value >> (msb - 3)) & (BINS_PER_OCTAVE - 1));
+        return (index < NUMBER_OF_BINS) ? index : NUMBER_OF_BINS - 1;
+    }
+
+    static uint64_t lowerBound(const uint32_t &bin) {
+        if (bin < BINS_PER_OCTAVE) {
+            return bin;
+        }
+        const uint32_t msb = bin / BINS_PER_OCTAVE + 2;
+        return static_cast< uint64_t >(BINS_PER_OCTAVE + bin % BINS_PER_OCTAVE) << (msb - 3);
+    }
+
+   private:
+    std::array< uint64_t, NUMBER_OF_BINS > m_bins;
+    uint64_t m_count;
+    uint64_t m_max;
+};
+
+/**
+ * VelodyneDecoderStatistics collects what a decoder did between two
+ * reports: the frames, their points and durations, a sample of the decode times (one
+ * packet in SAMPLING is timed so that the clock is not read for every
+ * packet) and the differences of the counters of the decoder core. A
+ * report is due every interval; it is checked once per frame.
+ */
+class VelodyneDecoderStatistics {
+   public:
+    static const uint32_t SAMPLING = 16; //power of two
+
+    VelodyneDecoderStatistics()
+        : m_interval(0)
+        , m_packetCount(0)
+        , m_decodeTimes()
+        , m_frames(0)
+        , m_points(0)
+        , m_maxPoints(0)
+        , m_duration(0)
+        , m_maxDuration(0)
+        , m_lastReport()
+        , m_lastCounters() {}
+
+    /**
+     * @param seconds time between two reports; 0 to disable the statistics.
+     */
+    void setInterval(const float &seconds) {
+        //Rounded to microseconds; any positive interval enables the statistics
+        m_interval = (seconds > 0.0f) ? std::chrono::microseconds(std::max< int64_t >(1, static_cast< int64_t >(static_cast< double >(seconds) * 1000000.0 + 0.5))) : std::chrono::microseconds(0);
+        m_lastReport = std::chrono::steady_clock::now();
+    }
+
+    bool isEnabled() const {
+        return m_interval.count() > 0;
+    }
+
+    /**
+     * @return true if the decoding of the next packet is to be timed.
+     */
+    bool sampleNext() {
+        return isEnabled() && ((++m_packetCount & (SAMPLING - 1)) == 0);
+    }
+
+    void addDecodeTime(const std::chrono::steady_clock::duration &decodeTime) {
+        m_decodeTimes.add(static_cast< uint64_t >(std::chrono::duration_cast< std::chrono::nanoseconds >(decodeTime).count()));
+    }
+
+    /**
+     * @param numberOfPoints points of the completed frame.
+     * @param duration microseconds from the first to the last firing of the frame.
+     */
+    void addFrame(const uint32_t &numberOfPoints, const uint32_t &duration) {
+        m_frames++;
+        m_points += numberOfPoints;
+        m_maxPoints = (numberOfPoints > m_maxPoints) ? numberOfPoints : m_maxPoints;
+        m_duration += duration;
+        m_maxDuration = (duration > m_maxDuration) ? duration : m_maxDuration;
+    }
+
+    /**
+     * This method fills the report and starts the next interval if it is due.
+     *
+     * @param counters counters of the decoder core.
+     * @param report statistics of the past interval.
+     * @return true if a report is due.
+     */
+    bool report(const VelodyneDecoderCounters &counters, opendlv::proxy::PointCloudDecoderStatistics &report) {
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (!isEnabled() || now - m_lastReport < m_interval) {
+            return false;
+        }
+        const double seconds = std::chrono::duration_cast< std::chrono::duration< double > >(now - m_lastReport).count();
+        report.setInterval(static_cast< float >(seconds));
+        report.setPacketsPerSecond(static_cast< float >(static_cast< double >(counters.packets - m_lastCounters.packets) / seconds));
+        report.setFrames(static_cast< uint32_t >(m_frames));
+        report.setPointsPerFrame(m_frames > 0 ? static_cast< float >(static_cast< double >(m_points) / static_cast< double >(m_frames)) : 0.0f);
+        report.setMaxPointsPerFrame(m_maxPoints);
+        report.setTruncatedFrames(static_cast< uint32_t >(counters.truncatedFrames - m_lastCounters.truncatedFrames));
+        report.setBadPackets(static_cast< uint32_t >(counters.badPackets - m_lastCounters.badPackets));
+        report.setMissingPackets(static_cast< uint32_t >(counters.missingPackets - m_lastCounters.missingPackets));
+        report.setDecodeTimeMedian(toMicroseconds(m_decodeTimes.getPercentile(0.5)));
+        report.setDecodeTime90(toMicroseconds(m_decodeTimes.getPercentile(0.9)));
+        report.setDecodeTime99(toMicroseconds(m_decodeTimes.getPercentile(0.99)));
+        report.setDecodeTimeMax(toMicroseconds(m_decodeTimes.getMax()));
+        report.setFrameDurationMean(m_frames > 0 ? static_cast< float >(static_cast< double >(m_duration) / static_cast< double >(m_frames)) : 0.0f);
+        report.setFrameDurationMax(m_maxDuration);
+
+        m_lastReport = now;
+        m_lastCounters = counters;
+        m_decodeTimes.clear();
+        m_frames = 0;
+        m_points = 0;
+        m_maxPoints = 0;
+        m_duration = 0;
+        m_maxDuration = 0;
+        return true;
+    }
+
+   private:
+    static float toMicroseconds(const uint64_t &nanoseconds) {
+        return static_cast< float >(static_cast< double >(nanoseconds) / 1000.0);
+    }
+
+   private:
+    std::chrono::microseconds m_interval;
+    uint32_t m_packetCount;
+    VelodyneDecodeTimeHistogram m_decodeTimes; //sampled decode times of the current interval
+    uint64_t m_frames; //frames of the current interval
+    uint64_t m_points;
+    uint32_t m_maxPoints;
+    uint64_t m_duration; //microseconds of the frames of the current interval
+    uint32_t m_maxDuration;
+    std::chrono::steady_clock::time_point m_lastReport;
+    VelodyneDecoderCounters m_lastCounters; //counters of the core at the last report
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNEDECODERSTATISTICS_H_*/
@@ -0,0 +1,600 @@
+/**
+ * VelodyneFusion - Merges the frames of several Velodyne sensors into one point cloud
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNEFUSION_H_
+#define VELODYNEFUSION_H_
+
+#include <stdint.h>
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "opendavinci/odcore/data/TimeStamp.h"
+#include "opendavinci/odcore/io/StringListener.h"
+
+#include "VelodyneDecoderCore.h"
+#include "VelodyneUDPReceiver.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * Pose of a sensor in the frame of the merged point cloud. The merged
+ * frame has the axes of the decoded points (x right, y forward, z up).
+ */
+struct VelodyneExtrinsics {
+    float transform[12]; //rows of the 3x4 matrix from sensor to merged coordinates
+
+    VelodyneExtrinsics()
+        : transform() {
+        setPose(0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+    }
+
+    /**
+     * This method sets the pose of the sensor. The rotations are applied
+     * in the order roll, pitch, yaw, all counterclockwise when looking
+     * against the axis.
+     *
+     * @param x position of the sensor to the right in meters.
+     * @param y position of the sensor forward in meters.
+     * @param z position of the sensor upwards in meters.
+     * @param roll rotation around the forward (y) axis in radians.
+     * @param pitch rotation around the right (x) axis in radians.
+     * @param yaw rotation around the upward (z) axis in radians.
+     */
+    void setPose(const double &x, const double &y, const double &z, const double &roll, const double &pitch, const double &yaw) {
+        const double cr = std::cos(roll), sr = std::sin(roll);
+        const double cp = std::cos(pitch), sp = std::sin(pitch);
+        const double cy = std::cos(yaw), sy = std::sin(yaw);
+        //Rz(yaw) * Rx(pitch) * Ry(roll)
+        const double rotation[9] = {cy * cr - sy * sp * sr, -sy * cp, cy * sr + sy * sp * cr,
+                                    sy * cr + cy * sp * sr, cy * cp, sy * sr - cy * sp * cr,
+                                    -cp * sr, sp, cp * cr};
+        const double translation[3] = {x, y, z};
+        for (uint32_t row = 0; row < 3; row++) {
+            for (uint32_t column = 0; column < 3; column++) {
+                transform[row * 4 + column] = static_cast< float >(rotation[row * 3 + column]);
+            }
+            transform[row * 4 + 3] = static_cast< float >(translation[row]);
+        }
+    }
+
+    /**
+     * This method transforms points (x, y, z, intensity each).
+     *
+     * @param in points of the sensor.
+     * @param numberOfPoints number of points.
+     * @param out memory for the transformed points; must not overlap in.
+     */
+    void apply(const float *in, const uint32_t &numberOfPoints, float *out) const {
+        const float *m = transform;
+        for (uint32_t i = 0; i < numberOfPoints; i++, in += 4, out += 4) {
+            const float x = in[0];
+            const float y = in[1];
+            const float z = in[2];
+            out[0] = m[0] * x + m[1] * y + m[2] * z + m[3];
+            out[1] = m[4] * x + m[5] * y + m[6] * z + m[7];
+            out[2] = m[8] * x + m[9] * y + m[10] * z + m[11];
+            out[3] = in[3];
+        }
+    }
+};
+
+/**
+ * Counters of a sensor of a VelodyneFusion.
+ */
+struct VelodyneFusionStatistics {
+    uint32_t decoded; //frames completed by the decoder
+    uint32_t merged; //frames included in a merged point cloud
+    uint32_t overwritten; //frames replaced by a newer one before they could be merged
+    uint32_t outOfTime; //frames left out as too far in time from the frame of the reference sensor
+};
+
+/**
+ * A completed frame of a sensor: xyz+intensity points as decoded.
+ */
+struct VelodyneFusionFrame {
+    const float *points;
+    uint32_t numberOfPoints;
+    int64_t startTime; //first firing in microseconds since the epoch
+    int64_t endTime; //last firing in microseconds since the epoch
+};
+
+/**
+ * VelodyneFusionSensor decodes the packets of one sensor on the thread
+ * delivering them (a VelodyneUDPReceiver or a UDPReceiver per sensor) and
+ * hands its completed frames to the merge without copying them: the
+ * decoder writes into one of three buffers, the latest completed frame
+ * waits in the second one and the merge reads from the third.
+ */
+class VelodyneFusionSensor : public odcore::io::StringListener, public VelodynePacketListener {
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    VelodyneFusionSensor(const VelodyneFusionSensor &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    VelodyneFusionSensor &operator=(const VelodyneFusionSensor &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param maxPointSize maximum number of points per frame.
+     * @param reference to be notified for each completed frame; NULL if this is not the reference sensor.
+     */
+    VelodyneFusionSensor(const uint32_t &maxPointSize, VelodyneFrameListener *reference)
+        : m_maxPointSize(maxPointSize)
+        , m_reference(reference)
+        , m_extrinsics()
+        , m_mutex()
+        , m_buffers()
+        , m_frames()
+        , m_decoding(0)
+        , m_ready(1)
+        , m_reading(2)
+        , m_fresh(false)
+        , m_statistics()
+        , m_packetTimeStamp()
+        , m_frameTimeStamp()
+        , m_haveReceiveTimeStamps(false)
+        , m_useDeviceTime(false) {}
+
+    virtual ~VelodyneFusionSensor() {}
+
+    virtual void setLookupTables(const bool &useLookupTables) = 0;
+
+    virtual void setFullCalibration(const bool &fullCalibration) = 0;
+
+    /**
+     * This method selects the clock the frames are stamped and aligned
+     * with: the GPS time stamps of the sensor or the receive time (default).
+     *
+     * @param useDeviceTime true to use the time stamps of the sensor.
+     */
+    void setDeviceTime(const bool &useDeviceTime) {
+        m_useDeviceTime = useDeviceTime;
+    }
+
+    /**
+     * This method sets the pose of the sensor in the merged point cloud. It
+     * must be called before the first packet.
+     *
+     * @param extrinsics pose of the sensor.
+     */
+    void setExtrinsics(const VelodyneExtrinsics &extrinsics) {
+        m_extrinsics = extrinsics;
+    }
+
+    const VelodyneExtrinsics &getExtrinsics() const {
+        return m_extrinsics;
+    }
+
+    uint32_t getMaxPointSize() const {
+        return m_maxPointSize;
+    }
+
+    VelodyneFusionStatistics getStatistics() const {
+        std::lock_guard< std::mutex > lock(m_mutex);
+        return m_statistics;
+    }
+
+    virtual void nextString(const std::string &s) {
+        nextPacket(reinterpret_cast< const uint8_t * >(s.data()), static_cast< uint32_t >(s.length()), odcore::data::TimeStamp());
+    }
+
+    /**
+     * This method takes the latest completed frame for a merge; it stays
+     * valid until the next call. Only one thread may take frames.
+     *
+     * @param frame latest completed frame.
+     * @return false if no frame was completed since the last call.
+     */
+    bool takeFrame(VelodyneFusionFrame &frame) {
+        std::lock_guard< std::mutex > lock(m_mutex);
+        if (!m_fresh) {
+            return false;
+        }
+        std::swap(m_ready, m_reading);
+        m_fresh = false;
+        frame = m_frames[m_reading];
+        return true;
+    }
+
+    /**
+     * This method counts a taken frame as merged or as too far in time.
+     *
+     * @param merged true if the frame was merged.
+     */
+    void countFrame(const bool &merged) {
+        std::lock_guard< std::mutex > lock(m_mutex);
+        if (merged) {
+            m_statistics.merged++;
+        } else {
+            m_statistics.outOfTime++;
+        }
+    }
+
+   protected:
+    //Sets up the three buffers; the first one is the memory the decoder has been writing into
+    void setUpBuffers(float *decoding) {
+        m_buffers.resize(2 * m_maxPointSize * 4);
+        m_frames[0].points = decoding;
+        m_frames[1].points = &m_buffers[0];
+        m_frames[2].points = &m_buffers[m_maxPointSize * 4];
+    }
+
+    //Receive time of the packet being decoded
+    void setPacketTime(const odcore::data::TimeStamp &received) {
+        m_packetTimeStamp = received;
+        if (!m_haveReceiveTimeStamps) {
+            m_frameTimeStamp = received;
+            m_haveReceiveTimeStamps = true;
+        }
+    }
+
+    /**
+     * This method makes the frame decoded into the current buffer the
+     * latest completed frame and returns the buffer for the next frame.
+     *
+     * @param numberOfPoints number of points of the completed frame.
+     * @param duration first to last firing of the frame in microseconds.
+     * @param deviceStartTime first firing in microseconds past the hour as sent by the sensor; negative if the sensor sends no time.
+     * @return Memory for the points of the next frame.
+     */
+    float *completeFrame(const uint32_t &numberOfPoints, const uint32_t &duration, const int64_t &deviceStartTime) {
+        //As VelodyneDecoder: the frame starts when its first packet arrived, or ends now without receive time stamps
+        int64_t startTime = 0;
+        if (m_haveReceiveTimeStamps) {
+            startTime = m_frameTimeStamp.toMicroseconds();
+            m_frameTimeStamp = m_packetTimeStamp;
+        } else {
+            startTime = odcore::data::TimeStamp().toMicroseconds() - duration;
+        }
+        if (m_useDeviceTime && deviceStartTime >= 0) {
+            startTime = VelodyneDeviceTime::toAbsolute(static_cast< uint32_t >(deviceStartTime), startTime);
+        }
+
+        float *next = NULL;
+        {
+            std::lock_guard< std::mutex > lock(m_mutex);
+            VelodyneFusionFrame &frame = m_frames[m_decoding];
+            frame.numberOfPoints = numberOfPoints;
+            frame.startTime = startTime;
+            frame.endTime = startTime + duration;
+            std::swap(m_decoding, m_ready);
+            if (m_fresh) {
+                m_statistics.overwritten++;
+            }
+            m_fresh = true;
+            m_statistics.decoded++;
+            next = const_cast< float * >(m_frames[m_decoding].points);
+        }
+        if (m_reference != NULL) {
+            m_reference->nextFrame();
+        }
+        return next;
+    }
+
+   private:
+    const uint32_t m_maxPointSize;
+    VelodyneFrameListener *m_reference; //merges when this sensor completes a frame; NULL for the other sensors
+    VelodyneExtrinsics m_extrinsics;
+    mutable std::mutex m_mutex; //guards the indices of the buffers, m_fresh and the statistics
+    std::vector< float > m_buffers; //the second and third buffer; the first one is owned by the decoder
+    VelodyneFusionFrame m_frames[3];
+    uint32_t m_decoding; //buffer the decoder writes into
+    uint32_t m_ready; //latest completed frame
+    uint32_t m_reading; //frame being merged
+    bool m_fresh; //m_ready holds a frame that has not been taken yet
+    VelodyneFusionStatistics m_statistics;
+    odcore::data::TimeStamp m_packetTimeStamp; //receive time of the packet being decoded
+    odcore::data::TimeStamp m_frameTimeStamp; //receive time of the first packet of the current frame
+    bool m_haveReceiveTimeStamps;
+    bool m_useDeviceTime;
+};
+
+/**
+ * VelodyneFusionDecoder is the sensor of a given model.
+ */
+template < typename Model >
+class VelodyneFusionDecoder : public VelodyneFusionSensor, public VelodyneFrameListener {
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    VelodyneFusionDecoder(const VelodyneFusionDecoder &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    VelodyneFusionDecoder &operator=(const VelodyneFusionDecoder &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param calibration name of the calibration file.
+     * @param reference to be notified for each completed frame; NULL if this is not the reference sensor.
+     */
+    VelodyneFusionDecoder(const std::string &calibration, VelodyneFrameListener *reference)
+        : VelodyneFusionSensor(VelodyneDecoderCore< Model >::POINT_CAPACITY, reference)
+        , m_core(calibration, getOptions(), *this) {
+        setUpBuffers(m_core.getSegment());
+    }
+
+    virtual ~VelodyneFusionDecoder() {}
+
+    virtual void setLookupTables(const bool &useLookupTables) {
+        m_core.setLookupTables(useLookupTables);
+    }
+
+    virtual void setFullCalibration(const bool &fullCalibration) {
+        m_core.setFullCalibration(fullCalibration);
+    }
+
+    virtual void nextPacket(const uint8_t *data, const uint32_t &length, const odcore::data::TimeStamp &received) {
+        setPacketTime(received);
+        m_core.nextPacket(data, length);
+    }
+
+    virtual void nextFrame() {
+        const int64_t deviceStartTime = m_core.hasDeviceTime() ? static_cast< int64_t >(m_core.getFrameStartTime()) : -1;
+        m_core.setSegment(completeFrame(m_core.getNumberOfPoints(), m_core.getFrameDuration(), deviceStartTime));
+    }
+
+   private:
+    //Cartesian shared point cloud only
+    static VelodyneDecoderOptions getOptions() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+        return options;
+    }
+
+   private:
+    VelodyneDecoderCore< Model > m_core;
+};
+
+/**
+ * Interface to publish the merged point clouds.
+ */
+class VelodyneFusionListener {
+   public:
+    virtual ~VelodyneFusionListener() {}
+
+    /**
+     * This method is called on the thread of the reference sensor when a
+     * merged point cloud is ready; VelodyneFusion::write() fills it into
+     * the memory to publish.
+     */
+    virtual void nextMergedFrame() = 0;
+};
+
+/**
+ * VelodyneFusion merges the frames of several Velodyne sensors into one
+ * point cloud of xyz+intensity points in a common frame.
+ *
+ * Each sensor decodes its packets on its own thread. The first sensor is
+ * the reference: whenever it completes a frame, the latest frame of every
+ * other sensor is added if the middle of both frames lies at most
+ * maxTimeDifference apart; frames that were already merged are not added
+ * again. The points are copied once, from the buffers of the decoders into
+ * the memory to publish, and transformed with the extrinsics of their
+ * sensor on the way.
+ */
+class VelodyneFusion : public VelodyneFrameListener {
+   public:
+    static constexpr int64_t DEFAULT_MAX_TIME_DIFFERENCE = 50000; //microseconds; half a rotation at 10 Hz
+
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    VelodyneFusion(const VelodyneFusion &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    VelodyneFusion &operator=(const VelodyneFusion &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param listener to be notified for each merged point cloud.
+     */
+    explicit VelodyneFusion(VelodyneFusionListener &listener)
+        : m_listener(listener)
+        , m_sensors()
+        , m_maxTimeDifference(DEFAULT_MAX_TIME_DIFFERENCE)
+        , m_frames()
+        , m_merged()
+        , m_numberOfPoints(0)
+        , m_frameStartTime(0)
+        , m_frameEndTime(0)
+        , m_mergedFrames(0) {}
+
+    virtual ~VelodyneFusion() {}
+
+    /**
+     * This method adds a sensor; the first one is the reference. Sensors
+     * must be added before the first packet is decoded.
+     *
+     * @param calibration name of the calibration file.
+     * @param extrinsics pose of the sensor in the merged point cloud.
+     * @return Sensor to hand the packets of the sensor to.
+     */
+    template < typename Model >
+    VelodyneFusionSensor &addSensor(const std::string &calibration, const VelodyneExtrinsics &extrinsics) {
+        std::shared_ptr< VelodyneFusionSensor > sensor(new VelodyneFusionDecoder< Model >(calibration, m_sensors.empty() ? this : NULL));
+        sensor->setExtrinsics(extrinsics);
+        m_sensors.push_back(sensor);
+        m_frames.resize(m_sensors.size());
+        m_merged.resize(m_sensors.size());
+        return *sensor;
+    }
+
+    uint32_t getNumberOfSensors() const {
+        return static_cast< uint32_t >(m_sensors.size());
+    }
+
+    VelodyneFusionSensor &getSensor(const uint32_t &index) {
+        return *m_sensors[index];
+    }
+
+    /**
+     * @param maxTimeDifference microseconds the middle of a merged frame may lie from the middle of the reference frame.
+     */
+    void setMaxTimeDifference(const int64_t &maxTimeDifference) {
+        m_maxTimeDifference = maxTimeDifference;
+    }
+
+    int64_t getMaxTimeDifference() const {
+        return m_maxTimeDifference;
+    }
+
+    /**
+     * @return Number of points of the largest merged point cloud.
+     */
+    uint32_t getMaxPointSize() const {
+        uint32_t size = 0;
+        for (const std::shared_ptr< VelodyneFusionSensor > &sensor : m_sensors) {
+            size += sensor->getMaxPointSize();
+        }
+        return size;
+    }
+
+    /**
+     * @return Number of points of the current merged point cloud.
+     */
+    uint32_t getNumberOfPoints() const {
+        return m_numberOfPoints;
+    }
+
+    /**
+     * @return First firing of the current merged point cloud in microseconds since the epoch.
+     */
+    int64_t getFrameStartTime() const {
+        return m_frameStartTime;
+    }
+
+    /**
+     * @return Last firing of the current merged point cloud in microseconds since the epoch.
+     */
+    int64_t getFrameEndTime() const {
+        return m_frameEndTime;
+    }
+
+    /**
+     * @param index sensor.
+     * @return true if the current merged point cloud holds a frame of the sensor.
+     */
+    bool isMerged(const uint32_t &index) const {
+        return m_merged[index];
+    }
+
+    uint32_t getMergedFrames() const {
+        return m_mergedFrames;
+    }
+
+    /**
+     * This method writes the current merged point cloud; the points of
+     * the sensors follow each other in the order the sensors were added.
+     *
+     * @param points memory for getNumberOfPoints() points of 4 floats.
+     * @param sensorIndices if not NULL, memory for the index of the sensor of each point.
+     */
+    void write(float *points, uint8_t *sensorIndices) const {
+        for (uint32_t index = 0; index < m_sensors.size(); index++) {
+            if (m_merged[index]) {
+                const VelodyneFusionFrame &frame = m_frames[index];
+                m_sensors[index]->getExtrinsics().apply(frame.points, frame.numberOfPoints, points);
+                points += frame.numberOfPoints * 4;
+                if (sensorIndices != NULL) {
+                    memset(sensorIndices, static_cast< int32_t >(index), frame.numberOfPoints);
+                    sensorIndices += frame.numberOfPoints;
+                }
+            }
+        }
+    }
+
+    //Merges when the reference sensor has completed a frame
+    virtual void nextFrame() {
+        if (!m_sensors[0]->takeFrame(m_frames[0])) {
+            return;
+        }
+        const int64_t reference = (m_frames[0].startTime + m_frames[0].endTime) / 2;
+        m_numberOfPoints = 0;
+        m_frameStartTime = m_frames[0].startTime;
+        m_frameEndTime = m_frames[0].endTime;
+        for (uint32_t index = 0; index < m_sensors.size(); index++) {
+            m_merged[index] = (index == 0) || m_sensors[index]->takeFrame(m_frames[index]);
+            if (m_merged[index] && index > 0) {
+                const int64_t difference = (m_frames[index].startTime + m_frames[index].endTime) / 2 - reference;
+                m_merged[index] = (difference <= m_maxTimeDifference && -difference <= m_maxTimeDifference);
+                m_sensors[index]->countFrame(m_merged[index]);
+            }
+            if (m_merged[index]) {
+                m_numberOfPoints += m_frames[index].numberOfPoints;
+                m_frameStartTime = (m_frames[index].startTime < m_frameStartTime) ? m_frames[index].startTime : m_frameStartTime;
+                m_frameEndTime = (m_frames[index].endTime > m_frameEndTime) ? m_frames[index].endTime : m_frameEndTime;
+            }
+        }
+        m_sensors[0]->countFrame(true);
+        m_mergedFrames++;
+        m_listener.nextMergedFrame();
+    }
+
+   private:
+    VelodyneFusionListener &m_listener;
+    std::vector< std::shared_ptr< VelodyneFusionSensor > > m_sensors;
+    int64_t m_maxTimeDifference;
+    std::vector< VelodyneFusionFrame > m_frames; //frame taken from each sensor for the current merge
+    std::vector< bool > m_merged; //the frame of each sensor is part of the current merge
+    uint32_t m_numberOfPoints;
+    int64_t m_frameStartTime;
+    int64_t m_frameEndTime;
+    uint32_t m_mergedFrames;
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNEFUSION_H_*/
@@ -0,0 +1,191 @@
+/**
+ * VelodynePacketQueue - Bounded single producer/single consumer packet queue
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNEPACKETQUEUE_H_
+#define VELODYNEPACKETQUEUE_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * VelodynePacketQueue is a bounded ring of preallocated packet buffers
+ * between exactly one producer (the receive thread) and one consumer (the
+ * decode thread). Neither side blocks or allocates: the producer fills free
+ * buffers in place and publishes them, the consumer reads them in place and
+ * releases them.
+ */
+class VelodynePacketQueue {
+   public:
+    static constexpr uint32_t MAX_PACKET_SIZE = 1536; //Ethernet MTU rounded up to cache lines
+    static constexpr uint32_t MAX_CAPACITY = 1u << 16; //larger capacities are clamped; 96 MiB of packet buffers
+
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    VelodynePacketQueue(const VelodynePacketQueue &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    VelodynePacketQueue &operator=(const VelodynePacketQueue &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param capacity number of packets; rounded up to a power of two and limited to MAX_CAPACITY.
+     */
+    explicit VelodynePacketQueue(const uint32_t &capacity)
+        : m_capacity(roundUp(capacity))
+        , m_mask(m_capacity - 1)
+        , m_buffers(static_cast< size_t >(m_capacity) * MAX_PACKET_SIZE)
+        , m_lengths(m_capacity, 0)
+        , m_timestamps(m_capacity, 0)
+        , m_padding0()
+        , m_head(0)
+        , m_padding1()
+        , m_tail(0)
+        , m_padding2()
+        , m_highWaterMark(0) {}
+
+    virtual ~VelodynePacketQueue() {}
+
+    uint32_t getCapacity() const {
+        return m_capacity;
+    }
+
+    /**
+     * @return Highest number of queued packets seen by the producer.
+     */
+    uint32_t getHighWaterMark() const {
+        return m_highWaterMark.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return Number of queued packets.
+     */
+    uint32_t size() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    // Producer side.
+
+    /**
+     * @return Number of free buffers the producer may fill.
+     */
+    uint32_t getFree() const {
+        return m_capacity - (m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_acquire));
+    }
+
+    /**
+     * @param offset 0 .. getFree() - 1.
+     * @return Buffer of MAX_PACKET_SIZE bytes of the offset-th free slot.
+     */
+    uint8_t *getFreeBuffer(const uint32_t &offset) {
+        return &m_buffers[static_cast< size_t >((m_head.load(std::memory_order_relaxed) + offset) & m_mask) * MAX_PACKET_SIZE];
+    }
+
+    /**
+     * This method publishes the first count free buffers to the consumer.
+     *
+     * @param count number of filled buffers (at most getFree()).
+     * @param lengths length of each packet.
+     * @param timestamps receive time of each packet in microseconds since the epoch.
+     */
+    void push(const uint32_t &count, const uint32_t *lengths, const int64_t *timestamps) {
+        const uint32_t head = m_head.load(std::memory_order_relaxed);
+        for (uint32_t i = 0; i < count; i++) {
+            m_lengths[(head + i) & m_mask] = lengths[i];
+            m_timestamps[(head + i) & m_mask] = timestamps[i];
+        }
+        m_head.store(head + count, std::memory_order_release);
+
+        const uint32_t queued = head + count - m_tail.load(std::memory_order_acquire);
+        if (queued > m_highWaterMark.load(std::memory_order_relaxed)) {
+            m_highWaterMark.store(queued, std::memory_order_relaxed);
+        }
+    }
+
+    // Consumer side.
+
+    /**
+     * @param data first queued packet.
+     * @param length length of the first queued packet.
+     * @param timestamp receive time of the first queued packet in microseconds since the epoch.
+     * @return false if the queue is empty.
+     */
+    bool front(const uint8_t *&data, uint32_t &length, int64_t &timestamp) const {
+        const uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        data = &m_buffers[static_cast< size_t >(tail & m_mask) * MAX_PACKET_SIZE];
+        length = m_lengths[tail & m_mask];
+        timestamp = m_timestamps[tail & m_mask];
+        return true;
+    }
+
+    /**
+     * This method releases the first queued packet.
+     */
+    void pop() {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+   private:
+    static uint32_t roundUp(const uint32_t &capacity) {
+        uint32_t c = 1;
+        while (c < capacity && c < MAX_CAPACITY) {
+            c <<= 1;
+        }
+        return c;
+    }
+
+   private:
+    const uint32_t m_capacity;
+    const uint32_t m_mask;
+    std::vector< uint8_t > m_buffers;
+    std::vector< uint32_t > m_lengths;
+    std::vector< int64_t > m_timestamps;
+    //Producer and consumer indexes on separate cache lines
+    uint8_t m_padding0[64];
+    std::atomic< uint32_t > m_head; //written by the producer only
+    uint8_t m_padding1[64];
+    std::atomic< uint32_t > m_tail; //written by the consumer only
+    uint8_t m_padding2[64];
+    std::atomic< uint32_t > m_highWaterMark;
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNEPACKETQUEUE_H_*/
@@ -0,0 +1,274 @@
+/**
+ * VelodynePcapReader extracts Velodyne data packets from pcap recordings
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNEPCAPREADER_H_
+#define VELODYNEPCAPREADER_H_
+
+#include <stdint.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * VelodynePcapFile iterates over the UDP payloads of the Velodyne data
+ * packets (1206 bytes) in a pcap file without copying them. The file is
+ * memory-mapped on Linux and read into memory elsewhere. Recordings in
+ * either byte order with micro- or nanosecond time stamps and Ethernet
+ * (optionally VLAN tagged) or Linux cooked capture framing are supported;
+ * all other records, such as the position packets, are skipped.
+ */
+class VelodynePcapFile {
+   public:
+    static const uint32_t PCAP_HEADER = 24;
+    static const uint32_t RECORD_HEADER = 16;
+    static const uint32_t PAYLOAD = 1206;
+
+   private:
+    static const uint32_t MAGIC = 0xa1b2c3d4;
+    static const uint32_t MAGIC_NANOSECONDS = 0xa1b23c4d;
+    static const uint32_t LINKTYPE_ETHERNET = 1;
+    static const uint32_t LINKTYPE_LINUX_SLL = 113;
+
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    VelodynePcapFile(const VelodynePcapFile &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    VelodynePcapFile &operator=(const VelodynePcapFile &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param fileName pcap file.
+     */
+    explicit VelodynePcapFile(const std::string &fileName)
+        : m_buffer()
+        , m_mapping(NULL)
+        , m_data(NULL)
+        , m_size(0)
+        , m_position(PCAP_HEADER)
+        , m_swapped(false)
+        , m_nanoseconds(false)
+        , m_linkType(0) {
+#ifdef __linux__
+        const int32_t fd = open(fileName.c_str(), O_RDONLY);
+        if (fd >= 0) {
+            struct stat status;
+            if (fstat(fd, &status) == 0 && status.st_size > 0) {
+                void *mapping = mmap(NULL, static_cast< size_t >(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping != MAP_FAILED) {
+                    //The packets are read once from the front to the back
+                    madvise(mapping, static_cast< size_t >(status.st_size), MADV_SEQUENTIAL);
+                    m_mapping = mapping;
+                    m_data = static_cast< const uint8_t * >(mapping);
+                    m_size = static_cast< uint64_t >(status.st_size);
+                }
+            }
+            close(fd);
+        }
+#endif
+        if (m_data == NULL) {
+            std::ifstream in(fileName.c_str(), std::ios::binary);
+            if (in.is_open()) {
+                m_buffer.assign((std::istreambuf_iterator< char >(in)), std::istreambuf_iterator< char >());
+                m_data = reinterpret_cast< const uint8_t * >(m_buffer.data());
+                m_size = m_buffer.size();
+            }
+        }
+        if (!readHeader()) {
+            m_position = m_size;
+        }
+    }
+
+    ~VelodynePcapFile() {
+#ifdef __linux__
+        if (m_mapping != NULL) {
+            munmap(m_mapping, static_cast< size_t >(m_size));
+        }
+#endif
+    }
+
+    /**
+     * @return true if the file is a pcap recording with a supported link layer.
+     */
+    bool isValid() const {
+        return m_linkType != 0;
+    }
+
+    /**
+     * @return true if the file is memory-mapped rather than read into memory.
+     */
+    bool isMapped() const {
+        return m_mapping != NULL;
+    }
+
+    /**
+     * This method moves to the next data packet.
+     *
+     * @param payload set to the UDP payload (PAYLOAD bytes) inside the file.
+     * @param timestamp set to the capture time in microseconds since the epoch.
+     * @return false at the end of the file.
+     */
+    bool nextDataPacket(const uint8_t *&payload, int64_t &timestamp) {
+        while (m_position + RECORD_HEADER <= m_size) {
+            const uint8_t *record = m_data + m_position;
+            const uint32_t capturedLength = read32(record + 8);
+            m_position += RECORD_HEADER;
+            if (capturedLength > m_size - m_position) {
+                m_position = m_size; //truncated recording
+                return false;
+            }
+            const uint8_t *packet = m_data + m_position;
+            m_position += capturedLength;
+            const uint8_t *udpPayload = getUDPPayload(packet, capturedLength);
+            if (udpPayload != NULL) {
+                const int64_t fraction = static_cast< int64_t >(read32(record + 4));
+                payload = udpPayload;
+                timestamp = static_cast< int64_t >(read32(record)) * 1000000L + (m_nanoseconds ? fraction / 1000L : fraction);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * This method moves back to the first packet.
+     */
+    void rewind() {
+        m_position = isValid() ? PCAP_HEADER : m_size;
+    }
+
+   private:
+    bool readHeader() {
+        if (m_size < PCAP_HEADER) {
+            return false;
+        }
+        uint32_t magic = 0;
+        memcpy(&magic, m_data, sizeof(uint32_t));
+        m_swapped = (magic == swap32(MAGIC) || magic == swap32(MAGIC_NANOSECONDS));
+        magic = read32(m_data);
+        if (magic != MAGIC && magic != MAGIC_NANOSECONDS) {
+            return false;
+        }
+        m_nanoseconds = (magic == MAGIC_NANOSECONDS);
+        const uint32_t linkType = read32(m_data + 20);
+        if (linkType != LINKTYPE_ETHERNET && linkType != LINKTYPE_LINUX_SLL) {
+            return false;
+        }
+        m_linkType = linkType;
+        return true;
+    }
+
+    //Returns the UDP payload of a captured IPv4 packet if it is a Velodyne data packet; NULL otherwise
+    const uint8_t *getUDPPayload(const uint8_t *packet, const uint32_t &length) const {
+        uint32_t offset = (m_linkType == LINKTYPE_ETHERNET) ? 12 : 14; //position of the ether type
+        if (offset + 2 > length) {
+            return NULL;
+        }
+        uint16_t etherType = readBigEndian16(packet + offset);
+        while (etherType == 0x8100 && offset + 6 <= length) { //802.1Q tag
+            offset += 4;
+            etherType = readBigEndian16(packet + offset);
+        }
+        offset += 2;
+        if (etherType != 0x0800 || offset + 20 > length || (packet[offset] >> 4) != 4 || packet[offset + 9] != 17) {
+            return NULL;
+        }
+        offset += static_cast< uint32_t >(packet[offset] & 0x0f) * 4; //IPv4 header with options
+        if (offset + 8 > length || readBigEndian16(packet + offset + 4) != 8 + PAYLOAD || offset + 8 + PAYLOAD > length) {
+            return NULL;
+        }
+        return packet + offset + 8;
+    }
+
+    static uint32_t swap32(const uint32_t v) {
+        return ((v & 0xff) << 24) | ((v & 0xff00) << 8) | ((v >> 8) & 0xff00) | (v >> 24);
+    }
+
+    uint32_t read32(const uint8_t *p) const {
+        uint32_t v = 0;
+        memcpy(&v, p, sizeof(uint32_t));
+        return m_swapped ? swap32(v) : v;
+    }
+
+    static uint16_t readBigEndian16(const uint8_t *p) {
+        return static_cast< uint16_t >((p[0] << 8) | p[1]);
+    }
+
+   private:
+    std::string m_buffer; //content of the file if it could not be mapped
+    void *m_mapping;
+    const uint8_t *m_data;
+    uint64_t m_size;
+    uint64_t m_position; //next record
+    bool m_swapped; //the recording was written on a machine of the other byte order
+    bool m_nanoseconds; //the records are stamped in nanoseconds
+    uint32_t m_linkType; //0 if the file is not a supported pcap recording
+};
+
+/**
+ * VelodynePcapReader returns the UDP payloads of all 1206 bytes data
+ * packets found in a pcap file (Ethernet, IPv4, UDP).
+ */
+class VelodynePcapReader {
+   public:
+    /**
+     * @param fileName pcap file.
+     * @return UDP payloads of the Velodyne data packets; empty if the file cannot be read.
+     */
+    static std::vector< std::string > readDataPackets(const std::string &fileName) {
+        std::vector< std::string > packets;
+        VelodynePcapFile file(fileName);
+        const uint8_t *payload = NULL;
+        int64_t timestamp = 0;
+        while (file.nextDataPacket(payload, timestamp)) {
+            packets.push_back(std::string(reinterpret_cast< const char * >(payload), VelodynePcapFile::PAYLOAD));
+        }
+        return packets;
+    }
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNEPCAPREADER_H_*/
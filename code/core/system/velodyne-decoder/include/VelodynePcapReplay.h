@@ -0,0 +1,241 @@
+/**
+ * VelodynePcapReplay feeds pcap recordings into a Velodyne decoder
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNEPCAPREPLAY_H_
+#define VELODYNEPCAPREPLAY_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "opendavinci/odcore/data/TimeStamp.h"
+
+#include "VelodynePcapReader.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * Counters of a VelodynePcapReplay.
+ */
+struct VelodyneReplayStatistics {
+    uint64_t packets; //data packets handed to the decoder
+    uint64_t frames; //frames completed by the decoder
+    int64_t recordedDuration; //time between the first and the last replayed packet in the recording in microseconds
+    int64_t replayDuration; //wall time of the replay in microseconds
+    int64_t decodeTime; //time spent in the decoder in microseconds
+    int64_t frameLatencySum; //sum of the frame latencies in microseconds
+    int64_t maxFrameLatency; //highest frame latency in microseconds
+    uint64_t latePackets; //packets handed to the decoder more than a millisecond after their replay time (paced replay only)
+};
+
+/**
+ * VelodynePcapReplay hands the data packets of a pcap recording to a
+ * decoder as if they were received from the sensor, either paced by the
+ * capture time stamps (speed 1), N times faster or slower (speed N), or as
+ * fast as possible (speed 0). The packets are read from the memory-mapped
+ * file without copying.
+ *
+ * In a paced replay, each packet is stamped with the wall time it is
+ * replayed at; otherwise with the time it is handed to the decoder. The
+ * frame latency is the time from the replay time of the packet completing
+ * a frame until the decoder has published it.
+ *
+ * The decoder must provide nextPacket() as a VelodynePacketListener and
+ * getNumberOfFrames() as VelodyneDecoder does.
+ */
+template < typename Decoder >
+class VelodynePcapReplay {
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    VelodynePcapReplay(const VelodynePcapReplay &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    VelodynePcapReplay &operator=(const VelodynePcapReplay &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param fileName pcap recording.
+     * @param decoder consumer of the packets.
+     * @param speed replay speed relative to the recording; 0 for as fast as possible.
+     */
+    VelodynePcapReplay(const std::string &fileName, Decoder &decoder, const double &speed)
+        : m_file(fileName)
+        , m_decoder(decoder)
+        , m_speed(speed > 0.0 ? speed : 0.0)
+        , m_running(false)
+        , m_finished(false)
+        , m_thread()
+        , m_statistics() {}
+
+    virtual ~VelodynePcapReplay() {
+        stop();
+    }
+
+    /**
+     * @return true if the recording could be opened.
+     */
+    bool isValid() const {
+        return m_file.isValid();
+    }
+
+    /**
+     * This method replays the recording in the calling thread.
+     *
+     * @return Counters of the replay.
+     */
+    VelodyneReplayStatistics run() {
+        m_running.store(true);
+        replay();
+        return m_statistics;
+    }
+
+    /**
+     * This method replays the recording in a dedicated thread.
+     *
+     * @return false if the recording could not be opened.
+     */
+    bool start() {
+        if (!isValid()) {
+            return false;
+        }
+        if (!m_running.exchange(true)) {
+            m_thread = std::thread(&VelodynePcapReplay::replay, this);
+        }
+        return true;
+    }
+
+    /**
+     * This method stops the replay after the current packet.
+     */
+    void stop() {
+        m_running.store(false);
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+    /**
+     * @return true when all packets of the recording have been replayed.
+     */
+    bool isFinished() const {
+        return m_finished.load();
+    }
+
+    /**
+     * @return Counters of the replay; complete once the replay is stopped or finished.
+     */
+    VelodyneReplayStatistics getStatistics() const {
+        return m_statistics;
+    }
+
+   private:
+    static int64_t toMicroseconds(const std::chrono::steady_clock::duration &d) {
+        return std::chrono::duration_cast< std::chrono::microseconds >(d).count();
+    }
+
+    void replay() {
+        typedef std::chrono::steady_clock Clock;
+        const bool paced = (m_speed > 0.0);
+        const Clock::time_point start = Clock::now();
+        const int64_t wallStart = odcore::data::TimeStamp().toMicroseconds();
+        const uint32_t length = VelodynePcapFile::PAYLOAD;
+        const uint8_t *payload = NULL;
+        int64_t captured = 0;
+        int64_t firstCaptured = 0;
+        int64_t lastCaptured = 0;
+        uint64_t frames = m_decoder.getNumberOfFrames();
+
+        while (m_running.load(std::memory_order_relaxed) && m_file.nextDataPacket(payload, captured)) {
+            if (m_statistics.packets == 0) {
+                firstCaptured = captured;
+                lastCaptured = captured;
+            }
+            //Packets recorded out of order are replayed right away
+            lastCaptured = (captured > lastCaptured) ? captured : lastCaptured;
+            const int64_t offset = lastCaptured - firstCaptured;
+
+            Clock::time_point arrival = Clock::now();
+            if (paced) {
+                const Clock::time_point scheduled = start + std::chrono::microseconds(static_cast< int64_t >(static_cast< double >(offset) / m_speed));
+                //Sleep in short steps to notice stop() during gaps in the recording
+                while (arrival < scheduled && m_running.load(std::memory_order_relaxed)) {
+                    const Clock::time_point wakeUp = arrival + std::chrono::milliseconds(100);
+                    std::this_thread::sleep_until(scheduled < wakeUp ? scheduled : wakeUp);
+                    arrival = Clock::now();
+                }
+                if (toMicroseconds(arrival - scheduled) > 1000) {
+                    m_statistics.latePackets++;
+                }
+                arrival = scheduled;
+            }
+            const int64_t received = wallStart + toMicroseconds(arrival - start);
+
+            const Clock::time_point before = Clock::now();
+            m_decoder.nextPacket(payload, length, odcore::data::TimeStamp(static_cast< int32_t >(received / 1000000L), static_cast< int32_t >(received % 1000000L)));
+            const Clock::time_point after = Clock::now();
+            m_statistics.decodeTime += toMicroseconds(after - before);
+            m_statistics.packets++;
+
+            const uint64_t completed = m_decoder.getNumberOfFrames();
+            if (completed != frames) {
+                const int64_t latency = toMicroseconds(after - arrival);
+                m_statistics.frames += completed - frames;
+                m_statistics.frameLatencySum += latency;
+                m_statistics.maxFrameLatency = (latency > m_statistics.maxFrameLatency) ? latency : m_statistics.maxFrameLatency;
+                frames = completed;
+            }
+        }
+        m_statistics.recordedDuration = lastCaptured - firstCaptured;
+        m_statistics.replayDuration = toMicroseconds(Clock::now() - start);
+        if (m_running.load()) {
+            m_finished.store(true);
+        }
+    }
+
+   private:
+    VelodynePcapFile m_file;
+    Decoder &m_decoder;
+    double m_speed; //0: as fast as possible
+    std::atomic< bool > m_running;
+    std::atomic< bool > m_finished;
+    std::thread m_thread;
+    VelodyneReplayStatistics m_statistics;
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNEPCAPREPLAY_H_*/
@@ -0,0 +1,307 @@
+/**
+ * VelodynePointEncoding - Compact encodings of the shared point cloud
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNEPOINTENCODING_H_
+#define VELODYNEPOINTENCODING_H_
+
+#include <stdint.h>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VELODYNE_POINT_ENCODING_X86 1
+#include <immintrin.h>
+#ifdef __SSE2__
+#define VELODYNE_POINT_ENCODING_SSE2 1
+#endif
+#endif
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * VelodynePointEncoding converts the xyz+intensity points of a frame
+ * (4 floats, 16 bytes per point) into the components published in the
+ * shared point cloud and back:
+ *
+ * - FLOAT32: 4 floats (FLOAT_T), as decoded.
+ * - INT16: 4 int16_t (INT16_T); x, y, z in units of INT16_RESOLUTION
+ *   (5 mm, i.e. +-163 m) and the intensity 0..255. NaN coordinates
+ *   (organised layout) are INT16_INVALID.
+ * - FLOAT16: 4 IEEE 754 half precision floats, announced as UINT16_T as
+ *   the SharedPointCloud has no half precision type; the resolution is
+ *   2^-11 of the value, e.g. 1.6 cm at 40 m.
+ *
+ * Both compact encodings need 8 bytes per point.
+ */
+class VelodynePointEncoding {
+   public:
+    enum Encoding {
+        FLOAT32 = 0,
+        INT16 = 1,
+        FLOAT16 = 2,
+    };
+
+    static constexpr uint32_t NUMBER_OF_COMPONENTS_PER_POINT = 4;
+    static constexpr float INT16_RESOLUTION = 0.005f; //meters per unit of x, y, z
+    static constexpr int16_t INT16_INVALID = -32768; //x, y, z of a point with NaN coordinates
+
+    /**
+     * @param encoding encoding of the points.
+     * @return Size in bytes of one point.
+     */
+    static uint32_t getBytesPerPoint(const Encoding &encoding) {
+        return (encoding == FLOAT32) ? NUMBER_OF_COMPONENTS_PER_POINT * static_cast< uint32_t >(sizeof(float)) : NUMBER_OF_COMPONENTS_PER_POINT * static_cast< uint32_t >(sizeof(uint16_t));
+    }
+
+    /**
+     * @return true if the CPU converts half precision floats (F16C).
+     */
+    static bool hasF16C() {
+#ifdef VELODYNE_POINT_ENCODING_X86
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * This method encodes xyz+intensity points.
+     *
+     * @param encoding encoding of the destination.
+     * @param points numberOfPoints * 4 floats.
+     * @param numberOfPoints number of points.
+     * @param destination memory for numberOfPoints * getBytesPerPoint(encoding) bytes; must not overlap points.
+     * @param useF16C false to convert half precision floats without F16C.
+     */
+    static void encode(const Encoding &encoding, const float *points, const uint32_t &numberOfPoints, void *destination, const bool &useF16C = true) {
+        if (encoding == INT16) {
+            int16_t *out = static_cast< int16_t * >(destination);
+            uint32_t i = 0;
+#ifdef VELODYNE_POINT_ENCODING_SSE2
+            i = toInt16SSE2(points, numberOfPoints, out);
+#endif
+            for (; i < numberOfPoints * NUMBER_OF_COMPONENTS_PER_POINT; i += NUMBER_OF_COMPONENTS_PER_POINT) {
+                out[i] = toInt16(points[i] * (1.0f / INT16_RESOLUTION));
+                out[i + 1] = toInt16(points[i + 1] * (1.0f / INT16_RESOLUTION));
+                out[i + 2] = toInt16(points[i + 2] * (1.0f / INT16_RESOLUTION));
+                out[i + 3] = toInt16(points[i + 3]);
+            }
+        } else if (encoding == FLOAT16) {
+#ifdef VELODYNE_POINT_ENCODING_X86
+            if (useF16C && isF16CSupported()) {
+                toHalfF16C(points, numberOfPoints, static_cast< uint16_t * >(destination));
+                return;
+            }
+#endif
+            uint16_t *out = static_cast< uint16_t * >(destination);
+            for (uint32_t i = 0; i < numberOfPoints * NUMBER_OF_COMPONENTS_PER_POINT; i++) {
+                out[i] = toHalf(points[i]);
+            }
+        } else {
+            memcpy(destination, points, numberOfPoints * getBytesPerPoint(FLOAT32));
+        }
+    }
+
+    /**
+     * This method decodes points of a shared point cloud into xyz+intensity floats.
+     *
+     * @param encoding encoding of the source.
+     * @param source numberOfPoints * getBytesPerPoint(encoding) bytes.
+     * @param numberOfPoints number of points.
+     * @param points memory for numberOfPoints * 4 floats.
+     * @param useF16C false to convert half precision floats without F16C.
+     */
+    static void decode(const Encoding &encoding, const void *source, const uint32_t &numberOfPoints, float *points, const bool &useF16C = true) {
+        if (encoding == INT16) {
+            const int16_t *in = static_cast< const int16_t * >(source);
+            uint32_t i = 0;
+#ifdef VELODYNE_POINT_ENCODING_SSE2
+            i = fromInt16SSE2(in, numberOfPoints, points);
+#endif
+            for (; i < numberOfPoints * NUMBER_OF_COMPONENTS_PER_POINT; i += NUMBER_OF_COMPONENTS_PER_POINT) {
+                points[i] = fromInt16(in[i], INT16_RESOLUTION);
+                points[i + 1] = fromInt16(in[i + 1], INT16_RESOLUTION);
+                points[i + 2] = fromInt16(in[i + 2], INT16_RESOLUTION);
+                points[i + 3] = fromInt16(in[i + 3], 1.0f);
+            }
+        } else if (encoding == FLOAT16) {
+#ifdef VELODYNE_POINT_ENCODING_X86
+            if (useF16C && isF16CSupported()) {
+                fromHalfF16C(static_cast< const uint16_t * >(source), numberOfPoints, points);
+                return;
+            }
+#endif
+            const uint16_t *in = static_cast< const uint16_t * >(source);
+            for (uint32_t i = 0; i < numberOfPoints * NUMBER_OF_COMPONENTS_PER_POINT; i++) {
+                points[i] = fromHalf(in[i]);
+            }
+        } else {
+            memcpy(points, source, numberOfPoints * getBytesPerPoint(FLOAT32));
+        }
+    }
+
+    /**
+     * @return Half precision float nearest to value (ties to even); beyond 65504 infinity.
+     */
+    static uint16_t toHalf(const float &value) {
+        uint32_t bits = 0;
+        memcpy(&bits, &value, sizeof(bits));
+        const uint16_t sign = static_cast< uint16_t >((bits >> 16) & 0x8000);
+        const uint32_t magnitude = bits & 0x7FFFFFFF;
+        if (magnitude > 0x7F800000) {
+            return static_cast< uint16_t >(sign | 0x7E00); //NaN
+        }
+        if (magnitude >= 0x477FF000) {
+            return static_cast< uint16_t >(sign | 0x7C00); //65520 and more round to infinity
+        }
+        if (magnitude < 0x38800000) {
+            //Subnormal half precision float: value = m * 2^-24
+            if (magnitude < 0x33000000) {
+                return sign;
+            }
+            const uint32_t shift = 126 - (magnitude >> 23);
+            const uint32_t mantissa = (magnitude & 0x7FFFFF) | 0x800000;
+            const uint32_t remainder = mantissa & ((1u << shift) - 1);
+            const uint32_t halfway = 1u << (shift - 1);
+            uint32_t half = mantissa >> shift;
+            if (remainder > halfway || (remainder == halfway && (half & 1))) {
+                half++;
+            }
+            return static_cast< uint16_t >(sign | half);
+        }
+        uint32_t half = (magnitude >> 13) - (112 << 10); //exponent bias 127 -> 15
+        const uint32_t remainder = magnitude & 0x1FFF;
+        if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+            half++; //a carry into the exponent is the next larger power of two
+        }
+        return static_cast< uint16_t >(sign | half);
+    }
+
+    /**
+     * @return Value of the half precision float.
+     */
+    static float fromHalf(const uint16_t &half) {
+        const uint32_t sign = static_cast< uint32_t >(half & 0x8000) << 16;
+        uint32_t exponent = (half >> 10) & 0x1F;
+        uint32_t mantissa = half & 0x3FF;
+        uint32_t bits = sign;
+        if (exponent == 0x1F) {
+            bits |= 0x7F800000 | (mantissa << 13);
+        } else if (exponent > 0) {
+            bits |= ((exponent + 112) << 23) | (mantissa << 13);
+        } else if (mantissa > 0) {
+            exponent = 113;
+            while ((mantissa & 0x400) == 0) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            bits |= (exponent << 23) | ((mantissa & 0x3FF) << 13);
+        }
+        float value = 0.0f;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+   private:
+    //Rounds to nearest even and saturates to +-32767 as the SSE2 path; NaN is INT16_INVALID
+    static int16_t toInt16(const float &units) {
+        if (std::isnan(units)) {
+            return INT16_INVALID;
+        }
+        if (units >= 32767.0f) {
+            return 32767;
+        }
+        if (units <= -32767.0f) {
+            return -32767;
+        }
+        return static_cast< int16_t >(std::lrint(units));
+    }
+
+    static float fromInt16(const int16_t &value, const float &scale) {
+        return (value == INT16_INVALID) ? std::numeric_limits< float >::quiet_NaN() : static_cast< float >(value) * scale;
+    }
+
+#ifdef VELODYNE_POINT_ENCODING_SSE2
+    //Two points per iteration; cvtps2dq converts NaN to INT32_MIN which packssdw saturates to INT16_INVALID
+    static uint32_t toInt16SSE2(const float *points, const uint32_t &numberOfPoints, int16_t *out) {
+        const __m128 scale = _mm_setr_ps(1.0f / INT16_RESOLUTION, 1.0f / INT16_RESOLUTION, 1.0f / INT16_RESOLUTION, 1.0f);
+        const __m128 lowest = _mm_set1_ps(-32767.0f);
+        const __m128 highest = _mm_set1_ps(32767.0f);
+        uint32_t i = 0;
+        for (; i + 2 * NUMBER_OF_COMPONENTS_PER_POINT <= numberOfPoints * NUMBER_OF_COMPONENTS_PER_POINT; i += 2 * NUMBER_OF_COMPONENTS_PER_POINT) {
+            const __m128i first = _mm_cvtps_epi32(_mm_min_ps(highest, _mm_max_ps(lowest, _mm_mul_ps(_mm_loadu_ps(points + i), scale)))); //minps and maxps keep a NaN in their second operand
+            const __m128i second = _mm_cvtps_epi32(_mm_min_ps(highest, _mm_max_ps(lowest, _mm_mul_ps(_mm_loadu_ps(points + i + NUMBER_OF_COMPONENTS_PER_POINT), scale))));
+            _mm_storeu_si128(reinterpret_cast< __m128i * >(out + i), _mm_packs_epi32(first, second));
+        }
+        return i;
+    }
+
+    static __m128 fromInt16SSE2(const __m128i &values, const __m128 &scale, const __m128 &nan) {
+        const __m128i invalid = _mm_cmpeq_epi32(values, _mm_set1_epi32(INT16_INVALID));
+        const __m128 converted = _mm_mul_ps(_mm_cvtepi32_ps(values), scale);
+        return _mm_or_ps(_mm_andnot_ps(_mm_castsi128_ps(invalid), converted), _mm_and_ps(_mm_castsi128_ps(invalid), nan));
+    }
+
+    static uint32_t fromInt16SSE2(const int16_t *in, const uint32_t &numberOfPoints, float *points) {
+        const __m128 scale = _mm_setr_ps(INT16_RESOLUTION, INT16_RESOLUTION, INT16_RESOLUTION, 1.0f);
+        const __m128 nan = _mm_set1_ps(std::numeric_limits< float >::quiet_NaN());
+        uint32_t i = 0;
+        for (; i + 2 * NUMBER_OF_COMPONENTS_PER_POINT <= numberOfPoints * NUMBER_OF_COMPONENTS_PER_POINT; i += 2 * NUMBER_OF_COMPONENTS_PER_POINT) {
+            const __m128i values = _mm_loadu_si128(reinterpret_cast< const __m128i * >(in + i));
+            //Sign extension by unpacking into the upper halves and shifting back
+            _mm_storeu_ps(points + i, fromInt16SSE2(_mm_srai_epi32(_mm_unpacklo_epi16(values, values), 16), scale, nan));
+            _mm_storeu_ps(points + i + NUMBER_OF_COMPONENTS_PER_POINT, fromInt16SSE2(_mm_srai_epi32(_mm_unpackhi_epi16(values, values), 16), scale, nan));
+        }
+        return i;
+    }
+#endif
+
+#ifdef VELODYNE_POINT_ENCODING_X86
+    static bool isF16CSupported() {
+        static const bool supported = hasF16C();
+        return supported;
+    }
+
+    //One point of 4 floats is one vector of 4 halves
+    __attribute__((target("avx,f16c"))) static void toHalfF16C(const float *points, const uint32_t &numberOfPoints, uint16_t *out) {
+        for (uint32_t i = 0; i < numberOfPoints; i++) {
+            _mm_storel_epi64(reinterpret_cast< __m128i * >(out + i * NUMBER_OF_COMPONENTS_PER_POINT), _mm_cvtps_ph(_mm_loadu_ps(points + i * NUMBER_OF_COMPONENTS_PER_POINT), _MM_FROUND_TO_NEAREST_INT));
+        }
+    }
+
+    __attribute__((target("avx,f16c"))) static void fromHalfF16C(const uint16_t *in, const uint32_t &numberOfPoints, float *points) {
+        for (uint32_t i = 0; i < numberOfPoints; i++) {
+            _mm_storeu_ps(points + i * NUMBER_OF_COMPONENTS_PER_POINT, _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast< const __m128i * >(in + i * NUMBER_OF_COMPONENTS_PER_POINT))));
+        }
+    }
+#endif
+};
+
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNEPOINTENCODING_H_*/
@@ -0,0 +1,431 @@
+/**
+ * VelodynePoseBuffer - Vehicle poses for motion compensated Velodyne frames
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNEPOSEBUFFER_H_
+#define VELODYNEPOSEBUFFER_H_
+
+#include <stdint.h>
+
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * Pose of the vehicle: position in a local north/east/down frame in meters
+ * and orientation of the vehicle frame (x forward, y right, z down) as unit
+ * quaternion (w, x, y, z).
+ */
+struct VelodynePose {
+    int64_t time; //microseconds since the epoch
+    double position[3];
+    double orientation[4];
+};
+
+/**
+ * VelodynePoseBuffer keeps the latest poses of the vehicle in a ring and
+ * interpolates the pose at the time of each firing. Poses are pushed by the
+ * thread receiving the navigation data and looked up by the decoding thread;
+ * lookups with rising times continue from the previous one and thus take
+ * constant time per firing.
+ */
+class VelodynePoseBuffer {
+   public:
+    static constexpr uint32_t DEFAULT_CAPACITY = 256; //more than one second of poses at 200 Hz
+    static constexpr uint32_t MAX_CAPACITY = 1u << 20; //larger capacities are clamped
+    static constexpr int64_t MAX_EXTRAPOLATION = 50000; //microseconds a pose is extrapolated beyond the latest one
+
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    VelodynePoseBuffer(const VelodynePoseBuffer &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    VelodynePoseBuffer &operator=(const VelodynePoseBuffer &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param capacity number of poses; rounded up to a power of two and limited to MAX_CAPACITY.
+     */
+    explicit VelodynePoseBuffer(const uint32_t &capacity)
+        : m_mutex()
+        , m_poses(roundUp(capacity))
+        , m_mask(static_cast< uint32_t >(m_poses.size()) - 1)
+        , m_count(0)
+        , m_cursor(0)
+        , m_haveOrigin(false)
+        , m_origin()
+        , m_mounting() {
+        setMounting(0.0, 0.0, 0.0);
+    }
+
+    virtual ~VelodynePoseBuffer() {}
+
+    /**
+     * This method sets the orientation of the sensor on the vehicle. With
+     * all angles 0, the y axis of the sensor points forward and its z axis
+     * up, as in the points decoded from a Velodyne.
+     *
+     * @param roll rotation around the forward axis of the vehicle in radians.
+     * @param pitch rotation around the right axis of the vehicle in radians.
+     * @param yaw rotation around the down axis of the vehicle in radians.
+     */
+    void setMounting(const double &roll, const double &pitch, const double &yaw) {
+        double q[4];
+        fromEuler(roll, pitch, yaw, q);
+        double vehicle[9];
+        toMatrix(q, vehicle);
+        //Sensor (right, forward, up) to vehicle (forward, right, down), then rotated by the mounting angles
+        const double axes[9] = {0.0, 1.0, 0.0, 1.0, 0.0, 0.0, 0.0, 0.0, -1.0};
+        multiply(vehicle, axes, m_mounting);
+    }
+
+    /**
+     * This method adds a pose; poses older than the latest one are ignored.
+     *
+     * @param pose pose to add.
+     */
+    void push(const VelodynePose &pose) {
+        std::lock_guard< std::mutex > lock(m_mutex);
+        if (m_count > 0 && pose.time <= m_poses[(m_count - 1) & m_mask].time) {
+            return;
+        }
+        m_poses[m_count & m_mask] = pose;
+        m_count++;
+    }
+
+    /**
+     * This method adds a pose from a navigation solution, e.g. Applanix Grp1Data.
+     * The first position is the origin of the local frame.
+     *
+     * @param time microseconds since the epoch.
+     * @param latitude WGS84 latitude in degrees.
+     * @param longitude WGS84 longitude in degrees.
+     * @param altitude altitude in meters.
+     * @param roll roll in degrees.
+     * @param pitch pitch in degrees.
+     * @param heading heading in degrees.
+     */
+    void pushGeodetic(const int64_t &time, const double &latitude, const double &longitude, const double &altitude, const double &roll, const double &pitch, const double &heading) {
+        const double TO_RADIAN = M_PI / 180.0;
+        const double EARTH_RADIUS = 6378137.0;
+        if (!m_haveOrigin) {
+            m_origin[0] = latitude;
+            m_origin[1] = longitude;
+            m_origin[2] = altitude;
+            m_haveOrigin = true;
+        }
+        VelodynePose pose;
+        pose.time = time;
+        pose.position[0] = (latitude - m_origin[0]) * TO_RADIAN * EARTH_RADIUS;
+        pose.position[1] = (longitude - m_origin[1]) * TO_RADIAN * EARTH_RADIUS * std::cos(m_origin[0] * TO_RADIAN);
+        pose.position[2] = m_origin[2] - altitude;
+        fromEuler(roll * TO_RADIAN, pitch * TO_RADIAN, heading * TO_RADIAN, pose.orientation);
+        push(pose);
+    }
+
+    /**
+     * This method adds a pose by rotating the latest one with the angular
+     * velocity of the vehicle, e.g. from an AngularVelocityReading. The
+     * position is kept; an IMU alone cannot observe the velocity.
+     *
+     * @param time microseconds since the epoch.
+     * @param angularVelocity angular velocity around the x, y, z axes of the vehicle in rad/s.
+     */
+    void pushAngularVelocity(const int64_t &time, const double angularVelocity[3]) {
+        VelodynePose pose;
+        {
+            std::lock_guard< std::mutex > lock(m_mutex);
+            if (m_count == 0) {
+                pose.time = time;
+                pose.position[0] = pose.position[1] = pose.position[2] = 0.0;
+                pose.orientation[0] = 1.0;
+                pose.orientation[1] = pose.orientation[2] = pose.orientation[3] = 0.0;
+            } else {
+                const VelodynePose &latest = m_poses[(m_count - 1) & m_mask];
+                const double dt = static_cast< double >(time - latest.time) * 1e-6;
+                //Integrate with the rotation of constant angular velocity over dt
+                const double omega = std::sqrt(angularVelocity[0] * angularVelocity[0] + angularVelocity[1] * angularVelocity[1] + angularVelocity[2] * angularVelocity[2]);
+                double delta[4] = {1.0, 0.0, 0.0, 0.0};
+                if (omega * dt > 1e-12) {
+                    const double s = std::sin(0.5 * omega * dt) / omega;
+                    delta[0] = std::cos(0.5 * omega * dt);
+                    delta[1] = angularVelocity[0] * s;
+                    delta[2] = angularVelocity[1] * s;
+                    delta[3] = angularVelocity[2] * s;
+                }
+                pose = latest;
+                pose.time = time;
+                multiplyQuaternion(latest.orientation, delta, pose.orientation);
+                normalize(pose.orientation);
+            }
+        }
+        push(pose);
+    }
+
+    /**
+     * @return Number of poses held.
+     */
+    uint32_t size() const {
+        std::lock_guard< std::mutex > lock(m_mutex);
+        return static_cast< uint32_t >((m_count < m_poses.size()) ? m_count : m_poses.size());
+    }
+
+    /**
+     * This method interpolates the pose at the given time; beyond the
+     * latest pose it is extrapolated by up to MAX_EXTRAPOLATION.
+     *
+     * @param time microseconds since the epoch.
+     * @param pose interpolated pose.
+     * @return false if no pose is known for this time.
+     */
+    bool interpolate(const int64_t &time, VelodynePose &pose) {
+        std::lock_guard< std::mutex > lock(m_mutex);
+        return find(time, pose);
+    }
+
+    /**
+     * This method transforms the points of a frame into the sensor pose at
+     * the end of the frame. One transformation is interpolated per firing,
+     * i.e. whenever the time offset advances by at least firingDuration.
+     *
+     * @param points x, y, z, intensity of each point.
+     * @param timeOffsets microseconds since the start of the frame of each point.
+     * @param numberOfPoints number of points.
+     * @param startTime first firing of the frame in microseconds since the epoch.
+     * @param endTime last firing of the frame in microseconds since the epoch.
+     * @param firingDuration microseconds between two firings.
+     * @return Number of compensated points; 0 if no poses are known for the frame.
+     */
+    uint32_t deskew(float *points, const float *timeOffsets, const uint32_t &numberOfPoints, const int64_t &startTime, const int64_t &endTime, const float &firingDuration) {
+        std::lock_guard< std::mutex > lock(m_mutex);
+        VelodynePose end;
+        VelodynePose firing;
+        if (numberOfPoints == 0 || !find(endTime, end) || !find(startTime, firing)) {
+            return 0;
+        }
+
+        //Vehicle to world at the end of the frame; inverted once
+        double endRotation[9];
+        toMatrix(end.orientation, endRotation);
+        double endInverse[9];
+        transpose(endRotation, endInverse);
+
+        float transform[12];
+        float firingOffset = -firingDuration;
+        uint32_t compensated = 0;
+        for (uint32_t i = 0; i < numberOfPoints; i++) {
+            if (timeOffsets[i] - firingOffset >= firingDuration) {
+                firingOffset = timeOffsets[i];
+                if (!find(startTime + static_cast< int64_t >(firingOffset), firing)) {
+                    break;
+                }
+                relativeTransform(endInverse, end.position, firing, transform);
+            }
+            float *p = points + i * 4;
+            const float x = p[0];
+            const float y = p[1];
+            const float z = p[2];
+            p[0] = transform[0] * x + transform[1] * y + transform[2] * z + transform[3];
+            p[1] = transform[4] * x + transform[5] * y + transform[6] * z + transform[7];
+            p[2] = transform[8] * x + transform[9] * y + transform[10] * z + transform[11];
+            compensated++;
+        }
+        return compensated;
+    }
+
+   private:
+    static uint32_t roundUp(const uint32_t &capacity) {
+        uint32_t c = 2;
+        while (c < capacity && c < MAX_CAPACITY) {
+            c <<= 1;
+        }
+        return c;
+    }
+
+    //Finds the poses around time starting at the previous lookup
+    bool find(const int64_t &time, VelodynePose &pose) {
+        const uint64_t size = (m_count < m_poses.size()) ? m_count : m_poses.size();
+        if (size == 0) {
+            return false;
+        }
+        const uint64_t oldest = m_count - size;
+        const uint64_t newest = m_count - 1;
+        if (time < m_poses[oldest & m_mask].time || time > m_poses[newest & m_mask].time + MAX_EXTRAPOLATION) {
+            return false;
+        }
+        if (size == 1) {
+            pose = m_poses[newest & m_mask];
+            pose.time = time;
+            return true;
+        }
+
+        uint64_t cursor = (m_cursor < oldest) ? oldest : ((m_cursor >= newest) ? newest - 1 : m_cursor);
+        while (cursor > oldest && m_poses[cursor & m_mask].time > time) {
+            cursor--;
+        }
+        while (cursor + 1 < newest && m_poses[(cursor + 1) & m_mask].time <= time) {
+            cursor++;
+        }
+        m_cursor = cursor;
+
+        const VelodynePose &a = m_poses[cursor & m_mask];
+        const VelodynePose &b = m_poses[(cursor + 1) & m_mask];
+        const double u = static_cast< double >(time - a.time) / static_cast< double >(b.time - a.time);
+        pose.time = time;
+        for (uint32_t i = 0; i < 3; i++) {
+            pose.position[i] = a.position[i] + u * (b.position[i] - a.position[i]);
+        }
+        slerp(a.orientation, b.orientation, u, pose.orientation);
+        return true;
+    }
+
+    //Transformation from the sensor at the firing to the sensor at the end of the frame
+    void relativeTransform(const double endInverse[9], const double endPosition[3], const VelodynePose &firing, float transform[12]) const {
+        double firingRotation[9];
+        toMatrix(firing.orientation, firingRotation);
+        double vehicle[9];
+        multiply(endInverse, firingRotation, vehicle);
+        const double delta[3] = {firing.position[0] - endPosition[0], firing.position[1] - endPosition[1], firing.position[2] - endPosition[2]};
+        double translation[3];
+        apply(endInverse, delta, translation);
+
+        //The mounting is a rotation, its inverse is its transpose
+        double mountingInverse[9];
+        transpose(m_mounting, mountingInverse);
+        double rotated[9];
+        multiply(vehicle, m_mounting, rotated);
+        double rotation[9];
+        multiply(mountingInverse, rotated, rotation);
+        double sensorTranslation[3];
+        apply(mountingInverse, translation, sensorTranslation);
+        for (uint32_t row = 0; row < 3; row++) {
+            for (uint32_t column = 0; column < 3; column++) {
+                transform[row * 4 + column] = static_cast< float >(rotation[row * 3 + column]);
+            }
+            transform[row * 4 + 3] = static_cast< float >(sensorTranslation[row]);
+        }
+    }
+
+    static void fromEuler(const double &roll, const double &pitch, const double &yaw, double q[4]) {
+        const double cr = std::cos(0.5 * roll), sr = std::sin(0.5 * roll);
+        const double cp = std::cos(0.5 * pitch), sp = std::sin(0.5 * pitch);
+        const double cy = std::cos(0.5 * yaw), sy = std::sin(0.5 * yaw);
+        q[0] = cy * cp * cr + sy * sp * sr;
+        q[1] = cy * cp * sr - sy * sp * cr;
+        q[2] = cy * sp * cr + sy * cp * sr;
+        q[3] = sy * cp * cr - cy * sp * sr;
+    }
+
+    static void multiplyQuaternion(const double a[4], const double b[4], double q[4]) {
+        q[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+        q[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+        q[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+        q[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+    }
+
+    static void normalize(double q[4]) {
+        const double n = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        for (uint32_t i = 0; i < 4; i++) {
+            q[i] /= n;
+        }
+    }
+
+    //Spherical interpolation; u > 1 continues the rotation beyond b
+    static void slerp(const double a[4], const double b[4], const double &u, double q[4]) {
+        double d = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+        const double sign = (d < 0.0) ? -1.0 : 1.0;
+        d *= sign;
+        double wa = 1.0 - u;
+        double wb = u;
+        if (d < 0.9995) {
+            const double theta = std::acos(d);
+            wa = std::sin((1.0 - u) * theta) / std::sin(theta);
+            wb = std::sin(u * theta) / std::sin(theta);
+        }
+        for (uint32_t i = 0; i < 4; i++) {
+            q[i] = wa * a[i] + wb * sign * b[i];
+        }
+        normalize(q);
+    }
+
+    static void toMatrix(const double q[4], double m[9]) {
+        const double w = q[0], x = q[1], y = q[2], z = q[3];
+        m[0] = 1.0 - 2.0 * (y * y + z * z);
+        m[1] = 2.0 * (x * y - w * z);
+        m[2] = 2.0 * (x * z + w * y);
+        m[3] = 2.0 * (x * y + w * z);
+        m[4] = 1.0 - 2.0 * (x * x + z * z);
+        m[5] = 2.0 * (y * z - w * x);
+        m[6] = 2.0 * (x * z - w * y);
+        m[7] = 2.0 * (y * z + w * x);
+        m[8] = 1.0 - 2.0 * (x * x + y * y);
+    }
+
+    static void multiply(const double a[9], const double b[9], double m[9]) {
+        for (uint32_t row = 0; row < 3; row++) {
+            for (uint32_t column = 0; column < 3; column++) {
+                m[row * 3 + column] = a[row * 3] * b[column] + a[row * 3 + 1] * b[3 + column] + a[row * 3 + 2] * b[6 + column];
+            }
+        }
+    }
+
+    static void transpose(const double a[9], double m[9]) {
+        for (uint32_t row = 0; row < 3; row++) {
+            for (uint32_t column = 0; column < 3; column++) {
+                m[row * 3 + column] = a[column * 3 + row];
+            }
+        }
+    }
+
+    static void apply(const double m[9], const double v[3], double r[3]) {
+        for (uint32_t row = 0; row < 3; row++) {
+            r[row] = m[row * 3] * v[0] + m[row * 3 + 1] * v[1] + m[row * 3 + 2] * v[2];
+        }
+    }
+
+   private:
+    mutable std::mutex m_mutex;
+    std::vector< VelodynePose > m_poses;
+    const uint32_t m_mask;
+    uint64_t m_count; //number of poses pushed so far
+    uint64_t m_cursor; //pose before the time of the previous lookup
+    bool m_haveOrigin;
+    double m_origin[3]; //latitude, longitude and altitude of the local frame
+    double m_mounting[9]; //sensor to vehicle
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNEPOSEBUFFER_H_*/
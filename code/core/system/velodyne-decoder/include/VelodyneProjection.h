@@ -0,0 +1,268 @@
+/**
+ * VelodyneProjection - Vectorized projection of Velodyne firings
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNEPROJECTION_H_
+#define VELODYNEPROJECTION_H_
+
+#include <stdint.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VELODYNE_PROJECTION_X86 1
+#include <immintrin.h>
+#endif
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * One firing to be projected to cartesian coordinates: the returns (3 bytes
+ * each: distance little endian, intensity) and the per-laser tables of the
+ * calibration, already offset to the first laser of the firing.
+ */
+struct VelodyneFiring {
+    const uint8_t *data; //at least 4 readable bytes after the last return
+    uint32_t numberOfReturns; //multiple of 8, at most 32
+    float sinAzimuth;
+    float cosAzimuth;
+    float distanceScale; //distance = raw * distanceScale / distanceDivisor + distCorrection
+    float distanceDivisor;
+    const float *distCorrection;
+    const float *cosVertical;
+    const float *sinVertical;
+    const float *cosRotation;
+    const float *sinRotation;
+    const float *horizOffsetCorrection;
+    const float *xyVertOffset;
+    const float *zVertOffset;
+    bool twoPointCorrection; //the distance corrections along x and y below are applied
+    const float *distSlopeX;
+    const float *distOffsetX;
+    const float *distSlopeY;
+    const float *distOffsetY;
+    bool intensityCorrection; //the intensity is calibrated with the tables below
+    const float *focalOffset;
+    const float *focalSlope;
+    const float *minIntensity;
+    const float *maxIntensity;
+};
+
+/**
+ * VelodyneProjection converts a whole firing into xyz+intensity points in
+ * one pass. Returns closer than 1 m are dropped; the remaining points are
+ * written consecutively. The arithmetic follows the scalar lookup table
+ * path of VelodyneDecoderCore operation by operation.
+ */
+class VelodyneProjection {
+   public:
+    enum Kernel {
+        SCALAR = 0,
+        SSE41 = 1,
+        AVX2 = 2,
+    };
+
+    /**
+     * @return The widest kernel supported by the CPU at runtime.
+     */
+    static Kernel best() {
+#ifdef VELODYNE_PROJECTION_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.1")) {
+            return SSE41;
+        }
+#endif
+        return SCALAR;
+    }
+
+    static bool isSupported(const Kernel &kernel) {
+        return kernel <= best();
+    }
+
+    static const char *getName(const Kernel &kernel) {
+        switch (kernel) {
+            case SCALAR: return "scalar";
+            case SSE41: return "SSE4.1";
+            case AVX2: return "AVX2";
+        }
+        return "unknown";
+    }
+
+    /**
+     * This method projects one firing with a vectorized kernel.
+     *
+     * @param kernel SSE41 or AVX2; must be supported by the CPU.
+     * @param firing returns and calibration.
+     * @param out points (4 floats each); must have room for numberOfReturns points.
+     * @param kept bit i is set if return i was written.
+     * @return Number of points written.
+     */
+    static uint32_t project(const Kernel &kernel, const VelodyneFiring &firing, float *out, uint32_t &kept) {
+        kept = 0;
+#ifdef VELODYNE_PROJECTION_X86
+        switch (kernel) {
+            case AVX2: return projectAVX2(firing, out, kept);
+            case SSE41: return projectSSE41(firing, out, kept);
+            case SCALAR: break;
+        }
+#else
+        (void)kernel;
+        (void)firing;
+        (void)out;
+#endif
+        return 0;
+    }
+
+#ifdef VELODYNE_PROJECTION_X86
+   private:
+    //Extracts 4 distances and intensities from 12 bytes of returns
+    __attribute__((target("sse4.1"))) static void unpack(const uint8_t *data, __m128 &raw, __m128 &intensity) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast< const __m128i * >(data));
+        const __m128i distances = _mm_shuffle_epi8(bytes, _mm_setr_epi8(0, 1, -1, -1, 3, 4, -1, -1, 6, 7, -1, -1, 9, 10, -1, -1));
+        const __m128i intensities = _mm_shuffle_epi8(bytes, _mm_setr_epi8(2, -1, -1, -1, 5, -1, -1, -1, 8, -1, -1, -1, 11, -1, -1, -1));
+        raw = _mm_cvtepi32_ps(distances);
+        intensity = _mm_cvtepi32_ps(intensities);
+    }
+
+    //Corrects 4 intensities for the focal distance and limits them to the range of their lasers (see VelodyneCalibration::calibrateIntensity)
+    __attribute__((target("sse4.1"))) static __m128 calibrateIntensity(const VelodyneFiring &f, const uint32_t &i, const __m128 &raw, const __m128 &intensity) {
+        const __m128 remaining = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_div_ps(raw, _mm_set1_ps(65535.0f)));
+        const __m128 focal = _mm_sub_ps(_mm_loadu_ps(f.focalOffset + i), _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(256.0f), remaining), remaining));
+        const __m128 calibrated = _mm_add_ps(intensity, _mm_mul_ps(_mm_loadu_ps(f.focalSlope + i), _mm_andnot_ps(_mm_set1_ps(-0.0f), focal)));
+        return _mm_min_ps(_mm_max_ps(calibrated, _mm_loadu_ps(f.minIntensity + i)), _mm_loadu_ps(f.maxIntensity + i));
+    }
+
+    //Writes the valid points of 4 lanes consecutively
+    __attribute__((target("sse4.1"))) static float *store(__m128 x, __m128 y, __m128 z, __m128 intensity, const int32_t &valid, float *out) {
+        _MM_TRANSPOSE4_PS(x, y, z, intensity);
+        _mm_storeu_ps(out, x);
+        out += 4 * (valid & 1);
+        _mm_storeu_ps(out, y);
+        out += 4 * ((valid >> 1) & 1);
+        _mm_storeu_ps(out, z);
+        out += 4 * ((valid >> 2) & 1);
+        _mm_storeu_ps(out, intensity);
+        out += 4 * ((valid >> 3) & 1);
+        return out;
+    }
+
+    __attribute__((target("sse4.1"))) static uint32_t projectSSE41(const VelodyneFiring &f, float *out, uint32_t &kept) {
+        float *const begin = out;
+        const __m128 sinAzimuth = _mm_set1_ps(f.sinAzimuth);
+        const __m128 cosAzimuth = _mm_set1_ps(f.cosAzimuth);
+        const __m128 scale = _mm_set1_ps(f.distanceScale);
+        const __m128 divisor = _mm_set1_ps(f.distanceDivisor);
+        const __m128 minimum = _mm_set1_ps(1.0f);
+        const __m128 sign = _mm_set1_ps(-0.0f);
+        for (uint32_t i = 0; i < f.numberOfReturns; i += 4) {
+            __m128 raw;
+            __m128 intensity;
+            unpack(f.data + i * 3, raw, intensity);
+
+            const __m128 distance = _mm_add_ps(_mm_div_ps(_mm_mul_ps(raw, scale), divisor), _mm_loadu_ps(f.distCorrection + i));
+            const int32_t valid = _mm_movemask_ps(_mm_cmpgt_ps(distance, minimum));
+
+            const __m128 cosRotation = _mm_loadu_ps(f.cosRotation + i);
+            const __m128 sinRotation = _mm_loadu_ps(f.sinRotation + i);
+            const __m128 horizOffset = _mm_loadu_ps(f.horizOffsetCorrection + i);
+            const __m128 sinRotated = _mm_sub_ps(_mm_mul_ps(sinAzimuth, cosRotation), _mm_mul_ps(cosAzimuth, sinRotation));
+            const __m128 cosRotated = _mm_add_ps(_mm_mul_ps(cosAzimuth, cosRotation), _mm_mul_ps(sinAzimuth, sinRotation));
+            const __m128 cosVertical = _mm_loadu_ps(f.cosVertical + i);
+            const __m128 sinVertical = _mm_loadu_ps(f.sinVertical + i);
+            const __m128 xyVertOffset = _mm_loadu_ps(f.xyVertOffset + i);
+            const __m128 zVertOffset = _mm_loadu_ps(f.zVertOffset + i);
+            const __m128 xyDistance = _mm_sub_ps(_mm_mul_ps(distance, cosVertical), xyVertOffset);
+            __m128 x = _mm_sub_ps(_mm_mul_ps(xyDistance, sinRotated), _mm_mul_ps(horizOffset, cosRotated));
+            __m128 y = _mm_add_ps(_mm_mul_ps(xyDistance, cosRotated), _mm_mul_ps(horizOffset, sinRotated));
+            __m128 z = _mm_add_ps(_mm_mul_ps(distance, sinVertical), zVertOffset);
+            if (f.twoPointCorrection) {
+                const __m128 distanceX = _mm_add_ps(_mm_add_ps(distance, _mm_mul_ps(_mm_loadu_ps(f.distSlopeX + i), _mm_andnot_ps(sign, x))), _mm_loadu_ps(f.distOffsetX + i));
+                const __m128 distanceY = _mm_add_ps(_mm_add_ps(distance, _mm_mul_ps(_mm_loadu_ps(f.distSlopeY + i), _mm_andnot_ps(sign, y))), _mm_loadu_ps(f.distOffsetY + i));
+                x = _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(distanceX, cosVertical), xyVertOffset), sinRotated), _mm_mul_ps(horizOffset, cosRotated));
+                y = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(distanceY, cosVertical), xyVertOffset), cosRotated), _mm_mul_ps(horizOffset, sinRotated));
+                z = _mm_add_ps(_mm_mul_ps(distanceY, sinVertical), zVertOffset);
+            }
+            if (f.intensityCorrection) {
+                intensity = calibrateIntensity(f, i, raw, intensity);
+            }
+            out = store(x, y, z, intensity, valid, out);
+            kept |= static_cast< uint32_t >(valid) << i;
+        }
+        return static_cast< uint32_t >(out - begin) / 4;
+    }
+
+    __attribute__((target("avx2"))) static uint32_t projectAVX2(const VelodyneFiring &f, float *out, uint32_t &kept) {
+        float *const begin = out;
+        const __m256 sinAzimuth = _mm256_set1_ps(f.sinAzimuth);
+        const __m256 cosAzimuth = _mm256_set1_ps(f.cosAzimuth);
+        const __m256 scale = _mm256_set1_ps(f.distanceScale);
+        const __m256 divisor = _mm256_set1_ps(f.distanceDivisor);
+        const __m256 minimum = _mm256_set1_ps(1.0f);
+        const __m256 sign = _mm256_set1_ps(-0.0f);
+        for (uint32_t i = 0; i < f.numberOfReturns; i += 8) {
+            __m128 rawLow, rawHigh, intensityLow, intensityHigh;
+            unpack(f.data + i * 3, rawLow, intensityLow);
+            unpack(f.data + i * 3 + 12, rawHigh, intensityHigh);
+            const __m256 raw = _mm256_insertf128_ps(_mm256_castps128_ps256(rawLow), rawHigh, 1);
+
+            const __m256 distance = _mm256_add_ps(_mm256_div_ps(_mm256_mul_ps(raw, scale), divisor), _mm256_loadu_ps(f.distCorrection + i));
+            const int32_t valid = _mm256_movemask_ps(_mm256_cmp_ps(distance, minimum, _CMP_GT_OQ));
+
+            const __m256 cosRotation = _mm256_loadu_ps(f.cosRotation + i);
+            const __m256 sinRotation = _mm256_loadu_ps(f.sinRotation + i);
+            const __m256 horizOffset = _mm256_loadu_ps(f.horizOffsetCorrection + i);
+            const __m256 sinRotated = _mm256_sub_ps(_mm256_mul_ps(sinAzimuth, cosRotation), _mm256_mul_ps(cosAzimuth, sinRotation));
+            const __m256 cosRotated = _mm256_add_ps(_mm256_mul_ps(cosAzimuth, cosRotation), _mm256_mul_ps(sinAzimuth, sinRotation));
+            const __m256 cosVertical = _mm256_loadu_ps(f.cosVertical + i);
+            const __m256 sinVertical = _mm256_loadu_ps(f.sinVertical + i);
+            const __m256 xyVertOffset = _mm256_loadu_ps(f.xyVertOffset + i);
+            const __m256 zVertOffset = _mm256_loadu_ps(f.zVertOffset + i);
+            const __m256 xyDistance = _mm256_sub_ps(_mm256_mul_ps(distance, cosVertical), xyVertOffset);
+            __m256 x = _mm256_sub_ps(_mm256_mul_ps(xyDistance, sinRotated), _mm256_mul_ps(horizOffset, cosRotated));
+            __m256 y = _mm256_add_ps(_mm256_mul_ps(xyDistance, cosRotated), _mm256_mul_ps(horizOffset, sinRotated));
+            __m256 z = _mm256_add_ps(_mm256_mul_ps(distance, sinVertical), zVertOffset);
+            if (f.twoPointCorrection) {
+                const __m256 distanceX = _mm256_add_ps(_mm256_add_ps(distance, _mm256_mul_ps(_mm256_loadu_ps(f.distSlopeX + i), _mm256_andnot_ps(sign, x))), _mm256_loadu_ps(f.distOffsetX + i));
+                const __m256 distanceY = _mm256_add_ps(_mm256_add_ps(distance, _mm256_mul_ps(_mm256_loadu_ps(f.distSlopeY + i), _mm256_andnot_ps(sign, y))), _mm256_loadu_ps(f.distOffsetY + i));
+                x = _mm256_sub_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(distanceX, cosVertical), xyVertOffset), sinRotated), _mm256_mul_ps(horizOffset, cosRotated));
+                y = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_mul_ps(distanceY, cosVertical), xyVertOffset), cosRotated), _mm256_mul_ps(horizOffset, sinRotated));
+                z = _mm256_add_ps(_mm256_mul_ps(distanceY, sinVertical), zVertOffset);
+            }
+            if (f.intensityCorrection) {
+                intensityLow = calibrateIntensity(f, i, rawLow, intensityLow);
+                intensityHigh = calibrateIntensity(f, i + 4, rawHigh, intensityHigh);
+            }
+
+            out = store(_mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z), intensityLow, valid & 0xF, out);
+            out = store(_mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1), intensityHigh, valid >> 4, out);
+            kept |= static_cast< uint32_t >(valid) << i;
+        }
+        return static_cast< uint32_t >(out - begin) / 4;
+    }
+#endif
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNEPROJECTION_H_*/
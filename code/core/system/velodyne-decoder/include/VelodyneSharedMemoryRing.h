@@ -0,0 +1,157 @@
+/**
+ * VelodyneSharedMemoryRing - Ring of shared memory slots for point clouds
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNESHAREDMEMORYRING_H_
+#define VELODYNESHAREDMEMORYRING_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "SharedMemorySlotRing.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * Description of a frame stored in the trailer of its slot.
+ */
+struct VelodyneFrameInfo {
+    uint32_t numberOfPoints;
+    int64_t startTime; //first firing of the frame in microseconds since the epoch
+    int64_t endTime; //last firing of the frame in microseconds since the epoch
+    float startAzimuth; //azimuth of the first firing in degrees
+    float endAzimuth; //azimuth of the last firing in degrees
+};
+
+typedef SharedMemorySlotTrailer< VelodyneFrameInfo > VelodyneSlotTrailer;
+
+/**
+ * VelodyneSharedMemoryRing is the SharedMemorySlotRing a decoder writes its
+ * frames into directly. A frame is published by announcing its slot in a
+ * SharedPointCloud. A reader copies the points out and validates the copy
+ * with read(): a slow reader sees either a changed sequence (the slot was
+ * overwritten while copying) or a gap in the frame numbers.
+ *
+ * The SharedPointCloud announces the size of the frame, not the size the
+ * slots were created for, so readers locate the trailer from the size of
+ * the segment with getCapacity().
+ */
+class VelodyneSharedMemoryRing : public SharedMemorySlotRing< VelodyneFrameInfo > {
+   private:
+    typedef SharedMemorySlotRing< VelodyneFrameInfo > Ring;
+
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    VelodyneSharedMemoryRing(const VelodyneSharedMemoryRing &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    VelodyneSharedMemoryRing &operator=(const VelodyneSharedMemoryRing &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param name base name of the shared memory segments.
+     * @param numberOfSlots number of slots (at least 2 to never overwrite the latest frame).
+     * @param size size in bytes of the point data per slot.
+     */
+    VelodyneSharedMemoryRing(const std::string &name, const uint32_t &numberOfSlots, const uint32_t &size)
+        : Ring(name, numberOfSlots, size) {}
+
+    virtual ~VelodyneSharedMemoryRing() {}
+
+    /**
+     * This method marks the slot of the current frame as being written.
+     *
+     * @return Memory for the points of the current frame.
+     */
+    float *beginFrame() {
+        return reinterpret_cast< float * >(Ring::beginFrame());
+    }
+
+    /**
+     * This method publishes the current frame and advances to the next slot.
+     *
+     * @param numberOfPoints number of points of the current frame.
+     * @param startTime first firing of the frame in microseconds since the epoch.
+     * @param endTime last firing of the frame in microseconds since the epoch.
+     * @param startAzimuth azimuth of the first firing in degrees.
+     * @param endAzimuth azimuth of the last firing in degrees.
+     * @return Name of the shared memory segment holding the published frame.
+     */
+    std::string publishFrame(const uint32_t &numberOfPoints, const int64_t &startTime = 0, const int64_t &endTime = 0, const float &startAzimuth = 0.0f, const float &endAzimuth = 0.0f) {
+        const VelodyneFrameInfo info = {numberOfPoints, startTime, endTime, startAzimuth, endAzimuth};
+        return Ring::publishFrame(info);
+    }
+
+    /**
+     * This method copies a published frame out of a slot without blocking
+     * the writer.
+     *
+     * @param slot memory of the slot as attached by the reader.
+     * @param slotSize size in bytes of the attached shared memory segment; the trailer is located with getCapacity(slotSize).
+     * @param destination memory for size bytes.
+     * @param size number of bytes to copy as announced in the SharedPointCloud.
+     * @param numberOfPoints number of points of the copied frame.
+     * @param frame number of the copied frame; a gap to the previous one means missed frames.
+     * @param startTime if not NULL, first firing of the frame in microseconds since the epoch.
+     * @param endTime if not NULL, last firing of the frame in microseconds since the epoch.
+     * @param startAzimuth if not NULL, azimuth of the first firing in degrees.
+     * @param endAzimuth if not NULL, azimuth of the last firing in degrees.
+     * @return true if a complete frame was copied; false if the slot was written meanwhile.
+     */
+    static bool read(const void *slot, const uint32_t &slotSize, void *destination, const uint32_t &size, uint32_t &numberOfPoints, uint32_t &frame, int64_t *startTime = NULL, int64_t *endTime = NULL, float *startAzimuth = NULL, float *endAzimuth = NULL) {
+        const uint32_t capacity = getCapacity(slotSize);
+        VelodyneFrameInfo info;
+        if (capacity == 0 || !Ring::read(slot, slotSize, capacity, destination, size, frame, &info)) {
+            return false;
+        }
+        numberOfPoints = info.numberOfPoints;
+        if (startTime != NULL) {
+            *startTime = info.startTime;
+        }
+        if (endTime != NULL) {
+            *endTime = info.endTime;
+        }
+        if (startAzimuth != NULL) {
+            *startAzimuth = info.startAzimuth;
+        }
+        if (endAzimuth != NULL) {
+            *endAzimuth = info.endAzimuth;
+        }
+        return true;
+    }
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNESHAREDMEMORYRING_H_*/
@@ -0,0 +1,408 @@
+/**
+ * VelodyneUDPReceiver - Receive and decode threads for Velodyne packets
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef VELODYNEUDPRECEIVER_H_
+#define VELODYNEUDPRECEIVER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#include "opendavinci/odcore/data/TimeStamp.h"
+
+#include "VelodynePacketQueue.h"
+
+namespace opendlv {
+namespace core {
+namespace system {
+namespace proxy {
+
+/**
+ * Interface to consume raw packets without copying them into a string.
+ */
+class VelodynePacketListener {
+   public:
+    virtual ~VelodynePacketListener() {}
+
+    /**
+     * @param data UDP payload.
+     * @param length length of the payload.
+     * @param received time the kernel received the packet.
+     */
+    virtual void nextPacket(const uint8_t *data, const uint32_t &length, const odcore::data::TimeStamp &received) = 0;
+};
+
+/**
+ * Counters of a VelodyneUDPReceiver.
+ */
+struct VelodyneReceiverStatistics {
+    uint64_t packets; //packets handed to the decode thread
+    uint64_t queueDrops; //packets dropped because the queue was full
+    uint64_t kernelDrops; //packets dropped by the kernel because the socket buffer was full
+    uint64_t batches; //number of recvmmsg calls that returned packets
+    uint32_t highWaterMark; //highest number of queued packets
+    uint32_t capacity; //capacity of the queue
+    uint32_t receiveBufferSize; //socket receive buffer in bytes granted by the kernel
+};
+
+/**
+ * VelodyneUDPReceiver drains a UDP socket in a dedicated receive thread
+ * with recvmmsg directly into the buffers of a VelodynePacketQueue; a
+ * second thread hands the queued packets to the decoder. A slow frame
+ * publication therefore does not stall the socket. The decode thread
+ * sleeps on a condition variable while the queue is empty and is woken
+ * after each batch the receive thread pushes. When the queue is full,
+ * the packets are still read from the socket but counted as queue drops.
+ *
+ * Each packet carries the receive time taken by the kernel (SO_TIMESTAMPNS);
+ * if the kernel does not provide it, the time the batch was read is used.
+ *
+ * Only available on Linux; start() returns false elsewhere.
+ */
+class VelodyneUDPReceiver {
+   public:
+    static constexpr uint32_t DEFAULT_BATCH_SIZE = 32; //default maximum number of packets per recvmmsg
+    static constexpr uint32_t MAX_BATCH_SIZE = 1024; //UIO_MAXIOV
+
+   private:
+    /**
+     * "Forbidden" copy constructor. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the copy constructor.
+     */
+    VelodyneUDPReceiver(const VelodyneUDPReceiver &);
+
+    /**
+     * "Forbidden" assignment operator. Goal: The compiler should warn
+     * already at compile time for unwanted bugs caused by any misuse
+     * of the assignment operator.
+     */
+    VelodyneUDPReceiver &operator=(const VelodyneUDPReceiver &);
+
+   public:
+    /**
+     * Constructor.
+     *
+     * @param address IP address to listen on ("0.0.0.0" for all interfaces).
+     * @param port UDP port; 0 to let the system choose (see getPort()).
+     * @param listener consumer of the packets, called from the decode thread.
+     * @param queueCapacity number of packets buffered between the threads.
+     */
+    VelodyneUDPReceiver(const std::string &address, const uint32_t &port, VelodynePacketListener &listener, const uint32_t &queueCapacity)
+        : m_address(address)
+        , m_port(port)
+        , m_listener(listener)
+        , m_queue(queueCapacity)
+        , m_batchSize(DEFAULT_BATCH_SIZE)
+        , m_receiveBufferSize(0)
+        , m_effectiveReceiveBufferSize(0)
+        , m_socket(-1)
+        , m_running(false)
+        , m_decoding(false)
+        , m_receiveThread()
+        , m_decodeThread()
+        , m_wakeupMutex()
+        , m_wakeup()
+        , m_packets(0)
+        , m_queueDrops(0)
+        , m_kernelDrops(0)
+        , m_batches(0) {}
+
+    virtual ~VelodyneUDPReceiver() {
+        stop();
+    }
+
+    /**
+     * This method sets the maximum number of packets read per system call.
+     * It must be called before start().
+     *
+     * @param batchSize 1 .. MAX_BATCH_SIZE packets.
+     */
+    void setBatchSize(const uint32_t &batchSize) {
+        m_batchSize = (batchSize < 1) ? 1 : ((batchSize > MAX_BATCH_SIZE) ? static_cast< uint32_t >(MAX_BATCH_SIZE) : batchSize);
+    }
+
+    uint32_t getBatchSize() const {
+        return m_batchSize;
+    }
+
+    /**
+     * This method sets the socket receive buffer (SO_RCVBUF) to absorb
+     * bursts while the receive thread is not scheduled. It must be called
+     * before start().
+     *
+     * @param size size in bytes; 0 keeps the system default.
+     */
+    void setReceiveBufferSize(const uint32_t &size) {
+        m_receiveBufferSize = size;
+    }
+
+    /**
+     * This method opens the socket and starts the receive and decode threads.
+     *
+     * @return true if the socket could be opened.
+     */
+    bool start() {
+        if (m_running.load()) {
+            return true;
+        }
+#ifdef __linux__
+        if (!openSocket()) {
+            return false;
+        }
+        m_running.store(true);
+        m_decoding.store(true);
+        m_decodeThread = std::thread(&VelodyneUDPReceiver::decode, this);
+        m_receiveThread = std::thread(&VelodyneUDPReceiver::receive, this);
+        return true;
+#else
+        std::cerr << "VelodyneUDPReceiver is only available on Linux." << std::endl;
+        return false;
+#endif
+    }
+
+    /**
+     * This method stops both threads after the queued packets are decoded.
+     */
+    void stop() {
+        if (!m_running.exchange(false)) {
+            return;
+        }
+        if (m_receiveThread.joinable()) {
+            m_receiveThread.join();
+        }
+        m_decoding.store(false);
+        wakeDecoder();
+        if (m_decodeThread.joinable()) {
+            m_decodeThread.join();
+        }
+#ifdef __linux__
+        close(m_socket);
+#endif
+        m_socket = -1;
+    }
+
+    /**
+     * @return Port the socket is bound to.
+     */
+    uint32_t getPort() const {
+        return m_port;
+    }
+
+    VelodyneReceiverStatistics getStatistics() const {
+        VelodyneReceiverStatistics s;
+        s.packets = m_packets.load(std::memory_order_relaxed);
+        s.queueDrops = m_queueDrops.load(std::memory_order_relaxed);
+        s.kernelDrops = m_kernelDrops.load(std::memory_order_relaxed);
+        s.batches = m_batches.load(std::memory_order_relaxed);
+        s.highWaterMark = m_queue.getHighWaterMark();
+        s.capacity = m_queue.getCapacity();
+        s.receiveBufferSize = m_effectiveReceiveBufferSize;
+        return s;
+    }
+
+   private:
+#ifdef __linux__
+    bool openSocket() {
+        m_socket = socket(AF_INET, SOCK_DGRAM, 0);
+        if (m_socket < 0) {
+            std::cerr << "VelodyneUDPReceiver: Could not create socket." << std::endl;
+            return false;
+        }
+
+        int32_t enable = 1;
+        setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+        //Report the number of packets dropped by the kernel with each packet
+        setsockopt(m_socket, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable));
+        //Report the time the kernel received each packet
+        setsockopt(m_socket, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable));
+        if (m_receiveBufferSize > 0) {
+            //SO_RCVBUFFORCE ignores net.core.rmem_max but needs CAP_NET_ADMIN
+            const int32_t size = static_cast< int32_t >(m_receiveBufferSize);
+            if (setsockopt(m_socket, SOL_SOCKET, SO_RCVBUFFORCE, &size, sizeof(size)) < 0) {
+                setsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+            }
+        }
+        int32_t effectiveSize = 0;
+        socklen_t sizeLength = sizeof(effectiveSize);
+        if (getsockopt(m_socket, SOL_SOCKET, SO_RCVBUF, &effectiveSize, &sizeLength) == 0) {
+            //The kernel reports twice the granted size (bookkeeping overhead included)
+            m_effectiveReceiveBufferSize = static_cast< uint32_t >(effectiveSize) / 2;
+        }
+        if (m_effectiveReceiveBufferSize < m_receiveBufferSize) {
+            std::cerr << "VelodyneUDPReceiver: Receive buffer limited to " << m_effectiveReceiveBufferSize << " bytes; raise net.core.rmem_max to get " << m_receiveBufferSize << " bytes." << std::endl;
+        }
+        //Wake up regularly to notice stop()
+        struct timeval timeout;
+        timeout.tv_sec = 0;
+        timeout.tv_usec = 100000;
+        setsockopt(m_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast< uint16_t >(m_port));
+        if (inet_pton(AF_INET, m_address.c_str(), &address.sin_addr) != 1
+            || bind(m_socket, reinterpret_cast< struct sockaddr * >(&address), sizeof(address)) < 0) {
+            std::cerr << "VelodyneUDPReceiver: Could not bind to " << m_address << ":" << m_port << "." << std::endl;
+            close(m_socket);
+            m_socket = -1;
+            return false;
+        }
+
+        socklen_t length = sizeof(address);
+        if (getsockname(m_socket, reinterpret_cast< struct sockaddr * >(&address), &length) == 0) {
+            m_port = ntohs(address.sin_port);
+        }
+        return true;
+    }
+
+    void receive() {
+        const uint32_t controlSize = CMSG_SPACE(sizeof(uint32_t)) + CMSG_SPACE(sizeof(struct timespec));
+        std::vector< struct mmsghdr > messages(m_batchSize);
+        std::vector< struct iovec > iovecs(m_batchSize);
+        std::vector< uint8_t > control(m_batchSize * controlSize);
+        std::vector< uint8_t > scratch(VelodynePacketQueue::MAX_PACKET_SIZE); //target for packets that do not fit into the queue
+        std::vector< uint32_t > lengths(m_batchSize);
+        std::vector< int64_t > timestamps(m_batchSize);
+        uint32_t lastKernelDrops = 0;
+        bool haveKernelDrops = false;
+
+        while (m_running.load(std::memory_order_relaxed)) {
+            const uint32_t available = m_queue.getFree();
+            const bool full = (available == 0);
+            const uint32_t count = full ? 1 : (available < m_batchSize ? available : m_batchSize);
+            for (uint32_t i = 0; i < count; i++) {
+                iovecs[i].iov_base = full ? &scratch[0] : m_queue.getFreeBuffer(i);
+                iovecs[i].iov_len = VelodynePacketQueue::MAX_PACKET_SIZE;
+                memset(&messages[i], 0, sizeof(struct mmsghdr));
+                messages[i].msg_hdr.msg_iov = &iovecs[i];
+                messages[i].msg_hdr.msg_iovlen = 1;
+                messages[i].msg_hdr.msg_control = &control[i * controlSize];
+                messages[i].msg_hdr.msg_controllen = controlSize;
+            }
+
+            const int32_t received = recvmmsg(m_socket, &messages[0], count, MSG_WAITFORONE, NULL);
+            if (received <= 0) {
+                continue; //timeout or interrupted
+            }
+
+            struct timeval batchTime;
+            gettimeofday(&batchTime, NULL);
+            for (int32_t i = 0; i < received; i++) {
+                lengths[i] = messages[i].msg_len;
+                timestamps[i] = static_cast< int64_t >(batchTime.tv_sec) * 1000000L + batchTime.tv_usec;
+                for (struct cmsghdr *c = CMSG_FIRSTHDR(&messages[i].msg_hdr); c != NULL; c = CMSG_NXTHDR(&messages[i].msg_hdr, c)) {
+                    if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_TIMESTAMPNS) {
+                        struct timespec t;
+                        memcpy(&t, CMSG_DATA(c), sizeof(t));
+                        timestamps[i] = static_cast< int64_t >(t.tv_sec) * 1000000L + t.tv_nsec / 1000L;
+                    } else if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SO_RXQ_OVFL) {
+                        uint32_t drops = 0;
+                        memcpy(&drops, CMSG_DATA(c), sizeof(drops));
+                        if (haveKernelDrops && drops != lastKernelDrops) {
+                            m_kernelDrops.fetch_add(drops - lastKernelDrops, std::memory_order_relaxed);
+                        }
+                        lastKernelDrops = drops;
+                        haveKernelDrops = true;
+                    }
+                }
+            }
+
+            m_batches.fetch_add(1, std::memory_order_relaxed);
+            if (full) {
+                m_queueDrops.fetch_add(static_cast< uint64_t >(received), std::memory_order_relaxed);
+            } else {
+                m_queue.push(static_cast< uint32_t >(received), &lengths[0], &timestamps[0]);
+                wakeDecoder();
+            }
+        }
+    }
+#endif
+
+    void decode() {
+        const uint8_t *data = NULL;
+        uint32_t length = 0;
+        int64_t timestamp = 0;
+        while (true) {
+            if (m_queue.front(data, length, timestamp)) {
+                m_listener.nextPacket(data, length, odcore::data::TimeStamp(static_cast< int32_t >(timestamp / 1000000L), static_cast< int32_t >(timestamp % 1000000L)));
+                m_queue.pop();
+                m_packets.fetch_add(1, std::memory_order_relaxed);
+            } else if (!waitForPackets()) {
+                break;
+            }
+        }
+    }
+
+    //Returns false once the queue is empty and stop() was called
+    bool waitForPackets() {
+        std::unique_lock< std::mutex > lock(m_wakeupMutex);
+        m_wakeup.wait(lock, [this]() { return (m_queue.size() > 0) || !m_decoding.load(std::memory_order_relaxed); });
+        return (m_queue.size() > 0);
+    }
+
+    //The mutex orders the notification after a waiting decode thread checked the queue
+    void wakeDecoder() {
+        std::lock_guard< std::mutex > lock(m_wakeupMutex);
+        m_wakeup.notify_one();
+    }
+
+   private:
+    std::string m_address;
+    uint32_t m_port;
+    VelodynePacketListener &m_listener;
+    VelodynePacketQueue m_queue;
+    uint32_t m_batchSize;
+    uint32_t m_receiveBufferSize; //requested socket receive buffer; 0 for the system default
+    uint32_t m_effectiveReceiveBufferSize;
+    int32_t m_socket;
+    std::atomic< bool > m_running; //receive thread
+    std::atomic< bool > m_decoding; //decode thread; stopped after the receive thread
+    std::thread m_receiveThread;
+    std::thread m_decodeThread;
+    std::mutex m_wakeupMutex;
+    std::condition_variable m_wakeup; //signalled after each pushed batch and by stop()
+    std::atomic< uint64_t > m_packets;
+    std::atomic< uint64_t > m_queueDrops;
+    std::atomic< uint64_t > m_kernelDrops;
+    std::atomic< uint64_t > m_batches;
+};
+}
+}
+}
+} // opendlv::core::system::proxy
+
+#endif /*VELODYNEUDPRECEIVER_H_*/
@@ -0,0 +1,135 @@
+/**
+ * velodyne-decoder - Decoder core shared by the Velodyne proxies.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VELODYNECPCALLOCATION_TESTSUITE_H
+#define VELODYNECPCALLOCATION_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../include/VelodyneDecoderCore.h"
+#include "../include/VelodynePcapReader.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+// Every test suite is linked into its own executable, so the global allocation
+// functions can be replaced here to count the allocations while enabled.
+namespace allocations {
+bool counting = false;
+uint64_t count = 0;
+}
+
+void *operator new(std::size_t size) {
+    if (allocations::counting) {
+        allocations::count++;
+    }
+    void *p = malloc((size > 0) ? size : 1);
+    if (p == NULL) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) noexcept {
+    free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    free(p);
+}
+
+// Sums up the completed frames without allocating.
+template < typename Model >
+class CPCSizeCounter : public VelodyneFrameListener {
+   public:
+    CPCSizeCounter()
+        : m_core(NULL)
+        , m_frames(0)
+        , m_bytes(0) {}
+
+    virtual void nextFrame() {
+        for (uint8_t part = 0; part < Model::NUMBER_OF_CPC_PARTS; part++) {
+            m_bytes += m_core->getCompactPointCloud(part, false).size() + m_core->getCompactPointCloud(part, true).size();
+        }
+        m_frames++;
+    }
+
+    const VelodyneDecoderCore< Model > *m_core;
+    uint32_t m_frames;
+    uint64_t m_bytes;
+};
+
+// Decodes the recording once to reach the steady state and counts the allocations while decoding it again.
+template < typename Model >
+void checkSteadyState(const string &recording, const string &calibration) {
+    const vector< string > packets = VelodynePcapReader::readDataPackets(recording);
+    TS_ASSERT(!packets.empty());
+
+    CPCSizeCounter< Model > counter;
+    VelodyneDecoderOptions options = {true, 0, true, 2, 3, 0, 1};
+    VelodyneDecoderCore< Model > core(calibration, options, counter);
+    counter.m_core = &core;
+    for (auto &packet : packets) {
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+    }
+    const uint32_t framesBefore = counter.m_frames;
+    const uint64_t bytesBefore = counter.m_bytes;
+
+    allocations::count = 0;
+    allocations::counting = true;
+    for (auto &packet : packets) {
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+    }
+    allocations::counting = false;
+
+    TS_ASSERT_EQUALS(allocations::count, 0u);
+    TS_ASSERT(counter.m_frames > framesBefore);
+    TS_ASSERT(counter.m_bytes > bytesBefore);
+}
+
+class VelodyneCPCAllocationTest : public CxxTest::TestSuite {
+   public:
+    void testAllocationsAreCounted() {
+        allocations::count = 0;
+        allocations::counting = true;
+        const string s(1000, 'x');
+        allocations::counting = false;
+        TS_ASSERT_EQUALS(allocations::count, 1u);
+        TS_ASSERT_EQUALS(s.size(), 1000u);
+    }
+
+    void testNoAllocationsPerPacketVLP16() {
+        checkSteadyState< VLP16 >("../sampleShort.pcap", "../VLP-16.xml");
+    }
+
+    void testNoAllocationsPerPacketHDL32E() {
+        checkSteadyState< HDL32E >("../sampleShort_velodyne32.pcap", "../HDL-32E.xml");
+    }
+
+    void testNoAllocationsPerPacketHDL64E() {
+        checkSteadyState< HDL64E >("../atwallshort.pcap", "../db.xml");
+    }
+};
+
+#endif /*VELODYNECPCALLOCATION_TESTSUITE_H*/
@@ -0,0 +1,305 @@
+/**
+ * velodyne-decoder - Decoder core shared by the Velodyne proxies.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VELODYNECPCCODEC_TESTSUITE_H
+#define VELODYNECPCCODEC_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "opendavinci/generated/odcore/data/CompactPointCloud.h"
+#include "opendavinci/odcore/data/Container.h"
+#include "opendavinci/odcore/io/conference/ContainerConference.h"
+#include "opendavinci/odcore/wrapper/CompressionFactory.h"
+#include "opendavinci/odcore/wrapper/DecompressedData.h"
+#include "odvdopendlvstandardmessageset/GeneratedHeaders_ODVDOpenDLVStandardMessageSet.h"
+
+#include "../include/VelodyneCPCCodec.h"
+#include "../include/VelodyneDecoder.h"
+#include "../include/VelodyneDecoderCore.h"
+#include "../include/VelodynePcapReader.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+// Keeps the compact point clouds (all parts, with and without intensity) of every completed frame.
+template < typename Model >
+class CPCCollector : public VelodyneFrameListener {
+   public:
+    CPCCollector()
+        : m_core(NULL)
+        , m_parts() {}
+
+    virtual void nextFrame() {
+        vector< pair< string, uint8_t > > frame;
+        for (uint8_t part = 0; part < Model::NUMBER_OF_CPC_PARTS; part++) {
+            frame.push_back(make_pair(m_core->getCompactPointCloud(part, false), m_core->getEntriesPerAzimuth(part)));
+            frame.push_back(make_pair(m_core->getCompactPointCloud(part, true), m_core->getEntriesPerAzimuth(part)));
+        }
+        m_parts.push_back(frame);
+    }
+
+    const VelodyneDecoderCore< Model > *m_core;
+    vector< vector< pair< string, uint8_t > > > m_parts;
+};
+
+template < typename Model >
+vector< vector< pair< string, uint8_t > > > collectCPC(const string &recording, const string &calibration, const uint8_t &distanceEncoding) {
+    const vector< string > packets = VelodynePcapReader::readDataPackets(recording);
+    TS_ASSERT(!packets.empty());
+    CPCCollector< Model > collector;
+    VelodyneDecoderOptions options = {false, 0, true, 2, 3, 0, distanceEncoding};
+    VelodyneDecoderCore< Model > core(calibration, options, collector);
+    collector.m_core = &core;
+    for (auto &packet : packets) {
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+    }
+    TS_ASSERT(!collector.m_parts.empty());
+    return collector.m_parts;
+}
+
+// Compresses and restores every part of every frame; returns compressed / uncompressed bytes.
+template < typename Model >
+double checkRoundTrip(const string &recording, const string &calibration) {
+    uint64_t uncompressed = 0;
+    uint64_t compressed = 0;
+    uint32_t mismatches = 0;
+    string packed;
+    string restored;
+    for (uint8_t distanceEncoding = 0; distanceEncoding < 2; distanceEncoding++) {
+        const vector< vector< pair< string, uint8_t > > > frames = collectCPC< Model >(recording, calibration, distanceEncoding);
+        for (auto &frame : frames) {
+            for (auto &part : frame) {
+                VelodyneCPCCodec::compress(part.first, part.second, packed);
+                mismatches += !VelodyneCPCCodec::decompress(packed, part.second, restored) || (restored != part.first);
+                uncompressed += part.first.size();
+                compressed += packed.size();
+            }
+        }
+    }
+    TS_ASSERT_EQUALS(mismatches, 0u);
+    TS_ASSERT(uncompressed > 0);
+    return static_cast< double >(compressed) / static_cast< double >(uncompressed);
+}
+
+// Ranges of the points exported by VeloView (format "x, y, z, intensity" per line after a header line).
+inline vector< float > readVeloViewRanges(const string &zip) {
+    fstream fin(zip.c_str(), ios::binary | ios::in);
+    TS_ASSERT(fin.is_open());
+    std::shared_ptr< odcore::wrapper::DecompressedData > dd = odcore::wrapper::CompressionFactory::getContents(fin);
+    fin.close();
+    vector< float > ranges;
+    vector< string > entries = dd->getListOfEntries();
+    TS_ASSERT(!entries.empty());
+    if (entries.empty()) {
+        return ranges;
+    }
+    std::shared_ptr< istream > stream = dd->getInputStreamFor(entries.at(0));
+    string line;
+    getline(*stream, line);
+    while (getline(*stream, line)) {
+        stringstream lineStream(line);
+        string cell;
+        float xyz[3] = {0.0f, 0.0f, 0.0f};
+        for (uint32_t i = 0; i < 3 && getline(lineStream, cell, ','); i++) {
+            xyz[i] = stof(cell);
+        }
+        ranges.push_back(sqrt(xyz[0] * xyz[0] + xyz[1] * xyz[1] + xyz[2] * xyz[2]));
+    }
+    return ranges;
+}
+
+// Restores frame 1 (the second frame) from the compressed compact point clouds and matches its ranges with the VeloView export.
+template < typename Model >
+double matchVeloView(const string &recording, const string &calibration, const string &zip, const float &tolerance) {
+    const vector< vector< pair< string, uint8_t > > > frames = collectCPC< Model >(recording, calibration, 1);
+    TS_ASSERT(frames.size() > 1);
+    vector< float > ranges;
+    string packed;
+    string restored;
+    for (uint32_t i = 0; i < frames[1].size(); i += 2) { // Parts without intensity.
+        VelodyneCPCCodec::compress(frames[1][i].first, frames[1][i].second, packed);
+        TS_ASSERT(packed.size() < frames[1][i].first.size());
+        TS_ASSERT(VelodyneCPCCodec::decompress(packed, frames[1][i].second, restored));
+        for (uint32_t j = 0; j + 1 < restored.size(); j += 2) {
+            const uint16_t distance = static_cast< uint16_t >((static_cast< uint8_t >(restored[j]) << 8) | static_cast< uint8_t >(restored[j + 1]));
+            if (distance > 0) {
+                ranges.push_back(static_cast< float >(distance) * 0.002f); // Units of 2 mm.
+            }
+        }
+    }
+    vector< float > expected = readVeloViewRanges(zip);
+    TS_ASSERT(!expected.empty());
+    sort(ranges.begin(), ranges.end());
+    sort(expected.begin(), expected.end());
+
+    // Each range of VeloView is matched with the closest unused range of the same order.
+    uint32_t matched = 0;
+    uint32_t j = 0;
+    for (const float range : expected) {
+        while (j < ranges.size() && ranges[j] < range - tolerance) {
+            j++;
+        }
+        if (j < ranges.size() && ranges[j] <= range + tolerance) {
+            matched++;
+            j++;
+        }
+    }
+    return (expected.empty() ? 0.0 : static_cast< double >(matched) / static_cast< double >(expected.size()));
+}
+
+// Keeps the compressed and the plain compact point clouds sent by a VelodyneDecoder.
+class CPCConference : public odcore::io::conference::ContainerConference {
+   public:
+    CPCConference()
+        : ContainerConference()
+        , m_compressed()
+        , m_plain() {}
+
+    virtual void send(odcore::data::Container &c) const {
+        if (c.getDataType() == opendlv::proxy::PointCloudReadingCompressed::ID()) {
+            m_compressed.push_back(c.getData< opendlv::proxy::PointCloudReadingCompressed >());
+        } else if (c.getDataType() == odcore::data::CompactPointCloud::ID()) {
+            m_plain.push_back(c.getData< odcore::data::CompactPointCloud >());
+        }
+    }
+
+    mutable vector< opendlv::proxy::PointCloudReadingCompressed > m_compressed;
+    mutable vector< odcore::data::CompactPointCloud > m_plain;
+};
+
+class VelodyneCPCCodecTest : public CxxTest::TestSuite {
+   public:
+    void testRoundTripVLP16() {
+        const double ratio = checkRoundTrip< VLP16 >("../sampleShort.pcap", "../VLP-16.xml");
+        cout << "VLP-16 compressed to " << ratio << endl;
+        TS_ASSERT(ratio < 0.7);
+    }
+
+    void testRoundTripHDL32E() {
+        const double ratio = checkRoundTrip< HDL32E >("../sampleShort_velodyne32.pcap", "../HDL-32E.xml");
+        cout << "HDL-32E compressed to " << ratio << endl;
+        TS_ASSERT(ratio < 0.7);
+    }
+
+    void testRoundTripHDL64E() {
+        const double ratio = checkRoundTrip< HDL64E >("../atwallshort.pcap", "../db.xml");
+        cout << "HDL-64E compressed to " << ratio << endl;
+        TS_ASSERT(ratio < 0.7);
+    }
+
+    void testMatchesVeloViewFrame1() {
+        // The export of the HDL-64E applies the offsets of the calibration to x, y, z; its ranges are not the measured distances.
+        TS_ASSERT(matchVeloView< VLP16 >("../sampleShort.pcap", "../VLP-16.xml", "../sampleVeloViewFrame1.zip", 0.02f) > 0.98);
+        TS_ASSERT(matchVeloView< HDL32E >("../sampleShort_velodyne32.pcap", "../HDL-32E.xml", "../sampleVeloViewFrame1_velodyne32.zip", 0.02f) > 0.98);
+    }
+
+    void testIncompressibleDataIsStored() {
+        string noise(2000, '\0');
+        srand(17);
+        for (auto &c : noise) {
+            c = static_cast< char >(rand() & 0xFF);
+        }
+        string packed;
+        string restored;
+        VelodyneCPCCodec::compress(noise, 16, packed);
+        TS_ASSERT_EQUALS(packed.size(), noise.size() + 1);
+        TS_ASSERT_EQUALS(static_cast< uint8_t >(packed[0]), static_cast< uint8_t >(VelodyneCPCCodec::STORED));
+        TS_ASSERT(VelodyneCPCCodec::decompress(packed, 16, restored));
+        TS_ASSERT(restored == noise);
+
+        VelodyneCPCCodec::compress(string(), 16, packed);
+        TS_ASSERT(VelodyneCPCCodec::decompress(packed, 16, restored));
+        TS_ASSERT(restored.empty());
+    }
+
+    void testCorruptDataIsRejected() {
+        // A constant column of lasers compresses to a few bits per entry.
+        string distances;
+        for (uint32_t i = 0; i < 1600; i++) {
+            distances.push_back(static_cast< char >(0x12));
+            distances.push_back(static_cast< char >(i % 16));
+        }
+        string packed;
+        string restored;
+        VelodyneCPCCodec::compress(distances, 16, packed);
+        TS_ASSERT_EQUALS(static_cast< uint8_t >(packed[0]), static_cast< uint8_t >(VelodyneCPCCodec::DELTA_RICE));
+        TS_ASSERT(packed.size() < distances.size() / 10);
+        TS_ASSERT(VelodyneCPCCodec::decompress(packed, 16, restored));
+        TS_ASSERT(restored == distances);
+
+        TS_ASSERT(!VelodyneCPCCodec::decompress(packed.substr(0, packed.size() - 2), 16, restored));
+        TS_ASSERT(restored.empty());
+        TS_ASSERT(!VelodyneCPCCodec::decompress(packed.substr(0, 3), 16, restored));
+        TS_ASSERT(!VelodyneCPCCodec::decompress(string(), 16, restored));
+        string unknown = packed;
+        unknown[0] = 7;
+        TS_ASSERT(!VelodyneCPCCodec::decompress(unknown, 16, restored));
+        string tooMany = packed;
+        tooMany[4] = static_cast< char >(0x7F); // More entries than bits.
+        TS_ASSERT(!VelodyneCPCCodec::decompress(tooMany, 16, restored));
+    }
+
+    void testDecoderSendsCompressedCPC() {
+        const VelodyneDecoderOptions options = {false, 0, true, 2, 3, 0, 1};
+        const vector< string > packets = VelodynePcapReader::readDataPackets("../sampleShort_velodyne32.pcap");
+        CPCConference plain;
+        VelodyneDecoder< HDL32E > plainDecoder(std::shared_ptr< odcore::wrapper::SharedMemory >(), plain, "../HDL-32E.xml", options);
+        CPCConference compressed;
+        VelodyneDecoder< HDL32E > compressedDecoder(std::shared_ptr< odcore::wrapper::SharedMemory >(), compressed, "../HDL-32E.xml", options);
+        compressedDecoder.setCPCCompression(true);
+        for (auto &packet : packets) {
+            plainDecoder.nextString(packet);
+            compressedDecoder.nextString(packet);
+        }
+
+        TS_ASSERT(!plain.m_plain.empty());
+        TS_ASSERT(plain.m_compressed.empty());
+        TS_ASSERT(compressed.m_plain.empty());
+        TS_ASSERT_EQUALS(compressed.m_compressed.size(), plain.m_plain.size());
+        uint64_t plainBytes = 0;
+        uint64_t compressedBytes = 0;
+        string restored;
+        for (uint32_t i = 0; i < compressed.m_compressed.size() && i < plain.m_plain.size(); i++) {
+            const opendlv::proxy::PointCloudReadingCompressed &c = compressed.m_compressed[i];
+            const odcore::data::CompactPointCloud &p = plain.m_plain[i];
+            TS_ASSERT_EQUALS(c.getStartAzimuth(), p.getStartAzimuth());
+            TS_ASSERT_EQUALS(c.getEndAzimuth(), p.getEndAzimuth());
+            TS_ASSERT_EQUALS(c.getEntriesPerAzimuth(), p.getEntriesPerAzimuth());
+            TS_ASSERT_EQUALS(c.getNumberOfBitsForIntensity(), p.getNumberOfBitsForIntensity());
+            TS_ASSERT_EQUALS(c.getIntensityPlacement(), static_cast< uint8_t >(p.getIntensityPlacement()));
+            TS_ASSERT_EQUALS(c.getDistanceEncoding(), static_cast< uint8_t >(p.getDistanceEncoding()));
+            TS_ASSERT(VelodyneCPCCodec::decompress(c.getDistances(), c.getEntriesPerAzimuth(), restored));
+            TS_ASSERT(restored == p.getDistances());
+            plainBytes += p.getDistances().size();
+            compressedBytes += c.getDistances().size();
+        }
+        TS_ASSERT(compressedBytes < plainBytes);
+    }
+};
+
+#endif /*VELODYNECPCCODEC_TESTSUITE_H*/
@@ -0,0 +1,218 @@
+/**
+ * velodyne-decoder - Decoder core shared by the Velodyne proxies.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VELODYNECALIBRATIONFILE_TESTSUITE_H
+#define VELODYNECALIBRATIONFILE_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../include/VelodyneCalibrationFile.h"
+#include "../include/VelodyneDecoderCore.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+inline string readFile(const string &fileName) {
+    ifstream in(fileName.c_str(), ios::binary);
+    return string((istreambuf_iterator< char >(in)), istreambuf_iterator< char >());
+}
+
+inline void writeFile(const string &fileName, const string &content) {
+    ofstream out(fileName.c_str(), ios::binary | ios::trunc);
+    out << content;
+}
+
+// Replaces the first occurrence of from in the content.
+inline string replaceFirst(string content, const string &from, const string &to) {
+    const size_t position = content.find(from);
+    TS_ASSERT(position != string::npos);
+    if (position != string::npos) {
+        content.replace(position, from.size(), to);
+    }
+    return content;
+}
+
+inline bool equalLasers(const vector< VelodyneLaserCalibration > &a, const vector< VelodyneLaserCalibration > &b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (uint32_t i = 0; i < a.size(); i++) {
+        if (memcmp(&a[i].rotCorrection, &b[i].rotCorrection, 9 * sizeof(float)) != 0 || a[i].minIntensity != b[i].minIntensity || a[i].maxIntensity != b[i].maxIntensity) {
+            return false;
+        }
+    }
+    return true;
+}
+
+class VelodyneCalibrationFileTest : public CxxTest::TestSuite {
+   public:
+    void tearDown() {
+        VelodyneCalibrationFile::setCacheDirectory("");
+    }
+
+    void testParseHDL64E() {
+        vector< VelodyneLaserCalibration > lasers;
+        string error;
+        TS_ASSERT(VelodyneCalibrationFile::parse(readFile("../db.xml"), lasers, error));
+        TS_ASSERT_EQUALS(error, "");
+        TS_ASSERT_EQUALS(lasers.size(), 64u);
+        TS_ASSERT_EQUALS(lasers[0].rotCorrection, -5.3328056f);
+        TS_ASSERT_EQUALS(lasers[0].vertCorrection, -7.2988362f);
+        TS_ASSERT_EQUALS(lasers[0].distCorrection, 111.0f);
+        TS_ASSERT_EQUALS(lasers[0].distCorrectionX, 118.0f);
+        TS_ASSERT_EQUALS(lasers[0].distCorrectionY, 118.0f);
+        TS_ASSERT_EQUALS(lasers[0].vertOffsetCorrection, 19.736338f);
+        TS_ASSERT_EQUALS(lasers[0].horizOffsetCorrection, 2.5999999f);
+        TS_ASSERT_EQUALS(lasers[1].distCorrectionY, 151.0f);
+        TS_ASSERT_EQUALS(lasers[63].vertOffsetCorrection, 12.081173f);
+        TS_ASSERT_EQUALS(lasers[63].horizOffsetCorrection, -2.5999999f);
+        TS_ASSERT_EQUALS(lasers[0].minIntensity, 0);
+        TS_ASSERT_EQUALS(lasers[0].maxIntensity, 255);
+    }
+
+    void testParseVLP16AndHDL32E() {
+        // Both files describe 64 lasers of which the decoders use the first 16 or 32.
+        vector< VelodyneLaserCalibration > lasers;
+        string error;
+        TS_ASSERT(VelodyneCalibrationFile::parse(readFile("../VLP-16.xml"), lasers, error));
+        TS_ASSERT_EQUALS(lasers.size(), 64u);
+        TS_ASSERT_EQUALS(lasers[0].vertCorrection, -15.0f);
+        TS_ASSERT_EQUALS(lasers[1].vertCorrection, 1.0f);
+        TS_ASSERT(VelodyneCalibrationFile::parse(readFile("../HDL-32E.xml"), lasers, error));
+        TS_ASSERT_EQUALS(lasers.size(), 64u);
+
+        VelodyneCalibration< 16 > calibration;
+        TS_ASSERT(calibration.load("../VLP-16.xml"));
+        TS_ASSERT_EQUALS(calibration.vertCorrection[0], -15.0f);
+        TS_ASSERT_EQUALS(calibration.sensorOrderIndex[0], 0);
+        TS_ASSERT_EQUALS(calibration.sensorOrderIndex[15], 15);
+    }
+
+    void testOffsetsInMeters() {
+        VelodyneCalibration< 64 > calibration;
+        TS_ASSERT(calibration.load("../db.xml"));
+        TS_ASSERT_EQUALS(calibration.distCorrection[0], 1.11f);
+        TS_ASSERT_EQUALS(calibration.vertOffsetCorrection[0], 19.736338f / 100.0f);
+        TS_ASSERT_EQUALS(calibration.horizOffsetCorrection[0], 2.5999999f / 100.0f);
+
+        VelodyneCalibration< 64 > missing;
+        TS_ASSERT(!missing.load("../missing.xml"));
+        TS_ASSERT_EQUALS(missing.rotCorrection[0], 0.0f);
+    }
+
+    void testInvalidFilesAreRejected() {
+        const string xml = readFile("../db.xml");
+        string moreLasersAnnounced = xml;
+        moreLasersAnnounced.replace(xml.find("<count>64</count>", xml.find("<points_")), 17, "<count>65</count>");
+        const string invalid[] = {
+            replaceFirst(xml, "<rotCorrection_>-5.3328056</rotCorrection_>", ""), // Missing required field.
+            replaceFirst(xml, "<id_>1</id_>", "<id_>0</id_>"), // Duplicate id.
+            replaceFirst(xml, "<id_>1</id_>", "<id_>64</id_>"), // Id out of range.
+            replaceFirst(xml, "<id_>1</id_>", "<id_>1.5</id_>"),
+            replaceFirst(xml, "-3.2344019</rotCorrection_>", "x3.2344019</rotCorrection_>"), // Not a number.
+            replaceFirst(xml, "-3.2344019</rotCorrection_>", "-3.2344019 cm</rotCorrection_>"),
+            replaceFirst(xml, "-3.2344019</rotCorrection_>", "nan</rotCorrection_>"),
+            moreLasersAnnounced,
+            xml.substr(0, xml.size() / 2), // Truncated.
+            replaceFirst(xml, "<points_", "<other_"),
+        };
+        for (const string &content : invalid) {
+            vector< VelodyneLaserCalibration > lasers;
+            string error;
+            TS_ASSERT(!VelodyneCalibrationFile::parse(content, lasers, error));
+            TS_ASSERT(error.find("line ") == 0);
+        }
+
+        // The error names the line of the problem.
+        vector< VelodyneLaserCalibration > lasers;
+        string error;
+        TS_ASSERT(!VelodyneCalibrationFile::parse(invalid[1], lasers, error));
+        TS_ASSERT(error.find("second laser with id_ 0") != string::npos);
+        TS_ASSERT(!VelodyneCalibrationFile::parse(invalid[0], lasers, error));
+        TS_ASSERT(error.find("laser without rotCorrection_") != string::npos);
+
+        // Comments and self contained declarations are skipped.
+        TS_ASSERT(VelodyneCalibrationFile::parse(replaceFirst(xml, "<id_>0</id_>", "<!-- <id_>5</id_> --><id_>0</id_>"), lasers, error));
+    }
+
+    void testCache() {
+        VelodyneCalibrationFile::setCacheDirectory(".");
+        const string xml = readFile("../db.xml");
+        writeFile("cached.xml", xml);
+        const string cache = VelodyneCalibrationFile::getCacheFileName(VelodyneCalibrationFile::hashFile(xml));
+        remove(cache.c_str());
+
+        vector< VelodyneLaserCalibration > parsed;
+        string error;
+        bool fromCache = true;
+        TS_ASSERT(VelodyneCalibrationFile::load("cached.xml", parsed, error, &fromCache));
+        TS_ASSERT(!fromCache);
+        TS_ASSERT(ifstream(cache.c_str()).good());
+
+        vector< VelodyneLaserCalibration > cached;
+        TS_ASSERT(VelodyneCalibrationFile::load("cached.xml", cached, error, &fromCache));
+        TS_ASSERT(fromCache);
+        TS_ASSERT(equalLasers(parsed, cached));
+
+        // A damaged cache is parsed again and rewritten.
+        string damaged = readFile(cache);
+        damaged[40] = static_cast< char >(damaged[40] ^ 1);
+        writeFile(cache, damaged);
+        TS_ASSERT(VelodyneCalibrationFile::load("cached.xml", cached, error, &fromCache));
+        TS_ASSERT(!fromCache);
+        TS_ASSERT(equalLasers(parsed, cached));
+        TS_ASSERT(VelodyneCalibrationFile::load("cached.xml", cached, error, &fromCache));
+        TS_ASSERT(fromCache);
+
+        // A changed file has its own cache; invalid files are never cached.
+        const string changed = replaceFirst(xml, "<rotCorrection_>-5.3328056</rotCorrection_>", "<rotCorrection_>-5.5</rotCorrection_>");
+        const string changedCache = VelodyneCalibrationFile::getCacheFileName(VelodyneCalibrationFile::hashFile(changed));
+        remove(changedCache.c_str());
+        writeFile("cached.xml", changed);
+        TS_ASSERT(VelodyneCalibrationFile::load("cached.xml", cached, error, &fromCache));
+        TS_ASSERT(!fromCache);
+        TS_ASSERT_EQUALS(cached[0].rotCorrection, -5.5f);
+        const string invalid = replaceFirst(xml, "<id_>1</id_>", "<id_>0</id_>");
+        writeFile("cached.xml", invalid);
+        TS_ASSERT(!VelodyneCalibrationFile::load("cached.xml", cached, error, &fromCache));
+        TS_ASSERT(!ifstream(VelodyneCalibrationFile::getCacheFileName(VelodyneCalibrationFile::hashFile(invalid)).c_str()).good());
+        TS_ASSERT(error.find("cached.xml: line ") == 0);
+
+        // The decoders load their calibration through the cache.
+        writeFile("cached.xml", xml);
+        VelodyneCalibration< 64 > fromFile;
+        TS_ASSERT(fromFile.load("../db.xml"));
+        VelodyneCalibration< 64 > fromCachedFile;
+        TS_ASSERT(fromCachedFile.load("cached.xml"));
+        TS_ASSERT(fromFile.rotCorrection == fromCachedFile.rotCorrection);
+        TS_ASSERT(fromFile.vertOffsetCorrection == fromCachedFile.vertOffsetCorrection);
+        TS_ASSERT(fromFile.sensorOrderIndex == fromCachedFile.sensorOrderIndex);
+        remove("cached.xml");
+        remove(cache.c_str());
+        remove(changedCache.c_str());
+    }
+};
+
+#endif /*VELODYNECALIBRATIONFILE_TESTSUITE_H*/
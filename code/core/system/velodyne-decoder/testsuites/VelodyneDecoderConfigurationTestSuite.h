@@ -0,0 +1,153 @@
+/**
+ * velodyne-decoder - Decoder core shared by the Velodyne proxies.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VELODYNEDECODERCONFIGURATION_TESTSUITE_H
+#define VELODYNEDECODERCONFIGURATION_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "opendavinci/generated/odcore/data/SharedPointCloud.h"
+#include "opendavinci/odcore/base/KeyValueConfiguration.h"
+#include "opendavinci/odcore/data/Container.h"
+#include "opendavinci/odcore/io/conference/ContainerConference.h"
+#include "opendavinci/odcore/wrapper/SharedMemoryFactory.h"
+
+#include "../include/VelodyneDecoderConfiguration.h"
+#include "../include/VelodynePcapReader.h"
+
+using namespace std;
+using namespace odcore::wrapper;
+using namespace opendlv::core::system::proxy;
+
+// Remembers the names of the announced shared point clouds.
+class NameCollector : public odcore::io::conference::ContainerConference {
+   public:
+    NameCollector()
+        : ContainerConference()
+        , m_names() {}
+
+    virtual void send(odcore::data::Container &c) const {
+        if (c.getDataType() == odcore::data::SharedPointCloud::ID()) {
+            m_names.push_back(c.getData< odcore::data::SharedPointCloud >().getName());
+        }
+    }
+
+    mutable vector< string > m_names;
+};
+
+inline odcore::base::KeyValueConfiguration toConfiguration(const string &lines) {
+    odcore::base::KeyValueConfiguration kv;
+    stringstream sstr(lines);
+    kv.readFrom(sstr);
+    return kv;
+}
+
+class VelodyneDecoderConfigurationTest : public CxxTest::TestSuite {
+   public:
+    void testDefaults() {
+        const odcore::base::KeyValueConfiguration kv = toConfiguration("proxy-velodyne64.udpPort=2368\n");
+        const VelodyneSourceOptions source(kv, "proxy-velodyne64");
+        TS_ASSERT(!source.receiveThread);
+        TS_ASSERT_EQUALS(source.receiveQueueSize, 4096u);
+        TS_ASSERT_EQUALS(source.receiveBatchSize, static_cast< uint32_t >(VelodyneUDPReceiver::DEFAULT_BATCH_SIZE));
+        TS_ASSERT_EQUALS(source.receiveBufferSize, 0u);
+        TS_ASSERT(source.replayFile.empty());
+        TS_ASSERT_EQUALS(source.replaySpeed, 1.0);
+
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        NameCollector collector;
+        VelodyneDecoder< HDL64E > decoder(SharedMemoryFactory::createSharedMemory("defaultSM", VelodyneDecoderCore< HDL64E >::SIZE), collector, "../db.xml", options);
+        std::shared_ptr< VelodynePoseBuffer > poses(new VelodynePoseBuffer(8));
+        TS_ASSERT_EQUALS(configureVelodyneDecoder(kv, "proxy-velodyne64", decoder, "defaultSM", VelodyneDecoderCore< HDL64E >::SIZE, poses), 0);
+        TS_ASSERT(poses.get() == NULL);
+        TS_ASSERT_EQUALS(decoder.getEncoding(), VelodynePointEncoding::FLOAT32);
+        TS_ASSERT_EQUALS(decoder.getFrameSize(), VelodyneDecoderCore< HDL64E >::SIZE);
+    }
+
+    void testOptionsOfThePrefixAreApplied() {
+        const odcore::base::KeyValueConfiguration kv = toConfiguration("proxy-velodyne64.receiveThread=1\n"
+                                                                       "proxy-velodyne64.receiveQueueSize=128\n"
+                                                                       "proxy-velodyne64.encoding=1\n"
+                                                                       "proxy-velodyne64.timeOffsets=1\n"
+                                                                       "proxy-velodyne64.sharedMemory.slots=2\n"
+                                                                       "proxy-velodyne64.deskew=2\n"
+                                                                       "proxy-velodyne16.encoding=2\n"
+                                                                       "proxy-velodyne16.receiveQueueSize=64\n");
+        const VelodyneSourceOptions source(kv, "proxy-velodyne64");
+        TS_ASSERT(source.receiveThread);
+        TS_ASSERT_EQUALS(source.receiveQueueSize, 128u);
+
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        NameCollector collector;
+        VelodyneDecoder< HDL64E > decoder(SharedMemoryFactory::createSharedMemory("configuredSM", 16), collector, "../db.xml", options);
+        const uint32_t frameSize = HDL64E::MAX_POINT_SIZE * VelodynePointEncoding::getBytesPerPoint(VelodynePointEncoding::INT16) + VelodyneDecoderCore< HDL64E >::TIME_OFFSETS_SIZE;
+        std::shared_ptr< VelodynePoseBuffer > poses;
+        TS_ASSERT_EQUALS(configureVelodyneDecoder(kv, "proxy-velodyne64", decoder, "configuredSM", frameSize, poses), 2);
+        TS_ASSERT(poses.get() != NULL);
+        TS_ASSERT_EQUALS(decoder.getEncoding(), VelodynePointEncoding::INT16);
+        TS_ASSERT_EQUALS(decoder.getFrameSize(), frameSize);
+
+        // The frames are decoded into the slots of the ring.
+        const vector< string > packets = VelodynePcapReader::readDataPackets("../atwallshort.pcap");
+        TS_ASSERT(!packets.empty());
+        for (auto &packet : packets) {
+            decoder.nextString(packet);
+        }
+        TS_ASSERT(!collector.m_names.empty());
+        for (uint32_t i = 0; i < collector.m_names.size(); i++) {
+            TS_ASSERT_EQUALS(collector.m_names[i], VelodyneSharedMemoryRing::getSlotName("configuredSM", i % 2));
+        }
+    }
+
+    void testReturnIndicesOfDualReturnModels() {
+        const odcore::base::KeyValueConfiguration kv = toConfiguration("proxy-velodyne16.returnIndices=1\n"
+                                                                       "proxy-velodyne64.returnIndices=1\n");
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        NameCollector collector;
+        VelodyneDecoder< VLP16 > vlp16(SharedMemoryFactory::createSharedMemory("vlp16SM", VelodyneDecoderCore< VLP16 >::SIZE), collector, "../VLP-16.xml", options);
+        std::shared_ptr< VelodynePoseBuffer > poses;
+        configureVelodyneDecoder(kv, "proxy-velodyne16", vlp16, "vlp16SM", VelodyneDecoderCore< VLP16 >::SIZE, poses);
+        TS_ASSERT_EQUALS(vlp16.getFrameSize(), VelodyneDecoderCore< VLP16 >::SIZE + VelodyneDecoderCore< VLP16 >::RETURN_INDICES_SIZE);
+
+        // The HDL-64E has no dual return mode; the key is not read.
+        VelodyneDecoder< HDL64E > hdl64(SharedMemoryFactory::createSharedMemory("hdl64SM", VelodyneDecoderCore< HDL64E >::SIZE), collector, "../db.xml", options);
+        configureVelodyneDecoder(kv, "proxy-velodyne64", hdl64, "hdl64SM", VelodyneDecoderCore< HDL64E >::SIZE, poses);
+        TS_ASSERT_EQUALS(hdl64.getFrameSize(), VelodyneDecoderCore< HDL64E >::SIZE);
+    }
+
+    void testSettingsNeedingASharedPointCloudAreRejected() {
+        const odcore::base::KeyValueConfiguration kv = toConfiguration("proxy-velodyne64.encoding=1\n"
+                                                                       "proxy-velodyne64.sharedMemory.slots=2\n"
+                                                                       "proxy-velodyne64.deskew=1\n");
+        const VelodyneDecoderOptions options = {false, 0, true, 0, 0, 0, 0};
+        NameCollector collector;
+        VelodyneDecoder< HDL64E > decoder(std::shared_ptr< SharedMemory >(), collector, "../db.xml", options);
+        std::shared_ptr< VelodynePoseBuffer > poses;
+        TS_ASSERT_EQUALS(configureVelodyneDecoder(kv, "proxy-velodyne64", decoder, "", 0, poses), 1);
+        TS_ASSERT(poses.get() == NULL);
+        TS_ASSERT_EQUALS(decoder.getEncoding(), VelodynePointEncoding::FLOAT32);
+    }
+};
+
+#endif /*VELODYNEDECODERCONFIGURATION_TESTSUITE_H*/
@@ -0,0 +1,832 @@
+/**
+ * velodyne-decoder - Decoder core shared by the Velodyne proxies.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VELODYNEDECODERCORE_TESTSUITE_H
+#define VELODYNEDECODERCORE_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "../include/VelodyneDecoderCore.h"
+#include "../include/VelodynePcapReader.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+const float TO_RADIAN = static_cast< float >(M_PI) / 180.0f;
+
+// Keeps a copy of every completed frame.
+template < typename Model >
+class FrameRecorder : public VelodyneFrameListener {
+   public:
+    FrameRecorder()
+        : m_core(NULL)
+        , m_points()
+        , m_cpc()
+        , m_startAzimuth()
+        , m_endAzimuth()
+        , m_timeOffsets()
+        , m_returnIndices()
+        , m_frameStartTime()
+        , m_frameDuration() {}
+
+    virtual void nextFrame() {
+        const float *segment = m_core->getSegment();
+        if (segment != NULL) {
+            m_points.push_back(vector< float >(segment, segment + m_core->getNumberOfPoints() * 4));
+        }
+        const float *timeOffsets = m_core->getTimeOffsets();
+        if (timeOffsets != NULL) {
+            m_timeOffsets.push_back(vector< float >(timeOffsets, timeOffsets + m_core->getNumberOfPoints()));
+        }
+        const uint8_t *returnIndices = m_core->getReturnIndices();
+        if (returnIndices != NULL) {
+            m_returnIndices.push_back(vector< uint8_t >(returnIndices, returnIndices + m_core->getNumberOfPoints()));
+        }
+        m_frameStartTime.push_back(m_core->getFrameStartTime());
+        m_frameDuration.push_back(m_core->getFrameDuration());
+        if (m_core->getOptions().withCPC) {
+            m_cpc.push_back(m_core->getCompactPointCloud(0, false));
+        }
+        m_startAzimuth.push_back(m_core->getStartAzimuth());
+        m_endAzimuth.push_back(m_core->getEndAzimuth());
+    }
+
+    const VelodyneDecoderCore< Model > *m_core;
+    vector< vector< float > > m_points;
+    vector< string > m_cpc;
+    vector< float > m_startAzimuth;
+    vector< float > m_endAzimuth;
+    vector< vector< float > > m_timeOffsets;
+    vector< vector< uint8_t > > m_returnIndices;
+    vector< uint32_t > m_frameStartTime;
+    vector< uint32_t > m_frameDuration;
+};
+
+// Builds a data packet where every block has the given flag and azimuth (in 0.01 degree)
+// and every return has the given raw distance (in 2mm) and intensity.
+inline string makePacket(const uint16_t &flag, const vector< uint16_t > &azimuths, const uint16_t &distance, const uint8_t &intensity) {
+    string packet(1206, '\0');
+    for (uint32_t block = 0; block < 12; block++) {
+        const uint32_t offset = block * 100;
+        packet[offset] = static_cast< char >(flag & 0xFF);
+        packet[offset + 1] = static_cast< char >(flag >> 8);
+        packet[offset + 2] = static_cast< char >(azimuths[block] & 0xFF);
+        packet[offset + 3] = static_cast< char >(azimuths[block] >> 8);
+        for (uint32_t r = 0; r < 32; r++) {
+            packet[offset + 4 + r * 3] = static_cast< char >(distance & 0xFF);
+            packet[offset + 5 + r * 3] = static_cast< char >(distance >> 8);
+            packet[offset + 6 + r * 3] = static_cast< char >(intensity);
+        }
+    }
+    return packet;
+}
+
+inline vector< uint16_t > azimuths(const uint16_t &start, const uint16_t &step) {
+    vector< uint16_t > a;
+    for (uint16_t i = 0; i < 12; i++) {
+        a.push_back(static_cast< uint16_t >((start + i * step) % 36000));
+    }
+    return a;
+}
+
+// Builds a dual return data packet: the blocks 2k (last return) and 2k+1 (strongest return) share
+// the azimuth start + k * step (in 0.01 degree) and carry the given raw distances.
+inline string makeDualReturnPacket(const uint16_t &start, const uint16_t &step, const uint16_t &last, const uint16_t &strongest) {
+    vector< uint16_t > a;
+    for (uint16_t i = 0; i < 12; i++) {
+        a.push_back(static_cast< uint16_t >((start + (i / 2) * step) % 36000));
+    }
+    string packet = makePacket(0xEEFF, a, last, 10);
+    for (uint32_t block = 1; block < 12; block += 2) {
+        for (uint32_t r = 0; r < 32; r++) {
+            packet[block * 100 + 4 + r * 3] = static_cast< char >(strongest & 0xFF);
+            packet[block * 100 + 5 + r * 3] = static_cast< char >(strongest >> 8);
+        }
+    }
+    packet[1204] = 0x39;
+    return packet;
+}
+
+// Decodes two dual return packets and checks that both returns of each firing share its azimuth and time.
+template < typename Model >
+void checkDualReturn(const string &calibration, const uint8_t &SPCOption) {
+    FrameRecorder< Model > recorder;
+    VelodyneDecoderOptions options = {true, SPCOption, true, 0, 0, 0, 1};
+    VelodyneDecoderCore< Model > core(calibration, options, recorder);
+    TS_ASSERT(core.setTimeOffsets(true));
+    TS_ASSERT(core.setReturnIndices(true));
+    recorder.m_core = &core;
+
+    //6 pairs of blocks per packet; the VLP-16 fires twice per block, so its pairs are 0.4 degree apart
+    const uint16_t step = static_cast< uint16_t >(20 * Model::FIRINGS_PER_BLOCK);
+    const string first = makeDualReturnPacket(100, step, 5000, 6000);
+    const string second = makeDualReturnPacket(static_cast< uint16_t >(100 + 6 * step), step, 5000, 6000);
+    const string wrap = makeDualReturnPacket(0, step, 5000, 6000);
+    core.nextPacket(reinterpret_cast< const uint8_t * >(first.data()), 1206);
+    core.nextPacket(reinterpret_cast< const uint8_t * >(second.data()), 1206);
+    TS_ASSERT(core.isDualReturn());
+    TS_ASSERT(recorder.m_points.empty()); //no wrap around within a pair of blocks
+    core.nextPacket(reinterpret_cast< const uint8_t * >(wrap.data()), 1206);
+    TS_ASSERT_EQUALS(recorder.m_points.size(), 1u);
+    TS_ASSERT_EQUALS(recorder.m_returnIndices.size(), 1u);
+    if (recorder.m_points.size() != 1u || recorder.m_returnIndices.size() != 1u) {
+        return;
+    }
+
+    //Each firing yields all lasers of the last return followed by all lasers of the strongest return
+    const uint32_t firings = 2 * 6 * Model::FIRINGS_PER_BLOCK;
+    const vector< float > &points = recorder.m_points[0];
+    const vector< float > &timeOffsets = recorder.m_timeOffsets[0];
+    const vector< uint8_t > &returnIndices = recorder.m_returnIndices[0];
+    TS_ASSERT_EQUALS(points.size(), firings * 2u * Model::NUMBER_OF_LASERS * 4u);
+    TS_ASSERT_EQUALS(returnIndices.size(), firings * 2u * Model::NUMBER_OF_LASERS);
+    uint32_t errors = 0;
+    for (uint32_t firing = 0; firing < firings; firing++) {
+        for (uint32_t laser = 0; laser < Model::NUMBER_OF_LASERS; laser++) {
+            const uint32_t last = (firing * 2) * Model::NUMBER_OF_LASERS + laser;
+            const uint32_t strongest = last + Model::NUMBER_OF_LASERS;
+            errors += (returnIndices[last] != 0) + (returnIndices[strongest] != 1);
+            errors += (timeOffsets[last] != timeOffsets[strongest]);
+            if (SPCOption == 1) {
+                //Polar points: the strongest return is 2 m further away at the same azimuth, which rises by 0.2 degree per firing
+                errors += (fabs(points[strongest * 4] - points[last * 4] - 2.0f) > 1e-4f);
+                errors += (points[last * 4 + 1] != points[strongest * 4 + 1]);
+                errors += (fabs(points[last * 4 + 1] - (1.0f + 0.2f * static_cast< float >(firing))) > 1e-3f);
+            }
+        }
+        //The firings follow each other at the firing rate
+        errors += (fabs(timeOffsets[firing * 2 * Model::NUMBER_OF_LASERS] - static_cast< float >(firing) * Model::FIRING_DURATION) > 1.0f);
+    }
+    TS_ASSERT_EQUALS(errors, 0u);
+
+    //The compact point cloud holds one azimuth per firing with the strongest return
+    uint32_t entries = 0;
+    for (uint8_t part = 0; part < Model::NUMBER_OF_CPC_PARTS; part++) {
+        entries += core.getEntriesPerAzimuth(part);
+    }
+    TS_ASSERT_EQUALS(entries, Model::NUMBER_OF_LASERS);
+}
+
+// Decodes a full rotation of dual return packets at the given azimuth step per firing (in 0.01 degree)
+// and checks that both returns of all firings fit into a frame.
+template < typename Model >
+void checkDualReturnRotation(const string &calibration, const uint16_t &step) {
+    FrameRecorder< Model > recorder;
+    VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+    VelodyneDecoderCore< Model > core(calibration, options, recorder);
+    TS_ASSERT(core.setTimeOffsets(true));
+    TS_ASSERT(core.setReturnIndices(true));
+    recorder.m_core = &core;
+
+    const uint16_t pairStep = static_cast< uint16_t >(step * Model::FIRINGS_PER_BLOCK);
+    uint32_t start = 0;
+    for (; start + 6 * pairStep <= 36000; start += 6 * pairStep) {
+        const string packet = makeDualReturnPacket(static_cast< uint16_t >(start), pairStep, 5000, 6000);
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), 1206);
+    }
+    TS_ASSERT(recorder.m_points.empty());
+    const string wrap = makeDualReturnPacket(0, pairStep, 5000, 6000);
+    core.nextPacket(reinterpret_cast< const uint8_t * >(wrap.data()), 1206);
+    TS_ASSERT_EQUALS(recorder.m_points.size(), 1u);
+    TS_ASSERT_EQUALS(core.getCounters().truncatedFrames, 0u);
+    if (recorder.m_points.size() != 1u) {
+        return;
+    }
+    //All lasers of both returns of each firing are kept
+    const uint32_t firings = start / pairStep * Model::FIRINGS_PER_BLOCK;
+    TS_ASSERT_EQUALS(recorder.m_points[0].size(), firings * 2u * Model::NUMBER_OF_LASERS * 4u);
+    TS_ASSERT_EQUALS(recorder.m_returnIndices[0].size(), firings * 2u * Model::NUMBER_OF_LASERS);
+    TS_ASSERT(firings * 2u * Model::NUMBER_OF_LASERS > Model::MAX_POINT_SIZE);
+}
+
+// Decodes a recording into the unordered and the organised layout and checks that the organised
+// frames hold the same points, one column per firing with the lasers by increasing vertical angle.
+// The frames must not be truncated, i.e. all firings of a rotation fit into the organised layout.
+template < typename Model >
+void checkOrganised(const string &recording, const string &calibration, const uint8_t &SPCOption, const VelodyneProjection::Kernel &kernel, const float &sectorSize) {
+    const vector< string > packets = VelodynePcapReader::readDataPackets(recording);
+    VelodyneDecoderOptions options = {true, SPCOption, false, 0, 0, 0, 1};
+    FrameRecorder< Model > unordered;
+    VelodyneDecoderCore< Model > unorderedCore(calibration, options, unordered);
+    unorderedCore.setProjectionKernel(kernel);
+    unorderedCore.setSectorSize(sectorSize);
+    unordered.m_core = &unorderedCore;
+    FrameRecorder< Model > organised;
+    VelodyneDecoderCore< Model > organisedCore(calibration, options, organised);
+    organisedCore.setProjectionKernel(kernel);
+    organisedCore.setSectorSize(sectorSize);
+    TS_ASSERT(organisedCore.setOrganised(true));
+    TS_ASSERT(organisedCore.setTimeOffsets(true));
+    organised.m_core = &organisedCore;
+    for (auto &packet : packets) {
+        unorderedCore.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+        organisedCore.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+    }
+
+    const VelodyneCalibration< Model::NUMBER_OF_LASERS > &calibrationData = organisedCore.getCalibration();
+    vector< uint32_t > rowOfSensor(Model::NUMBER_OF_LASERS);
+    for (uint32_t row = 0; row < Model::NUMBER_OF_LASERS; row++) {
+        rowOfSensor[calibrationData.sensorOrderIndex[row]] = row;
+        if (row > 0) {
+            TS_ASSERT(calibrationData.vertCorrection[calibrationData.sensorOrderIndex[row - 1]] <= calibrationData.vertCorrection[calibrationData.sensorOrderIndex[row]]);
+        }
+    }
+
+    TS_ASSERT(!organised.m_points.empty());
+    TS_ASSERT_EQUALS(organised.m_points.size(), unordered.m_points.size());
+    TS_ASSERT_EQUALS(organisedCore.getPointCapacity(), max(VelodyneDecoderCore< Model >::POINT_CAPACITY, VelodyneDecoderCore< Model >::ORGANISED_POINT_CAPACITY));
+    TS_ASSERT_EQUALS(organisedCore.getCounters().truncatedFrames, 0u);
+    uint32_t mismatches = 0;
+    for (uint32_t frame = 0; frame < organised.m_points.size() && frame < unordered.m_points.size(); frame++) {
+        const vector< float > &grid = organised.m_points[frame];
+        const vector< float > &points = unordered.m_points[frame];
+        TS_ASSERT_EQUALS(grid.size() % (Model::NUMBER_OF_LASERS * 4), 0u);
+        // The valid cells hold the unordered points; an HDL-64E column combines a lower block with the next upper block.
+        vector< vector< float > > valid;
+        for (uint32_t i = 0; i + 3 < grid.size(); i += 4) {
+            if (std::isnan(grid[i])) {
+                mismatches += (grid[i + 3] != 0.0f);
+            } else {
+                valid.push_back(vector< float >(grid.begin() + i, grid.begin() + i + 4));
+            }
+        }
+        vector< vector< float > > expected;
+        for (uint32_t i = 0; i + 3 < points.size(); i += 4) {
+            expected.push_back(vector< float >(points.begin() + i, points.begin() + i + 4));
+        }
+        sort(valid.begin(), valid.end());
+        sort(expected.begin(), expected.end());
+        TS_ASSERT(valid == expected);
+        // The lasers of one block in a column were fired within one firing duration.
+        const uint32_t lasersPerBlock = min< uint32_t >(32, Model::NUMBER_OF_LASERS);
+        const vector< float > &timeOffsets = organised.m_timeOffsets[frame];
+        for (uint32_t i = 0; i < timeOffsets.size(); i += Model::NUMBER_OF_LASERS) {
+            float first = timeOffsets[i + rowOfSensor[0]];
+            float last = first;
+            for (uint32_t sensorID = 1; sensorID < lasersPerBlock; sensorID++) {
+                first = min(first, timeOffsets[i + rowOfSensor[sensorID]]);
+                last = max(last, timeOffsets[i + rowOfSensor[sensorID]]);
+            }
+            mismatches += (last - first >= Model::FIRING_DURATION);
+        }
+    }
+    TS_ASSERT_EQUALS(mismatches, 0u);
+}
+
+// Decodes a recording and returns all completed frames; the time offsets of their points are returned if requested.
+template < typename Model >
+vector< vector< float > > decodeRecording(const string &recording, const string &calibration, const bool &lookupTables, const VelodyneProjection::Kernel &kernel, vector< vector< float > > *timeOffsets = NULL) {
+    FrameRecorder< Model > recorder;
+    VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+    VelodyneDecoderCore< Model > core(calibration, options, recorder);
+    core.setLookupTables(lookupTables);
+    core.setProjectionKernel(kernel);
+    core.setTimeOffsets(timeOffsets != NULL);
+    recorder.m_core = &core;
+    const vector< string > packets = VelodynePcapReader::readDataPackets(recording);
+    for (auto &packet : packets) {
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+    }
+    if (timeOffsets != NULL) {
+        *timeOffsets = recorder.m_timeOffsets;
+    }
+    return recorder.m_points;
+}
+
+// Compares the lookup tables against sin/cos per point; rounding the azimuth to
+// 0.01 degree moves a point by at most 0.005 degree, i.e. about 1e-4 times its range.
+template < typename Model >
+void compareLookupTables(const string &recording, const string &calibration) {
+    const vector< vector< float > > reference = decodeRecording< Model >(recording, calibration, false, VelodyneProjection::SCALAR);
+    const vector< vector< float > > lookup = decodeRecording< Model >(recording, calibration, true, VelodyneProjection::SCALAR);
+    TS_ASSERT(!reference.empty());
+    TS_ASSERT_EQUALS(reference.size(), lookup.size());
+    uint32_t outliers = 0;
+    for (uint32_t frame = 0; frame < reference.size() && frame < lookup.size(); frame++) {
+        TS_ASSERT_EQUALS(reference[frame].size(), lookup[frame].size());
+        for (uint32_t i = 0; i + 3 < reference[frame].size() && i + 3 < lookup[frame].size(); i += 4) {
+            const float *a = &reference[frame][i];
+            const float *b = &lookup[frame][i];
+            const float range = sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+            const float difference = sqrt((a[0] - b[0]) * (a[0] - b[0]) + (a[1] - b[1]) * (a[1] - b[1]) + (a[2] - b[2]) * (a[2] - b[2]));
+            if ((difference > 1e-4f * range + 1e-3f) || (a[3] != b[3])) {
+                outliers++;
+            }
+        }
+    }
+    TS_ASSERT_EQUALS(outliers, 0u);
+}
+
+// Compares all vectorized kernels supported by this CPU against the scalar lookup table path.
+template < typename Model >
+void compareKernels(const string &recording, const string &calibration) {
+    vector< vector< float > > referenceTimeOffsets;
+    const vector< vector< float > > reference = decodeRecording< Model >(recording, calibration, true, VelodyneProjection::SCALAR, &referenceTimeOffsets);
+    TS_ASSERT(!reference.empty());
+    for (uint32_t k = VelodyneProjection::SSE41; k <= VelodyneProjection::best(); k++) {
+        const VelodyneProjection::Kernel kernel = static_cast< VelodyneProjection::Kernel >(k);
+        vector< vector< float > > timeOffsets;
+        const vector< vector< float > > result = decodeRecording< Model >(recording, calibration, true, kernel, &timeOffsets);
+        TS_ASSERT_EQUALS(reference.size(), result.size());
+        TS_ASSERT(referenceTimeOffsets == timeOffsets);
+        uint32_t outliers = 0;
+        for (uint32_t frame = 0; frame < reference.size() && frame < result.size(); frame++) {
+            TS_ASSERT_EQUALS(reference[frame].size(), result[frame].size());
+            for (uint32_t i = 0; i < reference[frame].size() && i < result[frame].size(); i++) {
+                if (fabs(reference[frame][i] - result[frame][i]) > 1e-5f) {
+                    outliers++;
+                }
+            }
+        }
+        TS_ASSERT_EQUALS(outliers, 0u);
+    }
+}
+
+// Writes db.xml with a focal distance and slope for all lasers, the intensity of laser 0
+// limited to at least 75 and the intensity of laser 1 to at most 60.
+inline void writeFocalCalibration(const string &fileName) {
+    ifstream in("../db.xml", ios::binary);
+    string xml((istreambuf_iterator< char >(in)), istreambuf_iterator< char >());
+    const string replacements[2][2] = {{"<focalDistance_>0<", "<focalDistance_>1500<"}, {"<focalSlope_>0<", "<focalSlope_>1.2<"}};
+    for (const auto &replacement : replacements) {
+        for (size_t position = xml.find(replacement[0]); position != string::npos; position = xml.find(replacement[0], position)) {
+            xml.replace(position, replacement[0].size(), replacement[1]);
+        }
+    }
+    xml.replace(xml.find("<item>0</item>", xml.find("<minIntensity_")), 14, "<item>75</item>");
+    xml.replace(xml.find("<item>255</item>", xml.find("<item>255</item>", xml.find("<maxIntensity_")) + 1), 16, "<item>60</item>");
+    ofstream out(fileName.c_str(), ios::binary | ios::trunc);
+    out << xml;
+}
+
+// Checks that the time offsets of each frame rise from the first to the last firing of the frame.
+template < typename Model >
+void checkTimeOffsets(const string &recording, const string &calibration) {
+    FrameRecorder< Model > recorder;
+    VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+    VelodyneDecoderCore< Model > core(calibration, options, recorder);
+    TS_ASSERT(core.setTimeOffsets(true));
+    recorder.m_core = &core;
+    const vector< string > packets = VelodynePcapReader::readDataPackets(recording);
+    for (auto &packet : packets) {
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+    }
+
+    TS_ASSERT(recorder.m_timeOffsets.size() > 1u);
+    const float lastLaser = static_cast< float >(Model::NUMBER_OF_LASERS) * Model::LASER_DURATION;
+    for (uint32_t frame = 0; frame < recorder.m_timeOffsets.size(); frame++) {
+        const vector< float > &offsets = recorder.m_timeOffsets[frame];
+        TS_ASSERT_EQUALS(offsets.size(), recorder.m_points[frame].size() / 4);
+        uint32_t decreasing = 0;
+        for (uint32_t i = 1; i < offsets.size(); i++) {
+            if (offsets[i] < offsets[i - 1]) {
+                decreasing++;
+            }
+        }
+        TS_ASSERT_EQUALS(decreasing, 0u);
+        TS_ASSERT(offsets.empty() || (offsets.front() >= 0.0f && offsets.back() <= static_cast< float >(recorder.m_frameDuration[frame]) + lastLaser));
+        //A complete rotation at 5 - 20 Hz; the next frame starts after the last firing of this one
+        if (frame > 0 && frame + 1 < recorder.m_timeOffsets.size()) {
+            TS_ASSERT(recorder.m_frameDuration[frame] > 40000u && recorder.m_frameDuration[frame] < 210000u);
+            const uint32_t gap = VelodyneDeviceTime::difference(recorder.m_frameStartTime[frame + 1], recorder.m_frameStartTime[frame]) - recorder.m_frameDuration[frame];
+            TS_ASSERT(gap > 0u && gap <= static_cast< uint32_t >(Model::FIRING_DURATION + 1.0f));
+        }
+    }
+}
+
+// Decodes a recording into polar points (the azimuth is the second component) with the given sector size.
+template < typename Model >
+void decodeSectors(const string &recording, const string &calibration, const float &sectorSize, FrameRecorder< Model > &recorder) {
+    VelodyneDecoderOptions options = {true, 1, false, 0, 0, 0, 1};
+    VelodyneDecoderCore< Model > core(calibration, options, recorder);
+    core.setSectorSize(sectorSize);
+    recorder.m_core = &core;
+    const vector< string > packets = VelodynePcapReader::readDataPackets(recording);
+    for (auto &packet : packets) {
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+    }
+    recorder.m_core = NULL;
+}
+
+// Checks that sectors split the rotations at multiples of the sector size without losing or reordering points.
+template < typename Model >
+void checkSectors(const string &recording, const string &calibration) {
+    const float SECTOR = 30.0f;
+    FrameRecorder< Model > rotations;
+    decodeSectors< Model >(recording, calibration, 0.0f, rotations);
+    FrameRecorder< Model > sectors;
+    decodeSectors< Model >(recording, calibration, SECTOR, sectors);
+    TS_ASSERT(!rotations.m_points.empty());
+    TS_ASSERT(sectors.m_points.size() > rotations.m_points.size());
+
+    uint32_t outside = 0;
+    for (uint32_t k = 1; k < sectors.m_points.size(); k++) {
+        const uint32_t sector = static_cast< uint32_t >(sectors.m_startAzimuth[k] / SECTOR);
+        if (static_cast< uint32_t >(sectors.m_endAzimuth[k] / SECTOR) != sector) {
+            outside++;
+        }
+        for (uint32_t i = 1; i < sectors.m_points[k].size(); i += 4) {
+            if (static_cast< uint32_t >(sectors.m_points[k][i] / SECTOR) != sector) {
+                outside++;
+            }
+        }
+    }
+    TS_ASSERT_EQUALS(outside, 0u);
+
+    // The points of the complete rotations are followed by those of the sectors completed after the last wrap around.
+    vector< float > all;
+    for (auto &points : rotations.m_points) {
+        all.insert(all.end(), points.begin(), points.end());
+    }
+    vector< float > sectorPoints;
+    for (auto &points : sectors.m_points) {
+        sectorPoints.insert(sectorPoints.end(), points.begin(), points.end());
+    }
+    TS_ASSERT(sectorPoints.size() >= all.size());
+    TS_ASSERT(equal(all.begin(), all.end(), sectorPoints.begin()));
+}
+
+class VelodyneDecoderCoreTest : public CxxTest::TestSuite {
+   public:
+    void testLookupTablesMatchReference() {
+        compareLookupTables< VLP16 >("../sampleShort.pcap", "../VLP-16.xml");
+        compareLookupTables< HDL32E >("../sampleShort_velodyne32.pcap", "../HDL-32E.xml");
+        compareLookupTables< HDL64E >("../atwallshort.pcap", "../db.xml");
+    }
+
+    void testProjectionKernelsMatchScalar() {
+        compareKernels< VLP16 >("../sampleShort.pcap", "../VLP-16.xml");
+        compareKernels< HDL32E >("../sampleShort_velodyne32.pcap", "../HDL-32E.xml");
+        compareKernels< HDL64E >("../atwallshort.pcap", "../db.xml");
+    }
+
+    void testProjectionKernelDropsNearReturns() {
+        // Every other laser returns 0.5 m; only the far returns must be kept, in laser order.
+        string packet = makePacket(0xEEFF, azimuths(0, 20), 1000, 7);
+        for (uint32_t block = 0; block < 12; block++) {
+            for (uint32_t r = 0; r < 32; r += 2) {
+                packet[block * 100 + 4 + r * 3] = static_cast< char >(250);
+                packet[block * 100 + 5 + r * 3] = 0;
+            }
+        }
+        FrameRecorder< HDL32E > recorder;
+        VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+        VelodyneDecoderCore< HDL32E > core("../HDL-32E.xml", options, recorder);
+        core.setProjectionKernel(VelodyneProjection::best());
+        recorder.m_core = &core;
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+        TS_ASSERT_EQUALS(core.getNumberOfPoints(), 12u * 16u);
+
+        VelodyneDecoderCore< HDL32E > scalar("../HDL-32E.xml", options, recorder);
+        scalar.setProjectionKernel(VelodyneProjection::SCALAR);
+        scalar.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+        TS_ASSERT_EQUALS(scalar.getNumberOfPoints(), core.getNumberOfPoints());
+        for (uint32_t i = 0; i < core.getNumberOfPoints() * 4; i++) {
+            TS_ASSERT_DELTA(core.getSegment()[i], scalar.getSegment()[i], 1e-5f);
+        }
+    }
+
+    void testAzimuthTable() {
+        const VelodyneAzimuthTable &table = VelodyneAzimuthTable::getInstance();
+        TS_ASSERT_EQUALS(VelodyneAzimuthTable::index(0.0f), 0u);
+        TS_ASSERT_EQUALS(VelodyneAzimuthTable::index(90.0f), 9000u);
+        TS_ASSERT_EQUALS(VelodyneAzimuthTable::index(359.996f), 0u);
+        TS_ASSERT_DELTA(table.sin(9000), 1.0f, 1e-6f);
+        TS_ASSERT_DELTA(table.cos(9000), 0.0f, 1e-6f);
+        TS_ASSERT_DELTA(table.sin(12345), sin(123.45f * TO_RADIAN), 1e-6f);
+    }
+
+    void testCalibrationSensorOrder() {
+        VelodyneCalibration< 16 > calibration;
+        calibration.load("../VLP-16.xml");
+        //From -15 to 15 degrees: sensor IDs 0, 2, 4, ..., 14, 1, 3, ..., 15
+        for (uint8_t i = 0; i < 8; i++) {
+            TS_ASSERT_EQUALS(calibration.sensorOrderIndex[i], 2 * i);
+            TS_ASSERT_EQUALS(calibration.sensorOrderIndex[i + 8], 2 * i + 1);
+        }
+        TS_ASSERT_DELTA(calibration.vertCorrection[0], -15.0f, 1e-3f);
+        TS_ASSERT_DELTA(calibration.vertCorrection[15], 15.0f, 1e-3f);
+    }
+
+    void testPacketSizeIsChecked() {
+        FrameRecorder< VLP16 > recorder;
+        VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+        VelodyneDecoderCore< VLP16 > core("../VLP-16.xml", options, recorder);
+        const string packet(1000, '\0');
+        TS_ASSERT(!core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size())));
+    }
+
+    void testVLP16CartesianPointsAndFrames() {
+        FrameRecorder< VLP16 > recorder;
+        VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+        VelodyneDecoderCore< VLP16 > core("../VLP-16.xml", options, recorder);
+        recorder.m_core = &core;
+
+        //10m at azimuth 90 degrees; the second packet wraps around and completes the first frame.
+        const string first = makePacket(0xEEFF, azimuths(9000, 20), 5000, 100);
+        const string second = makePacket(0xEEFF, azimuths(35980, 20), 5000, 100);
+        TS_ASSERT(core.nextPacket(reinterpret_cast< const uint8_t * >(first.data()), 1206));
+        TS_ASSERT_EQUALS(core.getNumberOfPoints(), 12u * 32u);
+        TS_ASSERT(recorder.m_points.empty());
+        TS_ASSERT(core.nextPacket(reinterpret_cast< const uint8_t * >(second.data()), 1206));
+        TS_ASSERT_EQUALS(recorder.m_points.size(), 1u);
+
+        const vector< float > &points = recorder.m_points[0];
+        //Laser 0 (-15 degrees) in the first firing at 90 degrees
+        TS_ASSERT_DELTA(points[0], 10.0f * cos(15.0f * TO_RADIAN), 1e-3f);
+        TS_ASSERT_DELTA(points[1], 0.0f, 1e-3f);
+        TS_ASSERT_DELTA(points[2], -10.0f * sin(15.0f * TO_RADIAN), 1e-3f);
+        TS_ASSERT_DELTA(points[3], 100.0f, 1e-6f);
+        //Laser 0 in the second firing is interpolated to 90.1 degrees
+        TS_ASSERT_DELTA(points[16 * 4 + 1], 10.0f * cos(15.0f * TO_RADIAN) * cos(90.1f * TO_RADIAN), 1e-3f);
+        TS_ASSERT_EQUALS(recorder.m_endAzimuth[0], 360.0f); //Last interpolated azimuth before the wrap around
+        TS_ASSERT_DELTA(recorder.m_startAzimuth[0], 0.0f, 1e-6f);
+    }
+
+    void testPointsBelowOneMeterAreDropped() {
+        FrameRecorder< HDL32E > recorder;
+        VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+        VelodyneDecoderCore< HDL32E > core("../HDL-32E.xml", options, recorder);
+        recorder.m_core = &core;
+
+        const string packet = makePacket(0xEEFF, azimuths(100, 20), 400, 10); //0.8m
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), 1206);
+        TS_ASSERT_EQUALS(core.getNumberOfPoints(), 0u);
+    }
+
+    void testHDL64LowerBlock() {
+        FrameRecorder< HDL64E > recorder;
+        VelodyneDecoderOptions options = {true, 1, false, 0, 0, 0, 1};
+        VelodyneDecoderCore< HDL64E > core("../db.xml", options, recorder);
+        recorder.m_core = &core;
+
+        const string upper = makePacket(0xEEFF, azimuths(1000, 0), 5000, 1);
+        const string lower = makePacket(0xDDFF, azimuths(1000, 0), 5000, 1);
+        const string wrap = makePacket(0xEEFF, azimuths(0, 0), 5000, 1);
+        core.nextPacket(reinterpret_cast< const uint8_t * >(upper.data()), 1206);
+        core.nextPacket(reinterpret_cast< const uint8_t * >(lower.data()), 1206);
+        core.nextPacket(reinterpret_cast< const uint8_t * >(wrap.data()), 1206);
+        TS_ASSERT_EQUALS(recorder.m_points.size(), 1u);
+
+        //Polar points carry the vertical angle of the laser: lasers 0-31 in upper blocks, 32-63 in lower blocks
+        const vector< float > &points = recorder.m_points[0];
+        const uint32_t lowerStart = 12 * 32 * 4;
+        TS_ASSERT_DELTA(points[2], core.getCalibration().vertCorrection[0], 1e-6f);
+        TS_ASSERT_DELTA(points[lowerStart + 2], core.getCalibration().vertCorrection[32], 1e-6f);
+        TS_ASSERT_DELTA(points[lowerStart], 10.0f + core.getCalibration().distCorrection[32], 1e-4f);
+    }
+
+    void testHDL32CompactPointCloudParts() {
+        FrameRecorder< HDL32E > recorder;
+        VelodyneDecoderOptions options = {false, 0, true, 0, 0, 0, 1};
+        VelodyneDecoderCore< HDL32E > core("../HDL-32E.xml", options, recorder);
+        recorder.m_core = &core;
+        TS_ASSERT_EQUALS(core.getEntriesPerAzimuth(0), 12);
+        TS_ASSERT_EQUALS(core.getEntriesPerAzimuth(1), 11);
+        TS_ASSERT_EQUALS(core.getEntriesPerAzimuth(2), 9);
+
+        const string packet = makePacket(0xEEFF, azimuths(100, 20), 0x1234, 10);
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), 1206);
+        const string part = core.getCompactPointCloud(0, false);
+        TS_ASSERT_EQUALS(part.size(), 12u * 12u * 2u);
+        //Distances are stored big endian
+        TS_ASSERT_EQUALS(static_cast< uint8_t >(part[0]), 0x12);
+        TS_ASSERT_EQUALS(static_cast< uint8_t >(part[1]), 0x34);
+        TS_ASSERT(core.getSegment() == NULL);
+    }
+
+    void testTimeOffsets() {
+        checkTimeOffsets< VLP16 >("../sampleShort.pcap", "../VLP-16.xml");
+        checkTimeOffsets< HDL32E >("../sampleShort_velodyne32.pcap", "../HDL-32E.xml");
+        checkTimeOffsets< HDL64E >("../atwallshort.pcap", "../db.xml");
+    }
+
+    void testDeviceTimeOrFiringRate() {
+        //The VLP-16 recording carries GPS time stamps; this HDL-64E firmware sends status bytes instead
+        FrameRecorder< VLP16 > vlp16;
+        VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+        VelodyneDecoderCore< VLP16 > core16("../VLP-16.xml", options, vlp16);
+        vlp16.m_core = &core16;
+        const vector< string > packets16 = VelodynePcapReader::readDataPackets("../sampleShort.pcap");
+        uint32_t withDeviceTime = 0;
+        for (auto &packet : packets16) {
+            core16.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+            withDeviceTime += core16.hasDeviceTime() ? 1 : 0;
+        }
+        TS_ASSERT_EQUALS(withDeviceTime + 1, packets16.size());
+        const uint32_t last = static_cast< uint32_t >(packets16.back()[1200] & 0xFF) | (static_cast< uint32_t >(packets16.back()[1201] & 0xFF) << 8)
+                            | (static_cast< uint32_t >(packets16.back()[1202] & 0xFF) << 16) | (static_cast< uint32_t >(packets16.back()[1203] & 0xFF) << 24);
+        TS_ASSERT(VelodyneDeviceTime::difference(last, core16.getFrameStartTime()) < 110000u);
+
+        FrameRecorder< HDL64E > hdl64;
+        VelodyneDecoderCore< HDL64E > core64("../db.xml", options, hdl64);
+        hdl64.m_core = &core64;
+        const vector< string > packets64 = VelodynePcapReader::readDataPackets("../atwallshort.pcap");
+        uint32_t synthesized = 0;
+        for (auto &packet : packets64) {
+            core64.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+            synthesized += core64.hasDeviceTime() ? 0 : 1;
+        }
+        TS_ASSERT_EQUALS(synthesized, packets64.size());
+        //6 firings of 64 us per packet
+        for (uint32_t frame = 0; frame < hdl64.m_frameDuration.size(); frame++) {
+            TS_ASSERT_EQUALS(hdl64.m_frameDuration[frame] % 64u, 0u);
+        }
+    }
+
+    void testDeviceTimeAcrossTheHour() {
+        const uint32_t beforeHour = VelodyneDeviceTime::HOUR - 1000;
+        TS_ASSERT_EQUALS(VelodyneDeviceTime::difference(500, beforeHour), 1500u);
+        TS_ASSERT_EQUALS(VelodyneDeviceTime::difference(beforeHour, 500), VelodyneDeviceTime::HOUR - 1500);
+
+        //Reference shortly after a full hour (12:00:00.000200), device time shortly before
+        const int64_t hour = static_cast< int64_t >(VelodyneDeviceTime::HOUR);
+        const int64_t reference = 1000 * hour + 200;
+        TS_ASSERT_EQUALS(VelodyneDeviceTime::toAbsolute(beforeHour, reference), 1000 * hour - 1000);
+        TS_ASSERT_EQUALS(VelodyneDeviceTime::toAbsolute(100, reference), 1000 * hour + 100);
+        TS_ASSERT_EQUALS(VelodyneDeviceTime::toAbsolute(100, 1000 * hour - 300), 1000 * hour + 100);
+    }
+
+    void testPacketsWithoutTimeStampsFollowTheFiringRate() {
+        FrameRecorder< HDL32E > recorder;
+        VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+        VelodyneDecoderCore< HDL32E > core("../HDL-32E.xml", options, recorder);
+        TS_ASSERT(core.setTimeOffsets(true));
+        recorder.m_core = &core;
+
+        //Time stamps of 0: the second packet follows 12 firings after the first, the wrap around completes the frame
+        const string first = makePacket(0xEEFF, azimuths(100, 20), 5000, 10);
+        const string second = makePacket(0xEEFF, azimuths(340, 20), 5000, 10);
+        const string wrap = makePacket(0xEEFF, azimuths(0, 20), 5000, 10);
+        core.nextPacket(reinterpret_cast< const uint8_t * >(first.data()), 1206);
+        core.nextPacket(reinterpret_cast< const uint8_t * >(second.data()), 1206);
+        TS_ASSERT(!core.hasDeviceTime());
+        core.nextPacket(reinterpret_cast< const uint8_t * >(wrap.data()), 1206);
+        TS_ASSERT_EQUALS(recorder.m_timeOffsets.size(), 1u);
+        TS_ASSERT_EQUALS(recorder.m_frameStartTime[0], 0u);
+        TS_ASSERT_EQUALS(recorder.m_frameDuration[0], static_cast< uint32_t >(23 * HDL32E::FIRING_DURATION + 0.5f));
+
+        const vector< float > &offsets = recorder.m_timeOffsets[0];
+        TS_ASSERT_EQUALS(offsets.size(), 24u * 32u);
+        TS_ASSERT_DELTA(offsets[1], HDL32E::LASER_DURATION, 1e-4f);
+        TS_ASSERT_DELTA(offsets[32], HDL32E::FIRING_DURATION, 1.0f);
+        TS_ASSERT_DELTA(offsets[12 * 32], static_cast< float >(static_cast< uint32_t >(12 * HDL32E::FIRING_DURATION + 0.5f)), 1e-4f);
+    }
+
+    void testSectors() {
+        checkSectors< VLP16 >("../sampleShort.pcap", "../VLP-16.xml");
+        checkSectors< HDL32E >("../sampleShort_velodyne32.pcap", "../HDL-32E.xml");
+        checkSectors< HDL64E >("../atwallshort.pcap", "../db.xml");
+    }
+
+    void testDualReturn() {
+        checkDualReturn< VLP16 >("../VLP-16.xml", 0);
+        checkDualReturn< VLP16 >("../VLP-16.xml", 1);
+        checkDualReturn< HDL32E >("../HDL-32E.xml", 0);
+        checkDualReturn< HDL32E >("../HDL-32E.xml", 1);
+        //A rotation at 10 Hz: 0.2 degree per firing of the VLP-16 and about 0.17 degree of the HDL-32E
+        checkDualReturnRotation< VLP16 >("../VLP-16.xml", 20);
+        checkDualReturnRotation< HDL32E >("../HDL-32E.xml", 17);
+
+        //The HDL-64E uses the factory bytes for status information
+        FrameRecorder< HDL64E > recorder;
+        VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+        VelodyneDecoderCore< HDL64E > core("../db.xml", options, recorder);
+        const string packet = makeDualReturnPacket(100, 20, 5000, 6000);
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), 1206);
+        TS_ASSERT(!core.isDualReturn());
+    }
+
+    void testOrganisedLayout() {
+        const VelodyneProjection::Kernel kernels[] = {VelodyneProjection::SCALAR, VelodyneProjection::best()};
+        for (const VelodyneProjection::Kernel kernel : kernels) {
+            checkOrganised< VLP16 >("../sampleShort.pcap", "../VLP-16.xml", 0, kernel, 0.0f);
+            checkOrganised< HDL32E >("../sampleShort_velodyne32.pcap", "../HDL-32E.xml", 0, kernel, 0.0f);
+            //A rotation of the HDL-64E has more firings than MAX_POINT_SIZE / 64 columns
+            checkOrganised< HDL64E >("../atwallshort.pcap", "../db.xml", 0, kernel, 0.0f);
+            checkOrganised< HDL64E >("../atwallshort.pcap", "../db.xml", 0, kernel, 180.0f);
+        }
+        checkOrganised< VLP16 >("../sampleShort.pcap", "../VLP-16.xml", 1, VelodyneProjection::SCALAR, 0.0f);
+    }
+
+    void testHDL64IntensityCalibration() {
+        writeFocalCalibration("focal.xml");
+        FrameRecorder< HDL64E > recorder;
+        //8 bits for intensity in the lower bits
+        VelodyneDecoderOptions options = {true, 0, true, 1, 8, 1, 1};
+        VelodyneDecoderCore< HDL64E > core("focal.xml", options, recorder);
+        recorder.m_core = &core;
+        TS_ASSERT(core.hasFullCalibration());
+        TS_ASSERT(core.getCalibration().intensityCorrection);
+
+        //2m, intensity 10: 10 + 1.2 * |256 * (1 - 1500 / 13100)^2 - 256 * (1 - 1000 / 65535)^2| = 67.02
+        const float remaining = 1.0f - 1000.0f / 65535.0f;
+        const float focal = 1.0f - 1500.0f / 13100.0f;
+        const float expected = 10.0f + 1.2f * fabs(256.0f * focal * focal - 256.0f * remaining * remaining);
+        TS_ASSERT_DELTA(expected, 67.02f, 0.01f);
+        const string upper = makePacket(0xEEFF, azimuths(1000, 0), 1000, 10);
+        const string lower = makePacket(0xDDFF, azimuths(1000, 0), 1000, 10);
+        for (uint32_t k = 0; k <= VelodyneProjection::best(); k++) {
+            core.setProjectionKernel(static_cast< VelodyneProjection::Kernel >(k));
+            core.nextPacket(reinterpret_cast< const uint8_t * >(upper.data()), 1206);
+            const float *points = core.getSegment() + (core.getNumberOfPoints() - 12 * 32) * 4;
+            TS_ASSERT_DELTA(points[3], 75.0f, 1e-6f); //at least minIntensity
+            TS_ASSERT_DELTA(points[4 + 3], 60.0f, 1e-6f); //at most maxIntensity
+            TS_ASSERT_DELTA(points[8 + 3], expected, 1e-4f);
+        }
+
+        //The compact point cloud carries the rounded calibrated intensities
+        core.nextPacket(reinterpret_cast< const uint8_t * >(lower.data()), 1206);
+        const string cpc = core.getCompactPointCloud(0, true);
+        TS_ASSERT(cpc.size() >= 64u * 2u);
+        const uint8_t expectedCPC[3] = {75, 60, 67};
+        for (uint8_t layer = 0; layer < 64; layer++) {
+            const uint8_t sensorID = core.getCalibration().sensorOrderIndex[layer];
+            if (sensorID < 3) {
+                TS_ASSERT_EQUALS(static_cast< uint8_t >(cpc[layer * 2 + 1]), expectedCPC[sensorID]);
+            }
+        }
+
+        //The basic model keeps the intensities of the sensor
+        core.setFullCalibration(false);
+        TS_ASSERT(!core.getCalibration().intensityCorrection);
+        core.nextPacket(reinterpret_cast< const uint8_t * >(upper.data()), 1206);
+        TS_ASSERT_DELTA(core.getSegment()[(core.getNumberOfPoints() - 12 * 32) * 4 + 3], 10.0f, 1e-6f);
+
+        compareKernels< HDL64E >("../atwallshort.pcap", "focal.xml");
+        compareLookupTables< HDL64E >("../atwallshort.pcap", "focal.xml");
+        remove("focal.xml");
+    }
+
+    void testHDL64TwoPointCorrection() {
+        //A return of laser 0 at 10m along y: the distance correction along y is interpolated between distCorrectionY at 1.93m and distCorrection at 25.04m
+        FrameRecorder< HDL64E > recorder;
+        VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+        VelodyneDecoderCore< HDL64E > core("../db.xml", options, recorder);
+        recorder.m_core = &core;
+        const VelodyneCalibration< 64 > &calibration = core.getCalibration();
+        TS_ASSERT(calibration.twoPointCorrection);
+        TS_ASSERT_DELTA(calibration.distSlopeY[0] * 1.93f + calibration.distOffsetY[0], calibration.distCorrectionY[0] - calibration.distCorrection[0], 1e-6f);
+        TS_ASSERT_DELTA(calibration.distSlopeY[0] * 25.04f + calibration.distOffsetY[0], 0.0f, 1e-6f);
+
+        const uint16_t azimuth = static_cast< uint16_t >(calibration.rotCorrection[0] * 100.0f + 36000.5f) % 36000; //the beam of laser 0 points along y
+        const string packet = makePacket(0xEEFF, azimuths(azimuth, 0), 5000, 10);
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), 1206);
+        const float *point = core.getSegment();
+        const float distance = 10.0f + calibration.distCorrection[0];
+        const float y = fabs(point[1]);
+        const float distanceY = distance + (calibration.distCorrection[0] - calibration.distCorrectionY[0]) * (y - 1.93f) / (25.04f - 1.93f) + calibration.distCorrectionY[0] - calibration.distCorrection[0];
+        const float vertical = calibration.vertCorrection[0] * TO_RADIAN;
+        const float vertOffset = calibration.vertOffsetCorrection[0];
+        TS_ASSERT_DELTA(point[1], distanceY * cos(vertical) - vertOffset * sin(vertical), 2e-3f);
+        TS_ASSERT_DELTA(point[2], distanceY * sin(vertical) + vertOffset * cos(vertical), 1e-4f);
+
+        //The basic model neither corrects along y nor turns the vertical offset
+        core.setFullCalibration(false);
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), 1206);
+        const float *basic = core.getSegment() + (core.getNumberOfPoints() - 12 * 32) * 4;
+        TS_ASSERT_DELTA(basic[1], distance * cos(vertical), 2e-3f);
+        TS_ASSERT_DELTA(basic[2], distance * sin(vertical) + vertOffset, 1e-4f);
+        TS_ASSERT(fabs(basic[1] - point[1]) > 0.05f);
+    }
+
+    void testCompactPointCloudWithIntensity() {
+        FrameRecorder< VLP16 > recorder;
+        //4 bits for intensity in the higher bits, cm resolution
+        VelodyneDecoderOptions options = {false, 0, true, 1, 4, 0, 0};
+        VelodyneDecoderCore< VLP16 > core("../VLP-16.xml", options, recorder);
+        recorder.m_core = &core;
+
+        const string packet = makePacket(0xEEFF, azimuths(100, 20), 5000, 0xA0);
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), 1206);
+        const string cpc = core.getCompactPointCloud(0, true);
+        TS_ASSERT_EQUALS(cpc.size(), 24u * 16u * 2u);
+        const uint16_t value = static_cast< uint16_t >((static_cast< uint8_t >(cpc[0]) << 8) | static_cast< uint8_t >(cpc[1]));
+        TS_ASSERT_EQUALS(value, (0xA << 12) + 1000);
+    }
+};
+
+#endif /*VELODYNEDECODERCORE_TESTSUITE_H*/
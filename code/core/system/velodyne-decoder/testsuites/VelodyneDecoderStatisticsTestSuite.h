@@ -0,0 +1,245 @@
+/**
+ * velodyne-decoder - Decoder core shared by the Velodyne proxies.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VELODYNEDECODERSTATISTICS_TESTSUITE_H
+#define VELODYNEDECODERSTATISTICS_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "opendavinci/odcore/data/Container.h"
+#include "opendavinci/odcore/io/conference/ContainerConference.h"
+#include "opendavinci/odcore/wrapper/SharedMemoryFactory.h"
+#include "odvdopendlvstandardmessageset/GeneratedHeaders_ODVDOpenDLVStandardMessageSet.h"
+
+#include "../include/VelodyneDecoder.h"
+#include "../include/VelodyneDecoderStatistics.h"
+#include "../include/VelodynePcapReader.h"
+
+using namespace std;
+using namespace odcore::data;
+using namespace odcore::wrapper;
+using namespace opendlv::core::system::proxy;
+
+// A VLP-16 whose frames hold fewer points than a rotation has.
+struct SmallVLP16 : public VLP16 {
+    static constexpr uint32_t MAX_POINT_SIZE = 10000;
+};
+
+// Counts the frames and the truncated frames of a core.
+template < typename Model >
+class TruncationCounter : public VelodyneFrameListener {
+   public:
+    TruncationCounter()
+        : m_core(NULL)
+        , m_frames(0)
+        , m_truncated(0)
+        , m_maxPoints(0) {}
+
+    virtual void nextFrame() {
+        m_frames++;
+        m_truncated += m_core->isTruncated() ? 1 : 0;
+        m_maxPoints = (m_core->getNumberOfPoints() > m_maxPoints) ? m_core->getNumberOfPoints() : m_maxPoints;
+    }
+
+    VelodyneDecoderCore< Model > *m_core;
+    uint32_t m_frames;
+    uint32_t m_truncated;
+    uint32_t m_maxPoints;
+};
+
+// Keeps the statistics sent by a decoder.
+class StatisticsCollector : public odcore::io::conference::ContainerConference {
+   public:
+    StatisticsCollector()
+        : ContainerConference()
+        , m_statistics() {}
+
+    virtual void send(Container &c) const {
+        if (c.getDataType() == opendlv::proxy::PointCloudDecoderStatistics::ID()) {
+            m_statistics.push_back(c.getData< opendlv::proxy::PointCloudDecoderStatistics >());
+        }
+    }
+
+    mutable vector< opendlv::proxy::PointCloudDecoderStatistics > m_statistics;
+};
+
+// Decodes a recording with every dropEvery-th packet left out and returns the counters.
+template < typename Model >
+VelodyneDecoderCounters countPackets(const string &recording, const string &calibration, const uint32_t &dropEvery, uint32_t &dropped) {
+    const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+    TruncationCounter< Model > listener;
+    VelodyneDecoderCore< Model > core(calibration, options, listener);
+    listener.m_core = &core;
+    const vector< string > packets = VelodynePcapReader::readDataPackets(recording);
+    TS_ASSERT(!packets.empty());
+    dropped = 0;
+    for (uint32_t i = 0; i < packets.size(); i++) {
+        if (dropEvery > 0 && i > 0 && i % dropEvery == 0) {
+            dropped++;
+            continue;
+        }
+        core.nextPacket(reinterpret_cast< const uint8_t * >(packets[i].data()), static_cast< uint32_t >(packets[i].size()));
+    }
+    return core.getCounters();
+}
+
+class VelodyneDecoderStatisticsTest : public CxxTest::TestSuite {
+   public:
+    void testHistogram() {
+        for (uint64_t value = 0; value < 100000; value = value * 9 / 8 + 1) {
+            const uint32_t bin = VelodyneDecodeTimeHistogram::bin(value);
+            TS_ASSERT(VelodyneDecodeTimeHistogram::lowerBound(bin) <= value);
+            TS_ASSERT(value < VelodyneDecodeTimeHistogram::lowerBound(bin + 1));
+        }
+        TS_ASSERT_EQUALS(VelodyneDecodeTimeHistogram::bin(1ul << 60), VelodyneDecodeTimeHistogram::NUMBER_OF_BINS - 1);
+
+        VelodyneDecodeTimeHistogram histogram;
+        TS_ASSERT_EQUALS(histogram.getPercentile(0.5), 0u);
+        for (uint64_t value = 1; value <= 10000; value++) {
+            histogram.add(value);
+        }
+        TS_ASSERT_EQUALS(histogram.getCount(), 10000u);
+        TS_ASSERT_EQUALS(histogram.getMax(), 10000u);
+        const double fractions[3] = {0.5, 0.9, 0.99};
+        for (uint32_t i = 0; i < 3; i++) {
+            const double percentile = static_cast< double >(histogram.getPercentile(fractions[i]));
+            TS_ASSERT_DELTA(percentile, fractions[i] * 10000.0, fractions[i] * 10000.0 * 0.125);
+        }
+        TS_ASSERT_EQUALS(histogram.getPercentile(1.0), 10000u);
+        histogram.clear();
+        TS_ASSERT_EQUALS(histogram.getCount(), 0u);
+    }
+
+    void testMissingPackets() {
+        uint32_t dropped = 0;
+        VelodyneDecoderCounters counters = countPackets< VLP16 >("../sampleShort.pcap", "../VLP-16.xml", 0, dropped);
+        TS_ASSERT_EQUALS(counters.packets, 291u);
+        TS_ASSERT_EQUALS(counters.missingPackets, 0u);
+        TS_ASSERT_EQUALS(counters.badPackets, 0u);
+        TS_ASSERT_EQUALS(counters.truncatedFrames, 0u);
+        counters = countPackets< VLP16 >("../sampleShort.pcap", "../VLP-16.xml", 7, dropped);
+        TS_ASSERT_EQUALS(counters.packets, 291u - dropped);
+        TS_ASSERT_EQUALS(counters.missingPackets, dropped);
+
+        counters = countPackets< HDL32E >("../sampleShort_velodyne32.pcap", "../HDL-32E.xml", 0, dropped);
+        TS_ASSERT_EQUALS(counters.missingPackets, 0u);
+        counters = countPackets< HDL32E >("../sampleShort_velodyne32.pcap", "../HDL-32E.xml", 5, dropped);
+        TS_ASSERT_EQUALS(counters.missingPackets, dropped);
+
+        counters = countPackets< HDL64E >("../atwallshort.pcap", "../db.xml", 0, dropped);
+        TS_ASSERT_EQUALS(counters.missingPackets, 0u);
+        counters = countPackets< HDL64E >("../atwallshort.pcap", "../db.xml", 3, dropped);
+        TS_ASSERT_EQUALS(counters.missingPackets, dropped);
+    }
+
+    void testBadPackets() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        TruncationCounter< VLP16 > listener;
+        VelodyneDecoderCore< VLP16 > core("../VLP-16.xml", options, listener);
+        const vector< string > packets = VelodynePcapReader::readDataPackets("../sampleShort.pcap");
+        TS_ASSERT(!core.nextPacket(reinterpret_cast< const uint8_t * >(packets[0].data()), 512));
+        TS_ASSERT(core.nextPacket(reinterpret_cast< const uint8_t * >(packets[0].data()), 1206));
+        TS_ASSERT_EQUALS(core.getCounters().badPackets, 1u);
+        TS_ASSERT_EQUALS(core.getCounters().packets, 1u);
+    }
+
+    void testTruncatedFrames() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        TruncationCounter< SmallVLP16 > listener;
+        VelodyneDecoderCore< SmallVLP16 > core("../VLP-16.xml", options, listener);
+        listener.m_core = &core;
+        const vector< string > packets = VelodynePcapReader::readDataPackets("../sampleShort.pcap");
+        for (auto &packet : packets) {
+            core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+        }
+        // The complete rotations have more points than fit into a frame; the first, partial one does not.
+        TS_ASSERT(listener.m_frames > 2);
+        TS_ASSERT_EQUALS(listener.m_truncated, listener.m_frames - 1);
+        TS_ASSERT_EQUALS(core.getCounters().truncatedFrames, listener.m_truncated);
+        TS_ASSERT_EQUALS(listener.m_maxPoints, VelodyneDecoderCore< SmallVLP16 >::POINT_CAPACITY);
+
+        TruncationCounter< VLP16 > complete;
+        VelodyneDecoderCore< VLP16 > completeCore("../VLP-16.xml", options, complete);
+        complete.m_core = &completeCore;
+        for (auto &packet : packets) {
+            completeCore.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+        }
+        TS_ASSERT_EQUALS(complete.m_truncated, 0u);
+        TS_ASSERT(complete.m_maxPoints > VelodyneDecoderCore< SmallVLP16 >::POINT_CAPACITY);
+    }
+
+    void testStatisticsSent() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        const vector< string > packets = VelodynePcapReader::readDataPackets("../sampleShort.pcap");
+        StatisticsCollector silent;
+        VelodyneDecoder< VLP16 > silentDecoder(SharedMemoryFactory::createSharedMemory("silentStatisticsSM", VelodyneDecoderCore< VLP16 >::SIZE), silent, "../VLP-16.xml", options);
+        for (auto &packet : packets) {
+            silentDecoder.nextString(packet);
+        }
+        TS_ASSERT(silent.m_statistics.empty());
+
+        // A report after each frame; every packet but the left out ones is decoded.
+        StatisticsCollector collector;
+        VelodyneDecoder< VLP16 > decoder(SharedMemoryFactory::createSharedMemory("statisticsSM", VelodyneDecoderCore< VLP16 >::SIZE), collector, "../VLP-16.xml", options);
+        decoder.setStatisticsInterval(0.000001f);
+        uint32_t dropped = 0;
+        for (uint32_t i = 0; i < packets.size(); i++) {
+            if (i == 100 || i == 200) {
+                dropped++;
+                continue;
+            }
+            decoder.nextString(packets[i]);
+        }
+        decoder.nextString(string(100, '\0'));
+        TS_ASSERT_EQUALS(collector.m_statistics.size(), decoder.getNumberOfFrames());
+        uint32_t frames = 0;
+        uint32_t missing = 0;
+        uint32_t timed = 0;
+        uint32_t longestFrame = 0;
+        for (auto &s : collector.m_statistics) {
+            frames += s.getFrames();
+            missing += s.getMissingPackets();
+            TS_ASSERT(s.getInterval() > 0.0f);
+            TS_ASSERT(s.getPacketsPerSecond() > 0.0f);
+            TS_ASSERT(s.getPointsPerFrame() > 0.0f);
+            TS_ASSERT(static_cast< float >(s.getMaxPointsPerFrame()) >= s.getPointsPerFrame());
+            TS_ASSERT_EQUALS(s.getTruncatedFrames(), 0u);
+            TS_ASSERT_EQUALS(s.getBadPackets(), 0u);
+            TS_ASSERT(s.getDecodeTimeMedian() <= s.getDecodeTime90());
+            TS_ASSERT(s.getDecodeTime90() <= s.getDecodeTime99());
+            TS_ASSERT(s.getDecodeTime99() <= s.getDecodeTimeMax());
+            timed += (s.getDecodeTimeMax() > 0.0f) ? 1 : 0;
+            TS_ASSERT(static_cast< float >(s.getFrameDurationMax()) >= s.getFrameDurationMean());
+            longestFrame = max(longestFrame, s.getFrameDurationMax());
+        }
+        // The VLP-16 was recorded at 10 Hz; the first frame is a partial rotation.
+        TS_ASSERT(longestFrame > 95000u && longestFrame < 105000u);
+        TS_ASSERT_EQUALS(frames, decoder.getNumberOfFrames());
+        TS_ASSERT_EQUALS(missing, dropped);
+        TS_ASSERT(timed > 0);
+        TS_ASSERT_EQUALS(decoder.getCounters().packets, packets.size() - dropped);
+        TS_ASSERT_EQUALS(decoder.getCounters().badPackets, 1u);
+    }
+};
+
+#endif /*VELODYNEDECODERSTATISTICS_TESTSUITE_H*/
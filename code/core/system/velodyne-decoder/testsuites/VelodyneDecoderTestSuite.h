@@ -0,0 +1,468 @@
+/**
+ * velodyne-decoder - Decoder core shared by the Velodyne proxies.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VELODYNEDECODER_TESTSUITE_H
+#define VELODYNEDECODER_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "opendavinci/generated/odcore/data/SharedPointCloud.h"
+#include "opendavinci/odcore/data/Container.h"
+#include "opendavinci/odcore/io/conference/ContainerConference.h"
+#include "opendavinci/odcore/wrapper/SharedMemory.h"
+#include "opendavinci/odcore/wrapper/SharedMemoryFactory.h"
+
+#include "../include/VelodyneDecoder.h"
+#include "../include/VelodynePcapReader.h"
+#include "../include/VelodynePointEncoding.h"
+#include "../include/VelodyneSharedMemoryRing.h"
+
+using namespace std;
+using namespace odcore::data;
+using namespace odcore::wrapper;
+using namespace opendlv::core::system::proxy;
+
+// Copies the points (and time offsets and return indices) of every announced shared point cloud;
+// frames read from a slot are validated with the sequence of the slot.
+class FrameCollector : public odcore::io::conference::ContainerConference {
+   public:
+    FrameCollector()
+        : ContainerConference()
+        , m_names()
+        , m_frames()
+        , m_frameNumbers()
+        , m_sampleTimeStamps()
+        , m_frameTimes()
+        , m_azimuths()
+        , m_returnIndices()
+        , m_dataTypes()
+        , m_ring(false)
+        , m_timeOffsets(false)
+        , m_withReturnIndices(false)
+        , m_encoding(VelodynePointEncoding::FLOAT32) {}
+
+    virtual void send(Container &c) const {
+        if (c.getDataType() != SharedPointCloud::ID()) {
+            return;
+        }
+        SharedPointCloud spc = c.getData< SharedPointCloud >();
+        const uint32_t numberOfPoints = spc.getWidth() * spc.getHeight(); // The organised layout has one row per laser.
+        std::shared_ptr< SharedMemory > memory = SharedMemoryFactory::attachToSharedMemory(spc.getName());
+        TS_ASSERT(memory.get() != NULL && memory->isValid());
+        const uint32_t floatsPerPoint = spc.getNumberOfComponentsPerPoint() + (m_timeOffsets ? 1 : 0);
+        const uint32_t pointSize = VelodynePointEncoding::getBytesPerPoint(m_encoding);
+        const uint32_t bytesPerPoint = pointSize + (m_timeOffsets ? static_cast< uint32_t >(sizeof(float)) : 0) + (m_withReturnIndices ? 1 : 0);
+        TS_ASSERT_EQUALS(spc.getSize(), numberOfPoints * bytesPerPoint); // Only the points of the frame are announced.
+        vector< char > bytes(spc.getSize());
+        if (m_ring) {
+            uint32_t pointsInSlot = 0;
+            uint32_t frame = 0;
+            int64_t startTime = 0;
+            int64_t endTime = 0;
+            float startAzimuth = 0.0f;
+            float endAzimuth = 0.0f;
+            TS_ASSERT(VelodyneSharedMemoryRing::read(memory->getSharedMemory(), memory->getSize(), bytes.data(), spc.getSize(), pointsInSlot, frame, &startTime, &endTime, &startAzimuth, &endAzimuth));
+            TS_ASSERT_EQUALS(pointsInSlot, numberOfPoints);
+            m_frameNumbers.push_back(frame);
+            m_frameTimes.push_back(make_pair(startTime, endTime));
+            m_azimuths.push_back(make_pair(startAzimuth, endAzimuth));
+        } else {
+            memcpy(bytes.data(), memory->getSharedMemory(), spc.getSize());
+        }
+        // The points are decoded into floats, followed by their time offsets.
+        vector< float > points(numberOfPoints * floatsPerPoint);
+        VelodynePointEncoding::decode(m_encoding, bytes.data(), numberOfPoints, points.data());
+        const uint32_t timeOffsetsSize = (m_timeOffsets ? numberOfPoints * static_cast< uint32_t >(sizeof(float)) : 0);
+        memcpy(points.data() + numberOfPoints * spc.getNumberOfComponentsPerPoint(), bytes.data() + numberOfPoints * pointSize, timeOffsetsSize);
+        if (m_withReturnIndices) {
+            m_returnIndices.push_back(vector< uint8_t >(bytes.begin() + static_cast< ptrdiff_t >(numberOfPoints * pointSize + timeOffsetsSize), bytes.end()));
+        }
+        m_dataTypes.push_back(spc.getComponentDataType());
+        m_names.push_back(spc.getName());
+        m_frames.push_back(points);
+        m_sampleTimeStamps.push_back(c.getSampleTimeStamp().toMicroseconds());
+    }
+
+    mutable vector< string > m_names;
+    mutable vector< vector< float > > m_frames;
+    mutable vector< uint32_t > m_frameNumbers;
+    mutable vector< int64_t > m_sampleTimeStamps;
+    mutable vector< pair< int64_t, int64_t > > m_frameTimes;
+    mutable vector< pair< float, float > > m_azimuths;
+    mutable vector< vector< uint8_t > > m_returnIndices;
+    mutable vector< uint32_t > m_dataTypes;
+    bool m_ring;
+    bool m_timeOffsets;
+    bool m_withReturnIndices;
+    VelodynePointEncoding::Encoding m_encoding;
+};
+
+inline void replay(VelodyneDecoder< HDL64E > &decoder, const string &recording) {
+    const vector< string > packets = VelodynePcapReader::readDataPackets(recording);
+    TS_ASSERT(!packets.empty());
+    for (auto &packet : packets) {
+        decoder.nextString(packet);
+    }
+}
+
+class VelodyneDecoderTest : public CxxTest::TestSuite {
+   public:
+    void testRingMatchesCopy() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        const uint32_t SIZE = VelodyneDecoderCore< HDL64E >::SIZE;
+
+        FrameCollector copied;
+        VelodyneDecoder< HDL64E > copyDecoder(SharedMemoryFactory::createSharedMemory("copySM", SIZE), copied, "../db.xml", options);
+        replay(copyDecoder, "../atwallshort.pcap");
+
+        FrameCollector slotted;
+        slotted.m_ring = true;
+        VelodyneDecoder< HDL64E > ringDecoder(SharedMemoryFactory::createSharedMemory("ringSM", SIZE), slotted, "../db.xml", options);
+        TS_ASSERT(ringDecoder.setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing("ringSM", 2, SIZE))));
+        replay(ringDecoder, "../atwallshort.pcap");
+
+        TS_ASSERT(!copied.m_frames.empty());
+        TS_ASSERT(copied.m_frames == slotted.m_frames);
+        for (uint32_t i = 0; i < slotted.m_names.size(); i++) {
+            TS_ASSERT_EQUALS(copied.m_names[i], "copySM");
+            TS_ASSERT_EQUALS(slotted.m_names[i], VelodyneSharedMemoryRing::getSlotName("ringSM", i % 2));
+            TS_ASSERT_EQUALS(slotted.m_frameNumbers[i], i);
+        }
+    }
+
+    void testFramesCarryReceiveTime() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        FrameCollector collector;
+        VelodyneDecoder< HDL64E > decoder(SharedMemoryFactory::createSharedMemory("timedSM", VelodyneDecoderCore< HDL64E >::SIZE), collector, "../db.xml", options);
+
+        // Packet i is received at 1000 + i seconds; remember the packets completing a frame.
+        const vector< string > packets = VelodynePcapReader::readDataPackets("../atwallshort.pcap");
+        vector< int64_t > boundaries;
+        for (uint32_t i = 0; i < packets.size(); i++) {
+            const size_t frames = collector.m_frames.size();
+            decoder.nextPacket(reinterpret_cast< const uint8_t * >(packets[i].data()), static_cast< uint32_t >(packets[i].size()), TimeStamp(static_cast< int32_t >(1000 + i), 0));
+            if (collector.m_frames.size() != frames) {
+                boundaries.push_back(i);
+            }
+        }
+
+        TS_ASSERT(collector.m_sampleTimeStamps.size() > 1);
+        TS_ASSERT_EQUALS(collector.m_sampleTimeStamps[0], 1000 * 1000000L);
+        for (uint32_t k = 1; k < collector.m_sampleTimeStamps.size(); k++) {
+            TS_ASSERT_EQUALS(collector.m_sampleTimeStamps[k], (1000 + boundaries[k - 1]) * 1000000L); // The packet completing a frame starts the next one.
+        }
+    }
+
+    void testRingCarriesFrameTimesAndTimeOffsets() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        FrameCollector copied;
+        copied.m_timeOffsets = true;
+        VelodyneDecoder< HDL64E > copyDecoder(SharedMemoryFactory::createSharedMemory("offsetsSM", VelodyneDecoderCore< HDL64E >::SIZE + VelodyneDecoderCore< HDL64E >::TIME_OFFSETS_SIZE), copied, "../db.xml", options);
+        TS_ASSERT(copyDecoder.setTimeOffsets(true));
+        TS_ASSERT_EQUALS(copyDecoder.getFrameSize(), VelodyneDecoderCore< HDL64E >::SIZE + VelodyneDecoderCore< HDL64E >::TIME_OFFSETS_SIZE);
+        replay(copyDecoder, "../atwallshort.pcap");
+
+        FrameCollector slotted;
+        slotted.m_ring = true;
+        slotted.m_timeOffsets = true;
+        VelodyneDecoder< HDL64E > ringDecoder(SharedMemoryFactory::createSharedMemory("timedRingSM", 16), slotted, "../db.xml", options);
+        TS_ASSERT(ringDecoder.setTimeOffsets(true));
+        TS_ASSERT(!ringDecoder.setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing("timedRingSM", 2, VelodyneDecoderCore< HDL64E >::SIZE))));
+        TS_ASSERT(ringDecoder.setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing("timedRingSM", 2, ringDecoder.getFrameSize()))));
+
+        // Packet i is received at 1000 s + i ms.
+        const vector< string > packets = VelodynePcapReader::readDataPackets("../atwallshort.pcap");
+        for (uint32_t i = 0; i < packets.size(); i++) {
+            ringDecoder.nextPacket(reinterpret_cast< const uint8_t * >(packets[i].data()), static_cast< uint32_t >(packets[i].size()), TimeStamp(1000 + static_cast< int32_t >(i / 1000), static_cast< int32_t >((i % 1000) * 1000)));
+        }
+
+        TS_ASSERT(!slotted.m_frames.empty());
+        TS_ASSERT(copied.m_frames == slotted.m_frames); // Points followed by their time offsets.
+        for (uint32_t k = 0; k < slotted.m_frames.size(); k++) {
+            const vector< float > &frame = slotted.m_frames[k];
+            const uint32_t numberOfPoints = static_cast< uint32_t >(frame.size() / 5);
+            const int64_t startTime = slotted.m_frameTimes[k].first;
+            const int64_t endTime = slotted.m_frameTimes[k].second;
+            TS_ASSERT_EQUALS(slotted.m_sampleTimeStamps[k], startTime);
+            TS_ASSERT(endTime >= startTime);
+            if (numberOfPoints > 0) {
+                // The last point is fired at the end of the frame (the HDL-64E fires all lasers of a block at once).
+                TS_ASSERT_DELTA(static_cast< double >(frame.back()), static_cast< double >(endTime - startTime), 1.0);
+            }
+        }
+        TS_ASSERT_EQUALS(slotted.m_frameTimes.back().first, ringDecoder.getFrameStartTime());
+        TS_ASSERT_EQUALS(slotted.m_frameTimes.back().second, ringDecoder.getFrameEndTime());
+    }
+
+    void testStationaryPosesKeepPoints() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        FrameCollector reference;
+        VelodyneDecoder< HDL64E > referenceDecoder(SharedMemoryFactory::createSharedMemory("stillSM", VelodyneDecoderCore< HDL64E >::SIZE), reference, "../db.xml", options);
+
+        FrameCollector compensated;
+        VelodyneDecoder< HDL64E > decoder(SharedMemoryFactory::createSharedMemory("deskewSM", VelodyneDecoderCore< HDL64E >::SIZE), compensated, "../db.xml", options);
+        std::shared_ptr< VelodynePoseBuffer > poses(new VelodynePoseBuffer(8));
+        TS_ASSERT(decoder.setPoseBuffer(poses));
+        TS_ASSERT_EQUALS(decoder.getFrameSize(), VelodyneDecoderCore< HDL64E >::SIZE); // The time offsets are only used internally.
+        poses->pushGeodetic(999000000, 57.7, 11.9, 10.0, 1.0, 2.0, 45.0);
+        poses->pushGeodetic(1010000000, 57.7, 11.9, 10.0, 1.0, 2.0, 45.0);
+
+        const vector< string > packets = VelodynePcapReader::readDataPackets("../atwallshort.pcap");
+        for (uint32_t i = 0; i < packets.size(); i++) {
+            const TimeStamp received(1000 + static_cast< int32_t >(i / 1000), static_cast< int32_t >((i % 1000) * 1000));
+            referenceDecoder.nextPacket(reinterpret_cast< const uint8_t * >(packets[i].data()), static_cast< uint32_t >(packets[i].size()), received);
+            decoder.nextPacket(reinterpret_cast< const uint8_t * >(packets[i].data()), static_cast< uint32_t >(packets[i].size()), received);
+        }
+
+        TS_ASSERT(!compensated.m_frames.empty());
+        TS_ASSERT_EQUALS(decoder.getDeskewedFrames(), compensated.m_frames.size());
+        TS_ASSERT_EQUALS(reference.m_frames.size(), compensated.m_frames.size());
+        uint32_t outliers = 0;
+        for (uint32_t k = 0; k < reference.m_frames.size() && k < compensated.m_frames.size(); k++) {
+            TS_ASSERT_EQUALS(reference.m_frames[k].size(), compensated.m_frames[k].size());
+            for (uint32_t i = 0; i < reference.m_frames[k].size() && i < compensated.m_frames[k].size(); i++) {
+                if (fabs(reference.m_frames[k][i] - compensated.m_frames[k][i]) > 1e-4f) {
+                    outliers++;
+                }
+            }
+        }
+        TS_ASSERT_EQUALS(outliers, 0u);
+
+        // Polar points cannot be transformed.
+        const VelodyneDecoderOptions polar = {true, 1, false, 0, 0, 0, 0};
+        VelodyneDecoder< HDL64E > polarDecoder(SharedMemoryFactory::createSharedMemory("polarSM", VelodyneDecoderCore< HDL64E >::SIZE), compensated, "../db.xml", polar);
+        TS_ASSERT(!polarDecoder.setPoseBuffer(poses));
+    }
+
+    void testSectorsInRing() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        FrameCollector rotations;
+        rotations.m_ring = true;
+        VelodyneDecoder< HDL64E > rotationDecoder(SharedMemoryFactory::createSharedMemory("rotationSM", 16), rotations, "../db.xml", options);
+        TS_ASSERT(rotationDecoder.setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing("rotationSM", 3, VelodyneDecoderCore< HDL64E >::SIZE))));
+        replay(rotationDecoder, "../atwallshort.pcap");
+
+        FrameCollector sectors;
+        sectors.m_ring = true;
+        VelodyneDecoder< HDL64E > sectorDecoder(SharedMemoryFactory::createSharedMemory("sectorSM", 16), sectors, "../db.xml", options);
+        sectorDecoder.setSectorSize(90.0f);
+        TS_ASSERT(sectorDecoder.setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing("sectorSM", 3, VelodyneDecoderCore< HDL64E >::SIZE))));
+        replay(sectorDecoder, "../atwallshort.pcap");
+
+        // Up to four sectors per rotation (the recording starts late in the first one), each announced with its azimuths.
+        TS_ASSERT(sectors.m_frames.size() > rotations.m_frames.size());
+        size_t rotationPoints = 0;
+        size_t sectorPoints = 0;
+        for (auto &frame : rotations.m_frames) {
+            rotationPoints += frame.size();
+        }
+        for (auto &frame : sectors.m_frames) {
+            sectorPoints += frame.size();
+        }
+        TS_ASSERT(sectorPoints >= rotationPoints);
+        for (uint32_t k = 1; k < sectors.m_azimuths.size(); k++) {
+            const float startAzimuth = sectors.m_azimuths[k].first;
+            const float endAzimuth = sectors.m_azimuths[k].second;
+            TS_ASSERT(startAzimuth <= endAzimuth);
+            TS_ASSERT_EQUALS(static_cast< uint32_t >(startAzimuth / 90.0f), static_cast< uint32_t >(endAzimuth / 90.0f));
+            TS_ASSERT_EQUALS(sectors.m_frameNumbers[k], k);
+        }
+    }
+
+    void testOrganisedRotationsInRing() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        FrameCollector collector;
+        collector.m_ring = true;
+        collector.m_timeOffsets = true;
+        VelodyneDecoder< HDL64E > decoder(SharedMemoryFactory::createSharedMemory("organisedSM", 16), collector, "../db.xml", options);
+        TS_ASSERT(decoder.setOrganised(true));
+        TS_ASSERT(decoder.setTimeOffsets(true));
+        TS_ASSERT_EQUALS(decoder.getFrameSize(), VelodyneDecoderCore< HDL64E >::ORGANISED_POINT_CAPACITY * 20);
+        TS_ASSERT(decoder.setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing("organisedSM", 2, decoder.getFrameSize()))));
+        TS_ASSERT(!decoder.setOrganised(false)); // The slots are sized for the organised layout.
+        replay(decoder, "../atwallshort.pcap");
+
+        // Complete rotations have more columns (firings) than MAX_POINT_SIZE / 64 and are not truncated.
+        TS_ASSERT(collector.m_frames.size() > 1u);
+        size_t columns = 0;
+        for (auto &frame : collector.m_frames) {
+            TS_ASSERT_EQUALS(frame.size() % (64 * 5), 0u);
+            columns = (frame.size() / (64 * 5) > columns) ? frame.size() / (64 * 5) : columns;
+        }
+        TS_ASSERT(columns > HDL64E::MAX_POINT_SIZE / 64);
+        TS_ASSERT_EQUALS(decoder.getCounters().truncatedFrames, 0u);
+    }
+
+    void testReturnIndicesFollowTimeOffsets() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        FrameCollector reference;
+        reference.m_ring = true;
+        reference.m_timeOffsets = true;
+        VelodyneDecoder< HDL64E > referenceDecoder(SharedMemoryFactory::createSharedMemory("offsetsOnlySM", 16), reference, "../db.xml", options);
+        TS_ASSERT(referenceDecoder.setTimeOffsets(true));
+        TS_ASSERT(referenceDecoder.setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing("offsetsOnlySM", 2, referenceDecoder.getFrameSize()))));
+        replay(referenceDecoder, "../atwallshort.pcap");
+
+        FrameCollector collector;
+        collector.m_ring = true;
+        collector.m_timeOffsets = true;
+        collector.m_withReturnIndices = true;
+        VelodyneDecoder< HDL64E > decoder(SharedMemoryFactory::createSharedMemory("returnsSM", 16), collector, "../db.xml", options);
+        TS_ASSERT(decoder.setTimeOffsets(true));
+        TS_ASSERT(decoder.setReturnIndices(true));
+        TS_ASSERT_EQUALS(decoder.getFrameSize(), VelodyneDecoderCore< HDL64E >::SIZE + VelodyneDecoderCore< HDL64E >::TIME_OFFSETS_SIZE + VelodyneDecoderCore< HDL64E >::RETURN_INDICES_SIZE);
+        TS_ASSERT(decoder.setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing("returnsSM", 2, decoder.getFrameSize()))));
+        replay(decoder, "../atwallshort.pcap");
+
+        // The HDL-64E sends single returns: the points and time offsets are unchanged and followed by one 0 per point.
+        TS_ASSERT(!collector.m_frames.empty());
+        TS_ASSERT(collector.m_frames == reference.m_frames);
+        TS_ASSERT_EQUALS(collector.m_returnIndices.size(), collector.m_frames.size());
+        for (uint32_t k = 0; k < collector.m_returnIndices.size(); k++) {
+            TS_ASSERT_EQUALS(collector.m_returnIndices[k].size(), collector.m_frames[k].size() / 5);
+            TS_ASSERT(collector.m_returnIndices[k] == vector< uint8_t >(collector.m_returnIndices[k].size(), 0));
+        }
+        TS_ASSERT(!decoder.isDualReturn());
+    }
+
+    void testCompactEncodings() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        FrameCollector reference;
+        reference.m_timeOffsets = true;
+        VelodyneDecoder< HDL64E > referenceDecoder(SharedMemoryFactory::createSharedMemory("floatSM", VelodyneDecoderCore< HDL64E >::SIZE + VelodyneDecoderCore< HDL64E >::TIME_OFFSETS_SIZE), reference, "../db.xml", options);
+        TS_ASSERT(referenceDecoder.setTimeOffsets(true));
+        replay(referenceDecoder, "../atwallshort.pcap");
+        TS_ASSERT(!reference.m_frames.empty());
+
+        const VelodynePointEncoding::Encoding encodings[] = {VelodynePointEncoding::INT16, VelodynePointEncoding::FLOAT16};
+        const uint32_t dataTypes[] = {SharedPointCloud::INT16_T, SharedPointCloud::UINT16_T};
+        for (uint32_t e = 0; e < 2; e++) {
+            for (uint32_t ring = 0; ring < 2; ring++) {
+                const string name = "encodedSM" + to_string(e) + to_string(ring);
+                FrameCollector collector;
+                collector.m_ring = (ring == 1);
+                collector.m_timeOffsets = true;
+                collector.m_encoding = encodings[e];
+                VelodyneDecoder< HDL64E > decoder(SharedMemoryFactory::createSharedMemory(name, VelodyneDecoderCore< HDL64E >::SIZE), collector, "../db.xml", options);
+                TS_ASSERT(decoder.setEncoding(encodings[e]));
+                TS_ASSERT(decoder.setTimeOffsets(true));
+                TS_ASSERT_EQUALS(decoder.getFrameSize(), HDL64E::MAX_POINT_SIZE * 8 + VelodyneDecoderCore< HDL64E >::TIME_OFFSETS_SIZE);
+                if (collector.m_ring) {
+                    TS_ASSERT(decoder.setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing(name, 2, decoder.getFrameSize()))));
+                    TS_ASSERT(!decoder.setEncoding(VelodynePointEncoding::FLOAT32)); // The slots are sized for the encoding.
+                }
+                replay(decoder, "../atwallshort.pcap");
+
+                // Same points within the resolution of the encoding; same time offsets.
+                TS_ASSERT_EQUALS(collector.m_frames.size(), reference.m_frames.size());
+                uint32_t outliers = 0;
+                for (uint32_t k = 0; k < collector.m_frames.size() && k < reference.m_frames.size(); k++) {
+                    const vector< float > &frame = collector.m_frames[k];
+                    const vector< float > &expected = reference.m_frames[k];
+                    TS_ASSERT_EQUALS(collector.m_dataTypes[k], dataTypes[e]);
+                    TS_ASSERT_EQUALS(frame.size(), expected.size());
+                    const uint32_t numberOfPoints = static_cast< uint32_t >(expected.size() / 5);
+                    for (uint32_t i = 0; i < numberOfPoints * 4 && i < frame.size(); i++) {
+                        // Half precision floats below 2^-14 are subnormal with a resolution of 2^-24.
+                        const float tolerance = (i % 4 == 3) ? 0.0f : ((encodings[e] == VelodynePointEncoding::INT16) ? 0.0026f : fabs(expected[i]) / 2048.0f + 3e-8f);
+                        outliers += (fabs(frame[i] - expected[i]) > tolerance);
+                    }
+                    outliers += !equal(expected.begin() + numberOfPoints * 4, expected.end(), frame.begin() + numberOfPoints * 4);
+                }
+                TS_ASSERT_EQUALS(outliers, 0u);
+            }
+        }
+
+        // Polar points keep floats.
+        const VelodyneDecoderOptions polar = {true, 1, false, 0, 0, 0, 0};
+        FrameCollector collector;
+        VelodyneDecoder< HDL64E > decoder(SharedMemoryFactory::createSharedMemory("polarSM", VelodyneDecoderCore< HDL64E >::SIZE), collector, "../db.xml", polar);
+        TS_ASSERT(!decoder.setEncoding(VelodynePointEncoding::INT16));
+        TS_ASSERT_EQUALS(decoder.getEncoding(), VelodynePointEncoding::FLOAT32);
+    }
+
+    void testRingTooSmall() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        FrameCollector collector;
+        VelodyneDecoder< HDL64E > decoder(SharedMemoryFactory::createSharedMemory("smallSM", 16), collector, "../db.xml", options);
+        TS_ASSERT(!decoder.setSharedMemoryRing(std::shared_ptr< VelodyneSharedMemoryRing >(new VelodyneSharedMemoryRing("smallSM", 2, 16))));
+    }
+
+    void testSlowReaderDetectsMissedFrames() {
+        VelodyneSharedMemoryRing ring("slowSM", 2, 16);
+        TS_ASSERT(ring.isValid());
+        const void *slot0 = SharedMemoryFactory::attachToSharedMemory("slowSM.0")->getSharedMemory();
+        const uint32_t slotSize = VelodyneSharedMemoryRing::getSlotSize(16);
+        float copy[4];
+        uint32_t numberOfPoints = 0;
+        uint32_t frame = 0;
+
+        TS_ASSERT(!VelodyneSharedMemoryRing::read(slot0, slotSize, copy, 16, numberOfPoints, frame)); // Nothing published yet.
+
+        ring.beginFrame()[0] = 1.0f;
+        TS_ASSERT_EQUALS(ring.publishFrame(1), "slowSM.0");
+        TS_ASSERT(VelodyneSharedMemoryRing::read(slot0, slotSize, copy, 16, numberOfPoints, frame));
+        TS_ASSERT_EQUALS(frame, 0u);
+        TS_ASSERT_EQUALS(numberOfPoints, 1u);
+        TS_ASSERT_EQUALS(copy[0], 1.0f);
+
+        ring.beginFrame();
+        TS_ASSERT_EQUALS(ring.publishFrame(0), "slowSM.1");
+
+        // Frame 2 reuses slot 0: a reader copying meanwhile must not accept the slot.
+        ring.beginFrame()[0] = 3.0f;
+        TS_ASSERT(!VelodyneSharedMemoryRing::read(slot0, slotSize, copy, 16, numberOfPoints, frame));
+        ring.publishFrame(1);
+        TS_ASSERT(VelodyneSharedMemoryRing::read(slot0, slotSize, copy, 16, numberOfPoints, frame));
+        TS_ASSERT_EQUALS(frame, 2u); // Frame 1 was missed by a reader that only watches slot 0.
+        TS_ASSERT_EQUALS(copy[0], 3.0f);
+    }
+
+    void testReaderLocatesTrailerFromSlotSize() {
+        // The slots hold up to 64 bytes; the frame announces only 16.
+        VelodyneSharedMemoryRing ring("partialSM", 2, 60);
+        TS_ASSERT(ring.isValid());
+        std::shared_ptr< SharedMemory > memory = SharedMemoryFactory::attachToSharedMemory("partialSM.0");
+        TS_ASSERT_EQUALS(VelodyneSharedMemoryRing::getCapacity(memory->getSize()), 64u);
+        float copy[4];
+        uint32_t numberOfPoints = 0;
+        uint32_t frame = 0;
+
+        ring.beginFrame()[0] = 1.0f;
+        ring.publishFrame(1, 10, 20);
+        int64_t endTime = 0;
+        TS_ASSERT(VelodyneSharedMemoryRing::read(memory->getSharedMemory(), memory->getSize(), copy, 16, numberOfPoints, frame, NULL, &endTime));
+        TS_ASSERT_EQUALS(numberOfPoints, 1u);
+        TS_ASSERT_EQUALS(endTime, 20);
+        TS_ASSERT_EQUALS(copy[0], 1.0f);
+
+        // A segment size that is no slot size is rejected instead of reading the trailer elsewhere.
+        TS_ASSERT_EQUALS(VelodyneSharedMemoryRing::getCapacity(memory->getSize() - 4), 0u);
+        TS_ASSERT(!VelodyneSharedMemoryRing::read(memory->getSharedMemory(), memory->getSize() - 4, copy, 16, numberOfPoints, frame));
+    }
+};
+
+#endif /*VELODYNEDECODER_TESTSUITE_H*/
@@ -0,0 +1,339 @@
+/**
+ * velodyne-decoder - Decoder core shared by the Velodyne proxies.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VELODYNEFUSION_TESTSUITE_H
+#define VELODYNEFUSION_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../include/VelodyneDecoderCore.h"
+#include "../include/VelodyneFusion.h"
+#include "../include/VelodynePcapReader.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+// Keeps a copy of every completed frame of a sensor decoded on its own.
+template < typename Model >
+class SensorFrames : public VelodyneFrameListener {
+   public:
+    SensorFrames(const string &recording, const string &calibration)
+        : m_core(NULL)
+        , m_frames() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 1};
+        VelodyneDecoderCore< Model > core(calibration, options, *this);
+        m_core = &core;
+        for (const string &packet : VelodynePcapReader::readDataPackets(recording)) {
+            core.nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()));
+        }
+        m_core = NULL;
+    }
+
+    virtual void nextFrame() {
+        m_frames.push_back(vector< float >(m_core->getSegment(), m_core->getSegment() + m_core->getNumberOfPoints() * 4));
+    }
+
+    const VelodyneDecoderCore< Model > *m_core;
+    vector< vector< float > > m_frames;
+};
+
+// Keeps a copy of every merged point cloud.
+class MergedFrames : public VelodyneFusionListener {
+   public:
+    MergedFrames()
+        : m_fusion(NULL)
+        , m_points()
+        , m_sensorIndices()
+        , m_merged()
+        , m_startTime()
+        , m_endTime() {}
+
+    virtual void nextMergedFrame() {
+        vector< float > points(m_fusion->getNumberOfPoints() * 4);
+        vector< uint8_t > sensorIndices(m_fusion->getNumberOfPoints());
+        m_fusion->write(points.data(), sensorIndices.data());
+        m_points.push_back(points);
+        m_sensorIndices.push_back(sensorIndices);
+        vector< bool > merged;
+        for (uint32_t index = 0; index < m_fusion->getNumberOfSensors(); index++) {
+            merged.push_back(m_fusion->isMerged(index));
+        }
+        m_merged.push_back(merged);
+        m_startTime.push_back(m_fusion->getFrameStartTime());
+        m_endTime.push_back(m_fusion->getFrameEndTime());
+    }
+
+    const VelodyneFusion *m_fusion;
+    vector< vector< float > > m_points;
+    vector< vector< uint8_t > > m_sensorIndices;
+    vector< vector< bool > > m_merged;
+    vector< int64_t > m_startTime;
+    vector< int64_t > m_endTime;
+};
+
+// A recording replayed as one sensor: packets are received every interval microseconds from start on.
+struct Replay {
+    vector< string > packets;
+    int64_t start;
+    int64_t interval;
+
+    int64_t time(const uint32_t &packet) const {
+        return start + packet * interval;
+    }
+};
+
+inline odcore::data::TimeStamp toTimeStamp(const int64_t &microseconds) {
+    return odcore::data::TimeStamp(static_cast< int32_t >(microseconds / 1000000L), static_cast< int32_t >(microseconds % 1000000L));
+}
+
+// Hands the packets of all recordings to their sensors in the order they are received.
+inline void replayInOrder(VelodyneFusion &fusion, const vector< Replay > &replays) {
+    vector< uint32_t > next(replays.size(), 0);
+    while (true) {
+        int32_t earliest = -1;
+        for (uint32_t index = 0; index < replays.size(); index++) {
+            if (next[index] < replays[index].packets.size() && (earliest < 0 || replays[index].time(next[index]) < replays[static_cast< uint32_t >(earliest)].time(next[static_cast< uint32_t >(earliest)]))) {
+                earliest = static_cast< int32_t >(index);
+            }
+        }
+        if (earliest < 0) {
+            break;
+        }
+        const uint32_t index = static_cast< uint32_t >(earliest);
+        const string &packet = replays[index].packets[next[index]];
+        fusion.getSensor(index).nextPacket(reinterpret_cast< const uint8_t * >(packet.data()), static_cast< uint32_t >(packet.size()), toTimeStamp(replays[index].time(next[index])));
+        next[index]++;
+    }
+}
+
+// Finds the frame of a sensor that matches the given part of a merged point cloud after the transformation.
+inline int32_t findFrame(const vector< vector< float > > &frames, const VelodyneExtrinsics &extrinsics, const float *points, const uint32_t &numberOfPoints) {
+    for (uint32_t j = 0; j < frames.size(); j++) {
+        if (frames[j].size() != numberOfPoints * 4) {
+            continue;
+        }
+        vector< float > transformed(frames[j].size());
+        extrinsics.apply(frames[j].data(), numberOfPoints, transformed.data());
+        bool equal = true;
+        for (uint32_t i = 0; i < transformed.size() && equal; i++) {
+            equal = (transformed[i] == points[i]);
+        }
+        if (equal) {
+            return static_cast< int32_t >(j);
+        }
+    }
+    return -1;
+}
+
+class VelodyneFusionTest : public CxxTest::TestSuite {
+   public:
+    void testExtrinsics() {
+        const double TO_RADIAN = M_PI / 180.0;
+        const float points[12] = {1.0f, 0.0f, 0.0f, 10.0f, 0.0f, 1.0f, 0.0f, 20.0f, 0.0f, 0.0f, 1.0f, 30.0f};
+        float out[12];
+
+        VelodyneExtrinsics identity;
+        identity.apply(points, 3, out);
+        for (uint32_t i = 0; i < 12; i++) {
+            TS_ASSERT_EQUALS(out[i], points[i]);
+        }
+
+        // Yaw turns right into forward.
+        VelodyneExtrinsics yaw;
+        yaw.setPose(1.0, 2.0, 3.0, 0.0, 0.0, 90.0 * TO_RADIAN);
+        yaw.apply(points, 3, out);
+        TS_ASSERT_DELTA(out[0], 1.0f, 1e-6f);
+        TS_ASSERT_DELTA(out[1], 3.0f, 1e-6f);
+        TS_ASSERT_DELTA(out[2], 3.0f, 1e-6f);
+        TS_ASSERT_EQUALS(out[3], 10.0f);
+        TS_ASSERT_DELTA(out[4], 0.0f, 1e-6f);
+        TS_ASSERT_DELTA(out[5], 2.0f, 1e-6f);
+
+        // Pitch lifts forward upwards, roll turns upwards to the right.
+        VelodyneExtrinsics pitch;
+        pitch.setPose(0.0, 0.0, 0.0, 0.0, 90.0 * TO_RADIAN, 0.0);
+        pitch.apply(points, 3, out);
+        TS_ASSERT_DELTA(out[6], 1.0f, 1e-6f);
+        VelodyneExtrinsics roll;
+        roll.setPose(0.0, 0.0, 0.0, 90.0 * TO_RADIAN, 0.0, 0.0);
+        roll.apply(points, 3, out);
+        TS_ASSERT_DELTA(out[8], 1.0f, 1e-6f);
+
+        // Roll first, then pitch, then yaw: upwards is turned to the right, which stays right under pitch and becomes forward under yaw.
+        VelodyneExtrinsics all;
+        all.setPose(0.0, 0.0, 0.0, 90.0 * TO_RADIAN, 30.0 * TO_RADIAN, 90.0 * TO_RADIAN);
+        all.apply(points + 8, 1, out);
+        TS_ASSERT_DELTA(out[0], 0.0f, 1e-6f);
+        TS_ASSERT_DELTA(out[1], 1.0f, 1e-6f);
+        TS_ASSERT_DELTA(out[2], 0.0f, 1e-6f);
+    }
+
+    void testMergeRecordings() {
+        const SensorFrames< VLP16 > vlp16("../sampleShort.pcap", "../VLP-16.xml");
+        const SensorFrames< HDL32E > hdl32e("../sampleShort_velodyne32.pcap", "../HDL-32E.xml");
+        const SensorFrames< HDL64E > hdl64e("../atwallshort.pcap", "../db.xml");
+
+        MergedFrames merged;
+        VelodyneFusion fusion(merged);
+        merged.m_fusion = &fusion;
+        VelodyneExtrinsics left;
+        left.setPose(-1.0, 0.5, 1.5, 0.0, 0.1, 0.5 * M_PI);
+        VelodyneExtrinsics roof;
+        roof.setPose(0.0, 1.0, 3.0, 0.01, -0.02, 0.0);
+        fusion.addSensor< VLP16 >("../VLP-16.xml", VelodyneExtrinsics());
+        fusion.addSensor< HDL32E >("../HDL-32E.xml", left);
+        fusion.addSensor< HDL64E >("../db.xml", roof);
+        TS_ASSERT_EQUALS(fusion.getNumberOfSensors(), 3u);
+        TS_ASSERT_EQUALS(fusion.getMaxPointSize(), VelodyneDecoderCore< VLP16 >::POINT_CAPACITY + VelodyneDecoderCore< HDL32E >::POINT_CAPACITY + VelodyneDecoderCore< HDL64E >::POINT_CAPACITY);
+
+        // All sensors start at the same time: 754 (VLP-16), 1808 (HDL-32E) and 3472 (HDL-64E) packets per second.
+        const int64_t start = 1500000000000000L;
+        const vector< Replay > replays = {{VelodynePcapReader::readDataPackets("../sampleShort.pcap"), start, 1326},
+                                          {VelodynePcapReader::readDataPackets("../sampleShort_velodyne32.pcap"), start, 553},
+                                          {VelodynePcapReader::readDataPackets("../atwallshort.pcap"), start, 288}};
+        replayInOrder(fusion, replays);
+
+        // Every frame of the reference sensor is published, in full and untransformed.
+        TS_ASSERT_EQUALS(merged.m_points.size(), vlp16.m_frames.size());
+        TS_ASSERT_EQUALS(fusion.getMergedFrames(), vlp16.m_frames.size());
+        const vector< vector< float > > *frames[3] = {&vlp16.m_frames, &hdl32e.m_frames, &hdl64e.m_frames};
+        const VelodyneExtrinsics extrinsics[3] = {VelodyneExtrinsics(), left, roof};
+        vector< int32_t > previous(3, -1);
+        vector< uint32_t > mergedFrames(3, 0);
+        for (uint32_t k = 0; k < merged.m_points.size(); k++) {
+            TS_ASSERT(merged.m_merged[k][0]);
+            TS_ASSERT(merged.m_startTime[k] <= merged.m_endTime[k]);
+            uint32_t offset = 0;
+            for (uint32_t index = 0; index < 3; index++) {
+                if (!merged.m_merged[k][index]) {
+                    continue;
+                }
+                // The part of each sensor is one of its frames, transformed with its extrinsics and merged only once.
+                const uint32_t count = static_cast< uint32_t >(count_if(merged.m_sensorIndices[k].begin(), merged.m_sensorIndices[k].end(), [index](const uint8_t &i) { return i == index; }));
+                const int32_t frame = findFrame(*frames[index], extrinsics[index], merged.m_points[k].data() + offset * 4, count);
+                TS_ASSERT(frame > previous[index]);
+                previous[index] = frame;
+                for (uint32_t i = offset; i < offset + count; i++) {
+                    TS_ASSERT_EQUALS(merged.m_sensorIndices[k][i], index);
+                }
+                offset += count;
+                mergedFrames[index]++;
+            }
+            TS_ASSERT_EQUALS(offset * 4, merged.m_points[k].size());
+            TS_ASSERT_EQUALS(previous[0], static_cast< int32_t >(k));
+        }
+
+        // Each frame is either merged, replaced by a newer one, out of time or still waiting.
+        for (uint32_t index = 0; index < 3; index++) {
+            const VelodyneFusionStatistics statistics = fusion.getSensor(index).getStatistics();
+            TS_ASSERT_EQUALS(statistics.decoded, frames[index]->size());
+            TS_ASSERT_EQUALS(statistics.merged, mergedFrames[index]);
+            TS_ASSERT(statistics.decoded - statistics.merged - statistics.overwritten - statistics.outOfTime <= 1);
+            TS_ASSERT(statistics.merged > 0);
+        }
+    }
+
+    void testFramesOutOfTime() {
+        MergedFrames merged;
+        VelodyneFusion fusion(merged);
+        merged.m_fusion = &fusion;
+        fusion.addSensor< VLP16 >("../VLP-16.xml", VelodyneExtrinsics());
+        fusion.addSensor< HDL32E >("../HDL-32E.xml", VelodyneExtrinsics());
+        TS_ASSERT_EQUALS(fusion.getMaxTimeDifference(), 50000);
+
+        // The second sensor lags by a second: its frames are never merged.
+        const int64_t start = 1500000000000000L;
+        const vector< Replay > replays = {{VelodynePcapReader::readDataPackets("../sampleShort.pcap"), start, 1326},
+                                          {VelodynePcapReader::readDataPackets("../sampleShort_velodyne32.pcap"), start - 1000000L, 553}};
+        replayInOrder(fusion, replays);
+        TS_ASSERT(!merged.m_points.empty());
+        for (uint32_t k = 0; k < merged.m_points.size(); k++) {
+            TS_ASSERT(merged.m_merged[k][0]);
+            TS_ASSERT(!merged.m_merged[k][1]);
+        }
+        const VelodyneFusionStatistics statistics = fusion.getSensor(1).getStatistics();
+        TS_ASSERT_EQUALS(statistics.merged, 0u);
+        TS_ASSERT(statistics.outOfTime > 0);
+
+        // With a wider window, they are.
+        MergedFrames wider;
+        VelodyneFusion widerFusion(wider);
+        wider.m_fusion = &widerFusion;
+        widerFusion.addSensor< VLP16 >("../VLP-16.xml", VelodyneExtrinsics());
+        widerFusion.addSensor< HDL32E >("../HDL-32E.xml", VelodyneExtrinsics());
+        widerFusion.setMaxTimeDifference(1100000L);
+        replayInOrder(widerFusion, replays);
+        TS_ASSERT(widerFusion.getSensor(1).getStatistics().merged > 0);
+    }
+
+    void testOneThreadPerSensor() {
+        const SensorFrames< VLP16 > vlp16("../sampleShort.pcap", "../VLP-16.xml");
+        const SensorFrames< HDL32E > hdl32e("../sampleShort_velodyne32.pcap", "../HDL-32E.xml");
+
+        MergedFrames merged;
+        VelodyneFusion fusion(merged);
+        merged.m_fusion = &fusion;
+        VelodyneExtrinsics right;
+        right.setPose(1.0, 0.5, 1.5, 0.0, 0.0, -0.5 * M_PI);
+        fusion.addSensor< VLP16 >("../VLP-16.xml", VelodyneExtrinsics());
+        fusion.addSensor< HDL32E >("../HDL-32E.xml", right);
+        // Only the order within each sensor is given; any frame of the second sensor may be merged.
+        fusion.setMaxTimeDifference(1000000000L);
+
+        const int64_t start = 1500000000000000L;
+        const vector< Replay > replays = {{VelodynePcapReader::readDataPackets("../sampleShort.pcap"), start, 1326},
+                                          {VelodynePcapReader::readDataPackets("../sampleShort_velodyne32.pcap"), start, 553}};
+        vector< thread > workers;
+        for (uint32_t index = 0; index < replays.size(); index++) {
+            workers.push_back(thread([&fusion, &replays, index]() {
+                const Replay &replay = replays[index];
+                for (uint32_t p = 0; p < replay.packets.size(); p++) {
+                    fusion.getSensor(index).nextPacket(reinterpret_cast< const uint8_t * >(replay.packets[p].data()), static_cast< uint32_t >(replay.packets[p].size()), toTimeStamp(replay.time(p)));
+                }
+            }));
+        }
+        for (thread &worker : workers) {
+            worker.join();
+        }
+
+        TS_ASSERT_EQUALS(merged.m_points.size(), vlp16.m_frames.size());
+        int32_t previous = -1;
+        for (uint32_t k = 0; k < merged.m_points.size(); k++) {
+            const uint32_t reference = static_cast< uint32_t >(vlp16.m_frames[k].size() / 4);
+            TS_ASSERT_EQUALS(findFrame(vlp16.m_frames, VelodyneExtrinsics(), merged.m_points[k].data(), reference), static_cast< int32_t >(k));
+            if (merged.m_merged[k][1]) {
+                const uint32_t count = static_cast< uint32_t >(merged.m_points[k].size() / 4) - reference;
+                const int32_t frame = findFrame(hdl32e.m_frames, right, merged.m_points[k].data() + reference * 4, count);
+                TS_ASSERT(frame > previous);
+                previous = frame;
+            }
+        }
+        const VelodyneFusionStatistics statistics = fusion.getSensor(1).getStatistics();
+        TS_ASSERT_EQUALS(statistics.decoded, hdl32e.m_frames.size());
+        TS_ASSERT(statistics.decoded - statistics.merged - statistics.overwritten <= 1);
+    }
+};
+
+#endif /*VELODYNEFUSION_TESTSUITE_H*/
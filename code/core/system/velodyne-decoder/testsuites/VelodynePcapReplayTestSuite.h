@@ -0,0 +1,217 @@
+/**
+ * velodyne-decoder - Decoder core shared by the Velodyne proxies.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VELODYNEPCAPREPLAY_TESTSUITE_H
+#define VELODYNEPCAPREPLAY_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "opendavinci/generated/odcore/data/SharedPointCloud.h"
+#include "opendavinci/odcore/data/Container.h"
+#include "opendavinci/odcore/io/conference/ContainerConference.h"
+#include "opendavinci/odcore/wrapper/SharedMemoryFactory.h"
+
+#include "../include/VelodyneDecoder.h"
+#include "../include/VelodynePcapReader.h"
+#include "../include/VelodynePcapReplay.h"
+
+using namespace std;
+using namespace odcore::data;
+using namespace odcore::wrapper;
+using namespace opendlv::core::system::proxy;
+
+// Keeps the sample time stamps of the shared point clouds.
+class ReplayedFrames : public odcore::io::conference::ContainerConference {
+   public:
+    ReplayedFrames()
+        : ContainerConference()
+        , m_sampleTimeStamps() {}
+
+    virtual void send(Container &c) const {
+        if (c.getDataType() == SharedPointCloud::ID()) {
+            m_sampleTimeStamps.push_back(c.getSampleTimeStamp().toMicroseconds());
+        }
+    }
+
+    mutable vector< int64_t > m_sampleTimeStamps;
+};
+
+inline void appendBigEndian(string &s, const uint32_t &value, const uint32_t &bytes) {
+    for (uint32_t i = 0; i < bytes; i++) {
+        s.push_back(static_cast< char >((value >> (8 * (bytes - 1 - i))) & 0xff));
+    }
+}
+
+class VelodynePcapReplayTest : public CxxTest::TestSuite {
+   public:
+    void testPcapFile() {
+        VelodynePcapFile file("../sampleShort.pcap");
+        TS_ASSERT(file.isValid());
+        const vector< string > packets = VelodynePcapReader::readDataPackets("../sampleShort.pcap");
+        TS_ASSERT_EQUALS(packets.size(), 291u);
+
+        const uint8_t *payload = NULL;
+        int64_t timestamp = 0;
+        int64_t previous = 0;
+        uint32_t count = 0;
+        while (file.nextDataPacket(payload, timestamp)) {
+            TS_ASSERT(count < packets.size() && memcmp(payload, packets[count].data(), VelodynePcapFile::PAYLOAD) == 0);
+            TS_ASSERT(timestamp >= previous);
+            previous = timestamp;
+            count++;
+        }
+        TS_ASSERT_EQUALS(count, packets.size());
+        TS_ASSERT(!file.nextDataPacket(payload, timestamp));
+        file.rewind();
+        TS_ASSERT(file.nextDataPacket(payload, timestamp));
+        TS_ASSERT_EQUALS(memcmp(payload, packets[0].data(), VelodynePcapFile::PAYLOAD), 0);
+
+        VelodynePcapFile missing("../missing.pcap");
+        TS_ASSERT(!missing.isValid());
+        TS_ASSERT(!missing.nextDataPacket(payload, timestamp));
+    }
+
+    void testBigEndianNanosecondsLinuxCooked() {
+        // The packets of the recording written on a big endian machine with nanosecond time stamps and Linux cooked capture headers.
+        const vector< string > packets = VelodynePcapReader::readDataPackets("../sampleShort.pcap");
+        string pcap;
+        appendBigEndian(pcap, 0xa1b23c4d, 4);
+        appendBigEndian(pcap, 2, 2);
+        appendBigEndian(pcap, 4, 2);
+        appendBigEndian(pcap, 0, 8);
+        appendBigEndian(pcap, 65535, 4);
+        appendBigEndian(pcap, 113, 4);
+        for (uint32_t i = 0; i < packets.size(); i++) {
+            string packet(14, '\0');
+            appendBigEndian(packet, 0x0800, 2);
+            appendBigEndian(packet, 0x45000000 | (20 + 8 + VelodynePcapFile::PAYLOAD), 4);
+            appendBigEndian(packet, 0, 4);
+            appendBigEndian(packet, 0xff110000, 4);
+            appendBigEndian(packet, 0, 8);
+            appendBigEndian(packet, (2368 << 16) | 2368, 4);
+            appendBigEndian(packet, (8 + VelodynePcapFile::PAYLOAD) << 16, 4);
+            packet += packets[i];
+            appendBigEndian(pcap, 1500000000 + i, 4);
+            appendBigEndian(pcap, 123456789, 4);
+            appendBigEndian(pcap, static_cast< uint32_t >(packet.size()), 4);
+            appendBigEndian(pcap, static_cast< uint32_t >(packet.size()), 4);
+            pcap += packet;
+        }
+        // Records of other protocols are skipped.
+        appendBigEndian(pcap, 1600000000, 4);
+        appendBigEndian(pcap, 0, 4);
+        appendBigEndian(pcap, 18, 4);
+        appendBigEndian(pcap, 18, 4);
+        pcap += string(14, '\0');
+        appendBigEndian(pcap, 0x86dd, 2);
+        appendBigEndian(pcap, 0, 2);
+        {
+            ofstream out("bigEndian.pcap", ios::binary);
+            out.write(pcap.data(), static_cast< streamsize >(pcap.size()));
+        }
+
+        VelodynePcapFile file("bigEndian.pcap");
+        TS_ASSERT(file.isValid());
+        const uint8_t *payload = NULL;
+        int64_t timestamp = 0;
+        uint32_t count = 0;
+        while (file.nextDataPacket(payload, timestamp)) {
+            TS_ASSERT_EQUALS(timestamp, (1500000000L + count) * 1000000L + 123456L);
+            TS_ASSERT(count < packets.size() && memcmp(payload, packets[count].data(), VelodynePcapFile::PAYLOAD) == 0);
+            count++;
+        }
+        TS_ASSERT_EQUALS(count, packets.size());
+    }
+
+    void testReplayAsFastAsPossible() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        ReplayedFrames reference;
+        VelodyneDecoder< VLP16 > referenceDecoder(SharedMemoryFactory::createSharedMemory("replayReferenceSM", VelodyneDecoderCore< VLP16 >::SIZE), reference, "../VLP-16.xml", options);
+        const vector< string > packets = VelodynePcapReader::readDataPackets("../sampleShort.pcap");
+        for (auto &packet : packets) {
+            referenceDecoder.nextString(packet);
+        }
+        TS_ASSERT(reference.m_sampleTimeStamps.size() > 1);
+
+        ReplayedFrames replayed;
+        VelodyneDecoder< VLP16 > decoder(SharedMemoryFactory::createSharedMemory("replayFastSM", VelodyneDecoderCore< VLP16 >::SIZE), replayed, "../VLP-16.xml", options);
+        VelodynePcapReplay< VelodyneDecoder< VLP16 > > replay("../sampleShort.pcap", decoder, 0.0);
+        TS_ASSERT(replay.isValid());
+        const VelodyneReplayStatistics statistics = replay.run();
+        TS_ASSERT(replay.isFinished());
+        TS_ASSERT_EQUALS(statistics.packets, packets.size());
+        TS_ASSERT_EQUALS(statistics.frames, reference.m_sampleTimeStamps.size());
+        TS_ASSERT_EQUALS(statistics.frames, decoder.getNumberOfFrames());
+        TS_ASSERT_EQUALS(replayed.m_sampleTimeStamps.size(), reference.m_sampleTimeStamps.size());
+        TS_ASSERT(statistics.recordedDuration > 300000 && statistics.recordedDuration < 500000);
+        TS_ASSERT(statistics.replayDuration < statistics.recordedDuration);
+        TS_ASSERT(statistics.decodeTime <= statistics.replayDuration);
+        TS_ASSERT(statistics.maxFrameLatency >= 0);
+        TS_ASSERT(statistics.frameLatencySum >= statistics.maxFrameLatency);
+        TS_ASSERT_EQUALS(statistics.latePackets, 0u);
+    }
+
+    void testPacedReplay() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        ReplayedFrames replayed;
+        VelodyneDecoder< VLP16 > decoder(SharedMemoryFactory::createSharedMemory("replayPacedSM", VelodyneDecoderCore< VLP16 >::SIZE), replayed, "../VLP-16.xml", options);
+        VelodynePcapReplay< VelodyneDecoder< VLP16 > > replay("../sampleShort.pcap", decoder, 4.0);
+        TS_ASSERT(replay.start());
+        while (!replay.isFinished()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        replay.stop();
+        const VelodyneReplayStatistics statistics = replay.getStatistics();
+        TS_ASSERT_EQUALS(statistics.packets, 291u);
+        // A quarter of the recorded time; the frames are stamped with the time they were replayed at.
+        TS_ASSERT(statistics.replayDuration >= statistics.recordedDuration / 4);
+        TS_ASSERT(statistics.replayDuration < statistics.recordedDuration);
+        // The first frame is a partial rotation.
+        TS_ASSERT(replayed.m_sampleTimeStamps.size() > 2);
+        for (uint32_t i = 2; i < replayed.m_sampleTimeStamps.size(); i++) {
+            const int64_t interval = replayed.m_sampleTimeStamps[i] - replayed.m_sampleTimeStamps[i - 1];
+            TS_ASSERT(interval > 15000 && interval < 35000); // 100 ms per rotation at 10 Hz
+        }
+    }
+
+    void testStop() {
+        const VelodyneDecoderOptions options = {true, 0, false, 0, 0, 0, 0};
+        ReplayedFrames replayed;
+        VelodyneDecoder< VLP16 > decoder(SharedMemoryFactory::createSharedMemory("replayStopSM", VelodyneDecoderCore< VLP16 >::SIZE), replayed, "../VLP-16.xml", options);
+        VelodynePcapReplay< VelodyneDecoder< VLP16 > > replay("../sampleShort.pcap", decoder, 0.1);
+        TS_ASSERT(replay.start());
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        replay.stop();
+        TS_ASSERT(!replay.isFinished());
+        const VelodyneReplayStatistics statistics = replay.getStatistics();
+        TS_ASSERT(statistics.packets > 0 && statistics.packets < 291u);
+
+        VelodynePcapReplay< VelodyneDecoder< VLP16 > > missing("../missing.pcap", decoder, 1.0);
+        TS_ASSERT(!missing.isValid());
+        TS_ASSERT(!missing.start());
+    }
+};
+
+#endif /*VELODYNEPCAPREPLAY_TESTSUITE_H*/
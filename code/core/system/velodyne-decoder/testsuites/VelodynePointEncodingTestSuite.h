@@ -0,0 +1,165 @@
+/**
+ * velodyne-decoder - Decoder core shared by the Velodyne proxies.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VELODYNEPOINTENCODING_TESTSUITE_H
+#define VELODYNEPOINTENCODING_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "../include/VelodynePointEncoding.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+inline float fromBits(const uint32_t &bits) {
+    float value = 0.0f;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+class VelodynePointEncodingTest : public CxxTest::TestSuite {
+   public:
+    void testHalfRounding() {
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(1.0f), 0x3C00);
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(-2.0f), 0xC000);
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(-0.0f), 0x8000);
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(65504.0f), 0x7BFF);
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(65519.0f), 0x7BFF);
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(65520.0f), 0x7C00);
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(1.0f + 1.0f / 2048.0f), 0x3C00); // Tie to even.
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(1.0f + 3.0f / 2048.0f), 0x3C02);
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(1.9996f), 0x4000); // Carry into the exponent.
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(ldexpf(1.0f, -24)), 0x0001);
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(ldexpf(1.0f, -25)), 0x0000);
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(ldexpf(1.5f, -25)), 0x0001);
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(ldexpf(1.0f, -14)), 0x0400);
+        TS_ASSERT_EQUALS(VelodynePointEncoding::toHalf(ldexpf(1023.5f, -24)), 0x0400); // Largest subnormal rounds up to the smallest normal.
+        TS_ASSERT(std::isnan(VelodynePointEncoding::fromHalf(VelodynePointEncoding::toHalf(fromBits(0x7FC00000)))));
+        TS_ASSERT(std::isinf(VelodynePointEncoding::fromHalf(0x7C00)));
+    }
+
+    void testHalfRoundTrip() {
+        // Every half precision float survives the conversion to float and back, with and without F16C.
+        vector< uint16_t > halves(65536);
+        for (uint32_t h = 0; h < halves.size(); h++) {
+            halves[h] = static_cast< uint16_t >(h);
+        }
+        const bool useF16C[] = {false, true};
+        for (const bool f16c : useF16C) {
+            vector< float > floats(halves.size());
+            VelodynePointEncoding::decode(VelodynePointEncoding::FLOAT16, halves.data(), static_cast< uint32_t >(halves.size() / 4), floats.data(), f16c);
+            vector< uint16_t > back(halves.size());
+            VelodynePointEncoding::encode(VelodynePointEncoding::FLOAT16, floats.data(), static_cast< uint32_t >(floats.size() / 4), back.data(), f16c);
+            uint32_t mismatches = 0;
+            for (uint32_t h = 0; h < halves.size(); h++) {
+                const bool nan = ((h & 0x7C00) == 0x7C00) && ((h & 0x3FF) != 0);
+                mismatches += (nan ? !std::isnan(floats[h]) : (back[h] != halves[h]));
+            }
+            TS_ASSERT_EQUALS(mismatches, 0u);
+        }
+    }
+
+    void testHalfMatchesF16C() {
+        if (!VelodynePointEncoding::hasF16C()) {
+            TS_SKIP("No F16C on this CPU.");
+        }
+        // Float bit patterns spread over all exponents and both signs.
+        vector< float > floats;
+        for (uint64_t bits = 0; bits < 0x100000000ull; bits += 65521) {
+            const float value = fromBits(static_cast< uint32_t >(bits));
+            floats.push_back(std::isnan(value) ? 0.0f : value);
+        }
+        floats.resize(floats.size() - floats.size() % 4);
+        vector< uint16_t > scalar(floats.size());
+        vector< uint16_t > f16c(floats.size());
+        VelodynePointEncoding::encode(VelodynePointEncoding::FLOAT16, floats.data(), static_cast< uint32_t >(floats.size() / 4), scalar.data(), false);
+        VelodynePointEncoding::encode(VelodynePointEncoding::FLOAT16, floats.data(), static_cast< uint32_t >(floats.size() / 4), f16c.data(), true);
+        TS_ASSERT(scalar == f16c);
+    }
+
+    void testInt16() {
+        const float nan = std::numeric_limits< float >::quiet_NaN();
+        const float points[] = {1.2345f, -0.0024f, 120.0f, 255.0f, 200.0f, -200.0f, 0.0f, 0.0f, nan, nan, nan, 17.0f};
+        int16_t encoded[12];
+        VelodynePointEncoding::encode(VelodynePointEncoding::INT16, points, 3, encoded);
+        TS_ASSERT_EQUALS(encoded[0], 247);
+        TS_ASSERT_EQUALS(encoded[1], 0);
+        TS_ASSERT_EQUALS(encoded[2], 24000);
+        TS_ASSERT_EQUALS(encoded[3], 255);
+        TS_ASSERT_EQUALS(encoded[4], 32767); // Clamped beyond +-163 m.
+        TS_ASSERT_EQUALS(encoded[5], -32767);
+        TS_ASSERT_EQUALS(encoded[8], static_cast< int16_t >(VelodynePointEncoding::INT16_INVALID));
+        TS_ASSERT_EQUALS(encoded[11], 17);
+
+        float decoded[12];
+        VelodynePointEncoding::decode(VelodynePointEncoding::INT16, encoded, 3, decoded);
+        TS_ASSERT_DELTA(decoded[0], 1.235f, 1e-6f);
+        TS_ASSERT_DELTA(decoded[2], 120.0f, 1e-4f);
+        TS_ASSERT_EQUALS(decoded[3], 255.0f);
+        TS_ASSERT(std::isnan(decoded[8]) && std::isnan(decoded[9]) && std::isnan(decoded[10]));
+        TS_ASSERT_EQUALS(decoded[11], 17.0f);
+
+        // Pairs of points are converted with SSE2 where available; single points as the scalar remainder.
+        vector< float > sweep;
+        for (int32_t k = -40000; k <= 40000; k += 7) {
+            sweep.push_back(static_cast< float >(k) * 0.0051f);
+        }
+        sweep.push_back(nan);
+        sweep.push_back(1e12f);
+        sweep.push_back(-1e12f);
+        sweep.resize(sweep.size() + (4 - sweep.size() % 4) % 4, 0.5f);
+        const uint32_t numberOfPoints = static_cast< uint32_t >(sweep.size() / 4);
+        vector< int16_t > pairs(sweep.size());
+        VelodynePointEncoding::encode(VelodynePointEncoding::INT16, sweep.data(), numberOfPoints, pairs.data());
+        vector< int16_t > singles(sweep.size());
+        for (uint32_t i = 0; i < numberOfPoints; i++) {
+            VelodynePointEncoding::encode(VelodynePointEncoding::INT16, &sweep[i * 4], 1, &singles[i * 4]);
+        }
+        TS_ASSERT(pairs == singles);
+        vector< float > decodedPairs(sweep.size());
+        VelodynePointEncoding::decode(VelodynePointEncoding::INT16, pairs.data(), numberOfPoints, decodedPairs.data());
+        uint32_t mismatches = 0;
+        for (uint32_t i = 0; i < numberOfPoints; i++) {
+            float single[4];
+            VelodynePointEncoding::decode(VelodynePointEncoding::INT16, &pairs[i * 4], 1, single);
+            for (uint32_t c = 0; c < 4; c++) {
+                mismatches += (std::isnan(single[c]) != std::isnan(decodedPairs[i * 4 + c])) || (!std::isnan(single[c]) && (single[c] < decodedPairs[i * 4 + c] || single[c] > decodedPairs[i * 4 + c]));
+            }
+        }
+        TS_ASSERT_EQUALS(mismatches, 0u);
+    }
+
+    void testSizes() {
+        TS_ASSERT_EQUALS(VelodynePointEncoding::getBytesPerPoint(VelodynePointEncoding::FLOAT32), 16u);
+        TS_ASSERT_EQUALS(VelodynePointEncoding::getBytesPerPoint(VelodynePointEncoding::INT16), 8u);
+        TS_ASSERT_EQUALS(VelodynePointEncoding::getBytesPerPoint(VelodynePointEncoding::FLOAT16), 8u);
+
+        const float points[] = {1.0f, 2.0f, 3.0f, 4.0f};
+        float copy[4];
+        VelodynePointEncoding::encode(VelodynePointEncoding::FLOAT32, points, 1, copy);
+        TS_ASSERT_SAME_DATA(points, copy, sizeof(points));
+    }
+};
+
+#endif /*VELODYNEPOINTENCODING_TESTSUITE_H*/
@@ -0,0 +1,187 @@
+/**
+ * velodyne-decoder - Decoder core shared by the Velodyne proxies.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VELODYNEPOSEBUFFER_TESTSUITE_H
+#define VELODYNEPOSEBUFFER_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <cmath>
+#include <vector>
+
+#include "../include/VelodynePoseBuffer.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+// Degrees of latitude for the given meters to the north.
+inline double northToLatitude(const double &meters) {
+    return meters / 6378137.0 * 180.0 / M_PI;
+}
+
+// Pose with the given position and heading; roll and pitch are 0.
+inline VelodynePose makePose(const int64_t &time, const double &north, const double &east, const double &heading) {
+    VelodynePose pose;
+    pose.time = time;
+    pose.position[0] = north;
+    pose.position[1] = east;
+    pose.position[2] = 0.0;
+    pose.orientation[0] = cos(0.5 * heading);
+    pose.orientation[1] = 0.0;
+    pose.orientation[2] = 0.0;
+    pose.orientation[3] = sin(0.5 * heading);
+    return pose;
+}
+
+// Sensor coordinates (x right, y forward, z up) of a world point seen from the given vehicle pose.
+inline void toSensor(const double &north, const double &east, const double &heading, const double point[2], float sensor[4]) {
+    const double dn = point[0] - north;
+    const double de = point[1] - east;
+    sensor[0] = static_cast< float >(-sin(heading) * dn + cos(heading) * de);
+    sensor[1] = static_cast< float >(cos(heading) * dn + sin(heading) * de);
+    sensor[2] = 0.0f;
+    sensor[3] = 1.0f;
+}
+
+class VelodynePoseBufferTest : public CxxTest::TestSuite {
+   public:
+    void testInterpolation() {
+        VelodynePoseBuffer poses(4);
+        VelodynePose pose;
+        TS_ASSERT(!poses.interpolate(0, pose));
+
+        poses.push(makePose(1000000, 0.0, 0.0, 0.0));
+        poses.push(makePose(1100000, 10.0, 0.0, 0.2));
+        TS_ASSERT(poses.interpolate(1050000, pose));
+        TS_ASSERT_DELTA(pose.position[0], 5.0, 1e-9);
+        TS_ASSERT_DELTA(pose.orientation[3], sin(0.05), 1e-9);
+
+        // Beyond the latest pose the motion is continued for up to 50 ms.
+        TS_ASSERT(poses.interpolate(1120000, pose));
+        TS_ASSERT_DELTA(pose.position[0], 12.0, 1e-9);
+        TS_ASSERT_DELTA(pose.orientation[3], sin(0.12), 1e-9);
+        TS_ASSERT(!poses.interpolate(1100000 + VelodynePoseBuffer::MAX_EXTRAPOLATION + 1, pose));
+        TS_ASSERT(!poses.interpolate(999999, pose));
+
+        // Lookups going back in time still find their poses.
+        TS_ASSERT(poses.interpolate(1010000, pose));
+        TS_ASSERT_DELTA(pose.position[0], 1.0, 1e-9);
+    }
+
+    void testRingWrapsAround() {
+        VelodynePoseBuffer poses(3);
+        for (uint32_t i = 0; i < 10; i++) {
+            poses.push(makePose(i * 10000, i, 0.0, 0.0));
+        }
+        poses.push(makePose(50000, 100.0, 0.0, 0.0)); // Out of order: ignored.
+        TS_ASSERT_EQUALS(poses.size(), 4u);
+
+        VelodynePose pose;
+        TS_ASSERT(!poses.interpolate(55000, pose)); // Overwritten.
+        TS_ASSERT(poses.interpolate(65000, pose));
+        TS_ASSERT_DELTA(pose.position[0], 6.5, 1e-9);
+        TS_ASSERT(poses.interpolate(85000, pose));
+        TS_ASSERT_DELTA(pose.position[0], 8.5, 1e-9);
+    }
+
+    void testCapacityIsLimited() {
+        VelodynePoseBuffer poses(0xFFFFFFFFu); // Rounding up would overflow.
+        TS_ASSERT_EQUALS(poses.size(), 0u);
+    }
+
+    void testGeodeticAndAngularVelocity() {
+        VelodynePoseBuffer geodetic(8);
+        geodetic.pushGeodetic(0, 57.7, 11.9, 10.0, 0.0, 0.0, 0.0);
+        geodetic.pushGeodetic(100000, 57.7 + northToLatitude(2.0), 11.9, 9.0, 0.0, 0.0, 90.0);
+        VelodynePose pose;
+        TS_ASSERT(geodetic.interpolate(100000, pose));
+        TS_ASSERT_DELTA(pose.position[0], 2.0, 1e-6);
+        TS_ASSERT_DELTA(pose.position[1], 0.0, 1e-6);
+        TS_ASSERT_DELTA(pose.position[2], 1.0, 1e-6); // 1 m up is -1 m down.
+        TS_ASSERT_DELTA(pose.orientation[3], sin(M_PI / 4.0), 1e-9);
+
+        // Yawing with 1 rad/s for 100 ms.
+        VelodynePoseBuffer imu(16);
+        const double angularVelocity[3] = {0.0, 0.0, 1.0};
+        for (int64_t t = 0; t <= 100000; t += 10000) {
+            imu.pushAngularVelocity(t, angularVelocity);
+        }
+        TS_ASSERT(imu.interpolate(100000, pose));
+        TS_ASSERT_DELTA(pose.orientation[0], cos(0.05), 1e-9);
+        TS_ASSERT_DELTA(pose.orientation[3], sin(0.05), 1e-9);
+        TS_ASSERT_DELTA(pose.position[0], 0.0, 1e-12);
+    }
+
+    void testDeskewMovesPointsToFrameEnd() {
+        // The vehicle drives north with 20 m/s while turning right with 1 rad/s; the points are static.
+        VelodynePoseBuffer poses(64);
+        const int64_t start = 5000000;
+        for (int64_t t = start - 20000; t <= start + 120000; t += 5000) {
+            const double s = static_cast< double >(t - start) * 1e-6;
+            poses.push(makePose(t, 20.0 * s, 0.0, s));
+        }
+
+        // Four points per firing, one firing every 10 ms.
+        const double world[4][2] = {{30.0, 0.0}, {10.0, 5.0}, {-8.0, -3.0}, {0.0, 12.0}};
+        const uint32_t FIRINGS = 11;
+        vector< float > points(FIRINGS * 4 * 4);
+        vector< float > timeOffsets(FIRINGS * 4);
+        for (uint32_t firing = 0; firing < FIRINGS; firing++) {
+            const double s = firing * 0.01;
+            for (uint32_t i = 0; i < 4; i++) {
+                toSensor(20.0 * s, 0.0, s, world[i], &points[(firing * 4 + i) * 4]);
+                timeOffsets[firing * 4 + i] = static_cast< float >(firing * 10000 + i); // The lasers of a firing follow within microseconds.
+            }
+        }
+
+        TS_ASSERT_EQUALS(poses.deskew(points.data(), timeOffsets.data(), FIRINGS * 4, start, start + 100000, 55.0f), FIRINGS * 4);
+        for (uint32_t firing = 0; firing < FIRINGS; firing++) {
+            for (uint32_t i = 0; i < 4; i++) {
+                float expected[4];
+                toSensor(2.0, 0.0, 0.1, world[i], expected);
+                const float *p = &points[(firing * 4 + i) * 4];
+                TS_ASSERT_DELTA(p[0], expected[0], 1e-3f);
+                TS_ASSERT_DELTA(p[1], expected[1], 1e-3f);
+                TS_ASSERT_DELTA(p[2], expected[2], 1e-3f);
+                TS_ASSERT_EQUALS(p[3], 1.0f);
+            }
+        }
+
+        // Without poses for the frame the points are left as they are.
+        TS_ASSERT_EQUALS(poses.deskew(points.data(), timeOffsets.data(), FIRINGS * 4, start + 10000000, start + 10100000, 55.0f), 0u);
+    }
+
+    void testSensorMounting() {
+        // Sensor turned by 90 degrees: its y axis points to the right of the vehicle.
+        VelodynePoseBuffer poses(8);
+        poses.setMounting(0.0, 0.0, M_PI / 2.0);
+        poses.push(makePose(0, 0.0, 0.0, 0.0));
+        poses.push(makePose(100000, 1.0, 0.0, 0.0));
+
+        // A point 10 m ahead of the vehicle is on the -x axis of the sensor; 1 m less ahead at the end.
+        float point[4] = {-10.0f, 0.0f, 0.0f, 1.0f};
+        const float timeOffset = 0.0f;
+        TS_ASSERT_EQUALS(poses.deskew(point, &timeOffset, 1, 0, 100000, 55.0f), 1u);
+        TS_ASSERT_DELTA(point[0], -9.0f, 1e-5f);
+        TS_ASSERT_DELTA(point[1], 0.0f, 1e-5f);
+        TS_ASSERT_DELTA(point[2], 0.0f, 1e-5f);
+    }
+};
+
+#endif /*VELODYNEPOSEBUFFER_TESTSUITE_H*/
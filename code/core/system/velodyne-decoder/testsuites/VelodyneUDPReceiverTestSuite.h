@@ -0,0 +1,203 @@
+/**
+ * velodyne-decoder - Decoder core shared by the Velodyne proxies.
+ * Copyright (C) 2017 Chalmers Revere
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VELODYNEUDPRECEIVER_TESTSUITE_H
+#define VELODYNEUDPRECEIVER_TESTSUITE_H
+
+#include "cxxtest/TestSuite.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "opendavinci/odcore/data/TimeStamp.h"
+
+#include "../include/VelodynePacketQueue.h"
+#include "../include/VelodynePcapReader.h"
+#include "../include/VelodyneUDPReceiver.h"
+
+using namespace std;
+using namespace opendlv::core::system::proxy;
+
+// Keeps a copy of every packet; only accessed by the decode thread until the receiver is stopped.
+class PacketCollector : public VelodynePacketListener {
+   public:
+    PacketCollector()
+        : m_packets()
+        , m_received() {}
+
+    virtual void nextPacket(const uint8_t *data, const uint32_t &length, const odcore::data::TimeStamp &received) {
+        m_packets.push_back(string(reinterpret_cast< const char * >(data), length));
+        m_received.push_back(received.toMicroseconds());
+    }
+
+    vector< string > m_packets;
+    vector< int64_t > m_received;
+};
+
+// The value doubles as the timestamp to check that both travel together.
+inline void pushValue(VelodynePacketQueue &queue, const uint32_t &value) {
+    memcpy(queue.getFreeBuffer(0), &value, sizeof(value));
+    const uint32_t length = sizeof(value);
+    const int64_t timestamp = value;
+    queue.push(1, &length, &timestamp);
+}
+
+inline uint32_t popValue(VelodynePacketQueue &queue) {
+    const uint8_t *data = NULL;
+    uint32_t length = 0;
+    int64_t timestamp = 0;
+    uint32_t value = 0;
+    if (queue.front(data, length, timestamp)) {
+        memcpy(&value, data, sizeof(value));
+        TS_ASSERT_EQUALS(timestamp, static_cast< int64_t >(value));
+        queue.pop();
+    }
+    return value;
+}
+
+class VelodyneUDPReceiverTest : public CxxTest::TestSuite {
+   public:
+    void testQueueWrapsAround() {
+        VelodynePacketQueue queue(5);
+        TS_ASSERT_EQUALS(queue.getCapacity(), 8u);
+        TS_ASSERT_EQUALS(queue.getFree(), 8u);
+
+        // Push three, pop one until full: the indexes wrap before the queue fills up.
+        uint32_t value = 0;
+        uint32_t expected = 0;
+        while (queue.getFree() > 0) {
+            pushValue(queue, value++);
+            if (value % 3 == 0) {
+                TS_ASSERT_EQUALS(popValue(queue), expected++);
+            }
+        }
+        TS_ASSERT_EQUALS(value, 11u);
+        TS_ASSERT_EQUALS(queue.size(), 8u);
+        TS_ASSERT_EQUALS(queue.getHighWaterMark(), 8u);
+        while (queue.size() > 0) {
+            TS_ASSERT_EQUALS(popValue(queue), expected++);
+        }
+        TS_ASSERT_EQUALS(expected, 11u);
+        TS_ASSERT_EQUALS(queue.getFree(), 8u);
+
+        const uint8_t *data = NULL;
+        uint32_t length = 0;
+        int64_t timestamp = 0;
+        TS_ASSERT(!queue.front(data, length, timestamp));
+    }
+
+    void testQueueCapacityIsLimited() {
+        VelodynePacketQueue queue(0x80000001u); // Rounding up would overflow.
+        TS_ASSERT_EQUALS(queue.getCapacity(), static_cast< uint32_t >(VelodynePacketQueue::MAX_CAPACITY));
+    }
+
+    void testQueueBetweenThreads() {
+        const uint32_t COUNT = 200000;
+        VelodynePacketQueue queue(64);
+        std::thread producer([&queue, COUNT]() {
+            for (uint32_t value = 1; value <= COUNT; value++) {
+                while (queue.getFree() == 0) {
+                    std::this_thread::yield();
+                }
+                pushValue(queue, value);
+            }
+        });
+
+        uint32_t expected = 1;
+        uint32_t outOfOrder = 0;
+        while (expected <= COUNT) {
+            const uint32_t value = popValue(queue);
+            if (value == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (value != expected) {
+                outOfOrder++;
+            }
+            expected++;
+        }
+        producer.join();
+        TS_ASSERT_EQUALS(outOfOrder, 0u);
+        TS_ASSERT(queue.getHighWaterMark() <= 64u);
+    }
+
+    void testReceiveLoopback() {
+        const vector< string > packets = VelodynePcapReader::readDataPackets("../atwallshort.pcap");
+        TS_ASSERT(!packets.empty());
+
+        PacketCollector collector;
+        VelodyneUDPReceiver receiver("127.0.0.1", 0, collector, 1024);
+        receiver.setBatchSize(8);
+        receiver.setReceiveBufferSize(1 << 20);
+        TS_ASSERT(receiver.start());
+        TS_ASSERT(receiver.getPort() != 0);
+
+        const int32_t s = socket(AF_INET, SOCK_DGRAM, 0);
+        struct sockaddr_in address;
+        memset(&address, 0, sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast< uint16_t >(receiver.getPort()));
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        const odcore::data::TimeStamp before;
+        for (uint32_t i = 0; i < packets.size(); i++) {
+            sendto(s, packets[i].data(), packets[i].size(), 0, reinterpret_cast< struct sockaddr * >(&address), sizeof(address));
+            if (i % 32 == 31) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        close(s);
+        const odcore::data::TimeStamp after;
+
+        for (uint32_t i = 0; i < 200; i++) {
+            const VelodyneReceiverStatistics statistics = receiver.getStatistics();
+            if (statistics.packets + statistics.queueDrops + statistics.kernelDrops >= packets.size()) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        receiver.stop();
+
+        const VelodyneReceiverStatistics statistics = receiver.getStatistics();
+        TS_ASSERT_EQUALS(statistics.packets, packets.size());
+        TS_ASSERT_EQUALS(statistics.queueDrops, 0u);
+        TS_ASSERT_EQUALS(statistics.kernelDrops, 0u);
+        TS_ASSERT(statistics.batches > 0u);
+        TS_ASSERT(statistics.highWaterMark > 0u && statistics.highWaterMark <= statistics.capacity);
+        // The kernel reports twice the granted size; at most the requested size is granted.
+        TS_ASSERT(statistics.receiveBufferSize > 0u && statistics.receiveBufferSize <= (1u << 20));
+        TS_ASSERT(collector.m_packets == packets);
+
+        // Receive times are taken by the kernel while the packets were sent.
+        TS_ASSERT_EQUALS(collector.m_received.size(), packets.size());
+        for (uint32_t i = 0; i < collector.m_received.size(); i++) {
+            TS_ASSERT(collector.m_received[i] >= before.toMicroseconds() && collector.m_received[i] <= after.toMicroseconds());
+            TS_ASSERT(i == 0 || collector.m_received[i] >= collector.m_received[i - 1]);
+        }
+    }
+};
+
+#endif /*VELODYNEUDPRECEIVER_TESTSUITE_H*/
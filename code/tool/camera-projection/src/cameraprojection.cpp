@@ -31,6 +31,8 @@
 
 #include "opendavinci/odcore/strings/StringToolbox.h"
 
+#include "SharedImageRing.h"
+
 #include "cameraprojection.hpp"
 
 namespace opendlv {
@@ -136,7 +138,14 @@ void CameraProjection::nextContainer(odcore::data::Container &a_c)
   if (a_c.getDataType() == odcore::data::image::SharedImage::ID()) {
     odcore::data::image::SharedImage mySharedImg =
         a_c.getData<odcore::data::image::SharedImage>();
-    if (mySharedImg.getName().compare(m_cameraName) != 0) {
+    // Images from a proxy writing into several slots come from "<name>.<k>".
+    const std::string imgName = mySharedImg.getName();
+    const std::string slotPrefix = m_cameraName + ".";
+    const bool fromRing = imgName.size() > slotPrefix.size()
+        && imgName.compare(0, slotPrefix.size(), slotPrefix) == 0
+        && imgName.find_first_not_of("0123456789", slotPrefix.size())
+            == std::string::npos;
+    if (imgName.compare(m_cameraName) != 0 && !fromRing) {
       std::cout << "[" << getName() << "] Received shared image from: " 
           << mySharedImg.getName() << ", was expecting: " << m_cameraName 
           << std::endl;
@@ -163,10 +172,21 @@ void CameraProjection::nextContainer(odcore::data::Container &a_c)
       return;
     }
 
-    sharedMem->lock();
-    memcpy(m_image.data, sharedMem->getSharedMemory(), 
-        imgWidth*imgHeight*nrChannels);
-    sharedMem->unlock();
+    if (fromRing) {
+      // The slot is not locked; an image overwritten while copying is skipped.
+      uint32_t frame = 0;
+      if (!opendlv::core::system::proxy::SharedImageRing::read(
+          sharedMem->getSharedMemory(), sharedMem->getSize(), m_image.data,
+          imgWidth*imgHeight*nrChannels, frame)) {
+        cvReleaseImage(&myIplImage);
+        return;
+      }
+    } else {
+      sharedMem->lock();
+      memcpy(m_image.data, sharedMem->getSharedMemory(), 
+          imgWidth*imgHeight*nrChannels);
+      sharedMem->unlock();
+    }
 
     putText(m_image, "Rectangle width: " + std::to_string(m_recWidth),
         cvPoint(30, 30), 1, 0.8, cvScalar(0, 0, 254), 1, CV_AA);